@@ -0,0 +1,48 @@
+//----------------------------------------------------------------------------
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <malloc.h>
+//----------------------------------------------------------------------------
+#include "allocation_counter.hpp"
+//----------------------------------------------------------------------------
+namespace
+{
+//----------------------------------------------------------------------------
+std::atomic<std::size_t> allocations(0);
+std::atomic<std::size_t> bytes(0);
+std::atomic<std::size_t> live(0);
+//----------------------------------------------------------------------------
+} // namespace
+//----------------------------------------------------------------------------
+AllocationCounter AllocationCounter::snapshot()
+{
+  return AllocationCounter{allocations.load(std::memory_order_relaxed),
+                           bytes.load(std::memory_order_relaxed),
+                           live.load(std::memory_order_relaxed)};
+}
+//----------------------------------------------------------------------------
+void * operator new(std::size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  bytes.fetch_add(size, std::memory_order_relaxed);
+  void * ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  live.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+  return ptr;
+}
+//----------------------------------------------------------------------------
+void operator delete(void * ptr) noexcept
+{
+  if (ptr == nullptr)
+    return;
+  live.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+  std::free(ptr);
+}
+//----------------------------------------------------------------------------
+void operator delete(void * ptr, std::size_t) noexcept
+{
+  operator delete(ptr);
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
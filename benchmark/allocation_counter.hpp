@@ -0,0 +1,25 @@
+//----------------------------------------------------------------------------
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+//----------------------------------------------------------------------------
+#include <cstddef>
+//----------------------------------------------------------------------------
+/**
+ * @brief Process-wide counters of the replaced global operator new.
+ *
+ * Benchmarks take a snapshot before and after the timed loop and report the
+ * difference per iteration.
+ */
+struct AllocationCounter
+{
+//----------------------------------------------------------------------------
+  std::size_t allocations_; ///< Number of calls to operator new.
+  std::size_t bytes_;       ///< Total number of bytes requested from operator new.
+  std::size_t live_;        ///< Bytes currently held by the heap, including malloc overhead.
+//----------------------------------------------------------------------------
+  static AllocationCounter snapshot();
+//----------------------------------------------------------------------------
+}; // struct AllocationCounter
+//----------------------------------------------------------------------------
+#endif // ALLOCATION_COUNTER_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,56 @@
+//----------------------------------------------------------------------------
+#include <random>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "arc_cache.hpp"
+#include "workload.hpp"
+//----------------------------------------------------------------------------
+static constexpr int ARC_CAPACITY = 10000;
+static constexpr int ARC_KEYS     = 200000;
+static constexpr int ARC_PHASE    = 50000;
+//----------------------------------------------------------------------------
+/**
+ * @brief Read-through loop over a mixed key stream, reports the hit ratio.
+ *
+ * state.range(0) selects the workload:
+ * 0 - Zipf(0.9) only (frequency);
+ * 1 - Zipf(0.9) with every other request taken from a sequential scan;
+ * 2 - phases of ARC_PHASE requests that alternate between Zipf(0.9) and a
+ *     loop over 80% of the capacity of fresh keys (recency).
+ */
+template<class CacheT>
+static void BM_MixedHitRatio(benchmark::State & state)
+{
+  const int workload = static_cast<int>(state.range(0));
+  CacheT cache(ARC_CAPACITY);
+  ZipfDistribution zipf(ARC_KEYS, 0.9);
+  std::mt19937 gen(42);
+  std::size_t hits = 0;
+  std::size_t i    = 0;
+  int scanKey = ARC_KEYS;
+  int loopKey = 0;
+
+  for (auto _ : state)
+  {
+    int key = static_cast<int>(zipf(gen));
+    if (workload == 1 && i % 2 == 0)
+      key = scanKey++;
+    else if (workload == 2 && (i / ARC_PHASE) % 2 == 1)
+    {
+      const int loopBase = ARC_KEYS * (1 + static_cast<int>(i / ARC_PHASE));
+      key = loopBase + loopKey++ % (ARC_CAPACITY * 4 / 5);
+    }
+    ++i;
+    if (cache.get(key) != nullptr)
+      ++hits;
+    else
+      cache.put(key, key);
+  }
+  state.counters["hit_ratio"] = static_cast<double>(hits) / state.iterations();
+}
+//----------------------------------------------------------------------------
+BENCHMARK_TEMPLATE(BM_MixedHitRatio, LRUCache::Cache<int, int>)->DenseRange(0, 2)->Iterations(1000000);
+BENCHMARK_TEMPLATE(BM_MixedHitRatio, LRUCache::ArcCache<int, int>)->DenseRange(0, 2)->Iterations(1000000);
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,67 @@
+//----------------------------------------------------------------------------
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "async_cache.hpp"
+//----------------------------------------------------------------------------
+static constexpr int ASYNC_CAPACITY = 100000;
+static constexpr int ASYNC_HOT_KEYS = 1000;
+//----------------------------------------------------------------------------
+/**
+ * @brief Stand-in for a backend query that blocks for 200 microseconds.
+ */
+static int slowLoad(int key)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds(200));
+  return key;
+}
+//----------------------------------------------------------------------------
+static double percentile(std::vector<double> & samples, double fraction)
+{
+  if (samples.empty())
+    return 0;
+  auto it = samples.begin() + static_cast<std::ptrdiff_t>(fraction * (samples.size() - 1));
+  std::nth_element(samples.begin(), it, samples.end());
+  return *it;
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Hot-key reads mixed with state.range(0) misses per 100 requests on
+ *        fresh keys that take 200 us each to load on a pool of 4 workers.
+ *        Reports the latency percentiles of the get_async calls for hits and
+ *        misses, which should not depend on the number of loads in flight.
+ */
+static void BM_AsyncHitLatency(benchmark::State & state)
+{
+  LRUCache::AsyncCache<int, int> cache(ASYNC_CAPACITY, slowLoad, 4);
+  for (int i = 0; i < ASYNC_HOT_KEYS; ++i)
+    cache.put(i, i);
+  const int missPercent = static_cast<int>(state.range(0));
+  std::vector<double> hits;
+  std::vector<double> misses;
+  int next = ASYNC_HOT_KEYS;
+  int i    = 0;
+
+  for (auto _ : state)
+  {
+    const bool miss = i++ % 100 < missPercent;
+    const int key   = miss ? next++ : i % ASYNC_HOT_KEYS;
+    const auto start = std::chrono::steady_clock::now();
+    auto future = cache.get_async(key);
+    const auto end = std::chrono::steady_clock::now();
+    benchmark::DoNotOptimize(future);
+    (miss ? misses : hits).push_back(std::chrono::duration<double, std::nano>(end - start).count());
+  }
+  state.counters["hit_p50_ns"]  = percentile(hits, 0.5);
+  state.counters["hit_p99_ns"]  = percentile(hits, 0.99);
+  state.counters["hit_p999_ns"] = percentile(hits, 0.999);
+  state.counters["miss_p99_ns"] = percentile(misses, 0.99);
+}
+//----------------------------------------------------------------------------
+BENCHMARK(BM_AsyncHitLatency)->Arg(0)->Arg(1)->Arg(10);
+//----------------------------------------------------------------------------
\ No newline at end of file
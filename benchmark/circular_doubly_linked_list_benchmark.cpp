@@ -1,87 +1,153 @@
 //----------------------------------------------------------------------------
+#include <list>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <type_traits>
+#include <memory_resource>
+//----------------------------------------------------------------------------
 #include <benchmark/benchmark.h>
 //----------------------------------------------------------------------------
+#include "lru_cache.hpp"
 #include "circular_doubly_linked_list.hpp"
 //----------------------------------------------------------------------------
-static void BM_PushBackPopBack(benchmark::State & state)
+namespace
 {
-  CircularDoublyLinkedList<int> list;
-
-  for (auto _ : state)
-  {
-    list.pushBack(1);
-    list.popBack();
-  }
+//----------------------------------------------------------------------------
+constexpr int LIST_SIZE = 10000;
+//----------------------------------------------------------------------------
+using PmrListT = LRUCache::CircularDoublyLinkedList<int>;
+//----------------------------------------------------------------------------
+/**
+ * @brief Allocator of a list on `resource`, or the default one if the list
+ *        does not take a memory resource.
+ */
+template<class _ListT>
+typename _ListT::allocator_type listAllocator(std::pmr::memory_resource * resource)
+{
+  using AllocT = typename _ListT::allocator_type;
+  if constexpr (std::is_constructible<AllocT, std::pmr::memory_resource *>::value)
+    return AllocT(resource);
+  else
+    return AllocT();
 }
 //----------------------------------------------------------------------------
-static void BM_PushFrontPopFront(benchmark::State & state)
+/**
+ * @brief Memory resources a run can take its nodes from, by `state.range(0)`.
+ */
+enum class Resource : std::uint8_t
 {
-  CircularDoublyLinkedList<int> list;
-
-  for (auto _ : state)
+  HEAP,     ///< `new` and `delete`.
+  POOL,     ///< A `std::pmr::unsynchronized_pool_resource`.
+  MONOTONIC ///< A `std::pmr::monotonic_buffer_resource`, which never frees.
+};
+//----------------------------------------------------------------------------
+struct RunResource
+{
+//----------------------------------------------------------------------------
+  std::pmr::unsynchronized_pool_resource pool_;
+  std::pmr::monotonic_buffer_resource    monotonic_;
+  std::pmr::memory_resource *            resource_;
+//----------------------------------------------------------------------------
+  explicit RunResource(benchmark::State & state) :
+    monotonic_(LIST_SIZE * 64)
   {
-    list.pushFront(1);
-    list.popFront();
+    switch (static_cast<Resource>(state.range(0)))
+    {
+      case Resource::HEAP:      resource_ = std::pmr::new_delete_resource(); break;
+      case Resource::POOL:      resource_ = &pool_;                          break;
+      case Resource::MONOTONIC: resource_ = &monotonic_;                     break;
+    }
   }
-}
 //----------------------------------------------------------------------------
-static void BM_ToFrontWithTwoElems(benchmark::State & state)
+}; // struct RunResource
+//----------------------------------------------------------------------------
+} // namespace
+//----------------------------------------------------------------------------
+template<class _ListT>
+static void BM_PushBackPopBack(benchmark::State & state)
 {
-  CircularDoublyLinkedList<int> list = {1, 2};
+  RunResource resource(state);
+  _ListT list(listAllocator<_ListT>(resource.resource_));
 
   for (auto _ : state)
   {
-    auto it = list.begin();
-    ++it;
-    list.toFront(it);
+    list.push_back(1);
+    list.pop_back();
   }
 }
 //----------------------------------------------------------------------------
-static void BM_ToFrontWithThreeElems(benchmark::State & state)
+template<class _ListT>
+static void BM_PushFrontPopBack(benchmark::State & state)
 {
-  CircularDoublyLinkedList<int> list = {1, 2, 3};
+  // A FIFO ring: every iteration erases the oldest node and inserts a new one
+  RunResource resource(state);
+  _ListT list(listAllocator<_ListT>(resource.resource_));
+  for (int i = 0; i < LIST_SIZE; ++i)
+    list.push_front(i);
 
+  int i = 0;
   for (auto _ : state)
   {
-    auto it = list.begin();
-    ++it;
-    list.toFront(it);
+    list.push_front(++i);
+    list.pop_back();
   }
 }
 //----------------------------------------------------------------------------
-static void BM_ToBackWithTwoElems(benchmark::State & state)
+template<class _ListT>
+static void BM_SpliceToFront(benchmark::State & state)
 {
-  CircularDoublyLinkedList<int> list = {1, 2};
+  // LRU promotion of random entries
+  RunResource resource(state);
+  _ListT list(listAllocator<_ListT>(resource.resource_));
+  std::vector<typename _ListT::iterator> its;
+  for (int i = 0; i < LIST_SIZE; ++i)
+  {
+    list.push_front(i);
+    its.push_back(list.begin());
+  }
+  std::mt19937 gen(42);
+  std::vector<int> order(1 << 16);
+  for (int & index : order)
+    index = std::uniform_int_distribution<int>(0, LIST_SIZE - 1)(gen);
 
+  std::size_t i = 0;
   for (auto _ : state)
   {
-    auto it = list.begin();
-    ++it;
-    list.toBack(it);
+    list.splice(list.begin(), list, its[order[i++ & (order.size() - 1)]]);
+    benchmark::DoNotOptimize(list.front());
   }
 }
 //----------------------------------------------------------------------------
-static void BM_ToBackWithThreeElems(benchmark::State & state)
+template<class _ListT>
+static void BM_CacheMissChurn(benchmark::State & state)
 {
-  CircularDoublyLinkedList<int> list = {1, 2, 3};
+  // Every put misses and evicts: one list node erased and one inserted
+  RunResource resource(state);
+  LRUCache::Cache<int, int, _ListT> cache(LIST_SIZE, listAllocator<_ListT>(resource.resource_));
+  int key = 0;
+  for (; key < LIST_SIZE; ++key)
+    cache.put(key, key);
 
   for (auto _ : state)
   {
-    auto it = list.begin();
-    ++it;
-    list.toBack(it);
+    cache.put(key, key);
+    ++key;
   }
 }
 //----------------------------------------------------------------------------
-BENCHMARK(BM_PushBackPopBack);
-//----------------------------------------------------------------------------
-BENCHMARK(BM_PushFrontPopFront);
-//----------------------------------------------------------------------------
-BENCHMARK(BM_ToFrontWithTwoElems);
+// Only the lists that reuse their nodes are bounded on a monotonic resource
+BENCHMARK_TEMPLATE(BM_PushBackPopBack, std::list<int>)->ArgName("resource")->Arg(0);
+BENCHMARK_TEMPLATE(BM_PushBackPopBack, std::pmr::list<int>)->ArgName("resource")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_PushBackPopBack, PmrListT)->ArgName("resource")->Arg(0)->Arg(1)->Arg(2);
 //----------------------------------------------------------------------------
-BENCHMARK(BM_ToFrontWithThreeElems);
+BENCHMARK_TEMPLATE(BM_PushFrontPopBack, std::list<int>)->ArgName("resource")->Arg(0);
+BENCHMARK_TEMPLATE(BM_PushFrontPopBack, std::pmr::list<int>)->ArgName("resource")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_PushFrontPopBack, PmrListT)->ArgName("resource")->Arg(0)->Arg(1)->Arg(2);
 //----------------------------------------------------------------------------
-BENCHMARK(BM_ToBackWithTwoElems);
+BENCHMARK_TEMPLATE(BM_SpliceToFront, std::list<int>)->ArgName("resource")->Arg(0);
+BENCHMARK_TEMPLATE(BM_SpliceToFront, PmrListT)->ArgName("resource")->Arg(0);
 //----------------------------------------------------------------------------
-BENCHMARK(BM_ToBackWithThreeElems);
+BENCHMARK_TEMPLATE(BM_CacheMissChurn, std::list<int>)->ArgName("resource")->Arg(0);
+BENCHMARK_TEMPLATE(BM_CacheMissChurn, PmrListT)->ArgName("resource")->Arg(0)->Arg(1)->Arg(2);
 //----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,97 @@
+//----------------------------------------------------------------------------
+#include <memory>
+#include <random>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "clock_cache.hpp"
+#include "sharded_lru_cache.hpp"
+#include "workload.hpp"
+//----------------------------------------------------------------------------
+static constexpr int CLOCK_CAPACITY = 10000;
+static constexpr int CLOCK_KEYS     = 100000;
+//----------------------------------------------------------------------------
+/**
+ * @brief Read-through loop over a Zipf(alpha) key stream, alpha = state.range(0) / 100.
+ *        Reports the hit ratio of exact LRU.
+ */
+static void BM_ZipfHitRatioLRU(benchmark::State & state)
+{
+  LRUCache::Cache<int, int> cache(CLOCK_CAPACITY);
+  ZipfDistribution zipf(CLOCK_KEYS, state.range(0) / 100.0);
+  std::mt19937 gen(42);
+  std::size_t hits = 0;
+
+  for (auto _ : state)
+  {
+    const int key = static_cast<int>(zipf(gen));
+    if (cache.get(key) != nullptr)
+      ++hits;
+    else
+      cache.put(key, key);
+  }
+  state.counters["hit_ratio"] = static_cast<double>(hits) / state.iterations();
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Same workload as BM_ZipfHitRatioLRU, against the CLOCK approximation.
+ */
+static void BM_ZipfHitRatioClock(benchmark::State & state)
+{
+  LRUCache::ClockCache<int, int> cache(CLOCK_CAPACITY);
+  ZipfDistribution zipf(CLOCK_KEYS, state.range(0) / 100.0);
+  std::mt19937 gen(42);
+  std::size_t hits = 0;
+
+  for (auto _ : state)
+  {
+    const int key = static_cast<int>(zipf(gen));
+    int value;
+    if (cache.get(key, value))
+      ++hits;
+    else
+      cache.put(key, key);
+  }
+  state.counters["hit_ratio"] = static_cast<double>(hits) / state.iterations();
+}
+//----------------------------------------------------------------------------
+template<class CacheT>
+static std::unique_ptr<CacheT> & sharedCache()
+{
+  static std::unique_ptr<CacheT> cache;
+  return cache;
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Concurrent hits on a fully populated cache.
+ */
+template<class CacheT>
+static void BM_ConcurrentHits(benchmark::State & state)
+{
+  auto & cache = sharedCache<CacheT>();
+  if (state.thread_index() == 0)
+  {
+    cache.reset(new CacheT(CLOCK_CAPACITY));
+    for (int i = 0; i < CLOCK_CAPACITY; ++i)
+      cache->put(i, i);
+  }
+  ZipfDistribution zipf(CLOCK_CAPACITY, 0.99);
+  std::mt19937 gen(state.thread_index());
+
+  for (auto _ : state)
+  {
+    int value;
+    benchmark::DoNotOptimize(cache->get(static_cast<int>(zipf(gen)), value));
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0)
+    cache.reset();
+}
+//----------------------------------------------------------------------------
+BENCHMARK(BM_ZipfHitRatioLRU)->DenseRange(60, 120, 20);
+BENCHMARK(BM_ZipfHitRatioClock)->DenseRange(60, 120, 20);
+BENCHMARK_TEMPLATE(BM_ConcurrentHits, LRUCache::ShardedCache<int, int>)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConcurrentHits, LRUCache::ClockCache<int, int>)->ThreadRange(1, 64)->UseRealTime();
+//----------------------------------------------------------------------------
\ No newline at end of file
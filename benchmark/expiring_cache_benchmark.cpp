@@ -0,0 +1,114 @@
+//----------------------------------------------------------------------------
+#include <chrono>
+#include <random>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "expiring_cache.hpp"
+//----------------------------------------------------------------------------
+static constexpr int TTL_CAPACITY = 1 << 20;
+static constexpr int TTL_KEYS     = 1 << 16;
+//----------------------------------------------------------------------------
+/**
+ * @brief Deterministic clock: every operation of the benchmarks below moves it
+ *        forward by 10 microseconds.
+ */
+struct BenchmarkClock
+{
+  using duration   = std::chrono::microseconds;
+  using rep        = duration::rep;
+  using period     = duration::period;
+  using time_point = std::chrono::time_point<BenchmarkClock>;
+  static constexpr bool is_steady = true;
+
+  static time_point current_;
+
+  static time_point now()
+  {
+    return current_;
+  }
+};
+//----------------------------------------------------------------------------
+BenchmarkClock::time_point BenchmarkClock::current_;
+//----------------------------------------------------------------------------
+struct StampedValue
+{
+  int                        value_;
+  BenchmarkClock::time_point deadline_;
+};
+//----------------------------------------------------------------------------
+/**
+ * @brief Read-through loop with a TTL of state.range(0) ms, done by hand: the
+ *        deadline lives in the value and is checked after every get. Expired
+ *        entries stay resident until LRU pushes them out.
+ */
+static void BM_TtlInValue(benchmark::State & state)
+{
+  const auto ttl = std::chrono::milliseconds(state.range(0));
+  LRUCache::Cache<int, StampedValue> cache(TTL_CAPACITY);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> keys(0, TTL_KEYS - 1);
+  std::size_t hits = 0;
+
+  for (auto _ : state)
+  {
+    BenchmarkClock::current_ += std::chrono::microseconds(10);
+    const int key = keys(gen);
+    auto * entry = cache.get(key);
+    if (entry != nullptr && BenchmarkClock::now() < entry->deadline_)
+      ++hits;
+    else
+      cache.put(key, StampedValue{key, BenchmarkClock::now() + ttl});
+  }
+  state.counters["hit_ratio"] = static_cast<double>(hits) / state.iterations();
+  state.counters["resident"]  = cache.size();
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Same workload as BM_TtlInValue with native TTLs: expired entries are
+ *        misses and the timer wheel reclaims them.
+ */
+static void BM_TtlExpiringCache(benchmark::State & state)
+{
+  const auto ttl = std::chrono::milliseconds(state.range(0));
+  LRUCache::ExpiringCache<int, int, BenchmarkClock> cache(TTL_CAPACITY, ttl);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> keys(0, TTL_KEYS - 1);
+  std::size_t hits = 0;
+
+  for (auto _ : state)
+  {
+    BenchmarkClock::current_ += std::chrono::microseconds(10);
+    const int key = keys(gen);
+    if (cache.get(key) != nullptr)
+      ++hits;
+    else
+      cache.put(key, key);
+  }
+  state.counters["hit_ratio"] = static_cast<double>(hits) / state.iterations();
+  state.counters["resident"]  = cache.size();
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Cost of put with a fresh TTL for every entry of a full cache, i.e.
+ *        scheduling plus cancelling a timer on top of a plain LRU update.
+ */
+static void BM_TtlPut(benchmark::State & state)
+{
+  LRUCache::ExpiringCache<int, int, BenchmarkClock> cache(TTL_KEYS);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> keys(0, 2 * TTL_KEYS - 1);
+  std::uniform_int_distribution<int> ttls(1, 60000);
+
+  for (auto _ : state)
+  {
+    BenchmarkClock::current_ += std::chrono::microseconds(10);
+    cache.put(keys(gen), 1, std::chrono::milliseconds(ttls(gen)));
+  }
+}
+//----------------------------------------------------------------------------
+BENCHMARK(BM_TtlInValue)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK(BM_TtlExpiringCache)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK(BM_TtlPut);
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,88 @@
+//----------------------------------------------------------------------------
+#include <cstdio>
+#include <random>
+#include <string>
+#include <cstdint>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "hybrid_cache.hpp"
+#include "workload.hpp"
+//----------------------------------------------------------------------------
+static constexpr const char *  HYBRID_PATH     = "hybrid_cache_benchmark.log";
+static constexpr std::uint64_t HYBRID_CAPACITY = 10000;  ///< Entries in memory.
+static constexpr std::uint64_t HYBRID_KEYS     = 100000; ///< Key space, ten times the memory tier.
+static constexpr std::size_t   HYBRID_VALUE    = 512;    ///< Value size in bytes.
+//----------------------------------------------------------------------------
+/**
+ * @brief Look-aside caching of 512-byte values over a Zipf workload whose
+ *        working set is ten times the memory capacity. state.range(0) == 0
+ *        uses a memory-only `Cache`, 1 a `HybridCache` with a disk tier
+ *        large enough for all the keys. A miss builds the value and puts it.
+ *        Reports the hit ratio.
+ */
+static void BM_HybridZipf(benchmark::State & state)
+{
+  const bool hybrid = state.range(0) != 0;
+  LRUCache::Cache<std::uint64_t, std::string> memory(HYBRID_CAPACITY);
+  LRUCache::HybridCache<std::uint64_t, std::string> cache(HYBRID_CAPACITY, HYBRID_PATH, 16, 4 << 20);
+  ZipfDistribution zipf(HYBRID_KEYS, 0.9);
+  std::mt19937 gen(0);
+  std::uint64_t hits   = 0;
+  std::uint64_t misses = 0;
+
+  for (auto _ : state)
+  {
+    const std::uint64_t key = zipf(gen);
+    std::string * value = hybrid ? cache.get(key) : memory.get(key);
+    if (value != nullptr)
+    {
+      benchmark::DoNotOptimize(value->data());
+      ++hits;
+      continue;
+    }
+    ++misses;
+    if (hybrid)
+      cache.put(key, std::string(HYBRID_VALUE, static_cast<char>(key)));
+    else
+      memory.put(key, std::string(HYBRID_VALUE, static_cast<char>(key)));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["hit_ratio"] = static_cast<double>(hits) / (hits + misses);
+  if (hybrid)
+  {
+    const LRUCache::HybridCacheStats stats = cache.stats();
+    state.counters["disk_hits"]   = benchmark::Counter(static_cast<double>(stats.diskHits_), benchmark::Counter::kAvgIterations);
+    state.counters["compactions"] = static_cast<double>(stats.compactions_);
+    state.counters["dropped"]     = static_cast<double>(stats.dropped_);
+  }
+  std::remove(HYBRID_PATH);
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Cost of a disk hit: every lookup misses memory and promotes an
+ *        entry from the disk tier, which demotes another one.
+ */
+static void BM_HybridDiskHit(benchmark::State & state)
+{
+  LRUCache::HybridCache<std::uint64_t, std::string> cache(1, HYBRID_PATH, 16, 4 << 20);
+  for (std::uint64_t key = 0; key < HYBRID_CAPACITY; ++key)
+    cache.put(key, std::string(HYBRID_VALUE, static_cast<char>(key)));
+  cache.flush();
+  std::uint64_t key = 0;
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(cache.get(key));
+    key = (key + 7919) % HYBRID_CAPACITY;
+  }
+  state.SetItemsProcessed(state.iterations());
+  std::remove(HYBRID_PATH);
+}
+//----------------------------------------------------------------------------
+// 0: memory only, 1: memory and disk
+//----------------------------------------------------------------------------
+BENCHMARK(BM_HybridZipf)->DenseRange(0, 1);
+BENCHMARK(BM_HybridDiskHit);
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,88 @@
+//----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "intrusive_lru_cache.hpp"
+#include "allocation_counter.hpp"
+//----------------------------------------------------------------------------
+static std::vector<std::string> makeStringKeys(std::size_t count)
+{
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (std::size_t i = 0; i < count; ++i)
+    keys.push_back("user:session:" + std::to_string(i) + ":payload");
+  return keys;
+}
+//----------------------------------------------------------------------------
+template<class CacheT>
+static void BM_StringKeyMissEvict(benchmark::State & state)
+{
+  const std::size_t capacity = state.range(0);
+  const auto keys = makeStringKeys(capacity * 4);
+  CacheT cache(capacity);
+  std::size_t i = 0;
+
+  for (std::size_t k = 0; k < capacity; ++k)
+    cache.put(keys[k], 1);
+
+  const auto before = AllocationCounter::snapshot();
+  for (auto _ : state)
+  {
+    cache.put(keys[i], 1);
+    if (++i == keys.size())
+      i = 0;
+  }
+  const auto after = AllocationCounter::snapshot();
+  state.counters["allocs/op"] = benchmark::Counter(after.allocations_ - before.allocations_, benchmark::Counter::kAvgIterations);
+  state.counters["bytes/op"]  = benchmark::Counter(after.bytes_ - before.bytes_, benchmark::Counter::kAvgIterations);
+}
+//----------------------------------------------------------------------------
+template<class CacheT>
+static void BM_StringKeyHit(benchmark::State & state)
+{
+  const std::size_t capacity = state.range(0);
+  const auto keys = makeStringKeys(capacity);
+  CacheT cache(capacity);
+  std::size_t i = 0;
+
+  for (const auto & key : keys)
+    cache.put(key, 1);
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(cache.get(keys[i]));
+    if (++i == keys.size())
+      i = 0;
+  }
+}
+//----------------------------------------------------------------------------
+template<class CacheT>
+static void BM_StringKeyRemoveInsert(benchmark::State & state)
+{
+  const std::size_t capacity = state.range(0);
+  const auto keys = makeStringKeys(capacity);
+  CacheT cache(capacity);
+  std::size_t i = 0;
+
+  for (const auto & key : keys)
+    cache.put(key, 1);
+
+  for (auto _ : state)
+  {
+    cache.remove(keys[i]);
+    cache.put(keys[i], 1);
+    if (++i == keys.size())
+      i = 0;
+  }
+}
+//----------------------------------------------------------------------------
+BENCHMARK_TEMPLATE(BM_StringKeyMissEvict, LRUCache::Cache<std::string, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_StringKeyMissEvict, LRUCache::IntrusiveCache<std::string, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_StringKeyHit, LRUCache::Cache<std::string, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_StringKeyHit, LRUCache::IntrusiveCache<std::string, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_StringKeyRemoveInsert, LRUCache::Cache<std::string, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_StringKeyRemoveInsert, LRUCache::IntrusiveCache<std::string, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+//----------------------------------------------------------------------------
\ No newline at end of file
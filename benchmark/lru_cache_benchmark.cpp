@@ -1,9 +1,17 @@
 //----------------------------------------------------------------------------
+#include <cstdio>
+#include <memory>
 #include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
 //----------------------------------------------------------------------------
 #include <benchmark/benchmark.h>
 //----------------------------------------------------------------------------
 #include "lru_cache.hpp"
+#include "allocation_counter.hpp"
+#include "workload.hpp"
 //----------------------------------------------------------------------------
 static void BM_CachePut(benchmark::State & state) 
 {
@@ -89,10 +97,284 @@ static void BM_CacheRandomRemove(benchmark::State & state)
   }
 }
 //----------------------------------------------------------------------------
+template<class CacheT>
+static void BM_IndexRandomGet(benchmark::State & state)
+{
+  const int size = static_cast<int>(state.range(0));
+  CacheT cache(size);
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<int> distrib(0, size - 1);
+
+  for (int i = 0; i < size; ++i)
+    cache.put(i, i);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(cache.get(distrib(gen)));
+}
+//----------------------------------------------------------------------------
+template<class CacheT>
+static void BM_IndexRandomPut(benchmark::State & state)
+{
+  const int size = static_cast<int>(state.range(0));
+  CacheT cache(size);
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  // NOTE: half of the puts are misses that evict the least recently used entry
+  std::uniform_int_distribution<int> distrib(0, 2 * size - 1);
+
+  for (int i = 0; i < size; ++i)
+    cache.put(i, i);
+
+  for (auto _ : state)
+    cache.put(distrib(gen), 1);
+}
+//----------------------------------------------------------------------------
+// Keys arrive as std::string_view (e.g. slices of a request buffer). A cache
+// keyed by std::string has to materialise a temporary key for every lookup,
+// StringCache probes the index with the view itself.
+static std::vector<std::string> makeLongStringKeys(std::size_t count)
+{
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (std::size_t i = 0; i < count; ++i)
+    keys.push_back("tenant:42:user:session:" + std::to_string(i) + ":payload");
+  return keys;
+}
+//----------------------------------------------------------------------------
+static void BM_StringViewGetTemporaryKey(benchmark::State & state)
+{
+  const std::size_t size = state.range(0);
+  const auto keys = makeLongStringKeys(size);
+  const std::vector<std::string_view> views(keys.begin(), keys.end());
+  LRUCache::Cache<std::string, int> cache(size);
+  for (const auto & key : keys)
+    cache.put(key, 1);
+  std::size_t i = 0;
+
+  const auto before = AllocationCounter::snapshot();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(cache.get(std::string(views[i])));
+    if (++i == size)
+      i = 0;
+  }
+  const auto after = AllocationCounter::snapshot();
+  state.counters["allocs/op"] = benchmark::Counter(after.allocations_ - before.allocations_, benchmark::Counter::kAvgIterations);
+}
+//----------------------------------------------------------------------------
+static void BM_StringViewGetTransparent(benchmark::State & state)
+{
+  const std::size_t size = state.range(0);
+  const auto keys = makeLongStringKeys(size);
+  const std::vector<std::string_view> views(keys.begin(), keys.end());
+  LRUCache::StringCache<int> cache(size);
+  for (const auto & key : keys)
+    cache.put(key, 1);
+  std::size_t i = 0;
+
+  const auto before = AllocationCounter::snapshot();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(cache.get(views[i]));
+    if (++i == size)
+      i = 0;
+  }
+  const auto after = AllocationCounter::snapshot();
+  state.counters["allocs/op"] = benchmark::Counter(after.allocations_ - before.allocations_, benchmark::Counter::kAvgIterations);
+}
+//----------------------------------------------------------------------------
+// Values between 40 bytes and 80 KiB under a byte budget: the weigher makes
+// put re-weigh the entry and evict as many victims as it takes to fit.
+struct StringSizeWeigher
+{
+  std::size_t operator ()(int, const std::string & value) const
+  {
+    return value.size();
+  }
+};
+//----------------------------------------------------------------------------
+static void BM_WeightedRandomPut(benchmark::State & state)
+{
+  const std::size_t budget = state.range(0);
+  LRUCache::WeightedCache<int, std::string, StringSizeWeigher> cache(budget);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> keys(0, 1 << 16);
+  std::uniform_int_distribution<int> sizeClass(0, 11);
+  std::vector<std::string> values;
+  for (int i = 0; i <= 11; ++i)
+    values.emplace_back(std::size_t(40) << i, 'x');
+
+  for (auto _ : state)
+    cache.put(keys(gen), values[sizeClass(gen)]);
+  state.counters["entries"] = cache.size();
+  state.counters["weight"]  = cache.weight();
+}
+//----------------------------------------------------------------------------
+// Read-through loop over a Zipf(alpha) key stream, alpha = state.range(0) / 100,
+// to compare the hit ratio and the cost of the eviction policies
+template<class CacheT>
+static void BM_PolicyZipfHitRatio(benchmark::State & state)
+{
+  CacheT cache(10000);
+  ZipfDistribution zipf(100000, state.range(0) / 100.0);
+  std::mt19937 gen(42);
+  std::size_t hits = 0;
+
+  for (auto _ : state)
+  {
+    const int key = static_cast<int>(zipf(gen));
+    if (cache.get(key) != nullptr)
+      ++hits;
+    else
+      cache.put(key, key);
+  }
+  state.counters["hit_ratio"] = static_cast<double>(hits) / state.iterations();
+}
+//----------------------------------------------------------------------------
+// Batches of state.range(0) random keys against a cache of 1M entries, far
+// larger than the CPU caches, so nearly every probe misses in memory
+static constexpr int BATCH_CACHE_SIZE = 1 << 20;
+//----------------------------------------------------------------------------
+static void BM_BatchLoopGet(benchmark::State & state)
+{
+  LRUCache::Cache<int, int> cache(BATCH_CACHE_SIZE);
+  for (int i = 0; i < BATCH_CACHE_SIZE; ++i)
+    cache.put(i, i);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> keys(0, 2 * BATCH_CACHE_SIZE - 1);
+  std::vector<int> batch(state.range(0));
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    for (int & key : batch)
+      key = keys(gen);
+    state.ResumeTiming();
+    for (int key : batch)
+      benchmark::DoNotOptimize(cache.get(key));
+  }
+  state.SetItemsProcessed(state.iterations() * batch.size());
+}
+//----------------------------------------------------------------------------
+static void BM_BatchMultiGet(benchmark::State & state)
+{
+  LRUCache::Cache<int, int> cache(BATCH_CACHE_SIZE);
+  for (int i = 0; i < BATCH_CACHE_SIZE; ++i)
+    cache.put(i, i);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> keys(0, 2 * BATCH_CACHE_SIZE - 1);
+  std::vector<int> batch(state.range(0));
+  std::vector<int *> values(batch.size());
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    for (int & key : batch)
+      key = keys(gen);
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(cache.multi_get(batch, values));
+  }
+  state.SetItemsProcessed(state.iterations() * batch.size());
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Zipf get-or-put loop, to compare a cache that counts every operation
+ *        with one that does not.
+ */
+template<class CacheT>
+static void BM_StatsOverhead(benchmark::State & state)
+{
+  CacheT cache(10000);
+  ZipfDistribution zipf(100000, 0.99);
+  std::mt19937 gen(42);
+  std::vector<int> keys(1 << 16);
+  for (int & key : keys)
+    key = static_cast<int>(zipf(gen));
+  std::size_t i = 0;
+
+  for (auto _ : state)
+  {
+    const int key = keys[i++ & (keys.size() - 1)];
+    if (cache.get(key) == nullptr)
+      cache.put(key, key);
+  }
+  state.counters["hit_ratio"] = cache.stats().hit_ratio();
+}
+//----------------------------------------------------------------------------
+static constexpr const char * SNAPSHOT_PATH = "lru_cache_benchmark.snapshot";
+//----------------------------------------------------------------------------
+/**
+ * @brief Writes a snapshot of state.range(0) entries with 64-byte values.
+ */
+static void BM_SnapshotSave(benchmark::State & state)
+{
+  LRUCache::Cache<std::uint64_t, std::string> cache(state.range(0));
+  for (std::int64_t i = 0; i < state.range(0); ++i)
+    cache.put(i, std::string(64, 'v'));
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(cache.save(SNAPSHOT_PATH));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * state.range(0) * (sizeof(std::uint64_t) * 2 + 64));
+  std::remove(SNAPSHOT_PATH);
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Restores a snapshot of state.range(0) entries with 64-byte values
+ *        into an empty cache.
+ */
+static void BM_SnapshotLoad(benchmark::State & state)
+{
+  {
+    LRUCache::Cache<std::uint64_t, std::string> cache(state.range(0));
+    for (std::int64_t i = 0; i < state.range(0); ++i)
+      cache.put(i, std::string(64, 'v'));
+    cache.save(SNAPSHOT_PATH);
+  }
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    std::unique_ptr<LRUCache::Cache<std::uint64_t, std::string>> cache(new LRUCache::Cache<std::uint64_t, std::string>(state.range(0)));
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(cache->load(SNAPSHOT_PATH));
+    state.PauseTiming();
+    cache.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * state.range(0) * (sizeof(std::uint64_t) * 2 + 64));
+  std::remove(SNAPSHOT_PATH);
+}
+//----------------------------------------------------------------------------
 BENCHMARK(BM_CachePut);
 BENCHMARK(BM_CacheRandomPut);
 BENCHMARK(BM_CacheGet);
 BENCHMARK(BM_CacheRandomGet);
 BENCHMARK(BM_CacheRemove);
 BENCHMARK(BM_CacheRandomRemove);
+//----------------------------------------------------------------------------
+BENCHMARK_TEMPLATE(BM_IndexRandomGet, LRUCache::TreeCache<int, int>)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK_TEMPLATE(BM_IndexRandomGet, LRUCache::HashCache<int, int>)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK_TEMPLATE(BM_IndexRandomPut, LRUCache::TreeCache<int, int>)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK_TEMPLATE(BM_IndexRandomPut, LRUCache::HashCache<int, int>)->RangeMultiplier(10)->Range(1000, 10000000);
+
+BENCHMARK(BM_StringViewGetTemporaryKey)->Range(1 << 10, 1 << 18);
+BENCHMARK(BM_StringViewGetTransparent)->Range(1 << 10, 1 << 18);
+
+BENCHMARK(BM_WeightedRandomPut)->RangeMultiplier(8)->Range(1 << 20, 1 << 26);
+
+BENCHMARK_TEMPLATE(BM_PolicyZipfHitRatio, LRUCache::HashCache<int, int>)->DenseRange(60, 120, 20);
+BENCHMARK_TEMPLATE(BM_PolicyZipfHitRatio, LRUCache::FifoCache<int, int>)->DenseRange(60, 120, 20);
+BENCHMARK_TEMPLATE(BM_PolicyZipfHitRatio, LRUCache::LfuCache<int, int>)->DenseRange(60, 120, 20);
+
+BENCHMARK(BM_BatchLoopGet)->RangeMultiplier(4)->Range(8, 512);
+BENCHMARK(BM_BatchMultiGet)->RangeMultiplier(4)->Range(8, 512);
+
+BENCHMARK_TEMPLATE(BM_StatsOverhead, LRUCache::HashCache<int, int>);
+BENCHMARK_TEMPLATE(BM_StatsOverhead, LRUCache::StatsCache<int, int>);
+
+BENCHMARK(BM_SnapshotSave)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SnapshotLoad)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMillisecond);
 //----------------------------------------------------------------------------
\ No newline at end of file
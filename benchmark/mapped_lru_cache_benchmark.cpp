@@ -0,0 +1,96 @@
+//----------------------------------------------------------------------------
+#include <cstdio>
+#include <cstddef>
+#include <memory>
+#include <cstdint>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "mapped_lru_cache.hpp"
+//----------------------------------------------------------------------------
+static constexpr const char * MAPPED_PATH   = "mapped_lru_cache_benchmark.bin";
+static constexpr const char * SNAPSHOT_PATH = "mapped_lru_cache_benchmark.snapshot";
+//----------------------------------------------------------------------------
+/**
+ * @brief Reopens a clean cache file of state.range(0) entries and reads one
+ *        entry: the time until the first hit after a restart.
+ */
+static void BM_MappedReopen(benchmark::State & state)
+{
+  using CacheT = LRUCache::MappedCache<std::uint64_t, std::uint64_t>;
+  {
+    CacheT cache(MAPPED_PATH, state.range(0));
+    for (std::int64_t i = 0; i < state.range(0); ++i)
+      cache.put(i, i);
+  }
+
+  for (auto _ : state)
+  {
+    CacheT cache(MAPPED_PATH, state.range(0));
+    benchmark::DoNotOptimize(cache.get(state.range(0) / 2));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  std::remove(MAPPED_PATH);
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Same as BM_MappedReopen, but the file is marked dirty, as after a
+ *        crash, so every reopen checks all links first.
+ */
+static void BM_MappedReopenDirty(benchmark::State & state)
+{
+  using CacheT = LRUCache::MappedCache<std::uint64_t, std::uint64_t>;
+  {
+    CacheT cache(MAPPED_PATH, state.range(0));
+    for (std::int64_t i = 0; i < state.range(0); ++i)
+      cache.put(i, i);
+  }
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    std::FILE * file = std::fopen(MAPPED_PATH, "r+b");
+    const std::uint32_t dirty = LRUCache::Internal::MAPPED_DIRTY;
+    std::fseek(file, offsetof(LRUCache::Internal::MappedHeader, state_), SEEK_SET);
+    std::fwrite(&dirty, sizeof(dirty), 1, file);
+    std::fclose(file);
+    state.ResumeTiming();
+    CacheT cache(MAPPED_PATH, state.range(0));
+    benchmark::DoNotOptimize(cache.get(state.range(0) / 2));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  std::remove(MAPPED_PATH);
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Baseline: rebuilds a heap cache of state.range(0) entries from a
+ *        snapshot written by `Cache::save`.
+ */
+static void BM_SnapshotRebuild(benchmark::State & state)
+{
+  using CacheT = LRUCache::Cache<std::uint64_t, std::uint64_t>;
+  {
+    CacheT cache(state.range(0));
+    for (std::int64_t i = 0; i < state.range(0); ++i)
+      cache.put(i, i);
+    cache.save(SNAPSHOT_PATH);
+  }
+
+  for (auto _ : state)
+  {
+    std::unique_ptr<CacheT> cache(new CacheT(state.range(0)));
+    cache->load(SNAPSHOT_PATH);
+    benchmark::DoNotOptimize(cache->get(state.range(0) / 2));
+    state.PauseTiming();
+    cache.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  std::remove(SNAPSHOT_PATH);
+}
+//----------------------------------------------------------------------------
+BENCHMARK(BM_MappedReopen)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_MappedReopenDirty)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SnapshotRebuild)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMicrosecond);
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------------
+#include <memory>
+#include <random>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "clock_cache.hpp"
+#include "s3fifo_cache.hpp"
+#include "sharded_lru_cache.hpp"
+#include "workload.hpp"
+//----------------------------------------------------------------------------
+static constexpr int S3FIFO_CAPACITY = 10000;
+static constexpr int S3FIFO_KEYS     = 100000;
+//----------------------------------------------------------------------------
+/**
+ * @brief Single-threaded read-through loop over a Zipf(alpha) key stream,
+ *        alpha = state.range(0) / 100. Reports the hit ratio.
+ */
+template<class CacheT>
+static void BM_ZipfHitRatio(benchmark::State & state)
+{
+  CacheT cache(S3FIFO_CAPACITY);
+  ZipfDistribution zipf(S3FIFO_KEYS, state.range(0) / 100.0);
+  std::mt19937 gen(42);
+  std::size_t hits = 0;
+
+  for (auto _ : state)
+  {
+    const int key = static_cast<int>(zipf(gen));
+    int value;
+    if (cache.get(key, value))
+      ++hits;
+    else
+      cache.put(key, key);
+  }
+  state.counters["hit_ratio"] = static_cast<double>(hits) / state.iterations();
+}
+//----------------------------------------------------------------------------
+template<class CacheT>
+static std::unique_ptr<CacheT> & sharedCache()
+{
+  static std::unique_ptr<CacheT> cache;
+  return cache;
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Concurrent read-through loop over a Zipf(0.99) key stream, so threads
+ *        mix shared-lock hits with exclusive-lock inserts. Reports the hit ratio
+ *        of thread 0.
+ */
+template<class CacheT>
+static void BM_ConcurrentReadThrough(benchmark::State & state)
+{
+  auto & cache = sharedCache<CacheT>();
+  if (state.thread_index() == 0)
+    cache.reset(new CacheT(S3FIFO_CAPACITY));
+  ZipfDistribution zipf(S3FIFO_KEYS, 0.99);
+  std::mt19937 gen(state.thread_index());
+  std::size_t hits = 0;
+
+  for (auto _ : state)
+  {
+    const int key = static_cast<int>(zipf(gen));
+    int value;
+    if (cache->get(key, value))
+      ++hits;
+    else
+      cache->put(key, key);
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0)
+  {
+    state.counters["hit_ratio"] = static_cast<double>(hits) / state.iterations();
+    cache.reset();
+  }
+}
+//----------------------------------------------------------------------------
+BENCHMARK_TEMPLATE(BM_ZipfHitRatio, LRUCache::ShardedCache<int, int>)->DenseRange(60, 120, 20);
+BENCHMARK_TEMPLATE(BM_ZipfHitRatio, LRUCache::ClockCache<int, int>)->DenseRange(60, 120, 20);
+BENCHMARK_TEMPLATE(BM_ZipfHitRatio, LRUCache::S3FifoCache<int, int>)->DenseRange(60, 120, 20);
+BENCHMARK_TEMPLATE(BM_ConcurrentReadThrough, LRUCache::ShardedCache<int, int>)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConcurrentReadThrough, LRUCache::ClockCache<int, int>)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConcurrentReadThrough, LRUCache::S3FifoCache<int, int>)->ThreadRange(1, 64)->UseRealTime();
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,51 @@
+//----------------------------------------------------------------------------
+#include <random>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "segmented_cache.hpp"
+#include "workload.hpp"
+//----------------------------------------------------------------------------
+static constexpr int SLRU_CAPACITY = 10000;
+static constexpr int SLRU_KEYS     = 100000;
+//----------------------------------------------------------------------------
+/**
+ * @brief Daytime Zipf(0.9) traffic, a nightly scan of state.range(0) fresh keys
+ *        through the same cache, then daytime traffic again. Reports the hit
+ *        ratio of the first SLRU_CAPACITY requests after the scan, i.e. how
+ *        much of the hot set survived.
+ */
+template<class CacheT>
+static void BM_HitRatioAfterScan(benchmark::State & state)
+{
+  const int scanLength = static_cast<int>(state.range(0));
+  std::size_t hits     = 0;
+  std::size_t requests = 0;
+
+  for (auto _ : state)
+  {
+    CacheT cache(SLRU_CAPACITY);
+    ZipfDistribution zipf(SLRU_KEYS, 0.9);
+    std::mt19937 gen(42);
+    auto request = [&cache](int key)
+    {
+      if (cache.get(key) != nullptr)
+        return true;
+      cache.put(key, key);
+      return false;
+    };
+    for (int i = 0; i < 10 * SLRU_CAPACITY; ++i)
+      request(static_cast<int>(zipf(gen)));
+    for (int i = 0; i < scanLength; ++i)
+      request(SLRU_KEYS + i);
+    for (int i = 0; i < SLRU_CAPACITY; ++i)
+      hits += request(static_cast<int>(zipf(gen)));
+    requests += SLRU_CAPACITY;
+  }
+  state.counters["hit_ratio"] = static_cast<double>(hits) / requests;
+}
+//----------------------------------------------------------------------------
+BENCHMARK_TEMPLATE(BM_HitRatioAfterScan, LRUCache::Cache<int, int>)->Arg(0)->Arg(SLRU_CAPACITY)->Arg(10 * SLRU_CAPACITY)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_HitRatioAfterScan, LRUCache::SegmentedCache<int, int>)->Arg(0)->Arg(SLRU_CAPACITY)->Arg(10 * SLRU_CAPACITY)->Unit(benchmark::kMillisecond);
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,206 @@
+//----------------------------------------------------------------------------
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include <optional>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "sharded_lru_cache.hpp"
+#include "workload.hpp"
+//----------------------------------------------------------------------------
+static constexpr int SHARDED_CAPACITY = 100000;
+//----------------------------------------------------------------------------
+using ShardedCacheT = LRUCache::ShardedCache<int, int>;
+//----------------------------------------------------------------------------
+static std::unique_ptr<ShardedCacheT> shardedCache;
+//----------------------------------------------------------------------------
+/**
+ * @brief Mixed get/put workload shared by all benchmark threads.
+ *
+ * state.range(0) is the number of shards (one shard is a single global lock),
+ * state.range(1) is the percentage of reads.
+ */
+static void BM_ShardedMixed(benchmark::State & state)
+{
+  if (state.thread_index() == 0)
+  {
+    shardedCache.reset(new ShardedCacheT(SHARDED_CAPACITY, state.range(0)));
+    for (int i = 0; i < SHARDED_CAPACITY; ++i)
+      shardedCache->put(i, i);
+  }
+  std::mt19937 gen(state.thread_index());
+  std::uniform_int_distribution<int> keys(0, 2 * SHARDED_CAPACITY - 1);
+  std::uniform_int_distribution<int> percent(0, 99);
+  const int readPercent = static_cast<int>(state.range(1));
+
+  for (auto _ : state)
+  {
+    const int key = keys(gen);
+    if (percent(gen) < readPercent)
+    {
+      int value;
+      benchmark::DoNotOptimize(shardedCache->get(key, value));
+    }
+    else
+      shardedCache->put(key, key);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0)
+    shardedCache.reset();
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Stand-in for a backend query: blocks for about 50 microseconds
+ *        without using the CPU, like a network round trip.
+ */
+static int slowLoad(int key)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds(50));
+  return key;
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Thundering herd: all threads read a few hot keys, and one read in
+ *        state.range(1) removes its key as if it had expired. With
+ *        state.range(0) == 0 every missing thread loads and puts the value
+ *        itself, otherwise misses go through get_or_load. Reports the number
+ *        of loader calls per lookup.
+ */
+static void BM_ShardedHerd(benchmark::State & state)
+{
+  if (state.thread_index() == 0)
+    shardedCache.reset(new ShardedCacheT(SHARDED_CAPACITY, 64));
+  const bool singleFlight = state.range(0) != 0;
+  const int expireEvery   = static_cast<int>(state.range(1));
+  ZipfDistribution zipf(16, 1.2);
+  std::mt19937 gen(state.thread_index());
+  std::size_t loads = 0;
+  auto loader = [&loads](int key)
+  {
+    ++loads;
+    return slowLoad(key);
+  };
+  int i = 0;
+
+  for (auto _ : state)
+  {
+    const int key = static_cast<int>(zipf(gen));
+    int value;
+    if (singleFlight)
+      value = shardedCache->get_or_load(key, loader);
+    else if (!shardedCache->get(key, value))
+    {
+      value = loader(key);
+      shardedCache->put(key, value);
+    }
+    benchmark::DoNotOptimize(value);
+    if (++i % expireEvery == 0)
+      shardedCache->remove(key);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["loads/op"] = benchmark::Counter(static_cast<double>(loads), benchmark::Counter::kAvgIterations);
+
+  if (state.thread_index() == 0)
+    shardedCache.reset();
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Batches of state.range(0) random keys read by all benchmark threads,
+ *        with one get per key, or one multi_get per batch if state.range(1) != 0.
+ */
+static void BM_ShardedBatchGet(benchmark::State & state)
+{
+  if (state.thread_index() == 0)
+  {
+    shardedCache.reset(new ShardedCacheT(SHARDED_CAPACITY, 64));
+    for (int i = 0; i < SHARDED_CAPACITY; ++i)
+      shardedCache->put(i, i);
+  }
+  std::mt19937 gen(state.thread_index());
+  std::uniform_int_distribution<int> keys(0, 2 * SHARDED_CAPACITY - 1);
+  std::vector<int> batch(state.range(0));
+  std::vector<std::optional<int>> values(batch.size());
+  const bool batched = state.range(1) != 0;
+
+  for (auto _ : state)
+  {
+    for (int & key : batch)
+      key = keys(gen);
+    if (batched)
+      benchmark::DoNotOptimize(shardedCache->multi_get(batch, values));
+    else
+    {
+      for (int key : batch)
+      {
+        int value;
+        benchmark::DoNotOptimize(shardedCache->get(key, value));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch.size());
+
+  if (state.thread_index() == 0)
+    shardedCache.reset();
+}
+//----------------------------------------------------------------------------
+using BufferCacheT = LRUCache::ShardedCache<int, std::vector<char>>;
+//----------------------------------------------------------------------------
+static std::unique_ptr<BufferCacheT> bufferCache;
+//----------------------------------------------------------------------------
+/**
+ * @brief Every put of a 256 KiB buffer evicts another one, whose memory is
+ *        returned to the system. state.range(0) == 0 frees the evicted buffer
+ *        under the shard lock, 1 in a removal listener run by the putting
+ *        thread after the lock is released, 2 in a background listener.
+ *        Half of the operations are reads.
+ */
+static void BM_ShardedEvictLargeValues(benchmark::State & state)
+{
+  if (state.thread_index() == 0)
+  {
+    bufferCache.reset(new BufferCacheT(64, 4));
+    if (state.range(0) != 0)
+      bufferCache->set_removal_listener([](int &&, std::vector<char> &&, LRUCache::RemovalCause) {}, state.range(0) == 2);
+  }
+  std::mt19937 gen(state.thread_index());
+  std::uniform_int_distribution<int> keys(0, 1023);
+  std::vector<char> value;
+
+  for (auto _ : state)
+  {
+    const int key = keys(gen);
+    if (key % 2 == 0)
+      bufferCache->put(key, std::vector<char>(256 << 10, 1));
+    else
+      benchmark::DoNotOptimize(bufferCache->get(key, value));
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0)
+    bufferCache.reset();
+}
+//----------------------------------------------------------------------------
+// read-heavy: 95% reads, write-heavy: 50% reads
+//----------------------------------------------------------------------------
+BENCHMARK(BM_ShardedMixed)->Args({1, 95})->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_ShardedMixed)->Args({64, 95})->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_ShardedMixed)->Args({1, 50})->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_ShardedMixed)->Args({64, 50})->ThreadRange(1, 64)->UseRealTime();
+//----------------------------------------------------------------------------
+// 0: get then put on a miss, 1: get_or_load
+//----------------------------------------------------------------------------
+BENCHMARK(BM_ShardedHerd)->Args({0, 100})->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_ShardedHerd)->Args({1, 100})->ThreadRange(1, 64)->UseRealTime();
+//----------------------------------------------------------------------------
+// batch size, 0: get per key, 1: multi_get
+//----------------------------------------------------------------------------
+BENCHMARK(BM_ShardedBatchGet)->ArgsProduct({{16, 128, 512}, {0, 1}})->ThreadRange(1, 16)->UseRealTime();
+//----------------------------------------------------------------------------
+// 0: destroyed under the lock, 1: removal listener, 2: background removal listener
+//----------------------------------------------------------------------------
+BENCHMARK(BM_ShardedEvictLargeValues)->DenseRange(0, 2)->ThreadRange(1, 16)->UseRealTime();
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,152 @@
+//----------------------------------------------------------------------------
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+//----------------------------------------------------------------------------
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "shared_lru_cache.hpp"
+#include "workload.hpp"
+//----------------------------------------------------------------------------
+static constexpr std::uint64_t WORKER_CAPACITY = 10000;  ///< Capacity of each private cache, and of the shared one.
+static constexpr std::uint64_t WORKER_KEYS     = 100000; ///< Key space of the Zipf workload.
+static constexpr int           WORKER_OPS      = 50000;  ///< Lookups per worker and iteration.
+//----------------------------------------------------------------------------
+/**
+ * @brief Result of one worker process, written to anonymous shared memory.
+ */
+struct WorkerResult
+{
+  std::uint64_t hits_;
+  std::uint64_t entries_;
+};
+//----------------------------------------------------------------------------
+/**
+ * @brief Look-aside caching in state.range(0) pre-forked workers: every
+ *        worker reads Zipf-distributed keys and puts them on a miss. With
+ *        state.range(1) == 0 every worker has its own `Cache` of
+ *        WORKER_CAPACITY entries, otherwise they all share one `SharedCache`
+ *        of the same capacity. Reports the combined hit ratio and the number
+ *        of entries resident on the host.
+ */
+static void BM_SharedWorkers(benchmark::State & state)
+{
+  const int  workers = static_cast<int>(state.range(0));
+  const bool shared  = state.range(1) != 0;
+  const std::string name = "/lru_cache_benchmark_" + std::to_string(::getpid());
+  LRUCache::SharedCache<std::uint64_t, std::uint64_t>::remove_segment(name);
+  LRUCache::SharedCache<std::uint64_t, std::uint64_t> segment(name, shared ? WORKER_CAPACITY : 0);
+  void * memory = ::mmap(nullptr, workers * sizeof(WorkerResult), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  WorkerResult * results = static_cast<WorkerResult *>(memory);
+  std::uint64_t hits    = 0;
+  std::uint64_t entries = 0;
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    segment.clear();
+    state.ResumeTiming();
+    std::vector<pid_t> children;
+    for (int worker = 0; worker < workers; ++worker)
+    {
+      const pid_t pid = ::fork();
+      if (pid == 0)
+      {
+        ZipfDistribution zipf(WORKER_KEYS, 0.9);
+        std::mt19937 gen(worker);
+        WorkerResult & result = results[worker];
+        result = WorkerResult();
+        if (shared)
+        {
+          LRUCache::SharedCache<std::uint64_t, std::uint64_t> cache(name, WORKER_CAPACITY);
+          for (int i = 0; i < WORKER_OPS; ++i)
+          {
+            const std::uint64_t key = zipf(gen);
+            std::uint64_t value;
+            if (cache.get(key, value))
+              ++result.hits_;
+            else
+              cache.put(key, key);
+          }
+        }
+        else
+        {
+          LRUCache::Cache<std::uint64_t, std::uint64_t> cache(WORKER_CAPACITY);
+          for (int i = 0; i < WORKER_OPS; ++i)
+          {
+            const std::uint64_t key = zipf(gen);
+            if (cache.get(key) != nullptr)
+              ++result.hits_;
+            else
+              cache.put(key, key);
+          }
+          result.entries_ = cache.size();
+        }
+        ::_exit(0);
+      }
+      children.push_back(pid);
+    }
+    for (pid_t pid : children)
+      ::waitpid(pid, nullptr, 0);
+    for (int worker = 0; worker < workers; ++worker)
+    {
+      hits    += results[worker].hits_;
+      entries += results[worker].entries_;
+    }
+    if (shared)
+      entries += segment.size();
+  }
+  state.SetItemsProcessed(state.iterations() * workers * WORKER_OPS);
+  state.counters["hit_ratio"] = static_cast<double>(hits) / (state.iterations() * workers * WORKER_OPS);
+  state.counters["entries"]   = benchmark::Counter(static_cast<double>(entries), benchmark::Counter::kAvgIterations);
+  ::munmap(memory, workers * sizeof(WorkerResult));
+  LRUCache::SharedCache<std::uint64_t, std::uint64_t>::remove_segment(name);
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Single-process cost of a hit: state.range(0) == 0 reads a `Cache`,
+ *        1 a `SharedCache`, which locks a process-shared mutex and copies the value.
+ */
+static void BM_SharedGet(benchmark::State & state)
+{
+  const std::string name = "/lru_cache_benchmark_get_" + std::to_string(::getpid());
+  LRUCache::SharedCache<std::uint64_t, std::uint64_t>::remove_segment(name);
+  LRUCache::SharedCache<std::uint64_t, std::uint64_t> shared(name, WORKER_CAPACITY);
+  LRUCache::Cache<std::uint64_t, std::uint64_t> local(WORKER_CAPACITY);
+  for (std::uint64_t i = 0; i < WORKER_CAPACITY; ++i)
+  {
+    shared.put(i, i);
+    local.put(i, i);
+  }
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<std::uint64_t> keys(0, WORKER_CAPACITY - 1);
+
+  for (auto _ : state)
+  {
+    const std::uint64_t key = keys(gen);
+    if (state.range(0) == 0)
+      benchmark::DoNotOptimize(local.get(key));
+    else
+    {
+      std::uint64_t value;
+      benchmark::DoNotOptimize(shared.get(key, value));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  LRUCache::SharedCache<std::uint64_t, std::uint64_t>::remove_segment(name);
+}
+//----------------------------------------------------------------------------
+// worker processes, 0: private caches, 1: one shared cache
+//----------------------------------------------------------------------------
+BENCHMARK(BM_SharedWorkers)->ArgsProduct({{1, 4, 16}, {0, 1}})->UseRealTime()->Unit(benchmark::kMillisecond);
+//----------------------------------------------------------------------------
+// 0: Cache, 1: SharedCache
+//----------------------------------------------------------------------------
+BENCHMARK(BM_SharedGet)->DenseRange(0, 1);
+//----------------------------------------------------------------------------
\ No newline at end of file
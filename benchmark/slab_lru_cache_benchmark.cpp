@@ -0,0 +1,54 @@
+//----------------------------------------------------------------------------
+#include <random>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "slab_lru_cache.hpp"
+#include "intrusive_lru_cache.hpp"
+#include "allocation_counter.hpp"
+//----------------------------------------------------------------------------
+template<class CacheT>
+static void BM_SlabMissEvict(benchmark::State & state)
+{
+  const int capacity = static_cast<int>(state.range(0));
+  const auto empty = AllocationCounter::snapshot();
+  CacheT cache(capacity);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> distrib(0, 4 * capacity - 1);
+
+  for (int i = 0; i < capacity; ++i)
+    cache.put(i, i);
+  const auto filled = AllocationCounter::snapshot();
+
+  for (auto _ : state)
+    cache.put(distrib(gen), 1);
+  const auto after = AllocationCounter::snapshot();
+
+  state.counters["bytes/entry"] = static_cast<double>(filled.live_ - empty.live_) / capacity;
+  state.counters["allocs/op"]   = benchmark::Counter(after.allocations_ - filled.allocations_, benchmark::Counter::kAvgIterations);
+}
+//----------------------------------------------------------------------------
+template<class CacheT>
+static void BM_SlabRandomGet(benchmark::State & state)
+{
+  const int capacity = static_cast<int>(state.range(0));
+  CacheT cache(capacity);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> distrib(0, capacity - 1);
+
+  for (int i = 0; i < capacity; ++i)
+    cache.put(i, i);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(cache.get(distrib(gen)));
+}
+//----------------------------------------------------------------------------
+BENCHMARK_TEMPLATE(BM_SlabMissEvict, LRUCache::Cache<int, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_SlabMissEvict, LRUCache::TreeCache<int, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_SlabMissEvict, LRUCache::IntrusiveCache<int, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_SlabMissEvict, LRUCache::SlabCache<int, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_SlabRandomGet, LRUCache::Cache<int, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_SlabRandomGet, LRUCache::IntrusiveCache<int, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_SlabRandomGet, LRUCache::SlabCache<int, int>)->RangeMultiplier(100)->Range(1000, 1000000);
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,74 @@
+//----------------------------------------------------------------------------
+#include <random>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "tinylfu_cache.hpp"
+#include "workload.hpp"
+//----------------------------------------------------------------------------
+static constexpr int TINYLFU_CAPACITY = 10000;
+static constexpr int TINYLFU_KEYS     = 1000000;
+//----------------------------------------------------------------------------
+/**
+ * @brief Read-through loop over a Zipf(0.9) key stream. Every state.range(0)-th
+ *        request (0 for none) is replaced by the next key of a sequential scan
+ *        over keys that are never requested again. Reports the hit ratio of
+ *        the non-scan requests.
+ */
+template<class CacheT>
+static void BM_ZipfWithScans(benchmark::State & state)
+{
+  const int scanEvery = static_cast<int>(state.range(0));
+  CacheT cache(TINYLFU_CAPACITY);
+  ZipfDistribution zipf(TINYLFU_KEYS, 0.9);
+  std::mt19937 gen(42);
+  std::size_t requests = 0;
+  std::size_t hits     = 0;
+  int scanKey = TINYLFU_KEYS;
+  int i       = 0;
+
+  for (auto _ : state)
+  {
+    int key;
+    const bool scan = scanEvery != 0 && ++i % scanEvery == 0;
+    if (scan)
+      key = scanKey++;
+    else
+      key = static_cast<int>(zipf(gen));
+    if (cache.get(key) != nullptr)
+      hits += !scan;
+    else
+      cache.put(key, key);
+    requests += !scan;
+  }
+  state.counters["hit_ratio"] = static_cast<double>(hits) / requests;
+}
+//----------------------------------------------------------------------------
+static void BM_SketchIncrement(benchmark::State & state)
+{
+  LRUCache::Internal::FrequencySketch sketch(state.range(0));
+  std::uint64_t hash = 0;
+
+  for (auto _ : state)
+    sketch.increment(hash++);
+  state.counters["bytes/entry"] = static_cast<double>(sketch.memory()) / state.range(0);
+}
+//----------------------------------------------------------------------------
+static void BM_SketchFrequency(benchmark::State & state)
+{
+  LRUCache::Internal::FrequencySketch sketch(state.range(0));
+  for (std::uint64_t i = 0; i < static_cast<std::uint64_t>(state.range(0)); ++i)
+    sketch.increment(i);
+  std::uint64_t hash = 0;
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(sketch.frequency(hash++));
+}
+//----------------------------------------------------------------------------
+BENCHMARK_TEMPLATE(BM_ZipfWithScans, LRUCache::Cache<int, int>)->Arg(0)->Arg(4)->Arg(2);
+BENCHMARK_TEMPLATE(BM_ZipfWithScans, LRUCache::TinyLfuCache<int, int>)->Arg(0)->Arg(4)->Arg(2);
+
+BENCHMARK(BM_SketchIncrement)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SketchFrequency)->Range(1 << 10, 1 << 20);
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,187 @@
+//----------------------------------------------------------------------------
+#ifndef WORKLOAD_HPP
+#define WORKLOAD_HPP
+//----------------------------------------------------------------------------
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+//----------------------------------------------------------------------------
+/**
+ * @brief Zipf distribution over [0, n) with exponent alpha.
+ *
+ * Uses rejection-inversion sampling (W. Hormann, G. Derflinger, "Rejection-
+ * inversion to generate variates from monotone discrete distributions"), so it
+ * needs O(1) memory and O(1) expected time per sample for any n. Key 0 is the
+ * most popular one.
+ */
+class ZipfDistribution
+{
+//----------------------------------------------------------------------------
+public:
+//----------------------------------------------------------------------------
+  ZipfDistribution(std::uint64_t n, double alpha);
+//----------------------------------------------------------------------------
+  template<class GeneratorT>
+  std::uint64_t operator ()(GeneratorT & gen);
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  double hIntegral(double x) const;
+  double hIntegralInverse(double x) const;
+  static double helper1(double x);
+  static double helper2(double x);
+//----------------------------------------------------------------------------
+  std::uint64_t                          n_;
+  double                                 alpha_;
+  double                                 hIntegralX1_;
+  double                                 hIntegralN_;
+  double                                 s_;
+  std::uniform_real_distribution<double> uniform_;
+//----------------------------------------------------------------------------
+}; // class ZipfDistribution
+//----------------------------------------------------------------------------
+/**
+ * @brief Access pattern of a generated trace. The parameter of `makeTrace`
+ *        means something different for each one.
+ */
+enum class Pattern : std::uint8_t
+{
+  ZIPF,  ///< Zipf(parameter / 100) over ten times the capacity.
+  LOOP,  ///< Keys 0, 1, ... repeated, over parameter percent of the capacity.
+  SCAN,  ///< Zipf(0.9) hot set; parameter percent of the operations are scans of keys never seen again.
+  SHIFT  ///< Zipf(0.9) whose hot set moves to new keys parameter times over the trace.
+};
+//----------------------------------------------------------------------------
+/**
+ * @brief Pregenerated operations, so that timing measures the cache rather
+ *        than the random number generators.
+ */
+struct Trace
+{
+//----------------------------------------------------------------------------
+  std::vector<std::uint64_t> keys_;
+  std::vector<std::uint8_t>  writes_; ///< 1 if the operation is a put, 0 for a get.
+//----------------------------------------------------------------------------
+}; // struct Trace
+//----------------------------------------------------------------------------
+/**
+ * @brief Generates `length` operations of `pattern` for a cache of `capacity`
+ *        entries, writePercent percent of them puts.
+ */
+inline Trace makeTrace(Pattern pattern, std::uint64_t capacity, std::uint64_t parameter, int writePercent, std::size_t length, std::uint32_t seed = 42);
+//----------------------------------------------------------------------------
+inline ZipfDistribution::ZipfDistribution(std::uint64_t n, double alpha) :
+  n_(n),
+  alpha_(alpha),
+  hIntegralX1_(hIntegral(1.5) - 1.0),
+  hIntegralN_(hIntegral(n + 0.5)),
+  s_(2.0 - hIntegralInverse(hIntegral(2.5) - std::exp(-alpha * std::log(2.0))))
+{
+}
+//----------------------------------------------------------------------------
+template<class GeneratorT>
+std::uint64_t ZipfDistribution::operator ()(GeneratorT & gen)
+{
+  while (true)
+  {
+    const double u = hIntegralN_ + uniform_(gen) * (hIntegralX1_ - hIntegralN_);
+    const double x = hIntegralInverse(u);
+    double k = std::floor(x + 0.5);
+    if (k < 1.0)
+      k = 1.0;
+    else if (k > n_)
+      k = static_cast<double>(n_);
+    if (k - x <= s_ || u >= hIntegral(k + 0.5) - std::exp(-alpha_ * std::log(k)))
+      return static_cast<std::uint64_t>(k) - 1;
+  }
+}
+//----------------------------------------------------------------------------
+inline double ZipfDistribution::hIntegral(double x) const
+{
+  const double logX = std::log(x);
+  return helper2((1.0 - alpha_) * logX) * logX;
+}
+//----------------------------------------------------------------------------
+inline double ZipfDistribution::hIntegralInverse(double x) const
+{
+  double t = x * (1.0 - alpha_);
+  if (t < -1.0)
+    t = -1.0;
+  return std::exp(helper1(t) * x);
+}
+//----------------------------------------------------------------------------
+inline double ZipfDistribution::helper1(double x)
+{
+  // log1p(x) / x, with its Taylor expansion near zero
+  if (std::abs(x) > 1e-8)
+    return std::log1p(x) / x;
+  return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+//----------------------------------------------------------------------------
+inline double ZipfDistribution::helper2(double x)
+{
+  // expm1(x) / x, with its Taylor expansion near zero
+  if (std::abs(x) > 1e-8)
+    return std::expm1(x) / x;
+  return 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+}
+//----------------------------------------------------------------------------
+inline Trace makeTrace(Pattern pattern, std::uint64_t capacity, std::uint64_t parameter, int writePercent, std::size_t length, std::uint32_t seed)
+{
+  Trace trace;
+  trace.keys_.resize(length);
+  trace.writes_.resize(length);
+  std::mt19937_64 gen(seed);
+  std::uniform_int_distribution<int> percent(0, 99);
+  const std::uint64_t universe = 10 * capacity;
+
+  switch (pattern)
+  {
+    case Pattern::ZIPF:
+    {
+      ZipfDistribution zipf(universe, parameter / 100.0);
+      for (std::uint64_t & key : trace.keys_)
+        key = zipf(gen);
+      break;
+    }
+    case Pattern::LOOP:
+    {
+      const std::uint64_t loop = std::max<std::uint64_t>(capacity * parameter / 100, 1);
+      for (std::size_t i = 0; i < length; ++i)
+        trace.keys_[i] = i % loop;
+      break;
+    }
+    case Pattern::SCAN:
+    {
+      // Bursts of half the capacity, scanned keys start past the hot set
+      ZipfDistribution zipf(universe, 0.9);
+      const std::size_t burst = std::max<std::size_t>(capacity / 2, 1);
+      std::uint64_t scanned = universe;
+      std::size_t i = 0;
+      while (i < length)
+      {
+        const bool scan = percent(gen) < static_cast<int>(parameter);
+        for (std::size_t j = 0; j < burst && i < length; ++j, ++i)
+          trace.keys_[i] = scan ? scanned++ : zipf(gen);
+      }
+      break;
+    }
+    case Pattern::SHIFT:
+    {
+      ZipfDistribution zipf(universe, 0.9);
+      const std::size_t phase = std::max<std::size_t>(length / std::max<std::uint64_t>(parameter, 1), 1);
+      for (std::size_t i = 0; i < length; ++i)
+        trace.keys_[i] = zipf(gen) + (i / phase) * universe;
+      break;
+    }
+  }
+  for (std::uint8_t & write : trace.writes_)
+    write = percent(gen) < writePercent ? 1 : 0;
+  return trace;
+}
+//----------------------------------------------------------------------------
+#endif // WORKLOAD_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,157 @@
+//----------------------------------------------------------------------------
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+//----------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "workload.hpp"
+//----------------------------------------------------------------------------
+static constexpr std::size_t TRACE_LENGTH = 1 << 21; ///< Operations timed per run.
+//----------------------------------------------------------------------------
+/**
+ * @brief Length of the trace of a run, which is replayed once to warm up:
+ *        at least four times the capacity, so that large caches fill up.
+ */
+static std::size_t traceLength(std::uint64_t capacity)
+{
+  return std::max<std::size_t>(TRACE_LENGTH, 4 * capacity);
+}
+//----------------------------------------------------------------------------
+using Blob = std::vector<char>; ///< 4 KiB value.
+//----------------------------------------------------------------------------
+template<class _ValueT>
+static _ValueT makeValue(std::uint64_t key);
+//----------------------------------------------------------------------------
+template<>
+int makeValue<int>(std::uint64_t key)
+{
+  return static_cast<int>(key);
+}
+//----------------------------------------------------------------------------
+template<>
+std::string makeValue<std::string>(std::uint64_t key)
+{
+  return std::string(64, static_cast<char>(key));
+}
+//----------------------------------------------------------------------------
+template<>
+Blob makeValue<Blob>(std::uint64_t key)
+{
+  return Blob(4096, static_cast<char>(key));
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Replays a generated trace against a read-through cache: a get
+ *        that misses puts the value, a write puts it unconditionally.
+ *
+ * state.range(0) is the `Pattern`, state.range(1) the capacity,
+ * state.range(2) the parameter of the pattern (see `Pattern`) and
+ * state.range(3) the percentage of writes. The trace (see `traceLength`) is
+ * replayed once to warm the cache up, then its first `TRACE_LENGTH`
+ * operations are timed. Reports the hit ratio of the gets.
+ */
+template<class _CacheT, class _ValueT>
+static void BM_Workload(benchmark::State & state)
+{
+  const std::uint64_t capacity = static_cast<std::uint64_t>(state.range(1));
+  const std::size_t length = traceLength(capacity);
+  const Trace trace = makeTrace(static_cast<Pattern>(state.range(0)), capacity, state.range(2), static_cast<int>(state.range(3)), length);
+  _CacheT cache(capacity);
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    const std::uint64_t key = trace.keys_[i];
+    if (trace.writes_[i] != 0 || cache.get(key) == nullptr)
+      cache.put(key, makeValue<_ValueT>(key));
+  }
+  std::size_t i    = 0;
+  std::size_t gets = 0;
+  std::size_t hits = 0;
+  const auto start = std::chrono::steady_clock::now();
+
+  for (auto _ : state)
+  {
+    const std::uint64_t key = trace.keys_[i];
+    if (trace.writes_[i] != 0)
+      cache.put(key, makeValue<_ValueT>(key));
+    else
+    {
+      ++gets;
+      _ValueT * value = cache.get(key);
+      if (value != nullptr)
+      {
+        benchmark::DoNotOptimize(value);
+        ++hits;
+      }
+      else
+        cache.put(key, makeValue<_ValueT>(key));
+    }
+    if (++i == length)
+      i = 0;
+  }
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  state.SetItemsProcessed(state.iterations());
+  state.counters["ns/op"]     = elapsed.count() / state.iterations();
+  state.counters["hit_ratio"] = gets == 0 ? 0.0 : static_cast<double>(hits) / gets;
+}
+//----------------------------------------------------------------------------
+// Arguments: pattern, capacity, parameter, write percent
+//----------------------------------------------------------------------------
+static constexpr std::int64_t ZIPF  = static_cast<std::int64_t>(Pattern::ZIPF);
+static constexpr std::int64_t LOOP  = static_cast<std::int64_t>(Pattern::LOOP);
+static constexpr std::int64_t SCAN  = static_cast<std::int64_t>(Pattern::SCAN);
+static constexpr std::int64_t SHIFT = static_cast<std::int64_t>(Pattern::SHIFT);
+//----------------------------------------------------------------------------
+/**
+ * @brief Every pattern at one capacity: Zipf skews, loops shorter and
+ *        longer than the cache, scan shares and hot set shifts, read-only.
+ */
+static void PatternArgs(benchmark::internal::Benchmark * benchmark, std::int64_t capacity)
+{
+  for (std::int64_t alpha : {60, 80, 100, 120})
+    benchmark->Args({ZIPF, capacity, alpha, 0});
+  for (std::int64_t loop : {50, 110, 200})
+    benchmark->Args({LOOP, capacity, loop, 0});
+  for (std::int64_t scan : {10, 30, 50})
+    benchmark->Args({SCAN, capacity, scan, 0});
+  for (std::int64_t shifts : {4, 16, 64})
+    benchmark->Args({SHIFT, capacity, shifts, 0});
+}
+//----------------------------------------------------------------------------
+static void IntArgs(benchmark::internal::Benchmark * benchmark)
+{
+  PatternArgs(benchmark, 100000);
+  // Capacities up to 10^7 and read/write ratios, on Zipf(0.9)
+  for (std::int64_t capacity : {1000, 100000, 10000000})
+    benchmark->Args({ZIPF, capacity, 90, 0});
+  for (std::int64_t writes : {5, 20, 50})
+    benchmark->Args({ZIPF, 100000, 90, writes});
+}
+//----------------------------------------------------------------------------
+static void StringArgs(benchmark::internal::Benchmark * benchmark)
+{
+  PatternArgs(benchmark, 100000);
+  for (std::int64_t capacity : {1000, 1000000})
+    benchmark->Args({ZIPF, capacity, 90, 0});
+}
+//----------------------------------------------------------------------------
+static void BlobArgs(benchmark::internal::Benchmark * benchmark)
+{
+  // 4 KiB values: 10^5 entries already take 400 MiB
+  PatternArgs(benchmark, 10000);
+  for (std::int64_t capacity : {1000, 100000})
+    benchmark->Args({ZIPF, capacity, 90, 0});
+}
+//----------------------------------------------------------------------------
+BENCHMARK_TEMPLATE(BM_Workload, LRUCache::Cache<std::uint64_t, int>, int)->Apply(IntArgs)->Iterations(TRACE_LENGTH);
+BENCHMARK_TEMPLATE(BM_Workload, LRUCache::Cache<std::uint64_t, std::string>, std::string)->Apply(StringArgs)->Iterations(TRACE_LENGTH);
+BENCHMARK_TEMPLATE(BM_Workload, LRUCache::Cache<std::uint64_t, Blob>, Blob)->Apply(BlobArgs)->Iterations(TRACE_LENGTH);
+//----------------------------------------------------------------------------
+// The other eviction policies of Cache on the same patterns
+//----------------------------------------------------------------------------
+BENCHMARK_TEMPLATE(BM_Workload, LRUCache::FifoCache<std::uint64_t, int>, int)->Apply([](benchmark::internal::Benchmark * benchmark) { PatternArgs(benchmark, 100000); })->Iterations(TRACE_LENGTH);
+BENCHMARK_TEMPLATE(BM_Workload, LRUCache::LfuCache<std::uint64_t, int>, int)->Apply([](benchmark::internal::Benchmark * benchmark) { PatternArgs(benchmark, 100000); })->Iterations(TRACE_LENGTH);
+//----------------------------------------------------------------------------
\ No newline at end of file
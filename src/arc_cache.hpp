@@ -0,0 +1,433 @@
+//----------------------------------------------------------------------------
+#ifndef ARC_CACHE_HPP
+#define ARC_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <tuple>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <functional>
+#include <unordered_map>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+enum class ArcList : std::uint8_t
+{
+  T1, ///< Resident entries seen once recently.
+  T2, ///< Resident entries seen at least twice recently.
+  B1, ///< Keys recently evicted from T1.
+  B2  ///< Keys recently evicted from T2.
+};
+//----------------------------------------------------------------------------
+template<class _IteratorT, class _ValueT>
+struct ArcEntry
+{
+//----------------------------------------------------------------------------
+  _IteratorT it_;   ///< Position of the key in T1 or T2.
+  ArcList    list_; ///< Either `ArcList::T1` or `ArcList::T2`.
+  _ValueT    value_;
+//----------------------------------------------------------------------------
+  template<class ...Args>
+  ArcEntry(const _IteratorT & it, ArcList list, Args && ...args);
+//----------------------------------------------------------------------------
+}; // struct ArcEntry
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Cache with the Adaptive Replacement Cache (ARC) policy.
+ *
+ * Resident entries are split between T1 (seen once) and T2 (seen at least
+ * twice), both in LRU order. The ghost lists B1 and B2 remember the keys (but
+ * not the values) recently evicted from T1 and T2. Re-inserting a key found in
+ * B1 means T1 was too small and grows the target size `p` of T1; a key found
+ * in B2 shrinks it. Eviction takes from T1 while it is larger than `p`, so the
+ * cache keeps tuning itself between recency and frequency. Ghost lists hold at
+ * most `capacity` keys together.
+ *
+ * The lists and the ghost index are the ones `LRUCache::Cache` uses, and the
+ * API mirrors it. A ghost hit is still a miss for `get`, the adaptation takes
+ * place when the caller `put`s the value back.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+class ArcCache
+{
+//----------------------------------------------------------------------------
+  using SizeType  = std::size_t; ///< Type representing the size of the cache.
+  using ListT     = Internal::ListT<_KeyT>; ///< LRU order of the keys of a list, most recent first.
+  using ListId    = Internal::ArcList;
+  using EntryT    = Internal::ArcEntry<typename ListT::iterator, _ValueT>;
+  using MapT      = std::unordered_map<_KeyT, EntryT, _Hash, _KeyEqual>; ///< Resident entries.
+  using GhostMapT = Internal::HashMapT<_KeyT, ListId, ListT, _Hash, _KeyEqual>; ///< Ghost keys and the list they are in.
+//----------------------------------------------------------------------------
+public:
+  /**
+   * @brief Default constructor for the ArcCache class.
+   *
+   * Initializes an empty cache with the default capacity.
+   */
+  ArcCache();
+  /**
+   * @brief Constructs an ArcCache with a specified capacity.
+   *
+   * @param capacity The maximum number of items that the cache can hold.
+   */
+  ArcCache(SizeType capacity);
+  ArcCache(const ArcCache &) = delete;
+  ArcCache & operator =(const ArcCache &) = delete;
+  /**
+   * @brief Retrieves the current capacity of the cache.
+   *
+   * @return The maximum number of items that the cache can hold.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the current number of items in the cache.
+   *
+   * @return The number of items currently stored in the cache.
+   */
+  SizeType size() const;
+  /**
+   * @brief Retrieves the current target size `p` of T1.
+   */
+  SizeType target() const;
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be moved into the cache.
+   */
+  void put(const _KeyT & key, _ValueT && value);
+  /**
+   * @brief Constructs and inserts a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be constructed and inserted or updated.
+   * @param args The arguments used to construct the value.
+   */
+  template<class ...Args>
+  void emplace(const _KeyT & key, Args && ...args);
+  /**
+   * @brief Removes the value associated with the specified key from the cache.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears all items and the ghost history from the cache.
+   */
+  void clear();
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key
+   *        and moves it to the most recently used end of T2.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache.
+   */
+  _ValueT * get(const _KeyT & key);
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache.
+   * @note Does not update position of the associated value
+   */
+  const _ValueT * get(const _KeyT & key) const;
+  /**
+   * @brief Checks if the cache contains a value associated with the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not update position of the associated value
+   */
+  bool contains(const _KeyT & key) const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Shared implementation of put and emplace.
+   */
+  template<class ...Args>
+  void store(const _KeyT & key, Args && ...args);
+  /**
+   * @brief Evicts the LRU entry of T1 or T2 into its ghost list, following
+   *        the target size of T1.
+   */
+  void replace(bool inB2);
+  /**
+   * @brief Moves the LRU entry of T1 or T2 to the front of its ghost list.
+   */
+  void demote(ListId from, ListId to);
+  /**
+   * @brief Forgets the oldest key of a ghost list.
+   */
+  void forget(ListId ghost);
+  ListT & list(ListId id);
+//----------------------------------------------------------------------------
+  SizeType  capacity_; ///< The maximum number of items that the cache can hold.
+  SizeType  target_;   ///< Target size `p` of T1.
+  ListT     lists_[4]; ///< T1, T2, B1 and B2, indexed by `ListId`.
+  MapT      map_;      ///< Index of the resident entries.
+  GhostMapT ghosts_;   ///< Index of the ghost keys.
+//----------------------------------------------------------------------------
+}; // class ArcCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+template<class _IteratorT, class _ValueT>
+template<class ...Args>
+ArcEntry<_IteratorT, _ValueT>::ArcEntry(const _IteratorT & it, ArcList list, Args && ...args) :
+  it_(it),
+  list_(list),
+  value_(std::forward<Args>(args)...)
+{
+}
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::ArcCache() :
+  ArcCache(0)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::ArcCache(SizeType capacity) :
+  capacity_(capacity),
+  target_(0)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::capacity() const
+{
+  return capacity_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::size() const
+{
+  return map_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::target() const
+{
+  return target_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, const _ValueT & value)
+{
+  store(key, value);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, _ValueT && value)
+{
+  store(key, std::move(value));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::emplace(const _KeyT & key, Args && ...args)
+{
+  store(key, std::forward<Args>(args)...);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::remove(const _KeyT & key)
+{
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return false;
+  list(it->second.list_).erase(it->second.it_);
+  map_.erase(it);
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::clear()
+{
+  for (auto & keys : lists_)
+    keys.clear();
+  map_.clear();
+  ghosts_.clear();
+  target_ = 0;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+_ValueT * ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key)
+{
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return nullptr;
+  auto & entry = it->second;
+  ListT & t2 = list(ListId::T2);
+  t2.splice(t2.begin(), list(entry.list_), entry.it_);
+  entry.list_ = ListId::T2;
+  return &(entry.value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+const _ValueT * ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key) const
+{
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return nullptr;
+  return &(it->second.value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::contains(const _KeyT & key) const
+{
+  return map_.find(key) != map_.end();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::store(const _KeyT & key, Args && ...args)
+{
+  if (capacity_ == 0)
+    return;
+  auto it = map_.find(key);
+  if (it != map_.end())
+  {
+    it->second.value_ = _ValueT(std::forward<Args>(args)...);
+    get(key);
+    return;
+  }
+  ListT & t1 = list(ListId::T1);
+  ListT & t2 = list(ListId::T2);
+  ListT & b1 = list(ListId::B1);
+  ListT & b2 = list(ListId::B2);
+  ListId  to = ListId::T2;
+  auto ghost = ghosts_.find(key);
+  if (ghost != ghosts_.end())
+  {
+    // Ghost hit: the list the key was evicted from deserves more room
+    const bool inB2 = ghost->second.value_ == ListId::B2;
+    if (!inB2)
+    {
+      const SizeType delta = b1.size() >= b2.size() ? 1 : b2.size() / b1.size();
+      target_ = capacity_ - target_ > delta ? target_ + delta : capacity_;
+    }
+    else
+    {
+      const SizeType delta = b2.size() >= b1.size() ? 1 : b1.size() / b2.size();
+      target_ = target_ > delta ? target_ - delta : 0;
+    }
+    list(ghost->second.value_).erase(ghost->second.it_);
+    ghosts_.erase(ghost);
+    if (map_.size() >= capacity_)
+      replace(inB2);
+  }
+  else
+  {
+    to = ListId::T1;
+    if (t1.size() + b1.size() >= capacity_)
+    {
+      if (t1.size() < capacity_)
+      {
+        forget(ListId::B1);
+        if (map_.size() >= capacity_)
+          replace(false);
+      }
+      else
+      {
+        map_.erase(t1.back());
+        t1.pop_back();
+      }
+    }
+    else if (t1.size() + t2.size() + b1.size() + b2.size() >= capacity_)
+    {
+      if (t1.size() + t2.size() + b1.size() + b2.size() >= 2 * capacity_)
+        forget(ListId::B2);
+      if (map_.size() >= capacity_)
+        replace(false);
+    }
+  }
+  ListT & keys = list(to);
+  keys.push_front(key);
+  try
+  {
+    map_.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(keys.begin(), to, std::forward<Args>(args)...));
+  }
+  catch (...)
+  {
+    keys.pop_front();
+    throw;
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::replace(bool inB2)
+{
+  const SizeType t1 = list(ListId::T1).size();
+  if (t1 != 0 && (t1 > target_ || (inB2 && t1 == target_)))
+    demote(ListId::T1, ListId::B1);
+  else if (!list(ListId::T2).empty())
+    demote(ListId::T2, ListId::B2);
+  else
+    demote(ListId::T1, ListId::B1);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::demote(ListId from, ListId to)
+{
+  ListT & resident = list(from);
+  ListT & ghost    = list(to);
+  ghost.splice(ghost.begin(), resident, std::prev(resident.end()));
+  map_.erase(ghost.front());
+  ghosts_.emplace(ghost.front(), typename GhostMapT::mapped_type(ghost.begin(), to));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::forget(ListId ghost)
+{
+  ListT & keys = list(ghost);
+  if (keys.empty())
+    return;
+  ghosts_.erase(keys.back());
+  keys.pop_back();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::ListT & ArcCache<_KeyT, _ValueT, _Hash, _KeyEqual>::list(ListId id)
+{
+  return lists_[static_cast<std::size_t>(id)];
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // ARC_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,397 @@
+//----------------------------------------------------------------------------
+#ifndef ASYNC_CACHE_HPP
+#define ASYNC_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+/**
+ * @brief Fixed number of worker threads running tasks in submission order,
+ *        with a bounded queue of the tasks waiting for a worker.
+ *
+ * The destructor lets the running tasks finish and drops the queued ones.
+ */
+class ThreadPool
+{
+//----------------------------------------------------------------------------
+public:
+//----------------------------------------------------------------------------
+  ThreadPool(std::size_t threads, std::size_t queueCapacity);
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator =(const ThreadPool &) = delete;
+  ~ThreadPool();
+  /**
+   * @brief Queues a task for the next idle worker.
+   *
+   * @return False if the queue is full, in which case the task is dropped.
+   */
+  bool submit(std::function<void ()> task);
+  /**
+   * @brief Retrieves the number of worker threads.
+   */
+  std::size_t threads() const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  void run();
+//----------------------------------------------------------------------------
+  std::mutex                         mutex_;
+  std::condition_variable            ready_;   ///< Signalled when a task is queued or the pool stops.
+  std::deque<std::function<void ()>> tasks_;   ///< Queued tasks, oldest first.
+  std::size_t                        queueCapacity_; ///< Maximum number of queued tasks.
+  bool                               stopped_;
+  std::vector<std::thread>           workers_;
+//----------------------------------------------------------------------------
+}; // class ThreadPool
+//----------------------------------------------------------------------------
+/**
+ * @brief A load submitted to the pool. Shared by the cache entry and the task.
+ */
+template<class _ValueT>
+struct AsyncLoad
+{
+//----------------------------------------------------------------------------
+  std::promise<_ValueT> promise_;
+  std::atomic<bool>     cancelled_; ///< Set when the entry leaves the cache, the loader is skipped if it has not started.
+//----------------------------------------------------------------------------
+  AsyncLoad();
+//----------------------------------------------------------------------------
+}; // struct AsyncLoad
+//----------------------------------------------------------------------------
+template<class _ValueT>
+struct AsyncEntry
+{
+//----------------------------------------------------------------------------
+  std::shared_future<_ValueT>          future_;
+  std::shared_ptr<AsyncLoad<_ValueT>>  load_; ///< The load that completes `future_`, nullptr for values given to `put`.
+//----------------------------------------------------------------------------
+}; // struct AsyncEntry
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Thread-safe LRU cache that loads missing values on a worker pool.
+ *
+ * `get_async` never blocks on a load: a hit returns a ready future, a miss
+ * inserts a pending future and queues the loader on the pool. Pending entries
+ * are ordinary entries of the underlying `LRUCache::Cache`, so they count
+ * toward the capacity and later misses on the same key share the same future.
+ * A load that fails is removed from the cache and completed with the exception
+ * of the loader. A pending entry that leaves the cache, whether evicted for
+ * capacity, removed, cleared or replaced by `put`, cancels its load: a loader
+ * that has not started yet is skipped and its waiters get `std::future_error`
+ * with `std::future_errc::broken_promise`. A load that already started still
+ * completes its future, but the loaded value is not cached. At most
+ * `queueCapacity` loads wait for a worker; a miss beyond that is rejected like
+ * a cancelled load and not cached.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+class AsyncCache
+{
+//----------------------------------------------------------------------------
+  using SizeType = std::size_t; ///< Type representing the size of the cache.
+  using LoadT    = Internal::AsyncLoad<_ValueT>;
+  using EntryT   = Internal::AsyncEntry<_ValueT>;
+  using CacheT   = HashCache<_KeyT, EntryT, _Hash, _KeyEqual>;
+//----------------------------------------------------------------------------
+public:
+//----------------------------------------------------------------------------
+  using FutureT = std::shared_future<_ValueT>;             ///< Type returned by `get_async`.
+  using LoaderT = std::function<_ValueT (const _KeyT &)>;  ///< Type of the loader.
+//----------------------------------------------------------------------------
+  static constexpr SizeType DEFAULT_QUEUE_CAPACITY = 1024; ///< Default bound of the loads waiting for a worker.
+//----------------------------------------------------------------------------
+  /**
+   * @brief Constructs an AsyncCache and starts its worker pool.
+   *
+   * @param capacity The maximum number of items, loaded or pending, that the
+   *                 cache can hold.
+   * @param loader Produces the value of a missing key. Runs on a worker thread.
+   * @param threads The number of worker threads, which bounds the number of
+   *                concurrent loads. Defaults to the number of hardware threads.
+   * @param queueCapacity The maximum number of loads waiting for a worker.
+   *                      Cancelled loads keep their place until a worker skips them.
+   */
+  AsyncCache(SizeType capacity, LoaderT loader, SizeType threads = std::max<SizeType>(std::thread::hardware_concurrency(), 1), SizeType queueCapacity = DEFAULT_QUEUE_CAPACITY);
+  AsyncCache(const AsyncCache &) = delete;
+  AsyncCache & operator =(const AsyncCache &) = delete;
+  /**
+   * @brief Retrieves the current capacity of the cache.
+   *
+   * @return The maximum number of items that the cache can hold.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the current number of items in the cache, pending loads included.
+   *
+   * @return The number of items currently stored in the cache.
+   */
+  SizeType size() const;
+  /**
+   * @brief Returns the future value of the specified key without blocking.
+   *
+   * The entry is marked as recently used. On a miss, a load is queued and its
+   * pending future is cached, so concurrent misses on the key run one load.
+   * If the queue of the pool is full, the future is broken and nothing is cached.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A ready future on a hit, a pending one while the value is loading.
+   */
+  FutureT get_async(const _KeyT & key);
+  /**
+   * @brief Inserts or updates a value, cancelling a pending load of the key.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Removes the specified key from the cache, cancelling a pending load.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears all items from the cache, cancelling the pending loads.
+   *        Loads that already started still complete their futures, but
+   *        their values are not cached.
+   */
+  void clear();
+  /**
+   * @brief Checks if the cache contains a loaded or pending value for the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not update position of the associated value
+   */
+  bool contains(const _KeyT & key) const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Runs the loader of a queued load on a worker thread.
+   */
+  void load(const _KeyT & key, const std::shared_ptr<LoadT> & load);
+  /**
+   * @brief Cancels the pending load of an entry, if any. Called for every
+   *        entry that leaves the cache.
+   */
+  static void cancel(const EntryT & entry);
+//----------------------------------------------------------------------------
+  LoaderT              loader_; ///< Produces the value of a missing key.
+  mutable std::mutex   mutex_;  ///< Guards `cache_`.
+  CacheT               cache_;  ///< Ready and pending futures, in LRU order.
+  Internal::ThreadPool pool_;   ///< Runs the loads. Declared last, so that it stops first.
+//----------------------------------------------------------------------------
+}; // class AsyncCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+inline ThreadPool::ThreadPool(std::size_t threads, std::size_t queueCapacity) :
+  queueCapacity_(queueCapacity),
+  stopped_(false)
+{
+  threads = std::max<std::size_t>(threads, 1);
+  workers_.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i)
+    workers_.emplace_back(&ThreadPool::run, this);
+}
+//----------------------------------------------------------------------------
+inline ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  ready_.notify_all();
+  for (auto & worker : workers_)
+    worker.join();
+}
+//----------------------------------------------------------------------------
+inline bool ThreadPool::submit(std::function<void ()> task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.size() >= queueCapacity_)
+      return false;
+    tasks_.push_back(std::move(task));
+  }
+  ready_.notify_one();
+  return true;
+}
+//----------------------------------------------------------------------------
+inline std::size_t ThreadPool::threads() const
+{
+  return workers_.size();
+}
+//----------------------------------------------------------------------------
+inline void ThreadPool::run()
+{
+  while (true)
+  {
+    std::function<void ()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this]() { return stopped_ || !tasks_.empty(); });
+      if (stopped_)
+        return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+//----------------------------------------------------------------------------
+template<class _ValueT>
+AsyncLoad<_ValueT>::AsyncLoad() :
+  cancelled_(false)
+{
+}
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::AsyncCache(SizeType capacity, LoaderT loader, SizeType threads, SizeType queueCapacity) :
+  loader_(std::move(loader)),
+  cache_(capacity),
+  pool_(threads, queueCapacity)
+{
+  cache_.set_removal_listener([](_KeyT &&, EntryT && entry, RemovalCause) { cancel(entry); });
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::capacity() const
+{
+  return cache_.capacity();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cache_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::FutureT AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get_async(const _KeyT & key)
+{
+  std::shared_ptr<LoadT> load;
+  FutureT future;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const EntryT * cached = cache_.get(key);
+    if (cached != nullptr)
+      return cached->future_;
+    load = std::make_shared<LoadT>();
+    future = load->promise_.get_future().share();
+    cache_.put(key, EntryT{future, load});
+  }
+  // NOTE: a zero capacity cache does not keep the entry, the load still runs
+  if (pool_.submit([this, key, load]() { this->load(key, load); }))
+    return future;
+  // The queue is full: drop the entry, which breaks the promise with the last reference
+  std::lock_guard<std::mutex> lock(mutex_);
+  const EntryT * cached = static_cast<const CacheT &>(cache_).get(key);
+  if (cached != nullptr && cached->load_ == load)
+    cache_.remove(key);
+  return future;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, const _ValueT & value)
+{
+  std::promise<_ValueT> promise;
+  promise.set_value(value);
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_.put(key, EntryT{promise.get_future().share(), nullptr});
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::remove(const _KeyT & key)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cache_.remove(key);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_.clear();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::contains(const _KeyT & key) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cache_.contains(key);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::load(const _KeyT & key, const std::shared_ptr<LoadT> & load)
+{
+  // NOTE: a skipped load breaks the promise once the task is destroyed
+  if (load->cancelled_.load(std::memory_order_acquire))
+    return;
+  try
+  {
+    load->promise_.set_value(loader_(key));
+  }
+  catch (...)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const EntryT * cached = static_cast<const CacheT &>(cache_).get(key);
+      if (cached != nullptr && cached->load_ == load)
+        cache_.remove(key);
+    }
+    load->promise_.set_exception(std::current_exception());
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void AsyncCache<_KeyT, _ValueT, _Hash, _KeyEqual>::cancel(const EntryT & entry)
+{
+  if (entry.load_ != nullptr)
+    entry.load_->cancelled_.store(true, std::memory_order_release);
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // ASYNC_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -2,544 +2,726 @@
 #ifndef CIRCULAR_DOUBLY_LINKED_LIST_HPP
 #define CIRCULAR_DOUBLY_LINKED_LIST_HPP
 //----------------------------------------------------------------------------
-#include <cassert>
-#include <iostream>
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <type_traits>
 #include <memory_resource>
+#include <initializer_list>
 //----------------------------------------------------------------------------
-template<class ValueT>
-struct CircularDoublyLinkedListNode
-{
-//----------------------------------------------------------------------------
-  ValueT                         value_;
-  CircularDoublyLinkedListNode * prev_;
-  CircularDoublyLinkedListNode * next_;
-//----------------------------------------------------------------------------
-  CircularDoublyLinkedListNode();
-  CircularDoublyLinkedListNode(const ValueT & value);
 //----------------------------------------------------------------------------
-}; // struct Node
 //----------------------------------------------------------------------------
-template<class ValueT>
-CircularDoublyLinkedListNode<ValueT>::CircularDoublyLinkedListNode() :
-  prev_(this),
-  next_(this)
+namespace LRUCache
 {
-}
 //----------------------------------------------------------------------------
-template<class ValueT>
-CircularDoublyLinkedListNode<ValueT>::CircularDoublyLinkedListNode(const ValueT & value) :
-  value_(value),
-  prev_(this),
-  next_(this)
+namespace Internal
 {
-}
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc = std::pmr::polymorphic_allocator<CircularDoublyLinkedListNode<ValueT>>>
-class CircularDoublyLinkedList
+struct CircularLinks
 {
 //----------------------------------------------------------------------------
-public:
+  CircularLinks * prev_;
+  CircularLinks * next_;
 //----------------------------------------------------------------------------
-  using NodeT = CircularDoublyLinkedListNode<ValueT>;
+  CircularLinks();
 //----------------------------------------------------------------------------
-class iterator
-{
+}; // struct CircularLinks
 //----------------------------------------------------------------------------
-public:
-//----------------------------------------------------------------------------
-  iterator();
-  iterator(NodeT * node, std::size_t & size);
-  iterator(NodeT * node, std::size_t pos, std::size_t & size);
-  iterator(const iterator & rhs);
+template<class _ValueT>
+struct CircularNode : CircularLinks
+{
 //----------------------------------------------------------------------------
-  iterator & operator =(const iterator & rhs);
+  _ValueT value_;
 //----------------------------------------------------------------------------
-  iterator & operator ++();
-  iterator & operator --();
+  template<class ...Args>
+  CircularNode(Args && ...args);
 //----------------------------------------------------------------------------
-        ValueT & operator *();
-  const ValueT & operator *() const;
+}; // struct CircularNode
 //----------------------------------------------------------------------------
-        NodeT * operator ->();
-  const NodeT * operator ->() const;  
+/**
+ * @brief Bidirectional iterator of `CircularDoublyLinkedList`: a single
+ *        pointer to a node, or to the head of the list for `end`.
+ */
+template<class _ValueT, bool _IsConst>
+class CircularIterator
+{
 //----------------------------------------------------------------------------
-  bool operator ==(const iterator & rhs) const;
-  bool operator !=(const iterator & rhs) const;
+  using NodeT = CircularNode<_ValueT>;
 //----------------------------------------------------------------------------
-private:
-  NodeT       * node_;
-  std::size_t   pos_;
-  bool          dir_;
-  std::size_t * size_;
+public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type        = _ValueT;
+  using difference_type   = std::ptrdiff_t;
+  using pointer           = typename std::conditional<_IsConst, const _ValueT *, _ValueT *>::type;
+  using reference         = typename std::conditional<_IsConst, const _ValueT &, _ValueT &>::type;
+//----------------------------------------------------------------------------
+  CircularIterator();
+  explicit CircularIterator(CircularLinks * node);
+  /**
+   * @brief Converts an iterator to a const iterator.
+   */
+  template<bool _IsOtherConst, class = typename std::enable_if<_IsConst && !_IsOtherConst>::type>
+  CircularIterator(const CircularIterator<_ValueT, _IsOtherConst> & rhs);
+//----------------------------------------------------------------------------
+  reference operator *() const;
+  pointer operator ->() const;
+//----------------------------------------------------------------------------
+  CircularIterator & operator ++();
+  CircularIterator operator ++(int);
+  CircularIterator & operator --();
+  CircularIterator operator --(int);
+//----------------------------------------------------------------------------
+  bool operator ==(const CircularIterator & rhs) const;
+  bool operator !=(const CircularIterator & rhs) const;
+//----------------------------------------------------------------------------
+  CircularLinks * node_;
+//----------------------------------------------------------------------------
+}; // class CircularIterator
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Circular doubly linked list with an allocator-aware node layout.
+ *
+ * The list is a ring of nodes closed by a head node stored in the list
+ * itself, so no operation has to check for an empty list or a missing
+ * neighbour, and `end` is the head. Iterators are a single node pointer and
+ * stay valid until their element is erased, as with `std::list`.
+ *
+ * Erased nodes are kept, up to `MAX_SPARES`, and reused by the next
+ * insertions: a full cache that evicts one entry for every new one never
+ * calls the allocator. `clear` releases them.
+ *
+ * The API is the part of `std::list` that `LRUCache::Cache` and its policies
+ * use, so the list can be passed as `_ListT`. Nodes come from `_Alloc`,
+ * which defaults to `std::pmr::polymorphic_allocator`, so the list (or the
+ * cache) can take them from any `std::pmr::memory_resource`. Nodes beyond
+ * `MAX_SPARES` are deallocated, so prefer a resource that reuses freed blocks,
+ * such as `std::pmr::unsynchronized_pool_resource`, to a monotonic one.
+ *
+ * @tparam _ValueT The type of the elements.
+ * @tparam _Alloc The allocator of the elements, rebound to allocate nodes.
+ *                Defaults to `std::pmr::polymorphic_allocator<_ValueT>`.
+ */
+template<class _ValueT, class _Alloc = std::pmr::polymorphic_allocator<_ValueT>>
+class CircularDoublyLinkedList
+{
 //----------------------------------------------------------------------------
-};  // class iterator
+  using LinksT      = Internal::CircularLinks;
+  using NodeT       = Internal::CircularNode<_ValueT>;
+  using NodeAllocT  = typename std::allocator_traits<_Alloc>::template rebind_alloc<NodeT>;
+  using NodeTraitsT = std::allocator_traits<NodeAllocT>;
 //----------------------------------------------------------------------------
-  CircularDoublyLinkedList(const Alloc & alloc = Alloc());
-  CircularDoublyLinkedList(std::initializer_list<ValueT> init, const Alloc & alloc = Alloc());
+public:
+  using value_type             = _ValueT;
+  using allocator_type         = _Alloc;
+  using size_type              = std::size_t;
+  using difference_type        = std::ptrdiff_t;
+  using reference              = _ValueT &;
+  using const_reference        = const _ValueT &;
+  using iterator               = Internal::CircularIterator<_ValueT, false>;
+  using const_iterator         = Internal::CircularIterator<_ValueT, true>;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+//----------------------------------------------------------------------------
+  CircularDoublyLinkedList();
+  explicit CircularDoublyLinkedList(const _Alloc & alloc);
+  CircularDoublyLinkedList(std::initializer_list<_ValueT> init, const _Alloc & alloc = _Alloc());
+  CircularDoublyLinkedList(const CircularDoublyLinkedList & rhs);
+  /**
+   * @brief Takes the nodes of `rhs`, which is left empty.
+   */
+  CircularDoublyLinkedList(CircularDoublyLinkedList && rhs) noexcept;
   ~CircularDoublyLinkedList();
 //----------------------------------------------------------------------------
   CircularDoublyLinkedList & operator =(const CircularDoublyLinkedList & rhs);
+  /**
+   * @brief Takes the nodes of `rhs` if both lists use equal allocators, and
+   *        moves its elements one by one into new nodes otherwise.
+   */
+  CircularDoublyLinkedList & operator =(CircularDoublyLinkedList && rhs);
+//----------------------------------------------------------------------------
+  allocator_type get_allocator() const;
+  size_type size() const;
+  bool empty() const;
 //----------------------------------------------------------------------------
-  std::size_t size() const;
+        reference front();
+  const_reference front() const;
+        reference back();
+  const_reference back() const;
 //----------------------------------------------------------------------------
-  bool empty() const;
+  iterator begin();
+  const_iterator begin() const;
+  const_iterator cbegin() const;
+  iterator end();
+  const_iterator end() const;
+  const_iterator cend() const;
+  reverse_iterator rbegin();
+  const_reverse_iterator rbegin() const;
+  reverse_iterator rend();
+  const_reverse_iterator rend() const;
+//----------------------------------------------------------------------------
+  /**
+   * @brief Constructs an element in place before `pos`.
+   *
+   * @return An iterator to the new element.
+   */
+  template<class ...Args>
+  iterator emplace(const_iterator pos, Args && ...args);
+  iterator insert(const_iterator pos, const _ValueT & value);
+  iterator insert(const_iterator pos, _ValueT && value);
+  template<class ...Args>
+  reference emplace_front(Args && ...args);
+  template<class ...Args>
+  reference emplace_back(Args && ...args);
+  void push_front(const _ValueT & value);
+  void push_front(_ValueT && value);
+  void push_back(const _ValueT & value);
+  void push_back(_ValueT && value);
+//----------------------------------------------------------------------------
+  /**
+   * @brief Erases the element at `pos`.
+   *
+   * @return An iterator to the element that followed it.
+   */
+  iterator erase(const_iterator pos);
+  iterator erase(const_iterator first, const_iterator last);
+  void pop_front();
+  void pop_back();
+  void clear();
 //----------------------------------------------------------------------------
-  void pushFront(const ValueT & val);
-  void pushFront(ValueT && val);
+  /**
+   * @brief Moves the element at `it` of `other` before `pos`, without copying
+   *        or reallocating it. `other` may be this list; the allocators of
+   *        both lists must compare equal.
+   */
+  void splice(const_iterator pos, CircularDoublyLinkedList & other, const_iterator it);
 //----------------------------------------------------------------------------
-  void popFront();
+  static constexpr size_type MAX_SPARES = 16; ///< Number of erased nodes kept for reuse.
 //----------------------------------------------------------------------------
-  void pushBack(const ValueT & val);
-  void pushBack(ValueT && val);
+private:
 //----------------------------------------------------------------------------
-  void popBack();
+  /**
+   * @brief Inserts `node` before `pos`.
+   */
+  static void link(LinksT * pos, LinksT * node);
+  /**
+   * @brief Takes `node` out of its ring.
+   */
+  static void unlink(LinksT * node);
+  /**
+   * @brief Moves the nodes of `rhs` to this empty list.
+   */
+  void steal(CircularDoublyLinkedList & rhs);
+  /**
+   * @brief Constructs an element in a spare node, or in a new one if there is none.
+   */
+  template<class ...Args>
+  NodeT * createNode(Args && ...args);
+  /**
+   * @brief Destroys the element of `node` and keeps the node as a spare, or
+   *        deallocates it if there are `MAX_SPARES` already.
+   */
+  void destroyNode(LinksT * node);
+  /**
+   * @brief Deallocates the spare nodes.
+   */
+  void releaseSpares();
+//----------------------------------------------------------------------------
+  NodeAllocT alloc_;  ///< Allocates the nodes.
+  LinksT     head_;   ///< Closes the ring: `head_.next_` is the first node and `head_.prev_` the last.
+  size_type  size_;
+  LinksT *   spare_;  ///< Erased nodes, chained by `next_`.
+  size_type  spares_; ///< Number of nodes in `spare_`.
 //----------------------------------------------------------------------------
-  void toFront(iterator it);
-  void toBack(iterator it);
+}; // class CircularDoublyLinkedList
 //----------------------------------------------------------------------------
-  void clear();
+} // namespace LRUCache
 //----------------------------------------------------------------------------
-  void erase(iterator it);
-  void erase(iterator from, const iterator to);
 //----------------------------------------------------------------------------
-        ValueT & front();
-  const ValueT & front() const;
 //----------------------------------------------------------------------------
-        ValueT & back();
-  const ValueT & back() const;
+namespace LRUCache
+{
 //----------------------------------------------------------------------------
-  iterator begin();
-  iterator end();
+namespace Internal
+{
 //----------------------------------------------------------------------------
-  void print() const;
-  void printR() const;
+inline CircularLinks::CircularLinks() :
+  prev_(this),
+  next_(this)
+{
+}
 //----------------------------------------------------------------------------
-private:
-  Alloc       alloc_;
-  NodeT     * node_;
-  std::size_t size_;
+template<class _ValueT>
+template<class ...Args>
+CircularNode<_ValueT>::CircularNode(Args && ...args) :
+  value_(std::forward<Args>(args)...)
+{
+}
 //----------------------------------------------------------------------------
-}; // class CircularDoublyLinkedList
+template<class _ValueT, bool _IsConst>
+CircularIterator<_ValueT, _IsConst>::CircularIterator() :
+  node_(nullptr)
+{
+}
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::iterator::iterator() :
-  node_(nullptr),
-  pos_(0),
-  dir_(false),
-  size_(nullptr)
+template<class _ValueT, bool _IsConst>
+CircularIterator<_ValueT, _IsConst>::CircularIterator(CircularLinks * node) :
+  node_(node)
 {
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::iterator::iterator(NodeT * node, std::size_t & size) :
-  node_(node),
-  pos_(0),
-  dir_(false),
-  size_(&size)
+template<class _ValueT, bool _IsConst>
+template<bool _IsOtherConst, class>
+CircularIterator<_ValueT, _IsConst>::CircularIterator(const CircularIterator<_ValueT, _IsOtherConst> & rhs) :
+  node_(rhs.node_)
 {
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::iterator::iterator(NodeT * node, std::size_t pos, std::size_t & size) :
-  node_(node),
-  pos_(pos),
-  dir_(false),
-  size_(&size)
+template<class _ValueT, bool _IsConst>
+typename CircularIterator<_ValueT, _IsConst>::reference CircularIterator<_ValueT, _IsConst>::operator *() const
 {
+  return static_cast<NodeT *>(node_)->value_;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::iterator::iterator(const iterator & rhs) :
-  node_(rhs.node_),
-  pos_(rhs.pos_),
-  dir_(rhs.dir_),
-  size_(rhs.size_)
+template<class _ValueT, bool _IsConst>
+typename CircularIterator<_ValueT, _IsConst>::pointer CircularIterator<_ValueT, _IsConst>::operator ->() const
 {
+  return std::addressof(static_cast<NodeT *>(node_)->value_);
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::iterator & CircularDoublyLinkedList<ValueT, Alloc>::iterator::operator =(const iterator & rhs)
+template<class _ValueT, bool _IsConst>
+CircularIterator<_ValueT, _IsConst> & CircularIterator<_ValueT, _IsConst>::operator ++()
 {
-  if (*this != rhs)
-  {
-    node_ = rhs.node_;
-    pos_  = rhs.pos_;
-    dir_  = rhs.dir_;
-  }
+  node_ = node_->next_;
   return *this;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::iterator & CircularDoublyLinkedList<ValueT, Alloc>::iterator::operator++()
+template<class _ValueT, bool _IsConst>
+CircularIterator<_ValueT, _IsConst> CircularIterator<_ValueT, _IsConst>::operator ++(int)
 {
+  CircularIterator old(*this);
   node_ = node_->next_;
-  if (pos_ == 0)
-    dir_ = true; // true = forward
-  pos_ += (dir_ ? 1 : -1);
-  // NOTE: to handle overflow and underflow
-  pos_  = std::min(pos_, std::max((*size_) - 1, (std::size_t)1));
-  return *this;
+  return old;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::iterator & CircularDoublyLinkedList<ValueT, Alloc>::iterator::operator--()
+template<class _ValueT, bool _IsConst>
+CircularIterator<_ValueT, _IsConst> & CircularIterator<_ValueT, _IsConst>::operator --()
 {
   node_ = node_->prev_;
-  if (pos_ == 0)
-    dir_ = false; // false = backward
-  pos_ += (dir_ ? -1 : 1);
-  // NOTE: to handle overflow and underflow
-  pos_ = std::min(pos_, std::max((*size_) - 1, (std::size_t)1));
   return *this;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-ValueT & CircularDoublyLinkedList<ValueT, Alloc>::iterator::operator *()
+template<class _ValueT, bool _IsConst>
+CircularIterator<_ValueT, _IsConst> CircularIterator<_ValueT, _IsConst>::operator --(int)
+{
+  CircularIterator old(*this);
+  node_ = node_->prev_;
+  return old;
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, bool _IsConst>
+bool CircularIterator<_ValueT, _IsConst>::operator ==(const CircularIterator & rhs) const
 {
-  return node_->value_;
+  return node_ == rhs.node_;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-const ValueT & CircularDoublyLinkedList<ValueT, Alloc>::iterator::operator *() const
+template<class _ValueT, bool _IsConst>
+bool CircularIterator<_ValueT, _IsConst>::operator !=(const CircularIterator & rhs) const
 {
-  return node_->value_;
+  return node_ != rhs.node_;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::NodeT * CircularDoublyLinkedList<ValueT, Alloc>::iterator::operator ->()
+} // namespace Internal
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+CircularDoublyLinkedList<_ValueT, _Alloc>::CircularDoublyLinkedList() :
+  CircularDoublyLinkedList(_Alloc())
 {
-  return node_;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-const CircularDoublyLinkedList<ValueT, Alloc>::NodeT * CircularDoublyLinkedList<ValueT, Alloc>::iterator::operator ->() const
+template<class _ValueT, class _Alloc>
+CircularDoublyLinkedList<_ValueT, _Alloc>::CircularDoublyLinkedList(const _Alloc & alloc) :
+  alloc_(alloc),
+  size_(0),
+  spare_(nullptr),
+  spares_(0)
 {
-  return node_;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-bool CircularDoublyLinkedList<ValueT, Alloc>::iterator::operator ==(const iterator & rhs) const
+template<class _ValueT, class _Alloc>
+CircularDoublyLinkedList<_ValueT, _Alloc>::CircularDoublyLinkedList(std::initializer_list<_ValueT> init, const _Alloc & alloc) :
+  CircularDoublyLinkedList(alloc)
 {
-  return node_ == rhs.node_ && 
-         pos_  == rhs.pos_  &&
-         size_ == rhs.size_;
+  for (const _ValueT & value : init)
+    emplace_back(value);
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-bool CircularDoublyLinkedList<ValueT, Alloc>::iterator::operator !=(const iterator & rhs) const
+template<class _ValueT, class _Alloc>
+CircularDoublyLinkedList<_ValueT, _Alloc>::CircularDoublyLinkedList(const CircularDoublyLinkedList & rhs) :
+  CircularDoublyLinkedList(NodeTraitsT::select_on_container_copy_construction(rhs.alloc_))
 {
-  return !((*this) == rhs);
+  for (const _ValueT & value : rhs)
+    emplace_back(value);
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::CircularDoublyLinkedList(const Alloc & alloc) :
-  alloc_(alloc),
-  node_(nullptr),
-  size_(0)
+template<class _ValueT, class _Alloc>
+CircularDoublyLinkedList<_ValueT, _Alloc>::CircularDoublyLinkedList(CircularDoublyLinkedList && rhs) noexcept :
+  alloc_(rhs.alloc_),
+  size_(0),
+  spare_(nullptr),
+  spares_(0)
 {
+  steal(rhs);
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::CircularDoublyLinkedList(std::initializer_list<ValueT> init, const Alloc & alloc) :
-  alloc_(alloc),
-  node_(nullptr),
-  size_(init.size())
+template<class _ValueT, class _Alloc>
+CircularDoublyLinkedList<_ValueT, _Alloc>::~CircularDoublyLinkedList()
 {
-  NodeT * first = nullptr;
-  NodeT * last  = nullptr;
-  auto it = init.end();
-  for (std::size_t i = 0; i < init.size(); ++i)
-  {
-    std::advance(it, -1);
-    if (first == nullptr)
-    {
-      node_ = alloc_.template new_object<NodeT>(*it);
-      first = node_->prev_;
-      last  = node_->next_;
-      continue;
-    }
-    node_        = alloc_.template new_object<NodeT>(*it);
-    first->prev_ = node_;
-    last->next_  = node_;
-    node_->next_ = first;
-    node_->prev_ = last;
-    first = node_;
-  }
+  clear();
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::~CircularDoublyLinkedList()
+template<class _ValueT, class _Alloc>
+CircularDoublyLinkedList<_ValueT, _Alloc> & CircularDoublyLinkedList<_ValueT, _Alloc>::operator =(const CircularDoublyLinkedList & rhs)
 {
+  if (this == &rhs)
+    return *this;
   clear();
+  for (const _ValueT & value : rhs)
+    emplace_back(value);
+  return *this;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc> & CircularDoublyLinkedList<ValueT, Alloc>::operator =(const CircularDoublyLinkedList<ValueT, Alloc> & rhs)
+template<class _ValueT, class _Alloc>
+CircularDoublyLinkedList<_ValueT, _Alloc> & CircularDoublyLinkedList<_ValueT, _Alloc>::operator =(CircularDoublyLinkedList && rhs)
 {
-  if (*this == rhs)
+  if (this == &rhs)
     return *this;
   clear();
-  for (const auto & value : rhs)
-    pushBack(value);
+  // NOTE: the spare nodes of rhs stay with it, they belong to its allocator
+  if (alloc_ == rhs.alloc_)
+  {
+    steal(rhs);
+    return *this;
+  }
+  // NOTE: the nodes of rhs belong to another memory resource
+  for (_ValueT & value : rhs)
+    emplace_back(std::move(value));
+  rhs.clear();
   return *this;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-std::size_t CircularDoublyLinkedList<ValueT, Alloc>::size() const
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::allocator_type CircularDoublyLinkedList<_ValueT, _Alloc>::get_allocator() const
+{
+  return allocator_type(alloc_);
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::size_type CircularDoublyLinkedList<_ValueT, _Alloc>::size() const
 {
   return size_;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-bool CircularDoublyLinkedList<ValueT, Alloc>::empty() const
+template<class _ValueT, class _Alloc>
+bool CircularDoublyLinkedList<_ValueT, _Alloc>::empty() const
 {
   return size_ == 0;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::pushFront(const ValueT & val)
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::reference CircularDoublyLinkedList<_ValueT, _Alloc>::front()
 {
-  ++size_;
-  if (node_ == nullptr)
-  {
-    node_        = alloc_.template new_object<NodeT>(val);
-    node_->next_ = node_;
-    node_->prev_ = node_;
-    return;
-  }
-  NodeT * prev = node_->prev_;
-  NodeT * old  = prev->next_;
-
-  node_ = alloc_.template new_object<NodeT>(val);
-
-  prev->next_  = node_;
-  node_->prev_ = prev;
-
-  old->prev_   = node_;
-  node_->next_ = old;
+  return static_cast<NodeT *>(head_.next_)->value_;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::pushFront(ValueT && val)
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::const_reference CircularDoublyLinkedList<_ValueT, _Alloc>::front() const
 {
-  ++size_;
-  if (node_ == nullptr)
-  {
-    node_        = alloc_.template new_object<NodeT>(std::forward<ValueT>(val));
-    node_->next_ = node_;
-    node_->prev_ = node_;
-    return;
-  }
-  NodeT * prev = node_->prev_;
-  NodeT * old  = prev->next_;
-
-  node_ = alloc_.template new_object<NodeT>(std::forward<ValueT>(val));
-
-  prev->next_  = node_;
-  node_->prev_ = prev;
-
-  old->prev_   = node_;
-  node_->next_ = old;
+  return static_cast<const NodeT *>(head_.next_)->value_;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::popFront()
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::reference CircularDoublyLinkedList<_ValueT, _Alloc>::back()
 {
-  --size_;
-  NodeT * prev = node_->prev_;
-  NodeT * next = node_->next_;
-  alloc_.delete_object(node_);
-  prev->next_ = next;
-  next->prev_ = prev;
-  node_ = next;
+  return static_cast<NodeT *>(head_.prev_)->value_;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::pushBack(const ValueT & val)
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::const_reference CircularDoublyLinkedList<_ValueT, _Alloc>::back() const
 {
-  ++size_;
-  if (node_ == nullptr)
-  {
-    node_ = alloc_.template new_object<NodeT>(val);
-    node_->next_ = node_;
-    node_->prev_ = node_;
-    return;
-  }
-  NodeT * prev        = node_->prev_;
-  node_->prev_        = alloc_.template new_object<NodeT>(val);
-  node_->prev_->next_ = node_;
-  node_->prev_->prev_ = prev;
-  prev->next_         = node_->prev_;
+  return static_cast<const NodeT *>(head_.prev_)->value_;
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::iterator CircularDoublyLinkedList<_ValueT, _Alloc>::begin()
+{
+  return iterator(head_.next_);
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::const_iterator CircularDoublyLinkedList<_ValueT, _Alloc>::begin() const
+{
+  return const_iterator(head_.next_);
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::const_iterator CircularDoublyLinkedList<_ValueT, _Alloc>::cbegin() const
+{
+  return begin();
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::iterator CircularDoublyLinkedList<_ValueT, _Alloc>::end()
+{
+  return iterator(&head_);
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::const_iterator CircularDoublyLinkedList<_ValueT, _Alloc>::end() const
+{
+  // NOTE: const iterators never write through the node pointer
+  return const_iterator(const_cast<LinksT *>(&head_));
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::const_iterator CircularDoublyLinkedList<_ValueT, _Alloc>::cend() const
+{
+  return end();
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::reverse_iterator CircularDoublyLinkedList<_ValueT, _Alloc>::rbegin()
+{
+  return reverse_iterator(end());
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::pushBack(ValueT && val)
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::const_reverse_iterator CircularDoublyLinkedList<_ValueT, _Alloc>::rbegin() const
 {
+  return const_reverse_iterator(end());
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::reverse_iterator CircularDoublyLinkedList<_ValueT, _Alloc>::rend()
+{
+  return reverse_iterator(begin());
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::const_reverse_iterator CircularDoublyLinkedList<_ValueT, _Alloc>::rend() const
+{
+  return const_reverse_iterator(begin());
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+template<class ...Args>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::iterator CircularDoublyLinkedList<_ValueT, _Alloc>::emplace(const_iterator pos, Args && ...args)
+{
+  NodeT * node = createNode(std::forward<Args>(args)...);
+  link(pos.node_, node);
   ++size_;
-  if (node_ == nullptr)
-  {
-    node_        = alloc_.template new_object<NodeT>(val);
-    node_->next_ = node_;
-    node_->prev_ = node_;
-    return;
-  }
-  NodeT * prev        = node_->prev_;
-  node_->prev_        = alloc_.template new_object<NodeT>(std::forward<ValueT>(val));
-  node_->prev_->next_ = node_;
-  node_->prev_->prev_ = prev;
-  prev->next_         = node_->prev_;
+  return iterator(node);
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::popBack()
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::iterator CircularDoublyLinkedList<_ValueT, _Alloc>::insert(const_iterator pos, const _ValueT & value)
 {
-  --size_;
-  NodeT * prev = node_->prev_->prev_;
-  alloc_.delete_object(node_->prev_);
-  node_->prev_ = prev;
-  prev->next_ = node_;
-}
-//----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::toFront(iterator it)
-{
-  NodeT * prev = it->prev_;
-  NodeT * next = it->next_;
-  NodeT * old  = it->prev_->next_;
-
-  prev->next_ = next;
-  next->prev_ = prev;
-
-  old->prev_ = node_->prev_;
-  old->next_ = node_;
-
-  node_->prev_->next_ = old;
-  node_->prev_        = old;
-
-  node_ = old;
-}
-//----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::toBack(iterator it)
-{
-  NodeT * prev = it->prev_;
-  NodeT * next = it->next_;
-  NodeT * old  = it->prev_->next_;
-  
-  if (old == node_)
-  {
-    node_ = next;
-    return;
-  }
-
-  prev->next_ = next;
-  next->prev_ = prev;
-
-  old->next_ = node_;
-  old->prev_ = node_->prev_;
-
-  node_->prev_->next_ = old;
-  node_->prev_        = old;
-}
-//----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::clear()
-{
-  NodeT * cur  = node_;
-  NodeT * next = nullptr;
-  if (size_ != 0)
-  {
-    do
-    {
-      cur->prev_->next_ = nullptr;
-      next = cur->next_;
-      alloc_.delete_object(cur);
-      cur = next;
-    } while (cur != nullptr);
-  }
-  size_ = 0;
+  return emplace(pos, value);
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::iterator CircularDoublyLinkedList<_ValueT, _Alloc>::insert(const_iterator pos, _ValueT && value)
+{
+  return emplace(pos, std::move(value));
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+template<class ...Args>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::reference CircularDoublyLinkedList<_ValueT, _Alloc>::emplace_front(Args && ...args)
+{
+  return *emplace(begin(), std::forward<Args>(args)...);
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+template<class ...Args>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::reference CircularDoublyLinkedList<_ValueT, _Alloc>::emplace_back(Args && ...args)
+{
+  return *emplace(end(), std::forward<Args>(args)...);
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::push_front(const _ValueT & value)
+{
+  emplace(begin(), value);
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::erase(iterator it)
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::push_front(_ValueT && value)
 {
-  NodeT * prev = it->prev_;
-  NodeT * next = it->next_;
-  alloc_.delete_object(it->node_);
-  prev->next_ = next;
-  next->prev_ = prev;
+  emplace(begin(), std::move(value));
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::push_back(const _ValueT & value)
+{
+  emplace(end(), value);
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::push_back(_ValueT && value)
+{
+  emplace(end(), std::move(value));
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::iterator CircularDoublyLinkedList<_ValueT, _Alloc>::erase(const_iterator pos)
+{
+  LinksT * next = pos.node_->next_;
+  unlink(pos.node_);
+  destroyNode(pos.node_);
   --size_;
+  return iterator(next);
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::erase(iterator from, iterator to)
+template<class _ValueT, class _Alloc>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::iterator CircularDoublyLinkedList<_ValueT, _Alloc>::erase(const_iterator first, const_iterator last)
 {
-  while (from != to)
-  {
-    erase(from);
-    ++from;
-  }
+  while (first != last)
+    first = erase(first);
+  return iterator(last.node_);
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-ValueT & CircularDoublyLinkedList<ValueT, Alloc>::front()
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::pop_front()
 {
-  return node_->value_;
+  erase(begin());
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-const ValueT & CircularDoublyLinkedList<ValueT, Alloc>::front() const
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::pop_back()
 {
-  return node_->value_;
+  erase(const_iterator(head_.prev_));
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::clear()
+{
+  LinksT * node = head_.next_;
+  while (node != &head_)
+  {
+    LinksT * next = node->next_;
+    destroyNode(node);
+    node = next;
+  }
+  head_.prev_ = &head_;
+  head_.next_ = &head_;
+  size_       = 0;
+  releaseSpares();
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-ValueT & CircularDoublyLinkedList<ValueT, Alloc>::back()
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::splice(const_iterator pos, CircularDoublyLinkedList & other, const_iterator it)
 {
-  return node_->prev_->value_;
+  if (pos == it || pos.node_ == it.node_->next_)
+    return;
+  unlink(it.node_);
+  link(pos.node_, it.node_);
+  if (&other != this)
+  {
+    --other.size_;
+    ++size_;
+  }
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-const ValueT & CircularDoublyLinkedList<ValueT, Alloc>::back() const
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::link(LinksT * pos, LinksT * node)
 {
-  return node_->prev_->value_;
+  node->prev_       = pos->prev_;
+  node->next_       = pos;
+  pos->prev_->next_ = node;
+  pos->prev_        = node;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::iterator CircularDoublyLinkedList<ValueT, Alloc>::begin()
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::unlink(LinksT * node)
 {
-  return iterator(node_, size_);
+  node->prev_->next_ = node->next_;
+  node->next_->prev_ = node->prev_;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-CircularDoublyLinkedList<ValueT, Alloc>::iterator CircularDoublyLinkedList<ValueT, Alloc>::end()
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::steal(CircularDoublyLinkedList & rhs)
 {
-  return iterator(node_, std::max(size_-1, (std::size_t)1), size_);
+  if (rhs.size_ == 0)
+    return;
+  // The ring of rhs is closed by its own head: move the ends to ours
+  head_.next_        = rhs.head_.next_;
+  head_.prev_        = rhs.head_.prev_;
+  head_.next_->prev_ = &head_;
+  head_.prev_->next_ = &head_;
+  size_              = rhs.size_;
+  rhs.head_.prev_    = &rhs.head_;
+  rhs.head_.next_    = &rhs.head_;
+  rhs.size_          = 0;
+}
+//----------------------------------------------------------------------------
+template<class _ValueT, class _Alloc>
+template<class ...Args>
+typename CircularDoublyLinkedList<_ValueT, _Alloc>::NodeT * CircularDoublyLinkedList<_ValueT, _Alloc>::createNode(Args && ...args)
+{
+  NodeT * node;
+  if (spare_ != nullptr)
+  {
+    node   = static_cast<NodeT *>(static_cast<void *>(spare_));
+    spare_ = spare_->next_;
+    --spares_;
+  }
+  else
+    node = NodeTraitsT::allocate(alloc_, 1);
+  try
+  {
+    NodeTraitsT::construct(alloc_, node, std::forward<Args>(args)...);
+  }
+  catch (...)
+  {
+    NodeTraitsT::deallocate(alloc_, node, 1);
+    throw;
+  }
+  return node;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::print() const
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::destroyNode(LinksT * node)
 {
-  NodeT * cur = node_;
-  do
+  NodeT * full = static_cast<NodeT *>(node);
+  NodeTraitsT::destroy(alloc_, full);
+  if (spares_ == MAX_SPARES)
   {
-    std::cout << cur->value_ << "->";
-    cur = cur->next_;
-  } while (cur != node_);
-  std::cout << '\n';
+    NodeTraitsT::deallocate(alloc_, full, 1);
+    return;
+  }
+  LinksT * links = ::new (static_cast<void *>(full)) LinksT();
+  links->next_ = spare_;
+  spare_       = links;
+  ++spares_;
 }
 //----------------------------------------------------------------------------
-template<class ValueT, class Alloc>
-void CircularDoublyLinkedList<ValueT, Alloc>::printR() const
+template<class _ValueT, class _Alloc>
+void CircularDoublyLinkedList<_ValueT, _Alloc>::releaseSpares()
 {
-  NodeT * cur = node_->prev_;
-  do
+  while (spare_ != nullptr)
   {
-    std::cout << cur->value_ << "<-";
-    cur = cur->prev_;
-  } while (cur != node_->prev_);
-  std::cout << '\n';
+    NodeT * node = static_cast<NodeT *>(static_cast<void *>(spare_));
+    spare_ = spare_->next_;
+    NodeTraitsT::deallocate(alloc_, node, 1);
+  }
+  spares_ = 0;
 }
 //----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
 #endif // CIRCULAR_DOUBLY_LINKED_LIST_HPP
 //----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,321 @@
+//----------------------------------------------------------------------------
+#ifndef CLOCK_CACHE_HPP
+#define CLOCK_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <functional>
+//----------------------------------------------------------------------------
+#include "slot_table.hpp"
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+struct ClockMeta
+{
+  mutable std::atomic<bool> referenced_{false}; ///< Set by hits, cleared by the clock hand.
+}; // struct ClockMeta
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Thread-safe approximate LRU cache using the CLOCK (second chance) policy.
+ *
+ * Entries live in a fixed ring of slots of an `Internal::SlotTable`, so
+ * lookups take no lock. For trivially copyable keys and values, a hit writes
+ * nothing but the reference bit, and skips even that store if the bit is
+ * already set.
+ *
+ * Writers are serialized by a mutex. When the cache is full, the clock hand
+ * sweeps the ring, clearing reference bits until it finds an unreferenced
+ * victim.
+ *
+ * Values are returned by copy, like in `LRUCache::ShardedCache`.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+class ClockCache
+{
+//----------------------------------------------------------------------------
+  using TableT   = Internal::SlotTable<_KeyT, _ValueT, Internal::ClockMeta, _Hash, _KeyEqual>; ///< Entry storage and index.
+  using SizeType = typename TableT::SizeType; ///< Type representing the size of the cache.
+  using IndexT   = typename TableT::IndexT; ///< Type of a slot index.
+  using SlotT    = typename TableT::SlotT; ///< Type of an entry slot.
+//----------------------------------------------------------------------------
+public:
+  /**
+   * @brief Constructs a ClockCache and reserves all of its slots.
+   *
+   * @param capacity The maximum number of items that the cache can hold,
+   *                 at most 2^32 - 2.
+   */
+  ClockCache(SizeType capacity);
+  ClockCache(const ClockCache &) = delete;
+  ClockCache & operator =(const ClockCache &) = delete;
+  /**
+   * @brief Retrieves the current capacity of the cache.
+   *
+   * @return The maximum number of items that the cache can hold.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the current number of items in the cache.
+   *
+   * @return The number of items currently stored in the cache.
+   */
+  SizeType size() const;
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * If the cache is full, the clock hand picks the first entry whose reference
+   * bit is clear, giving referenced entries a second chance.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be moved into the cache.
+   */
+  void put(const _KeyT & key, _ValueT && value);
+  /**
+   * @brief Constructs and inserts a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be constructed and inserted or updated.
+   * @param args The arguments used to construct the value.
+   */
+  template<class ...Args>
+  void emplace(const _KeyT & key, Args && ...args);
+  /**
+   * @brief Removes the value associated with the specified key from the cache.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears all items from the cache.
+   */
+  void clear();
+  /**
+   * @brief Copies the value associated with the specified key and sets its
+   *        reference bit. Takes no lock.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @param value Receives a copy of the value if the key is found.
+   * @return True if the key was found, false otherwise.
+   */
+  bool get(const _KeyT & key, _ValueT & value) const;
+  /**
+   * @brief Checks if the cache contains a value associated with the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not set the reference bit
+   */
+  bool contains(const _KeyT & key) const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Replaces the value of an entry and sets its reference bit.
+   *        Requires `mutex_`.
+   */
+  template<class _V>
+  void update(IndexT index, _V && value);
+  /**
+   * @brief Stores a new entry in a free slot, or in the slot picked by the
+   *        clock hand if the cache is full. Requires `mutex_`.
+   */
+  template<class ...Args>
+  void insert(const _KeyT & key, SizeType hash, Args && ...args);
+  /**
+   * @brief Removes the entry of a slot and frees the slot. Requires `mutex_`.
+   */
+  void erase(IndexT index);
+  /**
+   * @brief Advances the clock hand to the next unreferenced slot, clearing
+   *        reference bits on the way. Requires `mutex_`.
+   */
+  IndexT sweep();
+//----------------------------------------------------------------------------
+  TableT              table_; ///< The clock ring, with its lock-free index.
+  mutable std::mutex  mutex_; ///< Serializes the writers; readers take no lock.
+  std::vector<IndexT> free_; ///< Unoccupied slots.
+  IndexT              hand_; ///< Next slot inspected by the clock hand.
+//----------------------------------------------------------------------------
+}; // class ClockCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::ClockCache(SizeType capacity) :
+  table_(capacity),
+  hand_(0)
+{
+  free_.reserve(table_.capacity());
+  for (SizeType index = table_.capacity(); index > 0; --index)
+    free_.push_back(static_cast<IndexT>(index - 1));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::capacity() const
+{
+  return table_.capacity();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::size() const
+{
+  return table_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, const _ValueT & value)
+{
+  const SizeType hash = table_.hash(key);
+  std::lock_guard<std::mutex> lock(mutex_);
+  const IndexT index = table_.find(key, hash);
+  if (index == Internal::TABLE_NIL)
+    insert(key, hash, value);
+  else
+    update(index, value);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, _ValueT && value)
+{
+  const SizeType hash = table_.hash(key);
+  std::lock_guard<std::mutex> lock(mutex_);
+  const IndexT index = table_.find(key, hash);
+  if (index == Internal::TABLE_NIL)
+    insert(key, hash, std::forward<_ValueT>(value));
+  else
+    update(index, std::forward<_ValueT>(value));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::emplace(const _KeyT & key, Args && ...args)
+{
+  const SizeType hash = table_.hash(key);
+  std::lock_guard<std::mutex> lock(mutex_);
+  const IndexT index = table_.find(key, hash);
+  if (index == Internal::TABLE_NIL)
+    insert(key, hash, std::forward<Args>(args)...);
+  else
+    update(index, _ValueT(std::forward<Args>(args)...));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::remove(const _KeyT & key)
+{
+  const SizeType hash = table_.hash(key);
+  std::lock_guard<std::mutex> lock(mutex_);
+  const IndexT index = table_.find(key, hash);
+  if (index == Internal::TABLE_NIL)
+    return false;
+  erase(index);
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  table_.clear();
+  free_.clear();
+  for (SizeType index = table_.capacity(); index > 0; --index)
+  {
+    table_[static_cast<IndexT>(index - 1)].referenced_.store(false, std::memory_order_relaxed);
+    free_.push_back(static_cast<IndexT>(index - 1));
+  }
+  hand_ = 0;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key, _ValueT & value) const
+{
+  return table_.lookup(key, [&value](const SlotT & slot, const _ValueT & found)
+  {
+    // NOTE: skip the store when the bit is already set to keep the line shared
+    if (!slot.referenced_.load(std::memory_order_relaxed))
+      slot.referenced_.store(true, std::memory_order_relaxed);
+    value = found;
+  });
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::contains(const _KeyT & key) const
+{
+  return table_.lookup(key, [](const SlotT &, const _ValueT &) {});
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class _V>
+void ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::update(IndexT index, _V && value)
+{
+  table_.assign(index, std::forward<_V>(value));
+  table_[index].referenced_.store(true, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::insert(const _KeyT & key, SizeType hash, Args && ...args)
+{
+  if (table_.capacity() == 0)
+    return;
+  if (free_.empty())
+    erase(sweep());
+  const IndexT index = free_.back();
+  table_.insert(index, key, hash, std::forward<Args>(args)...);
+  free_.pop_back();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::erase(IndexT index)
+{
+  table_.erase(index);
+  table_[index].referenced_.store(false, std::memory_order_relaxed);
+  free_.push_back(index);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::IndexT ClockCache<_KeyT, _ValueT, _Hash, _KeyEqual>::sweep()
+{
+  while (true)
+  {
+    SlotT & slot = table_[hand_];
+    const IndexT index = hand_;
+    hand_ = static_cast<IndexT>(hand_ + 1 == table_.capacity() ? 0 : hand_ + 1);
+    if (!slot.referenced_.load(std::memory_order_relaxed))
+      return index;
+    slot.referenced_.store(false, std::memory_order_relaxed);
+  }
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // CLOCK_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,703 @@
+//----------------------------------------------------------------------------
+#ifndef EXPIRING_CACHE_HPP
+#define EXPIRING_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <list>
+#include <tuple>
+#include <chrono>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+struct TimerNode
+{
+//----------------------------------------------------------------------------
+  TimerNode *   prev_;   ///< Previous node in the wheel bucket, nullptr if not scheduled.
+  TimerNode *   next_;   ///< Next node in the wheel bucket, nullptr if not scheduled.
+  std::uint64_t expiry_; ///< Tick at which the timer fires.
+//----------------------------------------------------------------------------
+  TimerNode();
+//----------------------------------------------------------------------------
+}; // struct TimerNode
+//----------------------------------------------------------------------------
+/**
+ * @brief Hierarchical timer wheel.
+ *
+ * Level `i` has 64 buckets that are `64^i` ticks wide, the last level has a
+ * single bucket for everything further away. A timer is placed on the lowest
+ * level whose span covers its delay. Advancing the wheel visits the buckets
+ * of the ticks it passes, at most 64 per level: due timers are handed to the
+ * callback, the others are moved down to a finer level, so a timer fires in
+ * the first `advance` that reaches its tick. Scheduling and cancelling are O(1), so every
+ * timer costs O(1) amortized work no matter how many are pending.
+ */
+class TimerWheel
+{
+//----------------------------------------------------------------------------
+public:
+//----------------------------------------------------------------------------
+  TimerWheel();
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel & operator =(const TimerWheel &) = delete;
+  /**
+   * @brief Current tick of the wheel.
+   */
+  std::uint64_t now() const;
+  /**
+   * @brief Schedules a timer that is not scheduled yet.
+   *
+   * @param node The timer to schedule.
+   * @param expiry The tick at which the timer fires. Past ticks fire on the
+   *               next call to `advance`.
+   */
+  void schedule(TimerNode * node, std::uint64_t expiry);
+  /**
+   * @brief Unschedules a timer. Does nothing if the timer is not scheduled.
+   */
+  static void cancel(TimerNode * node);
+  /**
+   * @brief Moves the wheel to `now` and calls `expire(TimerNode *)` for every
+   *        timer with an expiry tick not after `now`. The timer is already
+   *        unscheduled when the callback runs.
+   */
+  template<class _ExpireT>
+  void advance(std::uint64_t now, _ExpireT && expire);
+  /**
+   * @brief Unschedules all timers.
+   */
+  void clear();
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  static constexpr int      LEVELS = 5;
+  static constexpr unsigned BITS   = 6;
+//----------------------------------------------------------------------------
+  static std::uint64_t buckets(int level);
+  static unsigned      shift(int level);
+  void                 place(TimerNode * node);
+//----------------------------------------------------------------------------
+  TimerNode     wheel_[LEVELS][std::size_t(1) << BITS]; ///< Bucket sentinels of circular timer lists.
+  std::uint64_t now_; ///< Last tick the wheel was advanced to.
+//----------------------------------------------------------------------------
+}; // class TimerWheel
+//----------------------------------------------------------------------------
+template<class _IteratorT, class _ValueT, class _TimePointT>
+struct ExpiringEntry : TimerNode
+{
+//----------------------------------------------------------------------------
+  _IteratorT  it_;       ///< Position of the key in the LRU list.
+  _TimePointT deadline_; ///< Exact expiration time, `_TimePointT::max()` if the entry never expires.
+  _ValueT     value_;
+//----------------------------------------------------------------------------
+  template<class ...Args>
+  ExpiringEntry(const _IteratorT & it, Args && ...args);
+//----------------------------------------------------------------------------
+}; // struct ExpiringEntry
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief LRU cache with per-entry time-to-live.
+ *
+ * Every entry carries a deadline, given per `put`/`emplace_for` call or taken
+ * from the default TTL of the cache. `get` and `contains` compare it with the
+ * clock, so an expired entry is a miss as soon as its deadline passes. Expired
+ * entries are reclaimed by a hierarchical timer wheel that is advanced on every
+ * non-const call, which costs O(1) amortized time per entry and never scans the
+ * cache. Capacity eviction is plain LRU, as in `LRUCache::Cache`.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _ClockT Clock used to read the current time: any type with the
+ *                 `duration` and `time_point` members of the standard clocks
+ *                 and a const (or static) `now()`. Defaults to
+ *                 `std::chrono::steady_clock`; tests inject a manual clock.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _ClockT = std::chrono::steady_clock, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+class ExpiringCache
+{
+//----------------------------------------------------------------------------
+public:
+//----------------------------------------------------------------------------
+  using Duration  = typename _ClockT::duration;   ///< Type of TTLs.
+  using TimePoint = typename _ClockT::time_point; ///< Type of deadlines.
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  using SizeType = std::size_t; ///< Type representing the size of the cache.
+  using TickT    = std::chrono::milliseconds; ///< Resolution of the timer wheel.
+  using ListT    = std::list<_KeyT>; ///< LRU order of the keys, most recent first.
+  using EntryT   = Internal::ExpiringEntry<typename ListT::iterator, _ValueT, TimePoint>;
+  using MapT     = std::unordered_map<_KeyT, EntryT, _Hash, _KeyEqual>;
+//----------------------------------------------------------------------------
+public:
+  /**
+   * @brief Constructs an ExpiringCache.
+   *
+   * @param capacity The maximum number of items that the cache can hold.
+   * @param defaultTtl Time-to-live of entries inserted without an explicit one.
+   *                   `Duration::max()` means that they never expire.
+   * @param clock The clock used to read the current time.
+   */
+  ExpiringCache(SizeType capacity = 0, Duration defaultTtl = Duration::max(), const _ClockT & clock = _ClockT());
+  ExpiringCache(const ExpiringCache &) = delete;
+  ExpiringCache & operator =(const ExpiringCache &) = delete;
+  /**
+   * @brief Retrieves the current capacity of the cache.
+   *
+   * @return The maximum number of items that the cache can hold.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the current number of items in the cache.
+   *
+   * @return The number of items currently stored in the cache, including
+   *         expired ones the timer wheel has not reclaimed yet.
+   */
+  SizeType size() const;
+  /**
+   * @brief Retrieves the time-to-live of entries inserted without an explicit one.
+   */
+  Duration ttl() const;
+  /**
+   * @brief Sets the function told about every entry that leaves the cache.
+   *
+   * Entries reclaimed by the timer wheel, or found expired by `get`, `remove`
+   * or an update, are reported as `RemovalCause::EXPIRED`. As in `Cache`, the
+   * listener is called after the call that removed them has finished
+   * updating the cache, and receives the value moved out of it.
+   *
+   * @param listener The callback, or an empty function to remove it.
+   */
+  void set_removal_listener(RemovalListener<_KeyT, _ValueT> listener);
+  /**
+   * @brief Inserts or updates a value that expires after the default TTL.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Inserts or updates a value that expires after the default TTL.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be moved into the cache.
+   */
+  void put(const _KeyT & key, _ValueT && value);
+  /**
+   * @brief Inserts or updates a value that expires after `ttl`.
+   *
+   * Updating a key restarts its TTL. A non-positive `ttl` removes the key.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   * @param ttl Time-to-live of the entry, `Duration::max()` for no expiration.
+   */
+  void put(const _KeyT & key, const _ValueT & value, Duration ttl);
+  /**
+   * @brief Inserts or updates a value that expires after `ttl`.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be moved into the cache.
+   * @param ttl Time-to-live of the entry, `Duration::max()` for no expiration.
+   */
+  void put(const _KeyT & key, _ValueT && value, Duration ttl);
+  /**
+   * @brief Constructs and inserts a value that expires after the default TTL.
+   *
+   * @param key The key associated with the value to be constructed and inserted or updated.
+   * @param args The arguments used to construct the value.
+   */
+  template<class ...Args>
+  void emplace(const _KeyT & key, Args && ...args);
+  /**
+   * @brief Constructs and inserts a value that expires after `ttl`.
+   *
+   * @param key The key associated with the value to be constructed and inserted or updated.
+   * @param ttl Time-to-live of the entry, `Duration::max()` for no expiration.
+   * @param args The arguments used to construct the value.
+   */
+  template<class ...Args>
+  void emplace_for(const _KeyT & key, Duration ttl, Args && ...args);
+  /**
+   * @brief Removes the value associated with the specified key from the cache.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if an unexpired entry was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears all items from the cache.
+   */
+  void clear();
+  /**
+   * @brief Reclaims all entries whose deadline has passed.
+   *
+   * Every non-const call does this already; call it to release memory of an
+   * otherwise idle cache.
+   */
+  void purge();
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key
+   *        and marks it as recently used.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache
+   *         or its entry has expired.
+   */
+  _ValueT * get(const _KeyT & key);
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache
+   *         or its entry has expired.
+   * @note Does not update position of the associated value
+   */
+  const _ValueT * get(const _KeyT & key) const;
+  /**
+   * @brief Checks if the cache contains an unexpired value for the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache and has not expired, false otherwise.
+   * @note Does not update position of the associated value
+   */
+  bool contains(const _KeyT & key) const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Shared implementation of put and emplace.
+   */
+  template<class ...Args>
+  void store(const _KeyT & key, Duration ttl, Args && ...args);
+  /**
+   * @brief Advances the timer wheel to `now`, reclaiming expired entries.
+   */
+  void expire(TimePoint now);
+  /**
+   * @brief Sets the deadline of an entry and schedules its timer.
+   */
+  void arm(EntryT & entry, TimePoint now, Duration ttl);
+  /**
+   * @brief Cancels the timer of an entry and removes it. If there is a
+   *        listener, the entry is queued for it.
+   */
+  void erase(typename MapT::iterator it, RemovalCause cause);
+  /**
+   * @brief `RemovalCause::EXPIRED` if the deadline of the entry has passed,
+   *        `cause` otherwise.
+   */
+  static RemovalCause causeAt(const EntryT & entry, TimePoint now, RemovalCause cause);
+  /**
+   * @brief Converts a time point to timer wheel ticks, rounding up or down.
+   */
+  std::uint64_t ticks(TimePoint time, bool roundUp) const;
+//----------------------------------------------------------------------------
+  SizeType             capacity_;   ///< The maximum number of items that the cache can hold.
+  Duration             defaultTtl_; ///< TTL of entries inserted without an explicit one.
+  _ClockT              clock_;      ///< The clock used to read the current time.
+  TimePoint            epoch_;      ///< Time of tick zero of the timer wheel.
+  Internal::TimerWheel wheel_;      ///< Timers of the entries that expire.
+  ListT                list_;       ///< The list used to maintain the order of items.
+  MapT                 map_;        ///< The map used for fast key-value lookups.
+  RemovalListener<_KeyT, _ValueT>                listener_; ///< Told about removed entries, may be empty.
+  std::vector<Internal::Removal<_KeyT, _ValueT>> removed_;  ///< Removals not yet passed to `listener_`.
+//----------------------------------------------------------------------------
+}; // class ExpiringCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+inline TimerNode::TimerNode() :
+  prev_(nullptr),
+  next_(nullptr),
+  expiry_(0)
+{
+}
+//----------------------------------------------------------------------------
+inline TimerWheel::TimerWheel() :
+  now_(0)
+{
+  clear();
+}
+//----------------------------------------------------------------------------
+inline std::uint64_t TimerWheel::now() const
+{
+  return now_;
+}
+//----------------------------------------------------------------------------
+inline void TimerWheel::schedule(TimerNode * node, std::uint64_t expiry)
+{
+  node->expiry_ = expiry;
+  place(node);
+}
+//----------------------------------------------------------------------------
+inline void TimerWheel::cancel(TimerNode * node)
+{
+  if (node->prev_ == nullptr)
+    return;
+  node->prev_->next_ = node->next_;
+  node->next_->prev_ = node->prev_;
+  node->prev_ = nullptr;
+  node->next_ = nullptr;
+}
+//----------------------------------------------------------------------------
+template<class _ExpireT>
+void TimerWheel::advance(std::uint64_t now, _ExpireT && expire)
+{
+  if (now <= now_)
+    return;
+  const std::uint64_t previous = now_;
+  now_ = now;
+  for (int level = 0; level < LEVELS; ++level)
+  {
+    const std::uint64_t previousTicks = previous >> shift(level);
+    const std::uint64_t currentTicks  = now >> shift(level);
+    if (currentTicks == previousTicks)
+      break;
+    const std::uint64_t mask  = buckets(level) - 1;
+    const std::uint64_t count = std::min(currentTicks - previousTicks, buckets(level));
+    for (std::uint64_t i = 0; i < count; ++i)
+    {
+      // NOTE: the bucket is detached first, timers that are not due yet may be
+      //       placed back into it
+      TimerNode & sentinel = wheel_[level][(previousTicks + 1 + i) & mask];
+      TimerNode * node     = sentinel.next_;
+      sentinel.prev_ = &sentinel;
+      sentinel.next_ = &sentinel;
+      while (node != &sentinel)
+      {
+        TimerNode * next = node->next_;
+        node->prev_ = nullptr;
+        node->next_ = nullptr;
+        if (node->expiry_ <= now_)
+          expire(node);
+        else
+          place(node);
+        node = next;
+      }
+    }
+  }
+}
+//----------------------------------------------------------------------------
+inline void TimerWheel::clear()
+{
+  for (auto & level : wheel_)
+    for (auto & sentinel : level)
+    {
+      sentinel.prev_ = &sentinel;
+      sentinel.next_ = &sentinel;
+    }
+}
+//----------------------------------------------------------------------------
+inline std::uint64_t TimerWheel::buckets(int level)
+{
+  return level == LEVELS - 1 ? 1 : std::uint64_t(1) << BITS;
+}
+//----------------------------------------------------------------------------
+inline unsigned TimerWheel::shift(int level)
+{
+  return BITS * level;
+}
+//----------------------------------------------------------------------------
+inline void TimerWheel::place(TimerNode * node)
+{
+  // NOTE: the bucket of the current tick has been visited already
+  const std::uint64_t expiry = node->expiry_ > now_ ? node->expiry_ : now_ + 1;
+  const std::uint64_t delay  = expiry - now_;
+  int level = 0;
+  while (level < LEVELS - 1 && delay >= (std::uint64_t(1) << shift(level + 1)))
+    ++level;
+  TimerNode & sentinel = wheel_[level][(expiry >> shift(level)) & (buckets(level) - 1)];
+  node->prev_ = sentinel.prev_;
+  node->next_ = &sentinel;
+  sentinel.prev_->next_ = node;
+  sentinel.prev_ = node;
+}
+//----------------------------------------------------------------------------
+template<class _IteratorT, class _ValueT, class _TimePointT>
+template<class ...Args>
+ExpiringEntry<_IteratorT, _ValueT, _TimePointT>::ExpiringEntry(const _IteratorT & it, Args && ...args) :
+  it_(it),
+  deadline_(_TimePointT::max()),
+  value_(std::forward<Args>(args)...)
+{
+}
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::ExpiringCache(SizeType capacity, Duration defaultTtl, const _ClockT & clock) :
+  capacity_(capacity),
+  defaultTtl_(defaultTtl),
+  clock_(clock),
+  epoch_(clock_.now())
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+typename ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::SizeType ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::capacity() const
+{
+  return capacity_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+typename ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::SizeType ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::size() const
+{
+  return list_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+typename ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::Duration ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::ttl() const
+{
+  return defaultTtl_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::set_removal_listener(RemovalListener<_KeyT, _ValueT> listener)
+{
+  listener_ = std::move(listener);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::put(const _KeyT & key, const _ValueT & value)
+{
+  store(key, defaultTtl_, value);
+  Internal::notifyRemovals(removed_, listener_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::put(const _KeyT & key, _ValueT && value)
+{
+  store(key, defaultTtl_, std::move(value));
+  Internal::notifyRemovals(removed_, listener_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::put(const _KeyT & key, const _ValueT & value, Duration ttl)
+{
+  store(key, ttl, value);
+  Internal::notifyRemovals(removed_, listener_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::put(const _KeyT & key, _ValueT && value, Duration ttl)
+{
+  store(key, ttl, std::move(value));
+  Internal::notifyRemovals(removed_, listener_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::emplace(const _KeyT & key, Args && ...args)
+{
+  store(key, defaultTtl_, std::forward<Args>(args)...);
+  Internal::notifyRemovals(removed_, listener_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::emplace_for(const _KeyT & key, Duration ttl, Args && ...args)
+{
+  store(key, ttl, std::forward<Args>(args)...);
+  Internal::notifyRemovals(removed_, listener_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+bool ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::remove(const _KeyT & key)
+{
+  const TimePoint now = clock_.now();
+  expire(now);
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return false;
+  const bool alive = now < it->second.deadline_;
+  erase(it, causeAt(it->second, now, RemovalCause::EXPLICIT));
+  Internal::notifyRemovals(removed_, listener_);
+  return alive;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::clear()
+{
+  if (listener_)
+  {
+    const TimePoint now = clock_.now();
+    for (auto & entry : map_)
+      removed_.emplace_back(entry.first, std::move(entry.second.value_), causeAt(entry.second, now, RemovalCause::EXPLICIT));
+  }
+  wheel_.clear();
+  map_.clear();
+  list_.clear();
+  Internal::notifyRemovals(removed_, listener_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::purge()
+{
+  expire(clock_.now());
+  Internal::notifyRemovals(removed_, listener_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+_ValueT * ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::get(const _KeyT & key)
+{
+  const TimePoint now = clock_.now();
+  expire(now);
+  _ValueT * value = nullptr;
+  auto it = map_.find(key);
+  if (it != map_.end() && now < it->second.deadline_)
+  {
+    list_.splice(list_.begin(), list_, it->second.it_);
+    value = &(it->second.value_);
+  }
+  else if (it != map_.end())
+    erase(it, RemovalCause::EXPIRED);
+  // NOTE: the timer wheel may have reclaimed other entries even on a hit
+  Internal::notifyRemovals(removed_, listener_);
+  return value;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+const _ValueT * ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::get(const _KeyT & key) const
+{
+  auto it = map_.find(key);
+  if (it == map_.end() || !(clock_.now() < it->second.deadline_))
+    return nullptr;
+  return &(it->second.value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+bool ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::contains(const _KeyT & key) const
+{
+  return get(key) != nullptr;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::store(const _KeyT & key, Duration ttl, Args && ...args)
+{
+  const TimePoint now = clock_.now();
+  expire(now);
+  auto it = map_.find(key);
+  if (ttl <= Duration::zero())
+  {
+    if (it != map_.end())
+      erase(it, causeAt(it->second, now, RemovalCause::EXPLICIT));
+    return;
+  }
+  if (it == map_.end())
+  {
+    if (capacity_ == 0)
+      return;
+    if (list_.size() == capacity_)
+    {
+      auto victim = map_.find(list_.back());
+      erase(victim, causeAt(victim->second, now, RemovalCause::SIZE));
+    }
+    list_.push_front(key);
+    try
+    {
+      it = map_.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(list_.begin(), std::forward<Args>(args)...)).first;
+    }
+    catch (...)
+    {
+      list_.pop_front();
+      throw;
+    }
+  }
+  else
+  {
+    auto & entry = it->second;
+    if (listener_)
+      removed_.emplace_back(it->first, std::move(entry.value_), causeAt(entry, now, RemovalCause::REPLACED));
+    entry.value_ = _ValueT(std::forward<Args>(args)...);
+    list_.splice(list_.begin(), list_, entry.it_);
+  }
+  arm(it->second, now, ttl);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::expire(TimePoint now)
+{
+  wheel_.advance(ticks(now, false), [this](Internal::TimerNode * node)
+  {
+    auto & entry = static_cast<EntryT &>(*node);
+    auto listIt  = entry.it_;
+    if (listener_)
+      removed_.emplace_back(*listIt, std::move(entry.value_), RemovalCause::EXPIRED);
+    map_.erase(*listIt);
+    list_.erase(listIt);
+  });
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::arm(EntryT & entry, TimePoint now, Duration ttl)
+{
+  Internal::TimerWheel::cancel(&entry);
+  if (ttl >= TimePoint::max() - now)
+  {
+    entry.deadline_ = TimePoint::max();
+    return;
+  }
+  entry.deadline_ = now + ttl;
+  wheel_.schedule(&entry, ticks(entry.deadline_, true));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+void ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::erase(typename MapT::iterator it, RemovalCause cause)
+{
+  Internal::TimerWheel::cancel(&it->second);
+  if (listener_)
+    removed_.emplace_back(it->first, std::move(it->second.value_), cause);
+  auto listIt = it->second.it_;
+  map_.erase(it);
+  list_.erase(listIt);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+RemovalCause ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::causeAt(const EntryT & entry, TimePoint now, RemovalCause cause)
+{
+  return now < entry.deadline_ ? cause : RemovalCause::EXPIRED;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ClockT, class _Hash, class _KeyEqual>
+std::uint64_t ExpiringCache<_KeyT, _ValueT, _ClockT, _Hash, _KeyEqual>::ticks(TimePoint time, bool roundUp) const
+{
+  if (!(epoch_ < time))
+    return 0;
+  const auto elapsed = time - epoch_;
+  auto tick = std::chrono::duration_cast<TickT>(elapsed);
+  if (roundUp && tick < elapsed)
+    ++tick;
+  return static_cast<std::uint64_t>(tick.count());
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // EXPIRING_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,807 @@
+//----------------------------------------------------------------------------
+#ifndef HYBRID_CACHE_HPP
+#define HYBRID_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+//----------------------------------------------------------------------------
+#include <fcntl.h>
+#include <unistd.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+/**
+ * @brief Where a record of the disk tier of a `HybridCache` is stored:
+ *        12 bytes per entry in the index, next to the key.
+ */
+struct DiskLocation
+{
+//----------------------------------------------------------------------------
+  std::uint32_t region_;
+  std::uint32_t offset_; ///< Offset of the record within its region.
+  std::uint32_t size_;   ///< Size of the record, including its length prefix.
+//----------------------------------------------------------------------------
+  bool operator ==(const DiskLocation & other) const;
+//----------------------------------------------------------------------------
+}; // struct DiskLocation
+//----------------------------------------------------------------------------
+/**
+ * @brief Bookkeeping of one fixed-size region of the disk log.
+ */
+struct DiskRegion
+{
+//----------------------------------------------------------------------------
+  std::uint64_t live_;       ///< Bytes of the records the index still points to.
+  std::uint32_t used_;       ///< Bytes appended since the region was last reused.
+  std::uint32_t generation_; ///< Bumped whenever the region is reused.
+//----------------------------------------------------------------------------
+}; // struct DiskRegion
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Counters of a `HybridCache`.
+ */
+struct HybridCacheStats
+{
+//----------------------------------------------------------------------------
+  std::uint64_t memoryHits_;    ///< Lookups served by the memory tier.
+  std::uint64_t diskHits_;      ///< Lookups served by the disk tier, and promoted.
+  std::uint64_t misses_;        ///< Lookups that found the key in neither tier.
+  std::uint64_t demotions_;     ///< Entries evicted from memory and written to disk.
+  std::uint64_t dropped_;       ///< Evicted entries that were not written: queue full, record too large or write error.
+  std::uint64_t diskEvictions_; ///< Entries lost when their region was reclaimed.
+  std::uint64_t compactions_;   ///< Regions freed by moving their live records to the head of the log.
+  std::uint64_t reclaims_;      ///< Regions freed by dropping their records.
+  std::uint64_t bytesWritten_;  ///< Bytes written to the disk log, moved records included.
+//----------------------------------------------------------------------------
+  /**
+   * @brief Fraction of the lookups served by either tier, 0 if there were none.
+   */
+  double hit_ratio() const;
+//----------------------------------------------------------------------------
+}; // struct HybridCacheStats
+//----------------------------------------------------------------------------
+/**
+ * @brief Two-tier cache: an in-memory LRU cache in front of an append-only
+ *        log on local disk.
+ *
+ * Entries evicted from the memory tier are queued and written to the log by
+ * a background thread, in batches of one `pwrite` per region. An in-memory
+ * index maps every key on disk to the region, offset and size of its
+ * record, so a memory miss costs one hash lookup and, if the key is on
+ * disk, a single `pread`. A disk hit moves the entry back to memory, so an
+ * entry lives in exactly one tier.
+ *
+ * The log is split into fixed-size regions filled one after the other. The
+ * background thread keeps free regions ahead of the writes: a region whose
+ * records are mostly dead (overwritten, removed or promoted) is compacted by
+ * appending its live records to the head of the log, and when none is
+ * sparse enough the oldest region is reclaimed and its entries dropped, so
+ * the disk tier itself evicts in FIFO order.
+ *
+ * Keys and values are encoded with `_KeySerializerT` and `_ValueSerializerT`
+ * (see `Serializer`). The file is truncated when the cache is created: the
+ * disk tier is a cache, not a store. Like `Cache`, the cache is not
+ * thread-safe; only the disk writer runs in the background. POSIX only.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _CacheT The memory tier. Defaults to `::LRUCache::Cache<_KeyT, _ValueT>`.
+ * @tparam _Hash The hash function of the disk index. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeySerializerT Encodes and decodes keys. Defaults to `::LRUCache::Serializer<_KeyT>`.
+ * @tparam _ValueSerializerT Encodes and decodes values. Defaults to `::LRUCache::Serializer<_ValueT>`.
+ */
+template<class _KeyT, class _ValueT, class _CacheT = ::LRUCache::Cache<_KeyT, _ValueT>, class _Hash = std::hash<_KeyT>,
+         class _KeySerializerT = ::LRUCache::Serializer<_KeyT>, class _ValueSerializerT = ::LRUCache::Serializer<_ValueT>>
+class HybridCache
+{
+//----------------------------------------------------------------------------
+  using SizeType = std::size_t;   ///< Type representing the size of the cache.
+  using IndexT   = std::uint32_t; ///< Type of region numbers.
+//----------------------------------------------------------------------------
+  /**
+   * @brief Evicted entry waiting to be written.
+   */
+  struct Pending
+  {
+    _ValueT       value_;
+    std::uint64_t sequence_; ///< Tells a later demotion of the same key apart.
+  };
+  /**
+   * @brief Encoded record on its way to the log: a demotion, or a live record
+   *        moved out of a region being compacted.
+   */
+  struct Record
+  {
+    _KeyT                  key_;
+    std::string            bytes_;
+    std::uint64_t          sequence_; ///< Sequence number of the demotion.
+    bool                   moved_;    ///< Whether the record comes from `from_`.
+    Internal::DiskLocation from_;
+  };
+//----------------------------------------------------------------------------
+  static constexpr IndexT   NO_REGION       = 0xFFFFFFFF;
+  static constexpr SizeType RESERVE_REGIONS = 2;       ///< Free regions the background thread tries to keep.
+  static constexpr SizeType PENDING_LIMIT   = 1 << 16; ///< Evicted entries queued at most; more are dropped.
+//----------------------------------------------------------------------------
+public:
+//----------------------------------------------------------------------------
+  static constexpr SizeType DEFAULT_REGION_SIZE = 4 << 20; ///< 4 MiB.
+//----------------------------------------------------------------------------
+  /**
+   * @brief Creates the memory tier and truncates the disk log.
+   *
+   * @param capacity The maximum number of items of the memory tier.
+   * @param path The file of the disk log.
+   * @param regions The number of regions of the log, at least 3. The log
+   *        never grows past `regions * regionSize` bytes.
+   * @param regionSize The size of a region, and of the largest record.
+   */
+  HybridCache(SizeType capacity, const std::string & path, SizeType regions, SizeType regionSize = DEFAULT_REGION_SIZE);
+  HybridCache(const HybridCache &) = delete;
+  HybridCache & operator =(const HybridCache &) = delete;
+  /**
+   * @brief Stops the background thread, dropping the entries not written yet,
+   *        and closes the log. The file is left in place.
+   */
+  ~HybridCache();
+  /**
+   * @brief Tells whether the disk tier is available. If not, the cache works
+   *        as a plain memory cache.
+   */
+  bool is_open() const;
+  /**
+   * @brief Retrieves the capacity of the memory tier.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the number of items in the memory tier.
+   */
+  SizeType size() const;
+  /**
+   * @brief Retrieves the number of items on disk or queued for it.
+   */
+  SizeType disk_size() const;
+  /**
+   * @brief Retrieves the maximum size of the disk log in bytes.
+   */
+  SizeType disk_capacity() const;
+  /**
+   * @brief Retrieves the counters of both tiers.
+   */
+  HybridCacheStats stats() const;
+  /**
+   * @brief Inserts or updates a value in the memory tier, dropping any copy
+   *        on disk. The entry it evicts, if any, is queued for the disk.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Removes the value associated with the specified key from both tiers.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears both tiers. Disk space is reclaimed in the background.
+   */
+  void clear();
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key
+   *        and marks it as recently used.
+   *
+   * On a memory miss, the disk tier is checked with at most one read, and an
+   * entry found there is moved to the memory tier.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value in the memory tier, or nullptr if the key
+   *         is in neither tier.
+   */
+  _ValueT * get(const _KeyT & key);
+  /**
+   * @brief Checks if either tier contains a value associated with the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not update position of the associated value
+   */
+  bool contains(const _KeyT & key) const;
+  /**
+   * @brief Waits until the background thread has written every queued entry.
+   */
+  void flush();
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Queues an entry evicted from the memory tier. Runs as its removal listener.
+   */
+  void demote(_KeyT && key, _ValueT && value);
+  /**
+   * @brief Removes the disk copy of a key, queued or written.
+   *
+   * @return True if there was one.
+   */
+  bool dropDisk(const _KeyT & key);
+  /**
+   * @brief Moves an entry found on disk to the memory tier.
+   */
+  _ValueT * promote(const _KeyT & key, _ValueT && value);
+  /**
+   * @brief Encodes a record: its size, the key and the value.
+   */
+  std::string encode(const _KeyT & key, const _ValueT & value) const;
+  /**
+   * @brief Calls `visit(key, location)` for every record in the bytes of a region.
+   */
+  template<class _VisitT>
+  void scan(IndexT region, const std::string & data, _VisitT visit) const;
+//----------------------------------------------------------------------------
+  // Background thread only
+//----------------------------------------------------------------------------
+  void run();
+  /**
+   * @brief Appends records to the log, opening new regions as needed.
+   */
+  void write(std::vector<Record> & records);
+  /**
+   * @brief Writes the records placed in one region with a single `pwrite`,
+   *        then points the index at them.
+   */
+  void commit(const std::string & chunk, std::vector<std::pair<Record *, Internal::DiskLocation>> & placed);
+  /**
+   * @brief Takes a free region, reclaiming the oldest one if there is none.
+   */
+  IndexT allocate();
+  /**
+   * @brief Compacts sparse regions while fewer than `RESERVE_REGIONS` are free.
+   */
+  void maintain();
+  /**
+   * @brief Moves the live records of a region to the head of the log and frees it.
+   */
+  void compact(IndexT region);
+  /**
+   * @brief Reads the bytes written to a region.
+   */
+  std::string read(IndexT region) const;
+  /**
+   * @brief Drops the index entries of a region and marks it empty. Must hold `mutex_`.
+   */
+  void reset(IndexT region, const std::string & data);
+//----------------------------------------------------------------------------
+  _CacheT                                       cache_;      ///< The memory tier.
+  HybridCacheStats                              stats_;      ///< Memory hits are counted without `mutex_`, the rest under it.
+  _KeySerializerT                               keySerializer_;
+  _ValueSerializerT                             valueSerializer_;
+  int                                           fd_;         ///< The disk log, -1 if none.
+  SizeType                                      regionSize_;
+  mutable std::mutex                            mutex_;      ///< Guards everything below but `active_` and `DiskRegion::used_`.
+  std::condition_variable                       ready_;      ///< Signalled when an entry is queued or the cache stops.
+  std::condition_variable                       drained_;    ///< Signalled when the background thread is idle.
+  std::unordered_map<_KeyT, Pending, _Hash>     pending_;    ///< Evicted entries not written yet.
+  std::deque<std::pair<_KeyT, std::uint64_t>>   queue_;      ///< Keys and sequence numbers of `pending_` in eviction order; stale ones are skipped.
+  std::unordered_map<_KeyT, Internal::DiskLocation, _Hash> index_; ///< Location of every key on disk.
+  std::vector<Internal::DiskRegion>             regions_;
+  std::deque<IndexT>                            sealed_;     ///< Full regions, oldest first.
+  std::deque<IndexT>                            free_;       ///< Empty regions.
+  IndexT                                        active_;     ///< Region being appended to.
+  std::uint64_t                                 sequence_;   ///< Last demotion sequence number.
+  bool                                          writing_;    ///< Whether the background thread is busy.
+  bool                                          stopping_;
+  std::thread                                   thread_;     ///< Started last, after the members it uses.
+//----------------------------------------------------------------------------
+}; // class HybridCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+inline bool Internal::DiskLocation::operator ==(const DiskLocation & other) const
+{
+  return region_ == other.region_ && offset_ == other.offset_ && size_ == other.size_;
+}
+//----------------------------------------------------------------------------
+inline double HybridCacheStats::hit_ratio() const
+{
+  const std::uint64_t lookups = memoryHits_ + diskHits_ + misses_;
+  return lookups == 0 ? 0.0 : static_cast<double>(memoryHits_ + diskHits_) / lookups;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::HybridCache(SizeType capacity, const std::string & path, SizeType regions, SizeType regionSize) :
+  cache_(capacity),
+  stats_(),
+  fd_(-1),
+  regionSize_(regionSize),
+  regions_(regions, Internal::DiskRegion()),
+  active_(NO_REGION),
+  sequence_(0),
+  writing_(false),
+  stopping_(false)
+{
+  if (regions < 3 || regions >= NO_REGION || regionSize < sizeof(std::uint32_t) || regionSize > 0x80000000u)
+    return;
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0)
+    return;
+  if (::ftruncate(fd_, static_cast<off_t>(regions * regionSize)) != 0)
+  {
+    ::close(fd_);
+    fd_ = -1;
+    return;
+  }
+  for (SizeType region = 0; region < regions; ++region)
+    free_.push_back(static_cast<IndexT>(region));
+  cache_.set_removal_listener([this](_KeyT && key, _ValueT && value, RemovalCause cause)
+  {
+    if (cause == RemovalCause::SIZE)
+      demote(std::move(key), std::move(value));
+  });
+  thread_ = std::thread(&HybridCache::run, this);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::~HybridCache()
+{
+  if (fd_ < 0)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_all();
+  thread_.join();
+  ::close(fd_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+bool HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::is_open() const
+{
+  return fd_ >= 0;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+typename HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::SizeType HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::capacity() const
+{
+  return cache_.capacity();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+typename HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::SizeType HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::size() const
+{
+  return cache_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+typename HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::SizeType HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::disk_size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.size() + pending_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+typename HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::SizeType HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::disk_capacity() const
+{
+  return fd_ < 0 ? 0 : regions_.size() * regionSize_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+HybridCacheStats HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+void HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::put(const _KeyT & key, const _ValueT & value)
+{
+  // An entry is in one tier only, so a key in memory has no disk copy
+  if (fd_ >= 0 && !cache_.contains(key))
+    dropDisk(key);
+  cache_.put(key, value);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+bool HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::remove(const _KeyT & key)
+{
+  return cache_.remove(key) || (fd_ >= 0 && dropDisk(key));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+void HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::clear()
+{
+  cache_.clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_.clear();
+  queue_.clear();
+  index_.clear();
+  for (Internal::DiskRegion & region : regions_)
+    region.live_ = 0;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+_ValueT * HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::get(const _KeyT & key)
+{
+  _ValueT * value = cache_.get(key);
+  if (value != nullptr || fd_ < 0)
+  {
+    ++(value != nullptr ? stats_.memoryHits_ : stats_.misses_);
+    return value;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;)
+  {
+    auto pending = pending_.find(key);
+    if (pending != pending_.end())
+    {
+      _ValueT found = std::move(pending->second.value_);
+      pending_.erase(pending);
+      ++stats_.diskHits_;
+      lock.unlock();
+      return promote(key, std::move(found));
+    }
+    auto it = index_.find(key);
+    if (it == index_.end())
+    {
+      ++stats_.misses_;
+      return nullptr;
+    }
+    const Internal::DiskLocation location = it->second;
+    const std::uint32_t generation = regions_[location.region_].generation_;
+    lock.unlock();
+
+    // The region may be reclaimed during the read: check it was not afterwards
+    std::string data(location.size_, '\0');
+    const bool read = ::pread(fd_, &data[0], data.size(), static_cast<off_t>(location.region_ * regionSize_ + location.offset_)) == static_cast<ssize_t>(data.size());
+    const char * cursor = data.data() + sizeof(std::uint32_t);
+    const char * end    = data.data() + data.size();
+    _KeyT   storedKey;
+    _ValueT found;
+    const bool decoded = read && keySerializer_.read(cursor, end, storedKey) && valueSerializer_.read(cursor, end, found);
+    lock.lock();
+    it = index_.find(key);
+    if (it == index_.end())
+    {
+      ++stats_.misses_;
+      return nullptr;
+    }
+    // NOTE: a record moved by compaction in the meantime is still live, so
+    // look it up again and read it at its new location
+    if (!(it->second == location) || regions_[location.region_].generation_ != generation)
+      continue;
+    index_.erase(it);
+    regions_[location.region_].live_ -= location.size_;
+    ++(decoded ? stats_.diskHits_ : stats_.misses_);
+    lock.unlock();
+    return decoded ? promote(key, std::move(found)) : nullptr;
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+bool HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::contains(const _KeyT & key) const
+{
+  if (cache_.contains(key))
+    return true;
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_.count(key) != 0 || index_.count(key) != 0;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+void HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::flush()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  drained_.wait(lock, [this]() { return fd_ < 0 || (pending_.empty() && !writing_); });
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+void HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::demote(_KeyT && key, _ValueT && value)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.size() >= PENDING_LIMIT)
+    {
+      ++stats_.dropped_;
+      return;
+    }
+    queue_.emplace_back(key, ++sequence_);
+    pending_[std::move(key)] = Pending{std::move(value), sequence_};
+  }
+  ready_.notify_one();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+bool HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::dropDisk(const _KeyT & key)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_.erase(key) != 0)
+    return true;
+  auto it = index_.find(key);
+  if (it == index_.end())
+    return false;
+  regions_[it->second.region_].live_ -= it->second.size_;
+  index_.erase(it);
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+_ValueT * HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::promote(const _KeyT & key, _ValueT && value)
+{
+  cache_.put(key, std::move(value));
+  return cache_.get(key);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+std::string HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::encode(const _KeyT & key, const _ValueT & value) const
+{
+  std::string bytes(sizeof(std::uint32_t), '\0');
+  keySerializer_.write(bytes, key);
+  valueSerializer_.write(bytes, value);
+  const std::uint32_t size = static_cast<std::uint32_t>(std::min<SizeType>(bytes.size(), 0xFFFFFFFF));
+  std::memcpy(&bytes[0], &size, sizeof(size));
+  return bytes;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+template<class _VisitT>
+void HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::scan(IndexT region, const std::string & data, _VisitT visit) const
+{
+  SizeType offset = 0;
+  while (offset + sizeof(std::uint32_t) <= data.size())
+  {
+    std::uint32_t size;
+    std::memcpy(&size, data.data() + offset, sizeof(size));
+    if (size < sizeof(size) || offset + size > data.size())
+      return;
+    const char * cursor = data.data() + offset + sizeof(size);
+    _KeyT key;
+    if (keySerializer_.read(cursor, data.data() + offset + size, key))
+      visit(key, Internal::DiskLocation{region, static_cast<std::uint32_t>(offset), size});
+    offset += size;
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+void HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    ready_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+    if (stopping_)
+      return;
+    writing_ = true;
+    // Encode about one region worth of entries, oldest first, so that the
+    // log is in eviction order; they stay readable in pending_ until written
+    std::vector<Record> records;
+    SizeType bytes = 0;
+    while (!queue_.empty() && bytes < regionSize_)
+    {
+      auto it = pending_.find(queue_.front().first);
+      const std::uint64_t sequence = queue_.front().second;
+      queue_.pop_front();
+      if (it == pending_.end() || it->second.sequence_ != sequence)
+        continue;
+      std::string encoded = encode(it->first, it->second.value_);
+      if (encoded.size() > regionSize_)
+      {
+        ++stats_.dropped_;
+        pending_.erase(it);
+        continue;
+      }
+      bytes += encoded.size();
+      records.push_back(Record{it->first, std::move(encoded), sequence, false, Internal::DiskLocation()});
+    }
+    lock.unlock();
+    write(records);
+    maintain();
+    lock.lock();
+    writing_ = false;
+    drained_.notify_all();
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+void HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::write(std::vector<Record> & records)
+{
+  std::string chunk;
+  std::vector<std::pair<Record *, Internal::DiskLocation>> placed;
+  for (Record & record : records)
+  {
+    const std::uint32_t size = static_cast<std::uint32_t>(record.bytes_.size());
+    if (active_ == NO_REGION || regions_[active_].used_ + size > regionSize_)
+    {
+      commit(chunk, placed);
+      chunk.clear();
+      if (active_ != NO_REGION)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sealed_.push_back(active_);
+      }
+      active_ = allocate();
+    }
+    placed.emplace_back(&record, Internal::DiskLocation{active_, regions_[active_].used_, size});
+    regions_[active_].used_ += size;
+    chunk += record.bytes_;
+  }
+  commit(chunk, placed);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+void HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::commit(const std::string & chunk, std::vector<std::pair<Record *, Internal::DiskLocation>> & placed)
+{
+  if (placed.empty())
+    return;
+  const Internal::DiskLocation & first = placed.front().second;
+  const bool written = ::pwrite(fd_, chunk.data(), chunk.size(), static_cast<off_t>(first.region_ * regionSize_ + first.offset_)) == static_cast<ssize_t>(chunk.size());
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (written)
+    stats_.bytesWritten_ += chunk.size();
+  for (auto & entry : placed)
+  {
+    Record & record = *entry.first;
+    const Internal::DiskLocation & location = entry.second;
+    if (record.moved_)
+    {
+      // Skip records removed or promoted while they were moved
+      auto it = index_.find(record.key_);
+      if (!written || it == index_.end() || !(it->second == record.from_))
+        continue;
+      regions_[record.from_.region_].live_ -= location.size_;
+      regions_[location.region_].live_     += location.size_;
+      it->second = location;
+      continue;
+    }
+    // Skip demotions promoted, overwritten or demoted again while they were written
+    auto it = pending_.find(record.key_);
+    if (it == pending_.end() || it->second.sequence_ != record.sequence_)
+      continue;
+    pending_.erase(it);
+    if (!written)
+    {
+      ++stats_.dropped_;
+      continue;
+    }
+    index_[record.key_] = location;
+    regions_[location.region_].live_ += location.size_;
+    ++stats_.demotions_;
+  }
+  placed.clear();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+typename HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::IndexT HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::allocate()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!free_.empty())
+  {
+    const IndexT region = free_.front();
+    free_.pop_front();
+    return region;
+  }
+  // The log is full: reclaim its oldest region, dropping the entries in it
+  const IndexT region = sealed_.front();
+  sealed_.pop_front();
+  lock.unlock();
+  const std::string data = read(region);
+  lock.lock();
+  reset(region, data);
+  ++stats_.reclaims_;
+  return region;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+void HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::maintain()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  // Two sealed regions at least: if moving the victim fills the active
+  // region, `allocate` may still reclaim the other one
+  while (!stopping_ && free_.size() < RESERVE_REGIONS && sealed_.size() >= 2)
+  {
+    auto victim = std::min_element(sealed_.begin(), sealed_.end(), [this](IndexT a, IndexT b)
+    {
+      return regions_[a].live_ < regions_[b].live_;
+    });
+    if (2 * regions_[*victim].live_ >= regionSize_)
+      return;
+    const IndexT region = *victim;
+    sealed_.erase(victim);
+    lock.unlock();
+    compact(region);
+    lock.lock();
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+void HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::compact(IndexT region)
+{
+  const std::string data = read(region);
+  std::vector<Record> records;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    scan(region, data, [&](const _KeyT & key, const Internal::DiskLocation & location)
+    {
+      auto it = index_.find(key);
+      if (it != index_.end() && it->second == location)
+        records.push_back(Record{key, data.substr(location.offset_, location.size_), 0, true, location});
+    });
+  }
+  write(records);
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Records that could not be moved are dropped with the region
+  reset(region, data);
+  free_.push_back(region);
+  ++stats_.compactions_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+std::string HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::read(IndexT region) const
+{
+  std::string data(regions_[region].used_, '\0');
+  if (!data.empty() && ::pread(fd_, &data[0], data.size(), static_cast<off_t>(region * regionSize_)) != static_cast<ssize_t>(data.size()))
+    data.clear();
+  return data;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _KeySerializerT, class _ValueSerializerT>
+void HybridCache<_KeyT, _ValueT, _CacheT, _Hash, _KeySerializerT, _ValueSerializerT>::reset(IndexT region, const std::string & data)
+{
+  scan(region, data, [&](const _KeyT & key, const Internal::DiskLocation & location)
+  {
+    auto it = index_.find(key);
+    if (it != index_.end() && it->second == location)
+    {
+      regions_[region].live_ -= location.size_;
+      index_.erase(it);
+      ++stats_.diskEvictions_;
+    }
+  });
+  if (regions_[region].live_ != 0)
+  {
+    // The region could not be read back: drop whatever still points into it
+    for (auto it = index_.begin(); it != index_.end(); )
+    {
+      if (it->second.region_ == region)
+      {
+        it = index_.erase(it);
+        ++stats_.diskEvictions_;
+      }
+      else
+        ++it;
+    }
+  }
+  regions_[region].live_ = 0;
+  regions_[region].used_ = 0;
+  ++regions_[region].generation_;
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // HYBRID_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
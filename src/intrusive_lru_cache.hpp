@@ -0,0 +1,478 @@
+//----------------------------------------------------------------------------
+#ifndef INTRUSIVE_LRU_CACHE_HPP
+#define INTRUSIVE_LRU_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <functional>
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+struct IntrusiveLinks
+{
+//----------------------------------------------------------------------------
+  IntrusiveLinks * prev_; ///< More recently used neighbour.
+  IntrusiveLinks * next_; ///< Less recently used neighbour.
+//----------------------------------------------------------------------------
+  IntrusiveLinks();
+//----------------------------------------------------------------------------
+}; // struct IntrusiveLinks
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT>
+struct IntrusiveNode : IntrusiveLinks
+{
+//----------------------------------------------------------------------------
+  IntrusiveNode * chain_; ///< Next node in the same hash bucket.
+  std::size_t     hash_;  ///< Cached mixed hash of `key_`, used for rehashing and unlinking.
+  _KeyT           key_;
+  _ValueT         value_;
+//----------------------------------------------------------------------------
+  template<class ...Args>
+  IntrusiveNode(std::size_t hash, const _KeyT & key, Args && ...args);
+//----------------------------------------------------------------------------
+}; // struct IntrusiveNode
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief LRU cache with a single-allocation intrusive entry layout.
+ *
+ * Every entry is one heap node that carries the key, the value, the LRU links
+ * and the hash chain link, so the key is stored once and an insertion costs a
+ * single allocation. Promotion, eviction and removal work on the node directly
+ * and never look the key up a second time. Once the cache is full, the node of
+ * the evicted entry is reused for the new one, so steady-state misses do not
+ * touch the allocator at all.
+ *
+ * The API mirrors `LRUCache::Cache`.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+class IntrusiveCache
+{
+//----------------------------------------------------------------------------
+  using SizeType = std::size_t; ///< Type representing the size of the cache.
+  using LinksT   = Internal::IntrusiveLinks; ///< LRU links shared by the nodes and the list head.
+  using NodeT    = Internal::IntrusiveNode<_KeyT, _ValueT>; ///< Type of a cache entry.
+//----------------------------------------------------------------------------
+public:
+  /**
+   * @brief Default constructor for the IntrusiveCache class.
+   *
+   * Initializes an empty cache with the default capacity.
+   */
+  IntrusiveCache();
+  /**
+   * @brief Constructs an IntrusiveCache with a specified capacity.
+   *
+   * @param capacity The maximum number of items that the cache can hold.
+   * @param hash The hash function used for keys.
+   * @param keyEqual The key equality predicate.
+   */
+  IntrusiveCache(SizeType capacity, const _Hash & hash = _Hash(), const _KeyEqual & keyEqual = _KeyEqual());
+  IntrusiveCache(const IntrusiveCache &) = delete;
+  IntrusiveCache & operator =(const IntrusiveCache &) = delete;
+  ~IntrusiveCache();
+  /**
+   * @brief Retrieves the current capacity of the cache.
+   *
+   * @return The maximum number of items that the cache can hold.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the current number of items in the cache.
+   *
+   * @return The number of items currently stored in the cache.
+   */
+  SizeType size() const;
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * If the cache is full, the least recently used entry is evicted and its node
+   * is reused for the new entry.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * This overload accepts an rvalue reference for the value, allowing for efficient
+   * moves of temporary objects into the cache.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, _ValueT && value);
+  /**
+   * @brief Constructs and inserts a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be constructed and inserted or updated.
+   * @param args The arguments used to construct the value.
+   */
+  template<class ...Args>
+  void emplace(const _KeyT & key, Args && ...args);
+  /**
+   * @brief Removes the value associated with the specified key from the cache.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears all items from the cache.
+   */
+  void clear();
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key
+   *        and marks it as recently used.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache.
+   */
+  _ValueT * get(const _KeyT & key);
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache.
+   * @note Does not update position of the associated value
+   */
+  const _ValueT * get(const _KeyT & key) const;
+  /**
+   * @brief Checks if the cache contains a value associated with the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not update position of the associated value
+   */
+  bool contains(const _KeyT & key) const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Hashes a key and mixes the bits, since the bucket is picked by
+   *        masking the low bits.
+   */
+  std::size_t hashOf(const _KeyT & key) const;
+  /**
+   * @brief Returns the address of the bucket slot that points to the node with
+   *        the specified key, or of the empty slot at the end of its chain.
+   */
+  NodeT * const * find(std::size_t hash, const _KeyT & key) const;
+  /**
+   * @brief Inserts a new entry, reusing the least recently used node if the
+   *        cache is full.
+   */
+  template<class ...Args>
+  void insert(std::size_t hash, const _KeyT & key, Args && ...args);
+  /**
+   * @brief Unlinks the node from its hash bucket chain.
+   */
+  void unchain(NodeT * node);
+  /**
+   * @brief Grows the bucket array so the load factor stays below one.
+   */
+  void rehash(SizeType bucketCount);
+//----------------------------------------------------------------------------
+  static void unlink(LinksT * links);
+  void        linkFront(LinksT * links);
+  void        toFront(LinksT * links);
+//----------------------------------------------------------------------------
+  SizeType             capacity_; ///< The maximum number of items that the cache can hold.
+  SizeType             size_; ///< The number of items currently stored in the cache.
+  LinksT               head_; ///< Sentinel of the circular LRU list: next_ is the most recently used entry.
+  std::vector<NodeT *> buckets_; ///< Hash buckets, the size is always zero or a power of two.
+  _Hash                hash_; ///< The hash function used for keys.
+  _KeyEqual            keyEqual_; ///< The key equality predicate.
+//----------------------------------------------------------------------------
+}; // class IntrusiveCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+inline IntrusiveLinks::IntrusiveLinks() :
+  prev_(this),
+  next_(this)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT>
+template<class ...Args>
+IntrusiveNode<_KeyT, _ValueT>::IntrusiveNode(std::size_t hash, const _KeyT & key, Args && ...args) :
+  chain_(nullptr),
+  hash_(hash),
+  key_(key),
+  value_(std::forward<Args>(args)...)
+{
+}
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::IntrusiveCache() :
+  capacity_(0),
+  size_(0)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::IntrusiveCache(SizeType capacity, const _Hash & hash, const _KeyEqual & keyEqual) :
+  capacity_(capacity),
+  size_(0),
+  hash_(hash),
+  keyEqual_(keyEqual)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::~IntrusiveCache()
+{
+  clear();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::capacity() const
+{
+  return capacity_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::size() const
+{
+  return size_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, const _ValueT & value)
+{
+  const std::size_t hash = hashOf(key);
+  NodeT * node = *find(hash, key);
+  if (node == nullptr)
+  {
+    insert(hash, key, value);
+    return;
+  }
+  node->value_ = value;
+  toFront(node);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, _ValueT && value)
+{
+  const std::size_t hash = hashOf(key);
+  NodeT * node = *find(hash, key);
+  if (node == nullptr)
+  {
+    insert(hash, key, std::forward<_ValueT>(value));
+    return;
+  }
+  node->value_ = std::forward<_ValueT>(value);
+  toFront(node);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::emplace(const _KeyT & key, Args && ...args)
+{
+  const std::size_t hash = hashOf(key);
+  NodeT * node = *find(hash, key);
+  if (node == nullptr)
+  {
+    insert(hash, key, std::forward<Args>(args)...);
+    return;
+  }
+  node->value_ = _ValueT(std::forward<Args>(args)...);
+  toFront(node);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::remove(const _KeyT & key)
+{
+  NodeT ** slot = const_cast<NodeT **>(find(hashOf(key), key));
+  NodeT *  node = *slot;
+  if (node == nullptr)
+    return false;
+  *slot = node->chain_;
+  unlink(node);
+  delete node;
+  --size_;
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::clear()
+{
+  LinksT * cur = head_.next_;
+  while (cur != &head_)
+  {
+    LinksT * next = cur->next_;
+    delete static_cast<NodeT *>(cur);
+    cur = next;
+  }
+  head_.prev_ = &head_;
+  head_.next_ = &head_;
+  std::fill(buckets_.begin(), buckets_.end(), nullptr);
+  size_ = 0;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+_ValueT * IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key)
+{
+  NodeT * node = *find(hashOf(key), key);
+  if (node == nullptr)
+    return nullptr;
+  toFront(node);
+  return &(node->value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+const _ValueT * IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key) const
+{
+  const NodeT * node = *find(hashOf(key), key);
+  if (node == nullptr)
+    return nullptr;
+  return &(node->value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::contains(const _KeyT & key) const
+{
+  return *find(hashOf(key), key) != nullptr;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+std::size_t IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::hashOf(const _KeyT & key) const
+{
+  // NOTE: std::hash is the identity for integers, so keys with a common
+  // stride would share their low bits and a few chains without mixing
+  std::uint64_t hash = static_cast<std::uint64_t>(hash_(key));
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDull;
+  hash ^= hash >> 33;
+  return static_cast<std::size_t>(hash);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::NodeT * const * IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::find(std::size_t hash, const _KeyT & key) const
+{
+  static NodeT * const empty = nullptr;
+  if (buckets_.empty())
+    return &empty;
+  NodeT * const * slot = &buckets_[hash & (buckets_.size() - 1)];
+  while (*slot != nullptr && ((*slot)->hash_ != hash || !keyEqual_((*slot)->key_, key)))
+    slot = &((*slot)->chain_);
+  return slot;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::insert(std::size_t hash, const _KeyT & key, Args && ...args)
+{
+  if (capacity_ == 0)
+    return;
+  NodeT * node = nullptr;
+  if (size_ == capacity_)
+  {
+    node = static_cast<NodeT *>(head_.prev_);
+    unchain(node);
+    unlink(node);
+    try
+    {
+      node->key_   = key;
+      node->value_ = _ValueT(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      delete node;
+      --size_;
+      throw;
+    }
+    node->hash_ = hash;
+  }
+  else
+  {
+    if (size_ >= buckets_.size())
+      rehash(buckets_.empty() ? 16 : buckets_.size() * 2);
+    node = new NodeT(hash, key, std::forward<Args>(args)...);
+    ++size_;
+  }
+  NodeT *& bucket = buckets_[hash & (buckets_.size() - 1)];
+  node->chain_ = bucket;
+  bucket       = node;
+  linkFront(node);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::unchain(NodeT * node)
+{
+  NodeT ** slot = &buckets_[node->hash_ & (buckets_.size() - 1)];
+  while (*slot != node)
+    slot = &((*slot)->chain_);
+  *slot = node->chain_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::rehash(SizeType bucketCount)
+{
+  std::vector<NodeT *> buckets(bucketCount, nullptr);
+  for (LinksT * cur = head_.next_; cur != &head_; cur = cur->next_)
+  {
+    NodeT *  node   = static_cast<NodeT *>(cur);
+    NodeT *& bucket = buckets[node->hash_ & (bucketCount - 1)];
+    node->chain_ = bucket;
+    bucket       = node;
+  }
+  buckets_.swap(buckets);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::unlink(LinksT * links)
+{
+  links->prev_->next_ = links->next_;
+  links->next_->prev_ = links->prev_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::linkFront(LinksT * links)
+{
+  links->prev_        = &head_;
+  links->next_        = head_.next_;
+  head_.next_->prev_  = links;
+  head_.next_         = links;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void IntrusiveCache<_KeyT, _ValueT, _Hash, _KeyEqual>::toFront(LinksT * links)
+{
+  if (head_.next_ == links)
+    return;
+  unlink(links);
+  linkFront(links);
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // INTRUSIVE_LRU_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
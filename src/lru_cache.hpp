@@ -4,7 +4,27 @@
 //----------------------------------------------------------------------------
 #include <map>
 #include <list>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <utility>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#if __cplusplus >= 201703L
+#include <string_view>
+#include <memory_resource>
+#endif
+#if __cplusplus >= 202002L
+#include <span>
+#endif
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
@@ -31,27 +51,484 @@ struct MapValue
 template<class _KeyT, class _Alloc = std::allocator<_KeyT>>
 using ListT = std::list<_KeyT, _Alloc>;
 //----------------------------------------------------------------------------
+/**
+ * @brief List element of `LfuPolicy`: the key and its access count.
+ */
+template<class _KeyT>
+struct LfuEntry
+{
+//----------------------------------------------------------------------------
+  _KeyT       key_;
+  std::size_t count_;
+//----------------------------------------------------------------------------
+  explicit LfuEntry(_KeyT && key);
+//----------------------------------------------------------------------------
+}; // struct LfuEntry
+//----------------------------------------------------------------------------
+/**
+ * @brief Key of a list element, for lists of plain keys and of `LfuEntry`.
+ */
+template<class _KeyT>
+const _KeyT & listKey(const _KeyT & entry);
+//----------------------------------------------------------------------------
+template<class _KeyT>
+const _KeyT & listKey(const LfuEntry<_KeyT> & entry);
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+using HashMapT = std::unordered_map<_KeyT, MapValue<_ListT, _ValueT>, _Hash, _KeyEqual>;
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _Compare = std::less<_KeyT>>
+using TreeMapT = std::map<_KeyT, MapValue<_ListT, _ValueT>, _Compare>;
+//----------------------------------------------------------------------------
 template<class _KeyT, class _ValueT, class _ListT>
-using MapT = std::map<_KeyT, MapValue<ListT<_KeyT>, _ValueT>>;
+using MapT = HashMapT<_KeyT, _ValueT, _ListT>;
+//----------------------------------------------------------------------------
+#if __cplusplus >= 201703L
+/**
+ * @brief Hash map whose nodes and buckets come from a `std::pmr` memory
+ *        resource, the one given to the allocator constructors of `Cache`.
+ */
+template<class _KeyT, class _ValueT, class _ListT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+using PmrHashMapT = std::pmr::unordered_map<_KeyT, MapValue<_ListT, _ValueT>, _Hash, _KeyEqual>;
+#endif
+//----------------------------------------------------------------------------
+template<class ...>
+struct MakeVoid
+{
+  using type = void;
+};
+//----------------------------------------------------------------------------
+/**
+ * @brief Tells whether `_MapT::find` accepts keys of any type comparable with
+ *        its key type: ordered maps need a transparent comparator, unordered
+ *        maps need a transparent hasher and key equality (and C++20).
+ */
+template<class _MapT, class = void>
+struct IsTransparentMap : std::false_type
+{
+};
+//----------------------------------------------------------------------------
+template<class _MapT>
+struct IsTransparentMap<_MapT, typename MakeVoid<typename _MapT::key_compare::is_transparent>::type> : std::true_type
+{
+};
+//----------------------------------------------------------------------------
+#if defined(__cpp_lib_generic_unordered_lookup)
+template<class _MapT>
+struct IsTransparentMap<_MapT, typename MakeVoid<typename _MapT::hasher::is_transparent, typename _MapT::key_equal::is_transparent>::type> : std::true_type
+{
+};
+#endif
+//----------------------------------------------------------------------------
+/**
+ * @brief Resolves to `_ResultT` only for lookup keys of a type other than
+ *        `_KeyT` and only if the map supports heterogeneous lookup.
+ */
+template<class _MapT, class _KeyT, class _K, class _ResultT>
+using EnableIfTransparentT = typename std::enable_if<IsTransparentMap<_MapT>::value && !std::is_same<typename std::decay<_K>::type, _KeyT>::value, _ResultT>::type;
+//----------------------------------------------------------------------------
+/**
+ * @brief Hints the CPU to fetch the cache line at `address` for writing.
+ *        Does nothing on compilers without a prefetch builtin.
+ */
+inline void prefetch(const void * address);
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Why an entry left a cache, as passed to a removal listener.
+ */
+enum class RemovalCause : std::uint8_t
+{
+  SIZE,     ///< Evicted to make room, or heavier than the whole capacity.
+  EXPIRED,  ///< Its time-to-live passed.
+  EXPLICIT, ///< Removed by `remove` or `clear`.
+  REPLACED  ///< Its value was overwritten by `put` or `emplace`.
+};
+//----------------------------------------------------------------------------
+/**
+ * @brief Callback told about every entry that leaves a cache. It receives the
+ *        key, the value moved out of the cache and the cause.
+ */
+template<class _KeyT, class _ValueT>
+using RemovalListener = std::function<void(_KeyT &&, _ValueT &&, RemovalCause)>;
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+/**
+ * @brief Removed entry waiting to be passed to the listener.
+ */
+template<class _KeyT, class _ValueT>
+struct Removal
+{
+//----------------------------------------------------------------------------
+  _KeyT        key_;
+  _ValueT      value_;
+  RemovalCause cause_;
+//----------------------------------------------------------------------------
+  Removal(const _KeyT & key, _ValueT && value, RemovalCause cause);
+//----------------------------------------------------------------------------
+}; // struct Removal
+//----------------------------------------------------------------------------
+/**
+ * @brief Passes queued removals to a listener, emptying the queue first so
+ *        that the listener may call back into the cache. The queue keeps its
+ *        storage for the next batch.
+ */
+template<class _KeyT, class _ValueT>
+void notifyRemovals(std::vector<Removal<_KeyT, _ValueT>> & removed, const RemovalListener<_KeyT, _ValueT> & listener);
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Encodes keys or values of type `_T` for `Cache::save` and decodes
+ *        them for `Cache::load`.
+ *
+ * Defined for trivially copyable types (their bytes, in native byte order)
+ * and `std::string` (a 64-bit length, then the characters). Specialize it,
+ * or pass an object with the same two members to `save` and `load`, for
+ * other types.
+ */
+template<class _T, class = void>
+struct Serializer;
+//----------------------------------------------------------------------------
+template<class _T>
+struct Serializer<_T, typename std::enable_if<std::is_trivially_copyable<_T>::value>::type>
+{
+//----------------------------------------------------------------------------
+  /**
+   * @brief Appends the encoding of `value` to `out`.
+   */
+  void write(std::string & out, const _T & value) const;
+  /**
+   * @brief Decodes a value from `[data, end)` and advances `data` past it.
+   *
+   * @return False if the input is too short or malformed.
+   */
+  bool read(const char *& data, const char * end, _T & value) const;
+//----------------------------------------------------------------------------
+}; // struct Serializer
+//----------------------------------------------------------------------------
+template<>
+struct Serializer<std::string>
+{
+//----------------------------------------------------------------------------
+  void write(std::string & out, const std::string & value) const;
+  bool read(const char *& data, const char * end, std::string & value) const;
+//----------------------------------------------------------------------------
+}; // struct Serializer
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+static constexpr std::uint32_t SNAPSHOT_MAGIC   = 0x4355524C; ///< "LRUC" in little-endian byte order.
+static constexpr std::uint32_t SNAPSHOT_VERSION = 1;          ///< Bumped on every change of the format.
+//----------------------------------------------------------------------------
+/**
+ * @brief Continues a CRC-32 (IEEE 802.3) over `size` more bytes.
+ */
+inline std::uint32_t crc32(std::uint32_t crc, const char * data, std::size_t size);
+//----------------------------------------------------------------------------
+/**
+ * @brief Buffered writer of a snapshot file. Serializers append to `buffer`;
+ *        the bytes are checksummed as they are flushed, and `finish` appends
+ *        the checksum. The file is written next to `path` and only renamed
+ *        to it once complete, so a failed save keeps the previous snapshot.
+ */
+class SnapshotWriter
+{
+//----------------------------------------------------------------------------
+public:
+//----------------------------------------------------------------------------
+  explicit SnapshotWriter(const std::string & path);
+  SnapshotWriter(const SnapshotWriter &) = delete;
+  SnapshotWriter & operator =(const SnapshotWriter &) = delete;
+  ~SnapshotWriter();
+//----------------------------------------------------------------------------
+  bool          is_open() const;
+  std::string & buffer();
+  /**
+   * @brief Writes the buffer out once it holds at least `FLUSH_SIZE` bytes.
+   */
+  void flush_if_full();
+  /**
+   * @brief Appends the checksum, closes the file and moves it to `path`.
+   *
+   * @return True if every write succeeded.
+   */
+  bool finish();
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  static constexpr std::size_t FLUSH_SIZE = 1 << 16;
+//----------------------------------------------------------------------------
+  void flush();
+//----------------------------------------------------------------------------
+  std::string   path_;   ///< Final name of the snapshot.
+  std::string   temp_;   ///< Name of the file being written.
+  std::FILE *   file_;
+  std::string   buffer_; ///< Bytes not written yet.
+  std::uint32_t crc_;    ///< Checksum of the bytes written so far.
+  bool          ok_;     ///< False once a write failed.
+//----------------------------------------------------------------------------
+}; // class SnapshotWriter
+//----------------------------------------------------------------------------
+/**
+ * @brief Reads a whole snapshot file and checks its header and checksum.
+ *
+ * @param data Receives the contents of the file.
+ * @param count Receives the number of entries.
+ * @return The position of the first entry in `data`, or `nullptr` if the
+ *         file cannot be read, is not a snapshot of this version, or is corrupt.
+ */
+inline const char * readSnapshot(const std::string & path, std::string & data, std::uint64_t & count);
+//----------------------------------------------------------------------------
+/**
+ * @brief Reserves room for `count` entries in maps that support it.
+ */
+template<class _MapT>
+auto reserveMap(_MapT & map, std::size_t count, int) -> decltype(map.reserve(count), void());
+//----------------------------------------------------------------------------
+template<class _MapT>
+void reserveMap(_MapT & map, std::size_t count, long);
+//----------------------------------------------------------------------------
+/**
+ * @brief Constructs a map that allocates with `alloc` if its allocator can be
+ *        made from it, and a default map otherwise.
+ */
+template<class _MapT, class _AllocT>
+auto makeMap(const _AllocT & alloc, int) -> decltype(_MapT(typename _MapT::allocator_type(alloc)));
+//----------------------------------------------------------------------------
+template<class _MapT, class _AllocT>
+_MapT makeMap(const _AllocT & alloc, long);
 //----------------------------------------------------------------------------
 } // namespace Internal
 //----------------------------------------------------------------------------
+/**
+ * @brief Default weigher of `Cache`: every entry weighs 1, so the maximum
+ *        weight of the cache is its maximum number of entries.
+ */
+struct UnitWeigher
+{
+//----------------------------------------------------------------------------
+  template<class _KeyT, class _ValueT>
+  std::size_t operator ()(const _KeyT & key, const _ValueT & value) const noexcept;
+//----------------------------------------------------------------------------
+}; // struct UnitWeigher
+//----------------------------------------------------------------------------
+/**
+ * @brief Snapshot of the counters of a cache. All fields are zero if the
+ *        cache does not collect statistics.
+ */
+struct CacheStats
+{
+//----------------------------------------------------------------------------
+  std::uint64_t hits_;          ///< Number of lookups that found the key.
+  std::uint64_t misses_;        ///< Number of lookups that did not find the key.
+  std::uint64_t inserts_;       ///< Number of new entries.
+  std::uint64_t updates_;       ///< Number of values replaced by `put` or `emplace`.
+  std::uint64_t evictions_;     ///< Number of entries evicted to make room.
+  std::uint64_t removals_;      ///< Number of entries removed by `remove`.
+  std::uint64_t loadSuccesses_; ///< Number of loader calls that returned a value.
+  std::uint64_t loadFailures_;  ///< Number of loader calls that threw.
+  std::uint64_t loadTime_;      ///< Total time spent in loader calls, in nanoseconds.
+//----------------------------------------------------------------------------
+  /**
+   * @brief Fraction of the lookups that were hits, 0 if there were none.
+   */
+  double hit_ratio() const;
+  /**
+   * @brief Adds the counters of another snapshot, e.g. of another shard.
+   */
+  CacheStats & operator +=(const CacheStats & other);
+//----------------------------------------------------------------------------
+}; // struct CacheStats
+//----------------------------------------------------------------------------
+/**
+ * @brief Default statistics policy of `Cache`: collects nothing. Every call
+ *        is an empty inline function, and the member takes no space in C++20.
+ */
+struct NoStats
+{
+//----------------------------------------------------------------------------
+  static constexpr bool enabled = false;
+//----------------------------------------------------------------------------
+  void record_hit() {}
+  void record_miss() {}
+  void record_insert() {}
+  void record_update() {}
+  void record_eviction(std::uint64_t = 1) {}
+  void record_removal() {}
+  void record_load_success(std::chrono::nanoseconds) {}
+  void record_load_failure(std::chrono::nanoseconds) {}
+  CacheStats snapshot() const;
+//----------------------------------------------------------------------------
+}; // struct NoStats
+//----------------------------------------------------------------------------
+/**
+ * @brief Statistics policy that counts every operation.
+ *
+ * Counters are relaxed atomics updated with a plain load and store instead of
+ * a read-modify-write, so recording costs no more than a non-atomic increment.
+ * This requires a single writer at a time, which is the case for `Cache`
+ * (not thread-safe) and for the shards of `ShardedCache` (updated under the
+ * shard lock): each shard has its own counters, so threads never contend on
+ * them. `snapshot` may be called from any thread, and is consistent if taken
+ * under the lock that serializes the writers.
+ */
+class AtomicStats
+{
+//----------------------------------------------------------------------------
+public:
+//----------------------------------------------------------------------------
+  static constexpr bool enabled = true;
+//----------------------------------------------------------------------------
+  AtomicStats();
+  AtomicStats(const AtomicStats & other);
+  AtomicStats & operator =(const AtomicStats & other);
+//----------------------------------------------------------------------------
+  void record_hit();
+  void record_miss();
+  void record_insert();
+  void record_update();
+  void record_eviction(std::uint64_t count = 1);
+  void record_removal();
+  void record_load_success(std::chrono::nanoseconds time);
+  void record_load_failure(std::chrono::nanoseconds time);
+  CacheStats snapshot() const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  enum Counter { HITS, MISSES, INSERTS, UPDATES, EVICTIONS, REMOVALS, LOAD_SUCCESSES, LOAD_FAILURES, LOAD_TIME, COUNTERS };
+//----------------------------------------------------------------------------
+  void add(Counter counter, std::uint64_t count);
+//----------------------------------------------------------------------------
+  std::atomic<std::uint64_t> counters_[COUNTERS];
+//----------------------------------------------------------------------------
+}; // class AtomicStats
+//----------------------------------------------------------------------------
+/**
+ * @brief Default eviction policy of `Cache`: least recently used.
+ *
+ * An eviction policy is a class template over the list type of the cache.
+ * The cache pushes a new key to the front of the list and then calls the
+ * hooks below; a policy orders the list by splicing its nodes and never
+ * inserts or erases them itself. All calls are resolved at compile time.
+ *
+ * @tparam _ListT The list type of the cache.
+ */
+template<class _ListT>
+class LruPolicy
+{
+//----------------------------------------------------------------------------
+  using IteratorT = typename _ListT::iterator;
+//----------------------------------------------------------------------------
+public:
+  /**
+   * @brief Called after a new entry was pushed to the front of the list.
+   */
+  void on_insert(_ListT & list, IteratorT it);
+  /**
+   * @brief Called when an entry is read by `get` or overwritten by `put`.
+   */
+  void on_access(_ListT & list, IteratorT it);
+  /**
+   * @brief Called before an entry is erased from the list, by eviction or by `remove`.
+   */
+  void on_remove(_ListT & list, IteratorT it);
+  /**
+   * @brief Chooses the entry to evict. Only called on a non-empty list.
+   */
+  IteratorT select_victim(_ListT & list);
+//----------------------------------------------------------------------------
+}; // class LruPolicy
+//----------------------------------------------------------------------------
+/**
+ * @brief First in, first out: hits do not touch the list, and the oldest
+ *        insertion is evicted.
+ *
+ * @tparam _ListT The list type of the cache.
+ */
+template<class _ListT>
+class FifoPolicy
+{
+//----------------------------------------------------------------------------
+  using IteratorT = typename _ListT::iterator;
+//----------------------------------------------------------------------------
+public:
+  void on_insert(_ListT & list, IteratorT it);
+  void on_access(_ListT & list, IteratorT it);
+  void on_remove(_ListT & list, IteratorT it);
+  IteratorT select_victim(_ListT & list);
+//----------------------------------------------------------------------------
+}; // class FifoPolicy
+//----------------------------------------------------------------------------
+/**
+ * @brief Least frequently used, in O(1) per operation.
+ *
+ * The list holds `Internal::LfuEntry` elements sorted by access count, highest
+ * first, so that entries with equal counts form runs. The policy remembers the
+ * front of every run: a hit moves the entry to the front of its run, which is
+ * where the run of the next count ends. Ties are evicted in the order in which
+ * the entries reached their count. See `LfuCache`.
+ *
+ * @tparam _ListT The list type of the cache, with `Internal::LfuEntry` elements.
+ */
+template<class _ListT>
+class LfuPolicy
+{
+//----------------------------------------------------------------------------
+  using IteratorT = typename _ListT::iterator;
+//----------------------------------------------------------------------------
+public:
+  void on_insert(_ListT & list, IteratorT it);
+  void on_access(_ListT & list, IteratorT it);
+  void on_remove(_ListT & list, IteratorT it);
+  IteratorT select_victim(_ListT & list);
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Moves the front of the run of an entry past it, if it is there.
+   */
+  void leave(_ListT & list, IteratorT it);
+//----------------------------------------------------------------------------
+  std::unordered_map<std::size_t, IteratorT> heads_; ///< Access count to the front of its run.
+//----------------------------------------------------------------------------
+}; // class LfuPolicy
+//----------------------------------------------------------------------------
 /**
  * @brief LRU cache implementation.
  *
  * This class provides a cache that stores key-value pairs with a specified
  * capacity. When the cache exceeds its capacity, the least recently used items
  * are evicted to make room for new entries. The cache uses a list to maintain
- * the order of items and a map for fast key-value lookups.
+ * the order of items and a hash map for fast key-value lookups. See `HashCache`
+ * and `TreeCache` for the hash-indexed and tree-indexed configurations, and
+ * `FifoCache` and `LfuCache` for other eviction policies.
  *
  * @tparam _KeyT The type of keys used in the cache.
  * @tparam _ValueT The type of values associated with the keys in the cache.
  * @tparam _ListT The type of the list used to maintain the order of items.
- *                 Defaults to `::LRUCache::Internal::ListT<_KeyT>`.
+ *                 Defaults to `::LRUCache::Internal::ListT<_KeyT>`, a `std::list`.
+ *                 `::LRUCache::CircularDoublyLinkedList` takes its nodes from a
+ *                 `std::pmr` memory resource, see the allocator constructors.
  * @tparam _MapT The type of the map used for fast key-value lookups.
- *                Defaults to `::LRUCache::Internal::MapT<_KeyT, _ValueT, _ListT>`.
+ *                Defaults to `::LRUCache::Internal::MapT<_KeyT, _ValueT, _ListT>`,
+ *                which is a `std::unordered_map`.
+ * @tparam _WeigherT Functor `std::size_t(const _KeyT &, const _ValueT &)` giving
+ *                   the weight of an entry (e.g. its size in bytes). Items are
+ *                   evicted until the total weight fits into the capacity.
+ *                   Defaults to `::LRUCache::UnitWeigher`, which counts entries.
+ *                   The weight of a stored value must not change while it is in
+ *                   the cache: `put` a new value instead of mutating it in place.
+ * @tparam _PolicyT Eviction policy, a class template over `_ListT` with the
+ *                  hooks of `LruPolicy`. Defaults to `::LRUCache::LruPolicy`.
+ * @tparam _StatsT Statistics policy, `::LRUCache::NoStats` (the default) or
+ *                 `::LRUCache::AtomicStats`. See `stats`.
  */
-template<class _KeyT, class _ValueT, class _ListT = ::LRUCache::Internal::ListT<_KeyT>, class _MapT = ::LRUCache::Internal::MapT<_KeyT, _ValueT, _ListT>>
+template<class _KeyT, class _ValueT, class _ListT = ::LRUCache::Internal::ListT<_KeyT>, class _MapT = ::LRUCache::Internal::MapT<_KeyT, _ValueT, _ListT>, class _WeigherT = ::LRUCache::UnitWeigher, template<class> class _PolicyT = ::LRUCache::LruPolicy, class _StatsT = ::LRUCache::NoStats>
 class Cache
 {
 //----------------------------------------------------------------------------
@@ -69,27 +546,131 @@ public:
     /**
    * @brief Constructs a Cache with a specified capacity.
    *
-   * @param capacity The maximum number of items that the cache can hold.
+   * @param capacity The maximum number of items that the cache can hold, or
+   *                 the maximum total weight if a weigher is used.
    */
   Cache(SizeType capacity);
+  /**
+   * @brief Constructs a Cache that bounds the total weight of its entries.
+   *
+   * @param maxWeight The maximum total weight of the entries in the cache.
+   * @param weigher The functor used to weigh entries.
+   */
+  Cache(SizeType maxWeight, const _WeigherT & weigher);
+  /**
+   * @brief Constructs a Cache whose list and map allocate with `alloc`.
+   *
+   * With `LRUCache::CircularDoublyLinkedList` as `_ListT`, a pointer to a
+   * `std::pmr::memory_resource` converts to the allocator, for example a
+   * pool that recycles the nodes of evicted entries. The map allocates from
+   * it too if its allocator can be made from `alloc`, as with
+   * `Internal::PmrHashMapT`; other maps use their default allocator.
+   *
+   * @param capacity The maximum number of items that the cache can hold, or
+   *                 the maximum total weight if a weigher is used.
+   * @param alloc The allocator of the list, and of the map if it converts.
+   */
+  Cache(SizeType capacity, const typename _ListT::allocator_type & alloc);
+  /**
+   * @brief Constructs a Cache that bounds the total weight of its entries and
+   *        whose list and map allocate with `alloc`.
+   *
+   * @param maxWeight The maximum total weight of the entries in the cache.
+   * @param weigher The functor used to weigh entries.
+   * @param alloc The allocator of the list, and of the map if it converts.
+   */
+  Cache(SizeType maxWeight, const _WeigherT & weigher, const typename _ListT::allocator_type & alloc);
   /**
    * @brief Retrieves the current capacity of the cache.
    *
-   * @return The maximum number of items that the cache can hold.
+   * @return The maximum number of items that the cache can hold, or the
+   *         maximum total weight if a weigher is used.
    */
   SizeType capacity() const;
+  /**
+   * @brief Retrieves the maximum total weight of the entries. Same as `capacity`.
+   *
+   * @return The maximum total weight of the entries in the cache.
+   */
+  SizeType max_weight() const;
   /**
    * @brief Retrieves the current number of items in the cache.
    *
    * @return The number of items currently stored in the cache.
    */
   SizeType size() const;
+  /**
+   * @brief Retrieves the current total weight of the entries in the cache.
+   *
+   * @return The sum of the weights of the stored entries, equal to `size` for
+   *         the default `UnitWeigher`.
+   */
+  SizeType weight() const;
+  /**
+   * @brief Retrieves a snapshot of the statistics of the cache.
+   *
+   * Lookups through the non-const `get` and `multi_get` count as hits or misses.
+   *
+   * @return The counters of the cache, all zero unless `_StatsT` collects them.
+   */
+  CacheStats stats() const;
+  /**
+   * @brief Sets the function told about every entry that leaves the cache:
+   *        evicted, removed, cleared or overwritten.
+   *
+   * Removed entries are queued while the cache is being modified, and the
+   * listener is called once the call that removed them has finished updating
+   * the cache, so it sees a consistent cache and may call back into it. The
+   * value is moved out of the cache, so its destructor runs in the listener
+   * (or wherever the listener moves it) rather than in the middle of `put`.
+   * Without a listener, removed values are destroyed in place as before.
+   *
+   * @param listener The callback, or an empty function to remove it.
+   */
+  void set_removal_listener(RemovalListener<_KeyT, _ValueT> listener);
+  /**
+   * @brief Writes the entries to a snapshot file, from the least to the most
+   *        recently used (in the order of the eviction policy).
+   *
+   * The file is a versioned binary format with a CRC-32 of its contents.
+   * It is written under a temporary name and renamed when complete, so a
+   * failed or interrupted save keeps the previous file.
+   *
+   * @param path The snapshot file.
+   * @param keySerializer Encodes the keys, see `Serializer`.
+   * @param valueSerializer Encodes the values, see `Serializer`.
+   * @return True if the snapshot was written.
+   */
+  template<class _KeySerializerT = Serializer<_KeyT>, class _ValueSerializerT = Serializer<_ValueT>>
+  bool save(const std::string & path, const _KeySerializerT & keySerializer = _KeySerializerT(), const _ValueSerializerT & valueSerializer = _ValueSerializerT()) const;
+  /**
+   * @brief Replaces the contents of the cache with the entries of a snapshot
+   *        written by `save`.
+   *
+   * The file is read at once and checked before the cache is touched, so a
+   * missing, corrupt or incompatible file leaves the cache unchanged. The
+   * index is sized for all entries up front, and the entries are inserted in
+   * a single pass, oldest first, so the most recently used ones survive if
+   * the capacity is smaller than the snapshot. Policy metadata, such as LFU
+   * counts, is not saved. Requires default-constructible keys and values.
+   *
+   * @param path The snapshot file.
+   * @param keySerializer Decodes the keys, see `Serializer`.
+   * @param valueSerializer Decodes the values, see `Serializer`.
+   * @return True if the snapshot was loaded. If an entry cannot be decoded,
+   *         the cache is left empty and false is returned.
+   */
+  template<class _KeySerializerT = Serializer<_KeyT>, class _ValueSerializerT = Serializer<_ValueT>>
+  bool load(const std::string & path, const _KeySerializerT & keySerializer = _KeySerializerT(), const _ValueSerializerT & valueSerializer = _ValueSerializerT());
   /**
    * @brief Inserts or updates a value in the cache associated with the specified key.
    *
    * This function adds a new key-value pair to the cache. If the key already exists,
-   * the associated value is updated. If the cache exceeds its capacity after the
-   * insertion, the least recently used item is evicted.
+   * the associated value is updated. If the new entry does not fit, the victims
+   * of the eviction policy (the least recently used items by default) are
+   * evicted until it does.
+   * An entry heavier than the whole capacity is not stored, and an older value
+   * of the same key is removed.
    *
    * @param key The key associated with the value to be inserted or updated.
    * @param value The value to be associated with the specified key.
@@ -105,6 +686,26 @@ public:
    * @param value The value to be associated with the specified key.
    */
   void put(const _KeyT & key, _ValueT && value);
+  /**
+   * @brief Inserts or updates a value using a key of any type that the map can
+   *        compare with `_KeyT` (e.g. `std::string_view` for `std::string` keys).
+   *
+   * The owned `_KeyT` is only constructed if the key is not in the cache yet.
+   * Available if `_MapT` supports heterogeneous lookup, see `StringCache`.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  template<class _K>
+  Internal::EnableIfTransparentT<_MapT, _KeyT, _K, void> put(const _K & key, const _ValueT & value);
+  /**
+   * @brief Heterogeneous-key overload of put that moves the value into the cache.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  template<class _K>
+  Internal::EnableIfTransparentT<_MapT, _KeyT, _K, void> put(const _K & key, _ValueT && value);
   /**
    * @brief Constructs and inserts a value in the cache associated with the specified key.
    *
@@ -118,7 +719,7 @@ public:
    *             that is compatible with the constructor of `_ValueT`.
    */
   template<class ...Args>
-  void emplace(const _KeyT & key, Args && ...args) noexcept;
+  void emplace(const _KeyT & key, Args && ...args);
   /**
    * @brief Removes the value associated with the specified key from the cache.
    *
@@ -128,6 +729,14 @@ public:
    * @return True if the key was found and removed, false otherwise.
    */
   bool remove(const _KeyT & key);
+  /**
+   * @brief Heterogeneous-key overload of remove. Does not construct a `_KeyT`.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  template<class _K>
+  Internal::EnableIfTransparentT<_MapT, _KeyT, _K, bool> remove(const _K & key);
   /**
    * @brief Clears all items from the cache.
    *
@@ -146,34 +755,211 @@ public:
    *         if the key is not found in the cache.
    */
   _ValueT * get(const _KeyT & key);
+  /**
+   * @brief Heterogeneous-key overload of get. Does not construct a `_KeyT`.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value associated with the specified key, or nullptr
+   *         if the key is not found in the cache.
+   */
+  template<class _K>
+  Internal::EnableIfTransparentT<_MapT, _KeyT, _K, _ValueT *> get(const _K & key);
   /**
    * @brief Retrieves a pointer to the value associated with the specified key.
    *
    * This const-qualified version of the function can be called on const instances
-   * of the Cache. It behaves the same as the non-const version.
+   * of the Cache.
    *
    * @param key The key associated with the value to be retrieved.
    * @return A pointer to the value associated with the specified key, or nullptr
    *         if the key is not found in the cache.
+   * @note Does not update position of the associated value
    */
   const _ValueT * get(const _KeyT & key) const;
   /**
-   * @brief Checks if the cache contains a value associated with the specified key.
+   * @brief Heterogeneous-key overload of the const get. Does not construct a `_KeyT`.
    *
-   * @param key The key to check for existence in the cache.
-   * @return True if the key exists in the cache, false otherwise.
-   * @note Does not update position of the associated value
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value associated with the specified key, or nullptr
+   *         if the key is not found in the cache.
+   * @note Does not update position of the associated value
+   */
+  template<class _K>
+  Internal::EnableIfTransparentT<_MapT, _KeyT, _K, const _ValueT *> get(const _K & key) const;
+  /**
+   * @brief Checks if the cache contains a value associated with the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not update position of the associated value
    */
   bool contains(const _KeyT & key) const;
+  /**
+   * @brief Heterogeneous-key overload of contains. Does not construct a `_KeyT`.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not update position of the associated value
+   */
+  template<class _K>
+  Internal::EnableIfTransparentT<_MapT, _KeyT, _K, bool> contains(const _K & key) const;
+#if __cplusplus >= 202002L
+  /**
+   * @brief Looks up a batch of keys, like calling `get` for each in order.
+   *
+   * The keys are probed in groups: all lookups of a group are issued before
+   * any of the found entries is promoted, and the list nodes to be promoted
+   * are prefetched in between, so the memory stalls of a group overlap
+   * instead of being paid one key after another.
+   *
+   * @param keys The keys to look up.
+   * @param values Receives, at the index of each key, a pointer to its value
+   *               or nullptr if the key is not in the cache. Only the first
+   *               `min(keys.size(), values.size())` keys are looked up.
+   * @return The number of keys found.
+   */
+  SizeType multi_get(std::span<const _KeyT> keys, std::span<_ValueT *> values);
+  /**
+   * @brief Inserts or updates a batch of entries, like calling `put` for each in order.
+   *
+   * @param entries The key-value pairs to be inserted or updated.
+   */
+  void multi_put(std::span<const std::pair<_KeyT, _ValueT>> entries);
+#endif
 //----------------------------------------------------------------------------
 private:
 //----------------------------------------------------------------------------
-  SizeType capacity_; ///< The maximum number of items that the cache can hold.
-  _ListT   list_; ///< The list used to maintain the order of items.
-  _MapT    map_; ///< The map used for fast key-value lookups.
+  /**
+   * @brief Shared implementation of the put overloads. `_KeyT` is constructed
+   *        from `key` only when a new entry is inserted.
+   */
+  template<class _K, class _V>
+  void store(const _K & key, _V && value);
+  /**
+   * @brief Evicts the victims of the policy until the total weight, plus the
+   *        weight of an entry about to be inserted, fits.
+   */
+  void shrink(SizeType incomingWeight);
+  /**
+   * @brief Removes an entry and subtracts its weight. If there is a listener,
+   *        the entry is queued for it.
+   */
+  void erase(typename _MapT::iterator it, RemovalCause cause);
+  /**
+   * @brief Passes the queued removals to the listener.
+   */
+  void notify();
+//----------------------------------------------------------------------------
+  static constexpr SizeType PREFETCH_GROUP = 16; ///< Number of keys probed ahead by `multi_get`.
+//----------------------------------------------------------------------------
+  SizeType         capacity_; ///< The maximum number of items (or total weight) that the cache can hold.
+  SizeType         weight_;   ///< The total weight of the stored entries.
+  _WeigherT        weigher_;  ///< The functor used to weigh entries.
+  _ListT           list_;     ///< The list used to maintain the order of items.
+  _MapT            map_;      ///< The map used for fast key-value lookups.
+  _PolicyT<_ListT> policy_;   ///< Orders the list and selects the victims.
+#if __cplusplus >= 202002L
+  [[no_unique_address]]
+#endif
+  _StatsT          stats_;    ///< Counts the operations, see `stats`.
+  RemovalListener<_KeyT, _ValueT>                listener_; ///< Told about removed entries, may be empty.
+  std::vector<Internal::Removal<_KeyT, _ValueT>> removed_;  ///< Removals not yet passed to `listener_`.
 //----------------------------------------------------------------------------
 }; // class Cache
 //----------------------------------------------------------------------------
+/**
+ * @brief Hash-indexed LRU cache. This is the recommended configuration and
+ *        the one `Cache` uses by default: lookups are O(1) on average.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+using HashCache = Cache<_KeyT, _ValueT, Internal::ListT<_KeyT>, Internal::HashMapT<_KeyT, _ValueT, Internal::ListT<_KeyT>, _Hash, _KeyEqual>>;
+//----------------------------------------------------------------------------
+/**
+ * @brief Tree-indexed LRU cache. Lookups are O(log n), but keys only need
+ *        a strict weak ordering instead of a hash function.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Compare The key comparison function. Defaults to `std::less<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Compare = std::less<_KeyT>>
+using TreeCache = Cache<_KeyT, _ValueT, Internal::ListT<_KeyT>, Internal::TreeMapT<_KeyT, _ValueT, Internal::ListT<_KeyT>, _Compare>>;
+//----------------------------------------------------------------------------
+/**
+ * @brief Hash-indexed LRU cache bounded by the total weight of its entries
+ *        rather than by their number.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _WeigherT Functor `std::size_t(const _KeyT &, const _ValueT &)`.
+ */
+template<class _KeyT, class _ValueT, class _WeigherT>
+using WeightedCache = Cache<_KeyT, _ValueT, Internal::ListT<_KeyT>, Internal::MapT<_KeyT, _ValueT, Internal::ListT<_KeyT>>, _WeigherT>;
+//----------------------------------------------------------------------------
+/**
+ * @brief Hash-indexed cache that evicts in insertion order. Hits only look
+ *        up the map and never write to the list.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+using FifoCache = Cache<_KeyT, _ValueT, Internal::ListT<_KeyT>, Internal::HashMapT<_KeyT, _ValueT, Internal::ListT<_KeyT>, _Hash, _KeyEqual>, UnitWeigher, FifoPolicy>;
+//----------------------------------------------------------------------------
+/**
+ * @brief Hash-indexed cache that evicts the least frequently used entry.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+using LfuCache = Cache<_KeyT, _ValueT, Internal::ListT<Internal::LfuEntry<_KeyT>>, Internal::HashMapT<_KeyT, _ValueT, Internal::ListT<Internal::LfuEntry<_KeyT>>, _Hash, _KeyEqual>, UnitWeigher, LfuPolicy>;
+//----------------------------------------------------------------------------
+/**
+ * @brief Hash-indexed LRU cache that collects statistics, see `Cache::stats`.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+using StatsCache = Cache<_KeyT, _ValueT, Internal::ListT<_KeyT>, Internal::HashMapT<_KeyT, _ValueT, Internal::ListT<_KeyT>, _Hash, _KeyEqual>, UnitWeigher, LruPolicy, AtomicStats>;
+//----------------------------------------------------------------------------
+#if __cplusplus >= 201703L
+/**
+ * @brief Transparent hash for string keys: hashes `std::string`,
+ *        `std::string_view` and `const char *` to the same value.
+ */
+struct StringHash
+{
+//----------------------------------------------------------------------------
+  using is_transparent = void;
+//----------------------------------------------------------------------------
+  std::size_t operator ()(std::string_view key) const noexcept;
+//----------------------------------------------------------------------------
+}; // struct StringHash
+//----------------------------------------------------------------------------
+/**
+ * @brief Hash-indexed cache with `std::string` keys that can be probed with
+ *        `std::string_view` or `const char *` without building a temporary
+ *        `std::string`. Heterogeneous lookup in unordered maps needs C++20.
+ *
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ */
+template<class _ValueT>
+using StringCache = HashCache<std::string, _ValueT, StringHash, std::equal_to<>>;
+#endif
+//----------------------------------------------------------------------------
 } // namespace LRUCache
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
@@ -198,140 +984,859 @@ MapValue<_ListT, _ValueT>::MapValue(IteratorT && it, _ValueT && value) noexcept
 {
 }
 //----------------------------------------------------------------------------
-} // namespace Internal
+template<class _KeyT>
+LfuEntry<_KeyT>::LfuEntry(_KeyT && key) :
+  key_(std::forward<_KeyT>(key)),
+  count_(1)
+{
+}
 //----------------------------------------------------------------------------
-template<class _KeyT, class _ValueT, class _ListT, class _MapT>
-Cache<_KeyT, _ValueT, _ListT, _MapT>::Cache() :
-  capacity_(0)
+template<class _KeyT>
+const _KeyT & listKey(const _KeyT & entry)
 {
+  return entry;
 }
 //----------------------------------------------------------------------------
-template<class _KeyT, class _ValueT, class _ListT, class _MapT>
-Cache<_KeyT, _ValueT, _ListT, _MapT>::Cache(SizeType capacity) :
-  capacity_(capacity)
+template<class _KeyT>
+const _KeyT & listKey(const LfuEntry<_KeyT> & entry)
 {
+  return entry.key_;
 }
 //----------------------------------------------------------------------------
-template<class _KeyT, class _ValueT, class _ListT, class _MapT>
-typename Cache<_KeyT, _ValueT, _ListT, _MapT>::SizeType Cache<_KeyT, _ValueT, _ListT, _MapT>::capacity() const
+inline void prefetch(const void * address)
 {
-  return capacity_;
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address, 1);
+#else
+  (void)address;
+#endif
 }
 //----------------------------------------------------------------------------
-template<class _KeyT, class _ValueT, class _ListT, class _MapT>
-typename Cache<_KeyT, _ValueT, _ListT, _MapT>::SizeType Cache<_KeyT, _ValueT, _ListT, _MapT>::size() const
+template<class _KeyT, class _ValueT>
+Removal<_KeyT, _ValueT>::Removal(const _KeyT & key, _ValueT && value, RemovalCause cause) :
+  key_(key),
+  value_(std::forward<_ValueT>(value)),
+  cause_(cause)
 {
-  return list_.size();
 }
 //----------------------------------------------------------------------------
-template<class _KeyT, class _ValueT, class _ListT, class _MapT>
-void Cache<_KeyT, _ValueT, _ListT, _MapT>::put(const _KeyT & key, const _ValueT & value)
+template<class _KeyT, class _ValueT>
+void notifyRemovals(std::vector<Removal<_KeyT, _ValueT>> & removed, const RemovalListener<_KeyT, _ValueT> & listener)
 {
-  auto it = map_.find(key);
-  if (it == map_.end())
+  if (removed.empty())
+    return;
+  std::vector<Removal<_KeyT, _ValueT>> batch;
+  batch.swap(removed);
+  for (auto & removal : batch)
+    listener(std::move(removal.key_), std::move(removal.value_), removal.cause_);
+  batch.clear();
+  if (removed.empty())
+    removed.swap(batch);
+}
+//----------------------------------------------------------------------------
+inline std::uint32_t crc32(std::uint32_t crc, const char * data, std::size_t size)
+{
+  // Slicing-by-8: entries_[k][i] is the CRC of byte i followed by k zero bytes
+  struct Table
   {
-    list_.push_front(key);
-    map_.emplace_hint(it, key, MapValueT(list_.begin(), value));
-    if (list_.size() > capacity_)
+    std::uint32_t entries_[8][256];
+
+    Table()
     {
-      map_.erase(list_.back());
-      list_.pop_back();
+      for (std::uint32_t i = 0; i < 256; ++i)
+      {
+        std::uint32_t entry = i;
+        for (int bit = 0; bit < 8; ++bit)
+          entry = (entry >> 1) ^ (entry & 1 ? 0xEDB88320u : 0u);
+        entries_[0][i] = entry;
+      }
+      for (int k = 1; k < 8; ++k)
+        for (int i = 0; i < 256; ++i)
+          entries_[k][i] = (entries_[k - 1][i] >> 8) ^ entries_[0][entries_[k - 1][i] & 0xFF];
     }
+  };
+  static const Table table;
+  const auto & t = table.entries_;
+  crc = ~crc;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  for (; size >= 8; size -= 8, data += 8)
+  {
+    std::uint32_t low, high;
+    std::memcpy(&low, data, sizeof(low));
+    std::memcpy(&high, data + 4, sizeof(high));
+    low ^= crc;
+    crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+          t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+  }
+#endif
+  for (; size > 0; --size, ++data)
+    crc = t[0][(crc ^ static_cast<unsigned char>(*data)) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+//----------------------------------------------------------------------------
+inline SnapshotWriter::SnapshotWriter(const std::string & path) :
+  path_(path),
+  temp_(path + ".tmp"),
+  file_(std::fopen(temp_.c_str(), "wb")),
+  crc_(0),
+  ok_(file_ != nullptr)
+{
+  buffer_.reserve(2 * FLUSH_SIZE);
+}
+//----------------------------------------------------------------------------
+inline SnapshotWriter::~SnapshotWriter()
+{
+  if (file_ == nullptr)
     return;
+  // NOTE: not finished, drop the partial file
+  std::fclose(file_);
+  std::remove(temp_.c_str());
+}
+//----------------------------------------------------------------------------
+inline bool SnapshotWriter::is_open() const
+{
+  return file_ != nullptr;
+}
+//----------------------------------------------------------------------------
+inline std::string & SnapshotWriter::buffer()
+{
+  return buffer_;
+}
+//----------------------------------------------------------------------------
+inline void SnapshotWriter::flush_if_full()
+{
+  if (buffer_.size() >= FLUSH_SIZE)
+    flush();
+}
+//----------------------------------------------------------------------------
+inline bool SnapshotWriter::finish()
+{
+  flush();
+  const std::uint32_t crc = crc_;
+  ok_ = ok_ && std::fwrite(&crc, sizeof(crc), 1, file_) == 1;
+  ok_ = std::fclose(file_) == 0 && ok_;
+  file_ = nullptr;
+  ok_ = ok_ && std::rename(temp_.c_str(), path_.c_str()) == 0;
+  if (!ok_)
+    std::remove(temp_.c_str());
+  return ok_;
+}
+//----------------------------------------------------------------------------
+inline void SnapshotWriter::flush()
+{
+  crc_ = crc32(crc_, buffer_.data(), buffer_.size());
+  ok_  = ok_ && std::fwrite(buffer_.data(), 1, buffer_.size(), file_) == buffer_.size();
+  buffer_.clear();
+}
+//----------------------------------------------------------------------------
+inline const char * readSnapshot(const std::string & path, std::string & data, std::uint64_t & count)
+{
+  std::FILE * file = std::fopen(path.c_str(), "rb");
+  if (file == nullptr)
+    return nullptr;
+  bool ok = std::fseek(file, 0, SEEK_END) == 0;
+  const long size = ok ? std::ftell(file) : -1;
+  ok = size >= 0 && std::fseek(file, 0, SEEK_SET) == 0;
+  if (ok)
+  {
+    data.resize(static_cast<std::size_t>(size));
+    ok = std::fread(&data[0], 1, data.size(), file) == data.size();
   }
-  auto & mapEntryData = it->second;
-  mapEntryData.value_ = value;
-  list_.splice(list_.begin(), list_, mapEntryData.it_);
+  std::fclose(file);
+  const std::size_t headerSize = 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t);
+  if (!ok || data.size() < headerSize + sizeof(std::uint32_t))
+    return nullptr;
+  std::uint32_t magic, version, crc;
+  std::memcpy(&magic, data.data(), sizeof(magic));
+  std::memcpy(&version, data.data() + sizeof(magic), sizeof(version));
+  std::memcpy(&count, data.data() + 2 * sizeof(std::uint32_t), sizeof(count));
+  const std::size_t bodySize = data.size() - sizeof(crc);
+  std::memcpy(&crc, data.data() + bodySize, sizeof(crc));
+  if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION || crc != crc32(0, data.data(), bodySize))
+    return nullptr;
+  return data.data() + headerSize;
 }
 //----------------------------------------------------------------------------
-template<class _KeyT, class _ValueT, class _ListT, class _MapT>
-void Cache<_KeyT, _ValueT, _ListT, _MapT>::put(const _KeyT & key, _ValueT && value)
+template<class _MapT>
+auto reserveMap(_MapT & map, std::size_t count, int) -> decltype(map.reserve(count), void())
 {
-  auto it = map_.find(key);
-  if (it == map_.end())
+  map.reserve(count);
+}
+//----------------------------------------------------------------------------
+template<class _MapT>
+void reserveMap(_MapT &, std::size_t, long)
+{
+}
+//----------------------------------------------------------------------------
+template<class _MapT, class _AllocT>
+auto makeMap(const _AllocT & alloc, int) -> decltype(_MapT(typename _MapT::allocator_type(alloc)))
+{
+  return _MapT(typename _MapT::allocator_type(alloc));
+}
+//----------------------------------------------------------------------------
+template<class _MapT, class _AllocT>
+_MapT makeMap(const _AllocT &, long)
+{
+  return _MapT();
+}
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+template<class _T>
+void Serializer<_T, typename std::enable_if<std::is_trivially_copyable<_T>::value>::type>::write(std::string & out, const _T & value) const
+{
+  out.append(reinterpret_cast<const char *>(&value), sizeof(_T));
+}
+//----------------------------------------------------------------------------
+template<class _T>
+bool Serializer<_T, typename std::enable_if<std::is_trivially_copyable<_T>::value>::type>::read(const char *& data, const char * end, _T & value) const
+{
+  if (static_cast<std::size_t>(end - data) < sizeof(_T))
+    return false;
+  std::memcpy(&value, data, sizeof(_T));
+  data += sizeof(_T);
+  return true;
+}
+//----------------------------------------------------------------------------
+inline void Serializer<std::string>::write(std::string & out, const std::string & value) const
+{
+  const std::uint64_t size = value.size();
+  out.append(reinterpret_cast<const char *>(&size), sizeof(size));
+  out.append(value);
+}
+//----------------------------------------------------------------------------
+inline bool Serializer<std::string>::read(const char *& data, const char * end, std::string & value) const
+{
+  std::uint64_t size;
+  if (static_cast<std::size_t>(end - data) < sizeof(size))
+    return false;
+  std::memcpy(&size, data, sizeof(size));
+  data += sizeof(size);
+  if (static_cast<std::uint64_t>(end - data) < size)
+    return false;
+  value.assign(data, static_cast<std::size_t>(size));
+  data += size;
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::Cache() :
+  capacity_(0),
+  weight_(0)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::Cache(SizeType capacity) :
+  capacity_(capacity),
+  weight_(0)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::Cache(SizeType maxWeight, const _WeigherT & weigher) :
+  capacity_(maxWeight),
+  weight_(0),
+  weigher_(weigher)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::Cache(SizeType capacity, const typename _ListT::allocator_type & alloc) :
+  capacity_(capacity),
+  weight_(0),
+  list_(alloc),
+  map_(Internal::makeMap<_MapT>(alloc, 0))
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::Cache(SizeType maxWeight, const _WeigherT & weigher, const typename _ListT::allocator_type & alloc) :
+  capacity_(maxWeight),
+  weight_(0),
+  weigher_(weigher),
+  list_(alloc),
+  map_(Internal::makeMap<_MapT>(alloc, 0))
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+typename Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::SizeType Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::capacity() const
+{
+  return capacity_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+typename Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::SizeType Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::max_weight() const
+{
+  return capacity_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+typename Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::SizeType Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::size() const
+{
+  return list_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+typename Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::SizeType Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::weight() const
+{
+  return weight_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+CacheStats Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::stats() const
+{
+  return stats_.snapshot();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+void Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::set_removal_listener(RemovalListener<_KeyT, _ValueT> listener)
+{
+  listener_ = std::move(listener);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+template<class _KeySerializerT, class _ValueSerializerT>
+bool Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::save(const std::string & path, const _KeySerializerT & keySerializer, const _ValueSerializerT & valueSerializer) const
+{
+  Internal::SnapshotWriter writer(path);
+  if (!writer.is_open())
+    return false;
+  std::string & out = writer.buffer();
+  const std::uint64_t count = list_.size();
+  out.append(reinterpret_cast<const char *>(&Internal::SNAPSHOT_MAGIC), sizeof(Internal::SNAPSHOT_MAGIC));
+  out.append(reinterpret_cast<const char *>(&Internal::SNAPSHOT_VERSION), sizeof(Internal::SNAPSHOT_VERSION));
+  out.append(reinterpret_cast<const char *>(&count), sizeof(count));
+  // Oldest first, so that load can insert the entries in file order
+  for (auto it = list_.rbegin(); it != list_.rend(); ++it)
+  {
+    const _KeyT & key = Internal::listKey(*it);
+    keySerializer.write(out, key);
+    valueSerializer.write(out, map_.find(key)->second.value_);
+    writer.flush_if_full();
+  }
+  return writer.finish();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+template<class _KeySerializerT, class _ValueSerializerT>
+bool Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::load(const std::string & path, const _KeySerializerT & keySerializer, const _ValueSerializerT & valueSerializer)
+{
+  std::string data;
+  std::uint64_t count = 0;
+  const char * cursor = Internal::readSnapshot(path, data, count);
+  if (cursor == nullptr)
+    return false;
+  const char * end = data.data() + data.size() - sizeof(std::uint32_t);
+  clear();
+  // NOTE: the count comes from the file: reserve no more entries than the
+  // cache can hold, nor than the payload has bytes
+  const std::uint64_t payload = static_cast<std::uint64_t>(end - cursor);
+  std::uint64_t reserved = count < capacity_ ? count : capacity_;
+  reserved = reserved < payload ? reserved : payload;
+  Internal::reserveMap(map_, static_cast<std::size_t>(reserved), 0);
+  bool ok = true;
+  for (std::uint64_t i = 0; ok && i < count; ++i)
   {
-    list_.push_front(key);
-    map_.emplace_hint(it, key, MapValueT(list_.begin(), std::forward<_ValueT>(value)));
-    if (list_.size() > capacity_)
+    _KeyT key;
+    _ValueT value;
+    ok = keySerializer.read(cursor, end, key) && valueSerializer.read(cursor, end, value);
+    if (!ok)
+      break;
+    const SizeType entryWeight = weigher_(key, value);
+    if (entryWeight > capacity_)
+      continue;
+    shrink(entryWeight);
+    list_.emplace_front(std::move(key));
+    if (!map_.emplace(Internal::listKey(list_.front()), MapValueT(list_.begin(), std::move(value))).second)
     {
-      map_.erase(list_.back());
-      list_.pop_back();
+      // NOTE: a duplicate key, only possible with a mismatched serializer
+      list_.pop_front();
+      continue;
     }
-    return;
+    policy_.on_insert(list_, list_.begin());
+    weight_ += entryWeight;
   }
-  auto & mapEntryData = it->second;
-  mapEntryData.value_ = std::forward<_ValueT>(value);
-  list_.splice(list_.begin(), list_, mapEntryData.it_);
+  if (!ok || cursor != end)
+  {
+    clear();
+    return false;
+  }
+  notify();
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+void Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::put(const _KeyT & key, const _ValueT & value)
+{
+  store(key, value);
+  notify();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+void Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::put(const _KeyT & key, _ValueT && value)
+{
+  store(key, std::forward<_ValueT>(value));
+  notify();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+template<class _K>
+Internal::EnableIfTransparentT<_MapT, _KeyT, _K, void> Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::put(const _K & key, const _ValueT & value)
+{
+  store(key, value);
+  notify();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+template<class _K>
+Internal::EnableIfTransparentT<_MapT, _KeyT, _K, void> Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::put(const _K & key, _ValueT && value)
+{
+  store(key, std::forward<_ValueT>(value));
+  notify();
 }
 //----------------------------------------------------------------------------
-template<class _KeyT, class _ValueT, class _ListT, class _MapT>
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
 template<class ...Args>
-void Cache<_KeyT, _ValueT, _ListT, _MapT>::emplace(const _KeyT & key, Args && ...args) noexcept
+void Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::emplace(const _KeyT & key, Args && ...args)
+{
+  store(key, _ValueT(std::forward<Args>(args)...));
+  notify();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+bool Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::remove(const _KeyT & key)
 {
   auto it = map_.find(key);
   if (it == map_.end())
-  {
-    list_.push_front(key);
-    map_.emplace_hint(it, key, MapValueT(list_.begin(), _ValueT(args...)));
-    if (list_.size() > capacity_)
-    {
-      map_.erase(list_.back());
-      list_.pop_back();
-    }
-    return;
-  }
-  auto & mapEntryData = it->second;
-  mapEntryData.value_ = std::forward<_ValueT>(_ValueT(args...));
-  list_.splice(list_.begin(), list_, mapEntryData.it_);
+    return false;
+  erase(it, RemovalCause::EXPLICIT);
+  stats_.record_removal();
+  notify();
+  return true;
 }
 //----------------------------------------------------------------------------
-template<class _KeyT, class _ValueT, class _ListT, class _MapT>
-bool Cache<_KeyT, _ValueT, _ListT, _MapT>::remove(const _KeyT & key)
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+template<class _K>
+Internal::EnableIfTransparentT<_MapT, _KeyT, _K, bool> Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::remove(const _K & key)
 {
   auto it = map_.find(key);
   if (it == map_.end())
     return false;
-  auto & mapEntryData = it->second;
-  list_.erase(mapEntryData.it_);
-  map_.erase(it);
+  erase(it, RemovalCause::EXPLICIT);
+  stats_.record_removal();
+  notify();
   return true;
 }
 //----------------------------------------------------------------------------
-template<class _KeyT, class _ValueT, class _ListT, class _MapT>
-void Cache<_KeyT, _ValueT, _ListT, _MapT>::clear()
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+void Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::clear()
 {
+  if (listener_)
+  {
+    for (auto & entry : map_)
+      removed_.emplace_back(entry.first, std::move(entry.second.value_), RemovalCause::EXPLICIT);
+  }
   list_.clear();
   map_.clear();
+  policy_ = _PolicyT<_ListT>();
+  weight_ = 0;
+  notify();
 }
 //----------------------------------------------------------------------------
-template<class _KeyT, class _ValueT, class _ListT, class _MapT>
-_ValueT * Cache<_KeyT, _ValueT, _ListT, _MapT>::get(const _KeyT & key)
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+_ValueT * Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::get(const _KeyT & key)
 {
   auto it = map_.find(key);
   if (it == map_.end())
+  {
+    stats_.record_miss();
     return nullptr;
+  }
+  stats_.record_hit();
   auto & mapEntryData = it->second;
-  list_.splice(list_.begin(), list_, mapEntryData.it_);
+  policy_.on_access(list_, mapEntryData.it_);
   return &(mapEntryData.value_);
 }
 //----------------------------------------------------------------------------
-template<class _KeyT, class _ValueT, class _ListT, class _MapT>
-const _ValueT * Cache<_KeyT, _ValueT, _ListT, _MapT>::get(const _KeyT & key) const
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+template<class _K>
+Internal::EnableIfTransparentT<_MapT, _KeyT, _K, _ValueT *> Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::get(const _K & key)
 {
   auto it = map_.find(key);
   if (it == map_.end())
+  {
+    stats_.record_miss();
     return nullptr;
+  }
+  stats_.record_hit();
   auto & mapEntryData = it->second;
-  list_.splice(list_.begin(), mapEntryData.it_);
+  policy_.on_access(list_, mapEntryData.it_);
   return &(mapEntryData.value_);
 }
 //----------------------------------------------------------------------------
-template<class _KeyT, class _ValueT, class _ListT, class _MapT>
-bool Cache<_KeyT, _ValueT, _ListT, _MapT>::contains(const _KeyT & key) const
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+const _ValueT * Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::get(const _KeyT & key) const
+{
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return nullptr;
+  return &(it->second.value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+template<class _K>
+Internal::EnableIfTransparentT<_MapT, _KeyT, _K, const _ValueT *> Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::get(const _K & key) const
+{
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return nullptr;
+  return &(it->second.value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+bool Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::contains(const _KeyT & key) const
+{
+  return map_.find(key) != map_.end();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+template<class _K>
+Internal::EnableIfTransparentT<_MapT, _KeyT, _K, bool> Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::contains(const _K & key) const
+{
+  return map_.find(key) != map_.end();
+}
+//----------------------------------------------------------------------------
+#if __cplusplus >= 202002L
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+typename Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::SizeType Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::multi_get(std::span<const _KeyT> keys, std::span<_ValueT *> values)
+{
+  const SizeType count = keys.size() < values.size() ? keys.size() : values.size();
+  typename _MapT::iterator found[PREFETCH_GROUP];
+  SizeType hits = 0;
+  for (SizeType first = 0; first < count; first += PREFETCH_GROUP)
+  {
+    const SizeType group = count - first < PREFETCH_GROUP ? count - first : PREFETCH_GROUP;
+    for (SizeType i = 0; i < group; ++i)
+    {
+      found[i] = map_.find(keys[first + i]);
+      if (found[i] != map_.end())
+        Internal::prefetch(std::addressof(*found[i]->second.it_));
+    }
+    for (SizeType i = 0; i < group; ++i)
+    {
+      if (found[i] == map_.end())
+      {
+        stats_.record_miss();
+        values[first + i] = nullptr;
+        continue;
+      }
+      stats_.record_hit();
+      policy_.on_access(list_, found[i]->second.it_);
+      values[first + i] = &(found[i]->second.value_);
+      ++hits;
+    }
+  }
+  return hits;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+void Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::multi_put(std::span<const std::pair<_KeyT, _ValueT>> entries)
+{
+  for (const auto & entry : entries)
+    store(entry.first, entry.second);
+  notify();
+}
+//----------------------------------------------------------------------------
+#endif
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+template<class _K, class _V>
+void Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::store(const _K & key, _V && value)
+{
+  auto it = map_.find(key);
+  if (it == map_.end())
+  {
+    _KeyT ownedKey(key);
+    const SizeType entryWeight = weigher_(ownedKey, value);
+    if (entryWeight > capacity_)
+      return;
+    // Evict first, so that the policy cannot pick the new entry as the victim
+    shrink(entryWeight);
+    list_.emplace_front(std::move(ownedKey));
+    map_.emplace(Internal::listKey(list_.front()), MapValueT(list_.begin(), std::forward<_V>(value)));
+    policy_.on_insert(list_, list_.begin());
+    weight_ += entryWeight;
+    stats_.record_insert();
+    return;
+  }
+  auto & mapEntryData = it->second;
+  const SizeType entryWeight = weigher_(it->first, value);
+  if (entryWeight > capacity_)
+  {
+    erase(it, RemovalCause::SIZE);
+    stats_.record_eviction();
+    return;
+  }
+  stats_.record_update();
+  weight_ -= weigher_(it->first, mapEntryData.value_);
+  if (listener_)
+    removed_.emplace_back(it->first, std::move(mapEntryData.value_), RemovalCause::REPLACED);
+  mapEntryData.value_ = std::forward<_V>(value);
+  weight_ += entryWeight;
+  policy_.on_access(list_, mapEntryData.it_);
+  shrink(0);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+void Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::shrink(SizeType incomingWeight)
+{
+  while (weight_ + incomingWeight > capacity_ && !list_.empty())
+  {
+    erase(map_.find(Internal::listKey(*policy_.select_victim(list_))), RemovalCause::SIZE);
+    stats_.record_eviction();
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+void Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::erase(typename _MapT::iterator it, RemovalCause cause)
+{
+  const SizeType entryWeight = weigher_(it->first, it->second.value_);
+  weight_ -= entryWeight < weight_ ? entryWeight : weight_;
+  if (listener_)
+    removed_.emplace_back(it->first, std::move(it->second.value_), cause);
+  policy_.on_remove(list_, it->second.it_);
+  list_.erase(it->second.it_);
+  map_.erase(it);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _StatsT>
+void Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>::notify()
+{
+  Internal::notifyRemovals(removed_, listener_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT>
+std::size_t UnitWeigher::operator ()(const _KeyT &, const _ValueT &) const noexcept
+{
+  return 1;
+}
+//----------------------------------------------------------------------------
+inline double CacheStats::hit_ratio() const
+{
+  const std::uint64_t lookups = hits_ + misses_;
+  return lookups == 0 ? 0.0 : static_cast<double>(hits_) / lookups;
+}
+//----------------------------------------------------------------------------
+inline CacheStats & CacheStats::operator +=(const CacheStats & other)
+{
+  hits_          += other.hits_;
+  misses_        += other.misses_;
+  inserts_       += other.inserts_;
+  updates_       += other.updates_;
+  evictions_     += other.evictions_;
+  removals_      += other.removals_;
+  loadSuccesses_ += other.loadSuccesses_;
+  loadFailures_  += other.loadFailures_;
+  loadTime_      += other.loadTime_;
+  return *this;
+}
+//----------------------------------------------------------------------------
+inline CacheStats NoStats::snapshot() const
+{
+  return CacheStats();
+}
+//----------------------------------------------------------------------------
+inline AtomicStats::AtomicStats()
+{
+  for (auto & counter : counters_)
+    counter.store(0, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+inline AtomicStats::AtomicStats(const AtomicStats & other)
+{
+  *this = other;
+}
+//----------------------------------------------------------------------------
+inline AtomicStats & AtomicStats::operator =(const AtomicStats & other)
+{
+  for (int i = 0; i < COUNTERS; ++i)
+    counters_[i].store(other.counters_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  return *this;
+}
+//----------------------------------------------------------------------------
+inline void AtomicStats::record_hit()
+{
+  add(HITS, 1);
+}
+//----------------------------------------------------------------------------
+inline void AtomicStats::record_miss()
+{
+  add(MISSES, 1);
+}
+//----------------------------------------------------------------------------
+inline void AtomicStats::record_insert()
+{
+  add(INSERTS, 1);
+}
+//----------------------------------------------------------------------------
+inline void AtomicStats::record_update()
+{
+  add(UPDATES, 1);
+}
+//----------------------------------------------------------------------------
+inline void AtomicStats::record_eviction(std::uint64_t count)
+{
+  add(EVICTIONS, count);
+}
+//----------------------------------------------------------------------------
+inline void AtomicStats::record_removal()
+{
+  add(REMOVALS, 1);
+}
+//----------------------------------------------------------------------------
+inline void AtomicStats::record_load_success(std::chrono::nanoseconds time)
+{
+  add(LOAD_SUCCESSES, 1);
+  add(LOAD_TIME, static_cast<std::uint64_t>(time.count()));
+}
+//----------------------------------------------------------------------------
+inline void AtomicStats::record_load_failure(std::chrono::nanoseconds time)
+{
+  add(LOAD_FAILURES, 1);
+  add(LOAD_TIME, static_cast<std::uint64_t>(time.count()));
+}
+//----------------------------------------------------------------------------
+inline CacheStats AtomicStats::snapshot() const
+{
+  CacheStats stats;
+  stats.hits_          = counters_[HITS].load(std::memory_order_relaxed);
+  stats.misses_        = counters_[MISSES].load(std::memory_order_relaxed);
+  stats.inserts_       = counters_[INSERTS].load(std::memory_order_relaxed);
+  stats.updates_       = counters_[UPDATES].load(std::memory_order_relaxed);
+  stats.evictions_     = counters_[EVICTIONS].load(std::memory_order_relaxed);
+  stats.removals_      = counters_[REMOVALS].load(std::memory_order_relaxed);
+  stats.loadSuccesses_ = counters_[LOAD_SUCCESSES].load(std::memory_order_relaxed);
+  stats.loadFailures_  = counters_[LOAD_FAILURES].load(std::memory_order_relaxed);
+  stats.loadTime_      = counters_[LOAD_TIME].load(std::memory_order_relaxed);
+  return stats;
+}
+//----------------------------------------------------------------------------
+inline void AtomicStats::add(Counter counter, std::uint64_t count)
+{
+  // NOTE: single writer, see the class comment
+  counters_[counter].store(counters_[counter].load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+void LruPolicy<_ListT>::on_insert(_ListT &, IteratorT)
+{
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+void LruPolicy<_ListT>::on_access(_ListT & list, IteratorT it)
+{
+  list.splice(list.begin(), list, it);
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+void LruPolicy<_ListT>::on_remove(_ListT &, IteratorT)
+{
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+typename LruPolicy<_ListT>::IteratorT LruPolicy<_ListT>::select_victim(_ListT & list)
+{
+  return std::prev(list.end());
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+void FifoPolicy<_ListT>::on_insert(_ListT &, IteratorT)
+{
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+void FifoPolicy<_ListT>::on_access(_ListT &, IteratorT)
+{
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+void FifoPolicy<_ListT>::on_remove(_ListT &, IteratorT)
+{
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+typename FifoPolicy<_ListT>::IteratorT FifoPolicy<_ListT>::select_victim(_ListT & list)
+{
+  return std::prev(list.end());
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+void LfuPolicy<_ListT>::on_insert(_ListT & list, IteratorT it)
+{
+  // New entries go to the front of the run of count 1, which ends the list
+  auto head = heads_.find(it->count_);
+  if (head == heads_.end())
+  {
+    list.splice(list.end(), list, it);
+    heads_.emplace(it->count_, it);
+    return;
+  }
+  list.splice(head->second, list, it);
+  head->second = it;
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+void LfuPolicy<_ListT>::on_access(_ListT & list, IteratorT it)
+{
+  // The entry becomes the front of the run of the next count, which ends
+  // where its current run starts
+  auto head = heads_.find(it->count_);
+  auto next = heads_.find(it->count_ + 1);
+  const IteratorT position = next != heads_.end() ? next->second : head->second;
+  if (head->second == it)
+    leave(list, it);
+  if (position != it)
+    list.splice(position, list, it);
+  ++it->count_;
+  if (next != heads_.end())
+    next->second = it;
+  else
+    heads_.emplace(it->count_, it);
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+void LfuPolicy<_ListT>::on_remove(_ListT & list, IteratorT it)
+{
+  leave(list, it);
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+typename LfuPolicy<_ListT>::IteratorT LfuPolicy<_ListT>::select_victim(_ListT & list)
+{
+  return std::prev(list.end());
+}
+//----------------------------------------------------------------------------
+template<class _ListT>
+void LfuPolicy<_ListT>::leave(_ListT & list, IteratorT it)
+{
+  auto head = heads_.find(it->count_);
+  if (head->second != it)
+    return;
+  auto next = std::next(it);
+  if (next != list.end() && next->count_ == it->count_)
+    head->second = next;
+  else
+    heads_.erase(head);
+}
+//----------------------------------------------------------------------------
+#if __cplusplus >= 201703L
+inline std::size_t StringHash::operator ()(std::string_view key) const noexcept
 {
-  return map_.find(key) == map_.end();
+  return std::hash<std::string_view>()(key);
 }
 //----------------------------------------------------------------------------
+#endif
 } // namespace LRUCache
 //----------------------------------------------------------------------------
 #endif // LRU_CACHE_HPP
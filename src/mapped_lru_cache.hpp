@@ -0,0 +1,740 @@
+//----------------------------------------------------------------------------
+#ifndef MAPPED_LRU_CACHE_HPP
+#define MAPPED_LRU_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+//----------------------------------------------------------------------------
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+/**
+ * @brief How `MappedCache` opens its file.
+ */
+enum class MapMode : std::uint8_t
+{
+  READ_WRITE, ///< Reuse the file if it matches, otherwise (re)create it.
+  READ_ONLY   ///< Map an existing file without ever writing to it.
+};
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+using MappedIndexT = std::uint32_t;
+//----------------------------------------------------------------------------
+static constexpr MappedIndexT MAPPED_NIL     = 0xFFFFFFFF; ///< Marks the end of a list or of a hash chain.
+static constexpr std::uint32_t MAPPED_MAGIC   = 0x4D555243; ///< "CRUM" in little-endian byte order.
+static constexpr std::uint32_t MAPPED_VERSION = 3;          ///< Bumped on every change of the layout.
+static constexpr std::uint32_t MAPPED_CLEAN   = 0;          ///< Every change was flushed.
+static constexpr std::uint32_t MAPPED_DIRTY   = 1;          ///< Changed since the last flush; check before trusting the links.
+//----------------------------------------------------------------------------
+/**
+ * @brief First bytes of the file of a `MappedCache`: its geometry and the
+ *        heads of its lists. The slot array follows at `MAPPED_HEADER_SIZE`,
+ *        then the hash buckets.
+ */
+struct MappedHeader
+{
+//----------------------------------------------------------------------------
+  std::uint32_t magic_;
+  std::uint32_t version_;
+  std::uint32_t keySize_;   ///< sizeof of the key type.
+  std::uint32_t valueSize_; ///< sizeof of the value type.
+  std::uint32_t slotSize_;  ///< sizeof of a slot, including padding.
+  std::uint32_t state_;     ///< `MAPPED_CLEAN` or `MAPPED_DIRTY`.
+  std::uint64_t capacity_;
+  std::uint64_t buckets_;   ///< Number of hash buckets, a power of two.
+  MappedIndexT  head_;      ///< Most recently used slot.
+  MappedIndexT  tail_;      ///< Least recently used slot.
+  MappedIndexT  free_;      ///< First slot of the free list, linked through next_.
+  MappedIndexT  size_;
+//----------------------------------------------------------------------------
+}; // struct MappedHeader
+//----------------------------------------------------------------------------
+static constexpr std::size_t MAPPED_HEADER_SIZE = 64; ///< Header size rounded up to a cache line.
+//----------------------------------------------------------------------------
+static_assert(sizeof(MappedHeader) <= MAPPED_HEADER_SIZE, "MappedHeader must fit in MAPPED_HEADER_SIZE");
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT>
+struct MappedSlot
+{
+//----------------------------------------------------------------------------
+  MappedIndexT  prev_;  ///< More recently used slot.
+  MappedIndexT  next_;  ///< Less recently used slot, or the next free slot.
+  MappedIndexT  chain_; ///< Next slot in the same hash bucket.
+  MappedIndexT  hash_;  ///< Low 32 bits of the mixed key hash.
+  std::uint32_t check_; ///< `mappedChecksum` of the key and the value, written after them by `MappedCache`.
+  _KeyT         key_;
+  _ValueT       value_;
+//----------------------------------------------------------------------------
+}; // struct MappedSlot
+//----------------------------------------------------------------------------
+/**
+ * @brief Checksum of the key and the value of a slot, which tells a slot
+ *        whose write was cut short by a crash from a complete one.
+ */
+template<class _KeyT, class _ValueT>
+std::uint32_t mappedChecksum(const MappedSlot<_KeyT, _ValueT> & slot);
+//----------------------------------------------------------------------------
+/**
+ * @brief Mixes `size` bytes into `hash`, eight at a time.
+ */
+inline std::uint64_t mappedMix(std::uint64_t hash, const void * data, std::size_t size);
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Fixed-capacity LRU cache whose whole state lives in a memory-mapped file.
+ *
+ * The file holds a header, an array of slots and an array of hash buckets.
+ * The LRU list, the free list and the hash chains are 32-bit slot indices,
+ * so the file means the same thing wherever it is mapped: a restarted
+ * process, or another process opening it with `MapMode::READ_ONLY`, uses the
+ * entries as they are, without reading or deserializing them first.
+ *
+ * The header records whether the links may be half updated. The first change
+ * after a flush marks the file dirty (synchronously, before the change), and
+ * `flush` and the destructor mark it clean again. A clean file is used at
+ * once; a dirty one, left behind by a crash, is walked and checked first, and
+ * is cleared if any link is inconsistent. Since `put` writes keys and values
+ * in place, every slot also holds a checksum of its key and value, written
+ * after them, so that an entry torn by a crash fails the check too.
+ *
+ * The API mirrors `LRUCache::Cache`. Keys and values must be trivially
+ * copyable, and the hash must give the same result in every process that
+ * opens the file (`std::hash` of integers does). The cache is not
+ * thread-safe, and a read-only mapping sees the writes of another process
+ * without any synchronization. POSIX only.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+class MappedCache
+{
+//----------------------------------------------------------------------------
+  static_assert(std::is_trivially_copyable<_KeyT>::value, "MappedCache keys must be trivially copyable");
+  static_assert(std::is_trivially_copyable<_ValueT>::value, "MappedCache values must be trivially copyable");
+//----------------------------------------------------------------------------
+  using SizeType = std::size_t; ///< Type representing the size of the cache.
+  using IndexT   = Internal::MappedIndexT; ///< Type of the links between slots.
+  using SlotT    = Internal::MappedSlot<_KeyT, _ValueT>; ///< Type of an entry slot.
+//----------------------------------------------------------------------------
+public:
+  /**
+   * @brief Opens or creates the file of a cache and maps it.
+   *
+   * With `MapMode::READ_WRITE`, an existing file with the same capacity and
+   * entry layout is reused, and any other file is replaced by an empty cache.
+   * With `MapMode::READ_ONLY`, the file must exist, its capacity is used
+   * whatever `capacity` says, and the non-const methods do nothing (the
+   * non-const `get` returns nullptr: use the const one). Check `is_open` for
+   * failures.
+   *
+   * @param path The file holding the cache.
+   * @param capacity The maximum number of items that the cache can hold.
+   * @param mode Whether the cache may be modified.
+   * @param hash The hash function used for keys.
+   * @param keyEqual The key equality predicate.
+   */
+  MappedCache(const std::string & path, SizeType capacity, MapMode mode = MapMode::READ_WRITE, const _Hash & hash = _Hash(), const _KeyEqual & keyEqual = _KeyEqual());
+  MappedCache(const MappedCache &) = delete;
+  MappedCache & operator =(const MappedCache &) = delete;
+  /**
+   * @brief Flushes the file, marks it clean and unmaps it.
+   */
+  ~MappedCache();
+  /**
+   * @brief Tells whether the file is mapped. If not, the cache is empty and
+   *        has a capacity of zero.
+   */
+  bool is_open() const;
+  /**
+   * @brief Tells whether the file was found and reused rather than created.
+   */
+  bool reopened() const;
+  /**
+   * @brief Retrieves the current capacity of the cache.
+   *
+   * @return The maximum number of items that the cache can hold.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the current number of items in the cache.
+   *
+   * @return The number of items currently stored in the cache.
+   */
+  SizeType size() const;
+  /**
+   * @brief Writes the changes to the file and marks it clean.
+   *
+   * @return True if the file was synchronized, false on error or if the
+   *         cache is not open or read-only.
+   */
+  bool flush();
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * If the cache is full, the least recently used entry is evicted and its slot
+   * is reused in place.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Removes the value associated with the specified key from the cache.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears all items from the cache. The file keeps its size.
+   */
+  void clear();
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key
+   *        and marks it as recently used.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache
+   *         or if the cache is read-only: the mapping cannot be written.
+   */
+  _ValueT * get(const _KeyT & key);
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache.
+   * @note Does not update position of the associated value
+   */
+  const _ValueT * get(const _KeyT & key) const;
+  /**
+   * @brief Checks if the cache contains a value associated with the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not update position of the associated value
+   */
+  bool contains(const _KeyT & key) const;
+  /**
+   * @brief Checks that the lists and hash chains in the file are consistent:
+   *        every slot is either in the LRU list and in the chain of its
+   *        bucket, or in the free list, exactly once, and that the checksum
+   *        of every entry matches its key and value.
+   *
+   * Runs in O(capacity); called on opening a dirty file.
+   */
+  bool verify() const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Size of the file of a cache of the given capacity.
+   */
+  static SizeType fileSize(SizeType capacity, SizeType buckets);
+  /**
+   * @brief Tells whether the mapped header describes a cache of this type.
+   */
+  bool matches(SizeType fileBytes) const;
+  /**
+   * @brief Maps `bytes` of the open file and points the header, slots and buckets into it.
+   */
+  bool map(SizeType bytes);
+  /**
+   * @brief Unmaps the file and closes it.
+   */
+  void close();
+  /**
+   * @brief Writes a fresh header and an empty cache to the mapped file.
+   */
+  void reset(SizeType capacity, SizeType buckets);
+  /**
+   * @brief Marks the file dirty before the first change after a flush.
+   */
+  void touch();
+  /**
+   * @brief Hashes a key, mixing the bits since the bucket is picked by
+   *        masking the low bits, and keeps the low 32 bits.
+   */
+  IndexT hashOf(const _KeyT & key) const;
+  /**
+   * @brief Returns the address of the link that points to the slot with the
+   *        specified key, or of the NIL link at the end of its chain.
+   */
+  const IndexT * find(IndexT hash, const _KeyT & key) const;
+  /**
+   * @brief Unlinks the slot from its hash bucket chain.
+   */
+  void unchain(IndexT index);
+//----------------------------------------------------------------------------
+  void unlink(IndexT index);
+  void linkFront(IndexT index);
+  void toFront(IndexT index);
+//----------------------------------------------------------------------------
+  int                        fd_;       ///< The open file, -1 if none.
+  char *                     map_;      ///< Start of the mapping, nullptr if none.
+  SizeType                   mapSize_;  ///< Length of the mapping.
+  bool                       readOnly_; ///< Whether the file is mapped read-only.
+  bool                       reopened_; ///< Whether an existing cache was reused.
+  Internal::MappedHeader *   header_;   ///< Header at the start of the mapping.
+  SlotT *                    slots_;    ///< Slot array in the mapping.
+  IndexT *                   buckets_;  ///< Hash buckets in the mapping.
+  _Hash                      hash_;     ///< The hash function used for keys.
+  _KeyEqual                  keyEqual_; ///< The key equality predicate.
+//----------------------------------------------------------------------------
+}; // class MappedCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT>
+std::uint32_t mappedChecksum(const MappedSlot<_KeyT, _ValueT> & slot)
+{
+  std::uint64_t hash = mappedMix(0x9E3779B97F4A7C15ull, &slot.key_, sizeof(_KeyT));
+  hash = mappedMix(hash, &slot.value_, sizeof(_ValueT));
+  return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+}
+//----------------------------------------------------------------------------
+inline std::uint64_t mappedMix(std::uint64_t hash, const void * data, std::size_t size)
+{
+  const unsigned char * bytes = static_cast<const unsigned char *>(data);
+  for (; size >= sizeof(std::uint64_t); bytes += sizeof(std::uint64_t), size -= sizeof(std::uint64_t))
+  {
+    std::uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+  }
+  std::uint64_t word = 0;
+  std::memcpy(&word, bytes, size);
+  hash = (hash ^ word ^ (static_cast<std::uint64_t>(size) << 56)) * 0xC4CEB9FE1A85EC53ull;
+  return hash ^ (hash >> 33);
+}
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::MappedCache(const std::string & path, SizeType capacity, MapMode mode, const _Hash & hash, const _KeyEqual & keyEqual) :
+  fd_(-1),
+  map_(nullptr),
+  mapSize_(0),
+  readOnly_(mode == MapMode::READ_ONLY),
+  reopened_(false),
+  header_(nullptr),
+  slots_(nullptr),
+  buckets_(nullptr),
+  hash_(hash),
+  keyEqual_(keyEqual)
+{
+  fd_ = ::open(path.c_str(), readOnly_ ? O_RDONLY : O_RDWR | O_CREAT, 0644);
+  struct stat status;
+  if (fd_ < 0 || ::fstat(fd_, &status) != 0)
+  {
+    close();
+    return;
+  }
+  const SizeType fileBytes = static_cast<SizeType>(status.st_size);
+  if (fileBytes >= Internal::MAPPED_HEADER_SIZE && map(fileBytes) && matches(fileBytes) && (readOnly_ || header_->capacity_ == capacity))
+  {
+    reopened_ = header_->state_ == Internal::MAPPED_CLEAN || verify();
+    if (reopened_ || !readOnly_)
+    {
+      if (!reopened_)
+        reset(header_->capacity_, header_->buckets_);
+      return;
+    }
+  }
+  if (readOnly_ || capacity >= Internal::MAPPED_NIL)
+  {
+    close();
+    return;
+  }
+  // Not a cache of this type and capacity: start over
+  if (map_ != nullptr)
+    ::munmap(map_, mapSize_);
+  map_ = nullptr;
+  SizeType buckets = 1;
+  while (buckets < capacity)
+    buckets *= 2;
+  const SizeType bytes = fileSize(capacity, buckets);
+  if (::ftruncate(fd_, 0) != 0 || ::ftruncate(fd_, static_cast<off_t>(bytes)) != 0 || !map(bytes))
+  {
+    close();
+    return;
+  }
+  reset(capacity, buckets);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::~MappedCache()
+{
+  flush();
+  close();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::is_open() const
+{
+  return map_ != nullptr;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::reopened() const
+{
+  return reopened_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::capacity() const
+{
+  return map_ == nullptr ? 0 : static_cast<SizeType>(header_->capacity_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::size() const
+{
+  return map_ == nullptr ? 0 : header_->size_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::flush()
+{
+  if (map_ == nullptr || readOnly_)
+    return false;
+  if (header_->state_ == Internal::MAPPED_CLEAN)
+    return true;
+  // The entries must be on disk before the header says they are consistent
+  if (::msync(map_, mapSize_, MS_SYNC) != 0)
+    return false;
+  header_->state_ = Internal::MAPPED_CLEAN;
+  return ::msync(map_, Internal::MAPPED_HEADER_SIZE, MS_SYNC) == 0;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, const _ValueT & value)
+{
+  if (map_ == nullptr || readOnly_ || header_->capacity_ == 0)
+    return;
+  touch();
+  const IndexT hash  = hashOf(key);
+  IndexT       index = *find(hash, key);
+  if (index != Internal::MAPPED_NIL)
+  {
+    slots_[index].value_ = value;
+    slots_[index].check_ = Internal::mappedChecksum(slots_[index]);
+    toFront(index);
+    return;
+  }
+  index = header_->free_;
+  if (index == Internal::MAPPED_NIL)
+  {
+    // Reuse the slot of the least recently used entry in place
+    index = header_->tail_;
+    unchain(index);
+    unlink(index);
+  }
+  else
+  {
+    header_->free_ = slots_[index].next_;
+    ++header_->size_;
+  }
+  SlotT & slot = slots_[index];
+  slot.key_   = key;
+  slot.value_ = value;
+  slot.check_ = Internal::mappedChecksum(slot);
+  IndexT & bucket = buckets_[hash & (header_->buckets_ - 1)];
+  slot.hash_  = hash;
+  slot.chain_ = bucket;
+  bucket      = index;
+  linkFront(index);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::remove(const _KeyT & key)
+{
+  if (map_ == nullptr || readOnly_)
+    return false;
+  IndexT * link  = const_cast<IndexT *>(find(hashOf(key), key));
+  IndexT   index = *link;
+  if (index == Internal::MAPPED_NIL)
+    return false;
+  touch();
+  SlotT & slot = slots_[index];
+  *link = slot.chain_;
+  unlink(index);
+  slot.next_     = header_->free_;
+  header_->free_ = index;
+  --header_->size_;
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::clear()
+{
+  if (map_ == nullptr || readOnly_)
+    return;
+  touch();
+  reset(header_->capacity_, header_->buckets_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+_ValueT * MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key)
+{
+  if (map_ == nullptr || readOnly_)
+    return nullptr;
+  const IndexT index = *find(hashOf(key), key);
+  if (index == Internal::MAPPED_NIL)
+    return nullptr;
+  if (header_->head_ != index)
+  {
+    touch();
+    toFront(index);
+  }
+  return &(slots_[index].value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+const _ValueT * MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key) const
+{
+  if (map_ == nullptr)
+    return nullptr;
+  const IndexT index = *find(hashOf(key), key);
+  if (index == Internal::MAPPED_NIL)
+    return nullptr;
+  return &(slots_[index].value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::contains(const _KeyT & key) const
+{
+  return get(key) != nullptr;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::verify() const
+{
+  if (map_ == nullptr)
+    return false;
+  const IndexT capacity = static_cast<IndexT>(header_->capacity_);
+  const IndexT size     = header_->size_;
+  if (size > capacity)
+    return false;
+  // 0: not seen yet, 1: in the LRU list, 2: also found in its hash chain, 3: free
+  std::vector<std::uint8_t> seen(capacity, 0);
+  IndexT count = 0;
+  IndexT prev  = Internal::MAPPED_NIL;
+  for (IndexT index = header_->head_; index != Internal::MAPPED_NIL; index = slots_[index].next_)
+  {
+    if (index >= capacity || seen[index] != 0 || slots_[index].prev_ != prev || ++count > size)
+      return false;
+    if (slots_[index].check_ != Internal::mappedChecksum(slots_[index]) || slots_[index].hash_ != hashOf(slots_[index].key_))
+      return false;
+    seen[index] = 1;
+    prev = index;
+  }
+  if (count != size || header_->tail_ != prev)
+    return false;
+  for (IndexT index = header_->free_; index != Internal::MAPPED_NIL; index = slots_[index].next_)
+  {
+    if (index >= capacity || seen[index] != 0)
+      return false;
+    seen[index] = 3;
+    ++count;
+  }
+  if (count != capacity)
+    return false;
+  IndexT chained = 0;
+  for (std::uint64_t bucket = 0; bucket < header_->buckets_; ++bucket)
+  {
+    for (IndexT index = buckets_[bucket]; index != Internal::MAPPED_NIL; index = slots_[index].chain_)
+    {
+      if (index >= capacity || seen[index] != 1 || (slots_[index].hash_ & (header_->buckets_ - 1)) != bucket)
+        return false;
+      seen[index] = 2;
+      ++chained;
+    }
+  }
+  return chained == size;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::fileSize(SizeType capacity, SizeType buckets)
+{
+  return Internal::MAPPED_HEADER_SIZE + capacity * sizeof(SlotT) + buckets * sizeof(IndexT);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::matches(SizeType fileBytes) const
+{
+  const Internal::MappedHeader & header = *header_;
+  const std::uint64_t buckets = header.buckets_;
+  return header.magic_ == Internal::MAPPED_MAGIC && header.version_ == Internal::MAPPED_VERSION &&
+         header.keySize_ == sizeof(_KeyT) && header.valueSize_ == sizeof(_ValueT) && header.slotSize_ == sizeof(SlotT) &&
+         header.capacity_ < Internal::MAPPED_NIL && buckets >= header.capacity_ && (buckets & (buckets - 1)) == 0 &&
+         fileSize(static_cast<SizeType>(header.capacity_), static_cast<SizeType>(buckets)) == fileBytes;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::map(SizeType bytes)
+{
+  void * address = ::mmap(nullptr, bytes, readOnly_ ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (address == MAP_FAILED)
+    return false;
+  map_     = static_cast<char *>(address);
+  mapSize_ = bytes;
+  header_  = reinterpret_cast<Internal::MappedHeader *>(map_);
+  slots_   = reinterpret_cast<SlotT *>(map_ + Internal::MAPPED_HEADER_SIZE);
+  buckets_ = nullptr;
+  if (bytes >= Internal::MAPPED_HEADER_SIZE + header_->capacity_ * sizeof(SlotT))
+    buckets_ = reinterpret_cast<IndexT *>(map_ + Internal::MAPPED_HEADER_SIZE + header_->capacity_ * sizeof(SlotT));
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::close()
+{
+  if (map_ != nullptr)
+    ::munmap(map_, mapSize_);
+  if (fd_ >= 0)
+    ::close(fd_);
+  fd_      = -1;
+  map_     = nullptr;
+  mapSize_ = 0;
+  header_  = nullptr;
+  slots_   = nullptr;
+  buckets_ = nullptr;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::reset(SizeType capacity, SizeType buckets)
+{
+  header_->magic_     = Internal::MAPPED_MAGIC;
+  header_->version_   = Internal::MAPPED_VERSION;
+  header_->keySize_   = sizeof(_KeyT);
+  header_->valueSize_ = sizeof(_ValueT);
+  header_->slotSize_  = sizeof(SlotT);
+  header_->state_     = Internal::MAPPED_DIRTY;
+  header_->capacity_  = capacity;
+  header_->buckets_   = buckets;
+  header_->head_      = Internal::MAPPED_NIL;
+  header_->tail_      = Internal::MAPPED_NIL;
+  header_->free_      = capacity == 0 ? Internal::MAPPED_NIL : 0;
+  header_->size_      = 0;
+  slots_   = reinterpret_cast<SlotT *>(map_ + Internal::MAPPED_HEADER_SIZE);
+  buckets_ = reinterpret_cast<IndexT *>(map_ + Internal::MAPPED_HEADER_SIZE + capacity * sizeof(SlotT));
+  for (SizeType index = 0; index < capacity; ++index)
+    slots_[index].next_ = static_cast<IndexT>(index + 1 < capacity ? index + 1 : Internal::MAPPED_NIL);
+  for (SizeType bucket = 0; bucket < buckets; ++bucket)
+    buckets_[bucket] = Internal::MAPPED_NIL;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::touch()
+{
+  if (header_->state_ == Internal::MAPPED_DIRTY)
+    return;
+  header_->state_ = Internal::MAPPED_DIRTY;
+  ::msync(map_, Internal::MAPPED_HEADER_SIZE, MS_SYNC);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::IndexT MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::hashOf(const _KeyT & key) const
+{
+  // NOTE: std::hash is the identity for integers, so keys with a common
+  // stride would share their low bits and a few chains without mixing
+  std::uint64_t hash = static_cast<std::uint64_t>(hash_(key));
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDull;
+  hash ^= hash >> 33;
+  return static_cast<IndexT>(hash);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+const typename MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::IndexT * MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::find(IndexT hash, const _KeyT & key) const
+{
+  static const IndexT nil = Internal::MAPPED_NIL;
+  if (header_->buckets_ == 0)
+    return &nil;
+  const IndexT * link = &buckets_[hash & (header_->buckets_ - 1)];
+  while (*link != Internal::MAPPED_NIL)
+  {
+    const SlotT & slot = slots_[*link];
+    if (slot.hash_ == hash && keyEqual_(slot.key_, key))
+      break;
+    link = &slot.chain_;
+  }
+  return link;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::unchain(IndexT index)
+{
+  IndexT * link = &buckets_[slots_[index].hash_ & (header_->buckets_ - 1)];
+  while (*link != index)
+    link = &slots_[*link].chain_;
+  *link = slots_[index].chain_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::unlink(IndexT index)
+{
+  SlotT & slot = slots_[index];
+  if (slot.prev_ == Internal::MAPPED_NIL)
+    header_->head_ = slot.next_;
+  else
+    slots_[slot.prev_].next_ = slot.next_;
+  if (slot.next_ == Internal::MAPPED_NIL)
+    header_->tail_ = slot.prev_;
+  else
+    slots_[slot.next_].prev_ = slot.prev_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::linkFront(IndexT index)
+{
+  SlotT & slot = slots_[index];
+  slot.prev_ = Internal::MAPPED_NIL;
+  slot.next_ = header_->head_;
+  if (header_->head_ == Internal::MAPPED_NIL)
+    header_->tail_ = index;
+  else
+    slots_[header_->head_].prev_ = index;
+  header_->head_ = index;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void MappedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::toFront(IndexT index)
+{
+  if (header_->head_ == index)
+    return;
+  unlink(index);
+  linkFront(index);
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // MAPPED_LRU_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
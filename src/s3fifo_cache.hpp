@@ -0,0 +1,405 @@
+//----------------------------------------------------------------------------
+#ifndef S3FIFO_CACHE_HPP
+#define S3FIFO_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <functional>
+#include <unordered_map>
+//----------------------------------------------------------------------------
+#include "slot_table.hpp"
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+struct S3FifoMeta
+{
+  mutable std::atomic<std::uint8_t> frequency_{0};  ///< 2-bit access counter, bumped by hits and decayed by the main queue.
+  std::uint32_t                     generation_{0}; ///< Bumped whenever the slot is freed, so that its older queue items are stale.
+}; // struct S3FifoMeta
+//----------------------------------------------------------------------------
+struct S3FifoItem
+{
+  std::uint32_t slot_;
+  std::uint32_t generation_; ///< Generation of the slot when the item was queued.
+}; // struct S3FifoItem
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Thread-safe cache with the S3-FIFO policy.
+ *
+ * Three FIFO queues and no reordering on hits: a hit only bumps a saturating
+ * 2-bit counter of the entry. Entries live in an `Internal::SlotTable`, so
+ * lookups take no lock, and writers are serialized by a mutex.
+ * New keys enter the small queue (10% of the capacity). When the small queue
+ * is evicted from, entries that were hit move to the main queue and the others
+ * leave the cache, with their key remembered in the ghost queue. Keys found in
+ * the ghost queue are inserted straight into the main queue. The main queue is
+ * a CLOCK: an entry with a non-zero counter is reinserted with the counter
+ * decremented. This quickly demotes one-hit wonders while keeping the hit
+ * ratio of LRU or better on skewed workloads. A removed entry leaves its queue
+ * item behind, tagged with the generation of its slot, and eviction drops it.
+ *
+ * Values are returned by copy, like in `LRUCache::ClockCache`.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+class S3FifoCache
+{
+//----------------------------------------------------------------------------
+  using TableT    = Internal::SlotTable<_KeyT, _ValueT, Internal::S3FifoMeta, _Hash, _KeyEqual>; ///< Entry storage and index.
+  using SizeType  = typename TableT::SizeType; ///< Type representing the size of the cache.
+  using IndexT    = typename TableT::IndexT; ///< Type of a slot index.
+  using SlotT     = typename TableT::SlotT; ///< Type of an entry slot.
+  using ItemT     = Internal::S3FifoItem; ///< Queue item.
+  using GhostMapT = std::unordered_map<_KeyT, std::uint64_t, _Hash, _KeyEqual>; ///< Ghost key to its latest sequence number.
+//----------------------------------------------------------------------------
+public:
+  /**
+   * @brief Constructs an S3FifoCache and reserves all of its slots.
+   *
+   * @param capacity The maximum number of items that the cache can hold,
+   *                 at most 2^32 - 2.
+   */
+  S3FifoCache(SizeType capacity);
+  S3FifoCache(const S3FifoCache &) = delete;
+  S3FifoCache & operator =(const S3FifoCache &) = delete;
+  /**
+   * @brief Retrieves the current capacity of the cache.
+   *
+   * @return The maximum number of items that the cache can hold.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the current number of items in the cache.
+   *
+   * @return The number of items currently stored in the cache.
+   */
+  SizeType size() const;
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be moved into the cache.
+   */
+  void put(const _KeyT & key, _ValueT && value);
+  /**
+   * @brief Constructs and inserts a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be constructed and inserted or updated.
+   * @param args The arguments used to construct the value.
+   */
+  template<class ...Args>
+  void emplace(const _KeyT & key, Args && ...args);
+  /**
+   * @brief Removes the value associated with the specified key from the cache.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears all items and the ghost history from the cache.
+   */
+  void clear();
+  /**
+   * @brief Copies the value associated with the specified key and bumps its
+   *        access counter. Takes no lock.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @param value Receives a copy of the value if the key is found.
+   * @return True if the key was found, false otherwise.
+   */
+  bool get(const _KeyT & key, _ValueT & value) const;
+  /**
+   * @brief Checks if the cache contains a value associated with the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not bump the access counter
+   */
+  bool contains(const _KeyT & key) const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Replaces the value of an entry and bumps its access counter.
+   *        Requires `mutex_`.
+   */
+  template<class _V>
+  void update(IndexT index, _V && value);
+  /**
+   * @brief Stores a new entry in a free slot, evicting if the cache is full.
+   *        Requires `mutex_`.
+   */
+  template<class ...Args>
+  void insert(const _KeyT & key, SizeType hash, Args && ...args);
+  /**
+   * @brief Evicts one entry and returns its slot. Requires `mutex_`.
+   */
+  IndexT evict();
+  /**
+   * @brief Removes the entry of a slot and makes its queue items stale.
+   *        Requires `mutex_`.
+   */
+  void release(IndexT index);
+  /**
+   * @brief Remembers the key of an entry evicted from the small queue.
+   */
+  void remember(const _KeyT & key);
+  /**
+   * @brief Bumps the access counter of a slot, saturating at 3.
+   */
+  static void touch(const SlotT & slot);
+//----------------------------------------------------------------------------
+  TableT                    table_;         ///< Entry storage, with its lock-free index.
+  SizeType                  smallCapacity_; ///< Target size of the small queue.
+  std::vector<IndexT>       free_;          ///< Unoccupied slots.
+  std::deque<ItemT>         small_;         ///< Small FIFO, oldest first.
+  std::deque<ItemT>         main_;          ///< Main FIFO, oldest first.
+  std::deque<std::pair<_KeyT, std::uint64_t>> ghostQueue_; ///< Ghost FIFO, oldest first.
+  GhostMapT                 ghosts_;        ///< Keys in the ghost FIFO.
+  std::uint64_t             ghostSequence_; ///< Sequence number of the next ghost.
+  mutable std::mutex        mutex_;         ///< Serializes the writers; readers take no lock.
+//----------------------------------------------------------------------------
+}; // class S3FifoCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::S3FifoCache(SizeType capacity) :
+  table_(capacity),
+  smallCapacity_(table_.capacity() / 10 == 0 ? 1 : table_.capacity() / 10),
+  ghostSequence_(0)
+{
+  free_.reserve(table_.capacity());
+  for (SizeType index = table_.capacity(); index > 0; --index)
+    free_.push_back(static_cast<IndexT>(index - 1));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::capacity() const
+{
+  return table_.capacity();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::size() const
+{
+  return table_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, const _ValueT & value)
+{
+  const SizeType hash = table_.hash(key);
+  std::lock_guard<std::mutex> lock(mutex_);
+  const IndexT index = table_.find(key, hash);
+  if (index == Internal::TABLE_NIL)
+    insert(key, hash, value);
+  else
+    update(index, value);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, _ValueT && value)
+{
+  const SizeType hash = table_.hash(key);
+  std::lock_guard<std::mutex> lock(mutex_);
+  const IndexT index = table_.find(key, hash);
+  if (index == Internal::TABLE_NIL)
+    insert(key, hash, std::forward<_ValueT>(value));
+  else
+    update(index, std::forward<_ValueT>(value));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::emplace(const _KeyT & key, Args && ...args)
+{
+  const SizeType hash = table_.hash(key);
+  std::lock_guard<std::mutex> lock(mutex_);
+  const IndexT index = table_.find(key, hash);
+  if (index == Internal::TABLE_NIL)
+    insert(key, hash, std::forward<Args>(args)...);
+  else
+    update(index, _ValueT(std::forward<Args>(args)...));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::remove(const _KeyT & key)
+{
+  const SizeType hash = table_.hash(key);
+  std::lock_guard<std::mutex> lock(mutex_);
+  const IndexT index = table_.find(key, hash);
+  if (index == Internal::TABLE_NIL)
+    return false;
+  // NOTE: the slot can be reused at once; its queue item is stale and
+  // dropped when it reaches the front
+  release(index);
+  free_.push_back(index);
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  table_.clear();
+  small_.clear();
+  main_.clear();
+  ghostQueue_.clear();
+  ghosts_.clear();
+  free_.clear();
+  for (SizeType index = table_.capacity(); index > 0; --index)
+    free_.push_back(static_cast<IndexT>(index - 1));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key, _ValueT & value) const
+{
+  return table_.lookup(key, [&value](const SlotT & slot, const _ValueT & found)
+  {
+    touch(slot);
+    value = found;
+  });
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::contains(const _KeyT & key) const
+{
+  return table_.lookup(key, [](const SlotT &, const _ValueT &) {});
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class _V>
+void S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::update(IndexT index, _V && value)
+{
+  table_.assign(index, std::forward<_V>(value));
+  touch(table_[index]);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::insert(const _KeyT & key, SizeType hash, Args && ...args)
+{
+  if (table_.capacity() == 0)
+    return;
+  if (free_.empty())
+    free_.push_back(evict());
+  const IndexT index = free_.back();
+  table_.insert(index, key, hash, std::forward<Args>(args)...);
+  free_.pop_back();
+  SlotT & slot = table_[index];
+  slot.frequency_.store(0, std::memory_order_relaxed);
+  const ItemT item{index, slot.generation_};
+  auto ghost = ghosts_.find(key);
+  if (ghost == ghosts_.end())
+  {
+    small_.push_back(item);
+    return;
+  }
+  // NOTE: the stale ghost queue item is skipped once it reaches the front
+  ghosts_.erase(ghost);
+  main_.push_back(item);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::IndexT S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::evict()
+{
+  while (true)
+  {
+    const bool fromSmall = !small_.empty() && (small_.size() >= smallCapacity_ || main_.empty());
+    std::deque<ItemT> & queue = fromSmall ? small_ : main_;
+    const ItemT item = queue.front();
+    queue.pop_front();
+    SlotT & slot = table_[item.slot_];
+    if (item.generation_ != slot.generation_)
+      continue;
+    const std::uint8_t frequency = slot.frequency_.load(std::memory_order_relaxed);
+    if (fromSmall)
+    {
+      if (frequency > 0)
+      {
+        slot.frequency_.store(0, std::memory_order_relaxed);
+        main_.push_back(item);
+        continue;
+      }
+      remember(slot.key_);
+    }
+    else if (frequency > 0)
+    {
+      slot.frequency_.store(frequency - 1, std::memory_order_relaxed);
+      main_.push_back(item);
+      continue;
+    }
+    release(item.slot_);
+    return item.slot_;
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::release(IndexT index)
+{
+  table_.erase(index);
+  ++table_[index].generation_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::remember(const _KeyT & key)
+{
+  // The ghost queue holds as many keys as the main queue holds entries
+  const SizeType ghostCapacity = table_.capacity() - smallCapacity_;
+  if (ghostCapacity == 0)
+    return;
+  if (ghostQueue_.size() == ghostCapacity)
+  {
+    auto oldest = ghosts_.find(ghostQueue_.front().first);
+    if (oldest != ghosts_.end() && oldest->second == ghostQueue_.front().second)
+      ghosts_.erase(oldest);
+    ghostQueue_.pop_front();
+  }
+  ghostQueue_.emplace_back(key, ghostSequence_);
+  ghosts_[key] = ghostSequence_++;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void S3FifoCache<_KeyT, _ValueT, _Hash, _KeyEqual>::touch(const SlotT & slot)
+{
+  // NOTE: a racing hit may be lost, the counter is only a hint
+  const std::uint8_t frequency = slot.frequency_.load(std::memory_order_relaxed);
+  if (frequency < 3)
+    slot.frequency_.store(frequency + 1, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // S3FIFO_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
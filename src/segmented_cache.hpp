@@ -0,0 +1,362 @@
+//----------------------------------------------------------------------------
+#ifndef SEGMENTED_CACHE_HPP
+#define SEGMENTED_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <list>
+#include <tuple>
+#include <cstddef>
+#include <utility>
+#include <functional>
+#include <unordered_map>
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+template<class _IteratorT, class _ValueT>
+struct SegmentedEntry
+{
+//----------------------------------------------------------------------------
+  _IteratorT it_;         ///< Position of the key in the list of its segment.
+  bool       protected_;  ///< True if the entry is in the protected segment.
+  _ValueT    value_;
+//----------------------------------------------------------------------------
+  template<class ...Args>
+  SegmentedEntry(const _IteratorT & it, Args && ...args);
+//----------------------------------------------------------------------------
+}; // struct SegmentedEntry
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Segmented LRU (SLRU) cache that protects hot entries from scans.
+ *
+ * New entries are admitted to a probationary segment. A second hit promotes
+ * an entry to the protected segment, whose overflow is demoted back to the
+ * front of probation. Evictions always take the least recently used entry of
+ * probation (protected only once probation is empty), so a scan of keys that
+ * are requested once only cycles through probation and leaves the protected
+ * hot set in place.
+ *
+ * The API mirrors `LRUCache::Cache`.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+class SegmentedCache
+{
+//----------------------------------------------------------------------------
+  using SizeType = std::size_t; ///< Type representing the size of the cache.
+  using ListT    = std::list<_KeyT>; ///< LRU order of the keys of a segment, most recent first.
+  using EntryT   = Internal::SegmentedEntry<typename ListT::iterator, _ValueT>;
+  using MapT     = std::unordered_map<_KeyT, EntryT, _Hash, _KeyEqual>;
+//----------------------------------------------------------------------------
+public:
+  /**
+   * @brief Default constructor for the SegmentedCache class.
+   *
+   * Initializes an empty cache with the default capacity.
+   */
+  SegmentedCache();
+  /**
+   * @brief Constructs a SegmentedCache with a specified capacity.
+   *
+   * @param capacity The maximum number of items that the cache can hold.
+   * @param protectedRatio Share of the capacity reserved for the protected
+   *                       segment, clamped to [0, 1]. With 0 the cache is plain
+   *                       LRU, the default 0.8 leaves 20% for new entries.
+   */
+  SegmentedCache(SizeType capacity, double protectedRatio = 0.8);
+  SegmentedCache(const SegmentedCache &) = delete;
+  SegmentedCache & operator =(const SegmentedCache &) = delete;
+  /**
+   * @brief Retrieves the current capacity of the cache.
+   *
+   * @return The maximum number of items that the cache can hold.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the maximum number of items in the protected segment.
+   */
+  SizeType protected_capacity() const;
+  /**
+   * @brief Retrieves the current number of items in the cache.
+   *
+   * @return The number of items currently stored in the cache.
+   */
+  SizeType size() const;
+  /**
+   * @brief Retrieves the current number of items in the protected segment.
+   */
+  SizeType protected_size() const;
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * A new key is admitted to probation. Updating a key counts as a hit.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be moved into the cache.
+   */
+  void put(const _KeyT & key, _ValueT && value);
+  /**
+   * @brief Constructs and inserts a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be constructed and inserted or updated.
+   * @param args The arguments used to construct the value.
+   */
+  template<class ...Args>
+  void emplace(const _KeyT & key, Args && ...args);
+  /**
+   * @brief Removes the value associated with the specified key from the cache.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears all items from the cache.
+   */
+  void clear();
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key,
+   *        promoting it to the protected segment.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache.
+   */
+  _ValueT * get(const _KeyT & key);
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache.
+   * @note Does not update position of the associated value
+   */
+  const _ValueT * get(const _KeyT & key) const;
+  /**
+   * @brief Checks if the cache contains a value associated with the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not update position of the associated value
+   */
+  bool contains(const _KeyT & key) const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Shared implementation of put and emplace.
+   */
+  template<class ...Args>
+  void store(const _KeyT & key, Args && ...args);
+  /**
+   * @brief Moves an entry to the front of the protected segment, demoting the
+   *        protected overflow to probation.
+   */
+  void touch(EntryT & entry);
+  ListT & segment(const EntryT & entry);
+//----------------------------------------------------------------------------
+  SizeType capacity_;          ///< The maximum number of items that the cache can hold.
+  SizeType protectedCapacity_; ///< The maximum number of items in the protected segment.
+  ListT    probation_;         ///< Entries hit once since they were admitted or demoted.
+  ListT    protected_;         ///< Entries hit at least twice.
+  MapT     map_;               ///< The map used for fast key-value lookups.
+//----------------------------------------------------------------------------
+}; // class SegmentedCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+template<class _IteratorT, class _ValueT>
+template<class ...Args>
+SegmentedEntry<_IteratorT, _ValueT>::SegmentedEntry(const _IteratorT & it, Args && ...args) :
+  it_(it),
+  protected_(false),
+  value_(std::forward<Args>(args)...)
+{
+}
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SegmentedCache() :
+  SegmentedCache(0)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SegmentedCache(SizeType capacity, double protectedRatio) :
+  capacity_(capacity),
+  protectedCapacity_(protectedRatio <= 0.0 ? 0 : protectedRatio >= 1.0 ? capacity : static_cast<SizeType>(capacity * protectedRatio))
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::capacity() const
+{
+  return capacity_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::protected_capacity() const
+{
+  return protectedCapacity_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::size() const
+{
+  return map_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::protected_size() const
+{
+  return protected_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, const _ValueT & value)
+{
+  store(key, value);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, _ValueT && value)
+{
+  store(key, std::move(value));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::emplace(const _KeyT & key, Args && ...args)
+{
+  store(key, std::forward<Args>(args)...);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::remove(const _KeyT & key)
+{
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return false;
+  segment(it->second).erase(it->second.it_);
+  map_.erase(it);
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::clear()
+{
+  probation_.clear();
+  protected_.clear();
+  map_.clear();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+_ValueT * SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key)
+{
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return nullptr;
+  touch(it->second);
+  return &(it->second.value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+const _ValueT * SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key) const
+{
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return nullptr;
+  return &(it->second.value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::contains(const _KeyT & key) const
+{
+  return map_.find(key) != map_.end();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::store(const _KeyT & key, Args && ...args)
+{
+  if (capacity_ == 0)
+    return;
+  auto it = map_.find(key);
+  if (it != map_.end())
+  {
+    it->second.value_ = _ValueT(std::forward<Args>(args)...);
+    touch(it->second);
+    return;
+  }
+  if (map_.size() == capacity_)
+  {
+    ListT & victims = probation_.empty() ? protected_ : probation_;
+    map_.erase(victims.back());
+    victims.pop_back();
+  }
+  probation_.push_front(key);
+  try
+  {
+    map_.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(probation_.begin(), std::forward<Args>(args)...));
+  }
+  catch (...)
+  {
+    probation_.pop_front();
+    throw;
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::touch(EntryT & entry)
+{
+  if (protectedCapacity_ == 0)
+  {
+    probation_.splice(probation_.begin(), probation_, entry.it_);
+    return;
+  }
+  protected_.splice(protected_.begin(), segment(entry), entry.it_);
+  if (entry.protected_)
+    return;
+  entry.protected_ = true;
+  if (protected_.size() > protectedCapacity_)
+  {
+    auto & demoted = map_.find(protected_.back())->second;
+    probation_.splice(probation_.begin(), protected_, demoted.it_);
+    demoted.protected_ = false;
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::ListT & SegmentedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::segment(const EntryT & entry)
+{
+  return entry.protected_ ? protected_ : probation_;
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // SEGMENTED_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,800 @@
+//----------------------------------------------------------------------------
+#ifndef SHARDED_LRU_CACHE_HPP
+#define SHARDED_LRU_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+#if __cplusplus >= 202002L
+#include <span>
+#include <optional>
+#endif
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+/**
+ * @brief The cache of a shard: `_CacheT` itself, unless it is a `Cache`, which
+ *        is given the statistics policy of the sharded cache so that it counts
+ *        its own operations.
+ */
+template<class _CacheT, class _StatsT>
+struct ShardCache
+{
+  using type = _CacheT;
+  static constexpr bool counts = false; ///< Whether `type` collects the counters itself.
+};
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _ListT, class _MapT, class _WeigherT, template<class> class _PolicyT, class _CacheStatsT, class _StatsT>
+struct ShardCache<Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _CacheStatsT>, _StatsT>
+{
+  using type = Cache<_KeyT, _ValueT, _ListT, _MapT, _WeigherT, _PolicyT, _StatsT>;
+  static constexpr bool counts = true;
+};
+//----------------------------------------------------------------------------
+/**
+ * @brief Background thread that passes batches of removals to a listener,
+ *        in the order they were posted.
+ */
+template<class _KeyT, class _ValueT>
+class RemovalDispatcher
+{
+//----------------------------------------------------------------------------
+  using BatchT = std::vector<Removal<_KeyT, _ValueT>>;
+//----------------------------------------------------------------------------
+public:
+  explicit RemovalDispatcher(RemovalListener<_KeyT, _ValueT> listener);
+  RemovalDispatcher(const RemovalDispatcher &) = delete;
+  RemovalDispatcher & operator =(const RemovalDispatcher &) = delete;
+  /**
+   * @brief Delivers the batches already posted, then stops the thread.
+   */
+  ~RemovalDispatcher();
+  /**
+   * @brief Queues a batch for the thread.
+   */
+  void post(BatchT && batch);
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  void run();
+//----------------------------------------------------------------------------
+  RemovalListener<_KeyT, _ValueT> listener_;
+  std::mutex                      mutex_;
+  std::condition_variable         ready_;
+  std::deque<BatchT>              batches_;
+  bool                            stopping_;
+  std::thread                     thread_; ///< Started last, after the members it uses.
+//----------------------------------------------------------------------------
+}; // class RemovalDispatcher
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Counters aggregated over all shards of a ShardedCache.
+ */
+using ShardedCacheStats = CacheStats;
+//----------------------------------------------------------------------------
+/**
+ * @brief Thread-safe cache that splits keys across independently locked shards.
+ *
+ * Every key is hashed to one of N shards. Each shard is a separate `_CacheT`
+ * guarded by its own mutex, so threads working on different shards never
+ * contend. The total capacity is split evenly across the shards, which means
+ * eviction is LRU within a shard rather than across the whole cache.
+ *
+ * Values are returned by copy, because a pointer into a shard would outlive
+ * the shard lock.
+ *
+ * If `_CacheT` is a `Cache`, each shard is that `Cache` with `_StatsT` as its
+ * statistics policy, and it counts its own hits, misses and writes.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _CacheT The single-threaded cache used for each shard.
+ *                 Defaults to `::LRUCache::Cache<_KeyT, _ValueT>`.
+ * @tparam _Hash The hash function used to pick a shard. Defaults to `std::hash<_KeyT>`.
+ * @tparam _StatsT Statistics policy of every shard. Defaults to
+ *                 `::LRUCache::AtomicStats`; `::LRUCache::NoStats` disables `stats`.
+ */
+template<class _KeyT, class _ValueT, class _CacheT = ::LRUCache::Cache<_KeyT, _ValueT>, class _Hash = std::hash<_KeyT>, class _StatsT = ::LRUCache::AtomicStats>
+class ShardedCache
+{
+//----------------------------------------------------------------------------
+  using SizeType = std::size_t; ///< Type representing the size of the cache.
+  using ShardCacheT = typename Internal::ShardCache<_CacheT, _StatsT>::type; ///< The cache of every shard.
+//----------------------------------------------------------------------------
+  /// Whether the shard caches count all but the loads; `Shard::stats_` counts the rest.
+  static constexpr bool SHARD_COUNTS = Internal::ShardCache<_CacheT, _StatsT>::counts;
+//----------------------------------------------------------------------------
+  /**
+   * @brief A load in flight, see `get_or_load`.
+   */
+  struct Load
+  {
+    std::shared_future<_ValueT> result_;
+    bool                        written_; ///< The key was written since the load started, so its result is not cached.
+  };
+//----------------------------------------------------------------------------
+  /**
+   * @brief One independently locked part of the cache. Shards are aligned to
+   *        a cache line so that their mutexes do not share one.
+   */
+  struct alignas(64) Shard
+  {
+    mutable std::mutex mutex_;
+    ShardCacheT        cache_;
+    _StatsT            stats_; ///< Updated under `mutex_` only.
+    std::vector<Internal::Removal<_KeyT, _ValueT>> removed_; ///< Removals to deliver once `mutex_` is released.
+    std::unordered_map<_KeyT, Load, _Hash> loads_; ///< Loads in flight, by key.
+
+    Shard(SizeType capacity, const _Hash & hash);
+  };
+//----------------------------------------------------------------------------
+public:
+  /**
+   * @brief Returns the shard count used when none is specified: the smallest
+   *        power of two that is at least four times the number of hardware threads.
+   */
+  static SizeType defaultShardCount();
+  /**
+   * @brief Constructs a ShardedCache with a specified total capacity.
+   *
+   * @param capacity The maximum number of items that the cache can hold. It is
+   *                 split evenly across the shards.
+   * @param shardCount The number of shards. It is clamped to [1, capacity] so
+   *                   that every shard can hold at least one item.
+   * @param hash The hash function used to pick a shard.
+   */
+  ShardedCache(SizeType capacity, SizeType shardCount = defaultShardCount(), const _Hash & hash = _Hash());
+  ShardedCache(const ShardedCache &) = delete;
+  ShardedCache & operator =(const ShardedCache &) = delete;
+  /**
+   * @brief Retrieves the total capacity of the cache.
+   *
+   * @return The sum of the capacities of all shards.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the current number of items in the cache.
+   *
+   * The shards are locked one after another, so under concurrent writes the
+   * result is approximate.
+   *
+   * @return The number of items currently stored in all shards.
+   */
+  SizeType size() const;
+  /**
+   * @brief Retrieves the number of shards.
+   */
+  SizeType shards() const;
+  /**
+   * @brief Retrieves the counters summed over all shards.
+   *
+   * Every shard is locked while the counters are read, so the snapshot is
+   * consistent: no operation is counted in one shard but not in another.
+   *
+   * @return The counters of the cache, all zero if `_StatsT` is `NoStats`.
+   */
+  ShardedCacheStats stats() const;
+  /**
+   * @brief Sets the function told about every entry that leaves the cache.
+   *
+   * The shard caches queue the entries they evict, remove or overwrite (see
+   * `Cache::set_removal_listener`), and the listener is called after the
+   * shard lock is released, so slow destructors of removed values never
+   * block other threads on the shard. Without `background`, the thread whose
+   * call removed the entries runs the listener before that call returns;
+   * with it, batches are handed to a dedicated thread, which delivers them
+   * in order and finishes the pending ones when the cache is destroyed.
+   *
+   * Not thread-safe: set the listener before sharing the cache between threads.
+   * `_CacheT` must provide `set_removal_listener`.
+   *
+   * @param listener The callback, or an empty function to remove it.
+   * @param background Whether to call the listener on a background thread.
+   */
+  void set_removal_listener(RemovalListener<_KeyT, _ValueT> listener, bool background = false);
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be moved into the cache.
+   */
+  void put(const _KeyT & key, _ValueT && value);
+  /**
+   * @brief Constructs and inserts a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be constructed and inserted or updated.
+   * @param args The arguments used to construct the value.
+   */
+  template<class ...Args>
+  void emplace(const _KeyT & key, Args && ...args);
+  /**
+   * @brief Removes the value associated with the specified key from the cache.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears all shards.
+   */
+  void clear();
+  /**
+   * @brief Copies the value associated with the specified key and marks it as
+   *        recently used within its shard.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @param value Receives a copy of the value if the key is found.
+   * @return True if the key was found, false otherwise.
+   */
+  bool get(const _KeyT & key, _ValueT & value);
+  /**
+   * @brief Returns a copy of the value associated with the specified key,
+   *        loading and inserting it on a miss.
+   *
+   * Concurrent misses on the same key are deduplicated: the first caller runs
+   * `loader(key)` without holding the shard lock, and the others wait for its
+   * result. If the loader throws, every waiting caller gets the exception and
+   * nothing is cached, so the next call loads again. If the key is put or
+   * removed while it loads, the loaded value is returned but not cached.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @param loader Callable `_ValueT(const _KeyT &)` producing a missing value.
+   * @return A copy of the cached or loaded value.
+   */
+  template<class _LoaderT>
+  _ValueT get_or_load(const _KeyT & key, _LoaderT && loader);
+  /**
+   * @brief Checks if the cache contains a value associated with the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not update position of the associated value
+   */
+  bool contains(const _KeyT & key) const;
+#if __cplusplus >= 202002L
+  /**
+   * @brief Copies the values of a batch of keys, like calling `get` for each.
+   *
+   * The keys are grouped by shard, and every shard involved is locked once
+   * for the whole batch rather than once per key.
+   *
+   * @param keys The keys to look up.
+   * @param values Receives, at the index of each key, a copy of its value or
+   *               `std::nullopt` if the key is not in the cache. Only the first
+   *               `min(keys.size(), values.size())` keys are looked up.
+   * @return The number of keys found.
+   */
+  SizeType multi_get(std::span<const _KeyT> keys, std::span<std::optional<_ValueT>> values);
+  /**
+   * @brief Inserts or updates a batch of entries, locking every shard involved once.
+   *
+   * Entries of the same shard are applied in batch order.
+   *
+   * @param entries The key-value pairs to be inserted or updated.
+   */
+  void multi_put(std::span<const std::pair<_KeyT, _ValueT>> entries);
+#endif
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Picks the index of the shard of the specified key.
+   */
+  SizeType shardIndex(const _KeyT & key) const;
+  /**
+   * @brief Picks the shard of the specified key.
+   */
+  Shard & shardFor(const _KeyT & key) const;
+  /**
+   * @brief Marks the load of `key` in the locked shard, if any, as written.
+   */
+  void written(Shard & shard, const _KeyT & key);
+  /**
+   * @brief Runs `put`, which inserts or updates `key` in the locked shard. If
+   *        the shard cache does not count its writes, records whether `put`
+   *        inserted or updated and how many entries it evicted.
+   */
+  template<class _PutT>
+  void store(Shard & shard, const _KeyT & key, _PutT && put);
+  /**
+   * @brief Takes the removals queued in a shard, unlocks it and delivers them.
+   */
+  void release(Shard & shard, std::unique_lock<std::mutex> & lock);
+  /**
+   * @brief Sorts the indices of a batch by shard, keeping the batch order
+   *        within a shard. The indices of shard `s` end up in
+   *        `order[starts[s]]` to `order[starts[s + 1] - 1]`.
+   *
+   * @param count The size of the batch.
+   * @param keyOf Returns the key at an index of the batch.
+   */
+  template<class _KeyOfT>
+  void groupByShard(SizeType count, _KeyOfT && keyOf, std::vector<SizeType> & order, std::vector<SizeType> & starts) const;
+//----------------------------------------------------------------------------
+  SizeType                            capacity_; ///< The maximum number of items that the cache can hold.
+  std::vector<std::unique_ptr<Shard>> shards_; ///< Independently locked shards.
+  _Hash                               hash_; ///< The hash function used to pick a shard.
+  RemovalListener<_KeyT, _ValueT>     listener_; ///< Told about removed entries, may be empty.
+  std::unique_ptr<Internal::RemovalDispatcher<_KeyT, _ValueT>> dispatcher_; ///< Calls `listener_` in the background, if requested.
+//----------------------------------------------------------------------------
+}; // class ShardedCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT>
+RemovalDispatcher<_KeyT, _ValueT>::RemovalDispatcher(RemovalListener<_KeyT, _ValueT> listener) :
+  listener_(std::move(listener)),
+  stopping_(false),
+  thread_(&RemovalDispatcher::run, this)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT>
+RemovalDispatcher<_KeyT, _ValueT>::~RemovalDispatcher()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_one();
+  thread_.join();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT>
+void RemovalDispatcher<_KeyT, _ValueT>::post(BatchT && batch)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batches_.push_back(std::move(batch));
+  }
+  ready_.notify_one();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT>
+void RemovalDispatcher<_KeyT, _ValueT>::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;)
+  {
+    ready_.wait(lock, [this]() { return stopping_ || !batches_.empty(); });
+    if (batches_.empty())
+      return;
+    BatchT batch = std::move(batches_.front());
+    batches_.pop_front();
+    lock.unlock();
+    notifyRemovals(batch, listener_);
+    lock.lock();
+  }
+}
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::Shard::Shard(SizeType capacity, const _Hash & hash) :
+  cache_(capacity),
+  loads_(0, hash)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+typename ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::SizeType ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::defaultShardCount()
+{
+  const SizeType threads = std::max<SizeType>(std::thread::hardware_concurrency(), 1);
+  SizeType count = 1;
+  while (count < 4 * threads)
+    count *= 2;
+  return count;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::ShardedCache(SizeType capacity, SizeType shardCount, const _Hash & hash) :
+  capacity_(capacity),
+  hash_(hash)
+{
+  shardCount = std::max<SizeType>(std::min(shardCount, capacity), 1);
+  shards_.reserve(shardCount);
+  for (SizeType i = 0; i < shardCount; ++i)
+    shards_.emplace_back(new Shard(capacity / shardCount + (i < capacity % shardCount ? 1 : 0), hash_));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+typename ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::SizeType ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::capacity() const
+{
+  return capacity_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+typename ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::SizeType ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::size() const
+{
+  SizeType size = 0;
+  for (const auto & shard : shards_)
+  {
+    std::lock_guard<std::mutex> lock(shard->mutex_);
+    size += shard->cache_.size();
+  }
+  return size;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+typename ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::SizeType ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::shards() const
+{
+  return shards_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+ShardedCacheStats ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::stats() const
+{
+  ShardedCacheStats stats = ShardedCacheStats();
+  if (!_StatsT::enabled)
+    return stats;
+  // NOTE: always locked in index order, and no other method holds two shard
+  // locks at once, so this cannot deadlock
+  std::vector<std::unique_lock<std::mutex>> locks;
+  locks.reserve(shards_.size());
+  for (const auto & shard : shards_)
+    locks.emplace_back(shard->mutex_);
+  for (const auto & shard : shards_)
+  {
+    stats += shard->stats_.snapshot();
+    if constexpr (SHARD_COUNTS)
+      stats += shard->cache_.stats();
+  }
+  return stats;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+void ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::set_removal_listener(RemovalListener<_KeyT, _ValueT> listener, bool background)
+{
+  for (auto & shard : shards_)
+  {
+    std::lock_guard<std::mutex> lock(shard->mutex_);
+    if (!listener)
+    {
+      shard->cache_.set_removal_listener(RemovalListener<_KeyT, _ValueT>());
+      continue;
+    }
+    // NOTE: called by the shard cache under the shard lock, so only queue
+    auto * removed = &shard->removed_;
+    shard->cache_.set_removal_listener([removed](_KeyT && key, _ValueT && value, RemovalCause cause)
+    {
+      removed->emplace_back(key, std::move(value), cause);
+    });
+  }
+  dispatcher_.reset();
+  listener_ = std::move(listener);
+  if (listener_ && background)
+    dispatcher_.reset(new Internal::RemovalDispatcher<_KeyT, _ValueT>(listener_));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+void ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::put(const _KeyT & key, const _ValueT & value)
+{
+  Shard & shard = shardFor(key);
+  std::unique_lock<std::mutex> lock(shard.mutex_);
+  store(shard, key, [&]() { shard.cache_.put(key, value); });
+  release(shard, lock);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+void ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::put(const _KeyT & key, _ValueT && value)
+{
+  Shard & shard = shardFor(key);
+  std::unique_lock<std::mutex> lock(shard.mutex_);
+  store(shard, key, [&]() { shard.cache_.put(key, std::forward<_ValueT>(value)); });
+  release(shard, lock);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+template<class ...Args>
+void ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::emplace(const _KeyT & key, Args && ...args)
+{
+  Shard & shard = shardFor(key);
+  std::unique_lock<std::mutex> lock(shard.mutex_);
+  store(shard, key, [&]() { shard.cache_.emplace(key, std::forward<Args>(args)...); });
+  release(shard, lock);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+bool ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::remove(const _KeyT & key)
+{
+  Shard & shard = shardFor(key);
+  std::unique_lock<std::mutex> lock(shard.mutex_);
+  written(shard, key);
+  if (!shard.cache_.remove(key))
+    return false;
+  if (!SHARD_COUNTS)
+    shard.stats_.record_removal();
+  release(shard, lock);
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+void ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::clear()
+{
+  for (auto & shard : shards_)
+  {
+    std::unique_lock<std::mutex> lock(shard->mutex_);
+    for (auto & load : shard->loads_)
+      load.second.written_ = true;
+    shard->cache_.clear();
+    release(*shard, lock);
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+bool ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::get(const _KeyT & key, _ValueT & value)
+{
+  Shard & shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex_);
+  const _ValueT * cached = shard.cache_.get(key);
+  if (cached == nullptr)
+  {
+    if (!SHARD_COUNTS)
+      shard.stats_.record_miss();
+    return false;
+  }
+  if (!SHARD_COUNTS)
+    shard.stats_.record_hit();
+  value = *cached;
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+template<class _LoaderT>
+_ValueT ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::get_or_load(const _KeyT & key, _LoaderT && loader)
+{
+  Shard & shard = shardFor(key);
+  std::unique_lock<std::mutex> lock(shard.mutex_);
+  const _ValueT * cached = shard.cache_.get(key);
+  if (cached != nullptr)
+  {
+    if (!SHARD_COUNTS)
+      shard.stats_.record_hit();
+    return *cached;
+  }
+  if (!SHARD_COUNTS)
+    shard.stats_.record_miss();
+  auto load = shard.loads_.find(key);
+  if (load != shard.loads_.end())
+  {
+    std::shared_future<_ValueT> result = load->second.result_;
+    lock.unlock();
+    return result.get();
+  }
+  std::promise<_ValueT> promise;
+  shard.loads_.emplace(key, Load{promise.get_future().share(), false});
+  lock.unlock();
+  const auto start = std::chrono::steady_clock::now();
+  // NOTE: only the loader is guarded; an exception thrown after it returned,
+  // e.g. by the removal listener, is not a failed load
+  _ValueT value = [&]() -> _ValueT
+  {
+    try
+    {
+      return loader(key);
+    }
+    catch (...)
+    {
+      // The key is not cached, so the next call runs the loader again
+      const auto time = std::chrono::steady_clock::now() - start;
+      lock.lock();
+      shard.stats_.record_load_failure(time);
+      shard.loads_.erase(key);
+      lock.unlock();
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+  }();
+  const auto time = std::chrono::steady_clock::now() - start;
+  lock.lock();
+  shard.stats_.record_load_success(time);
+  load = shard.loads_.find(key);
+  const bool written = load->second.written_;
+  shard.loads_.erase(load);
+  // A put or remove made during the load is newer than the loaded value
+  if (!written)
+    store(shard, key, [&]() { shard.cache_.put(key, value); });
+  promise.set_value(value);
+  release(shard, lock);
+  return value;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+bool ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::contains(const _KeyT & key) const
+{
+  Shard & shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex_);
+  return shard.cache_.contains(key);
+}
+//----------------------------------------------------------------------------
+#if __cplusplus >= 202002L
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+typename ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::SizeType ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::multi_get(std::span<const _KeyT> keys, std::span<std::optional<_ValueT>> values)
+{
+  const SizeType count = std::min(keys.size(), values.size());
+  std::vector<SizeType> order;
+  std::vector<SizeType> starts;
+  groupByShard(count, [&keys](SizeType i) -> const _KeyT & { return keys[i]; }, order, starts);
+  SizeType hits = 0;
+  for (SizeType index = 0; index < shards_.size(); ++index)
+  {
+    if (starts[index] == starts[index + 1])
+      continue;
+    Shard & shard = *shards_[index];
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    for (SizeType j = starts[index]; j < starts[index + 1]; ++j)
+    {
+      const SizeType i = order[j];
+      const _ValueT * cached = shard.cache_.get(keys[i]);
+      if (cached == nullptr)
+      {
+        if (!SHARD_COUNTS)
+          shard.stats_.record_miss();
+        values[i].reset();
+        continue;
+      }
+      if (!SHARD_COUNTS)
+        shard.stats_.record_hit();
+      values[i] = *cached;
+      ++hits;
+    }
+  }
+  return hits;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+void ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::multi_put(std::span<const std::pair<_KeyT, _ValueT>> entries)
+{
+  std::vector<SizeType> order;
+  std::vector<SizeType> starts;
+  groupByShard(entries.size(), [&entries](SizeType i) -> const _KeyT & { return entries[i].first; }, order, starts);
+  for (SizeType index = 0; index < shards_.size(); ++index)
+  {
+    if (starts[index] == starts[index + 1])
+      continue;
+    Shard & shard = *shards_[index];
+    std::unique_lock<std::mutex> lock(shard.mutex_);
+    for (SizeType j = starts[index]; j < starts[index + 1]; ++j)
+    {
+      const auto & entry = entries[order[j]];
+      store(shard, entry.first, [&]() { shard.cache_.put(entry.first, entry.second); });
+    }
+    release(shard, lock);
+  }
+}
+//----------------------------------------------------------------------------
+#endif
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+typename ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::SizeType ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::shardIndex(const _KeyT & key) const
+{
+  // NOTE: std::hash is the identity for integers, and the shard cache hashes
+  // the key again with the same function, so mix the bits before picking a shard
+  std::uint64_t hash = static_cast<std::uint64_t>(hash_(key));
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDull;
+  hash ^= hash >> 33;
+  return hash % shards_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+typename ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::Shard & ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::shardFor(const _KeyT & key) const
+{
+  return *shards_[shardIndex(key)];
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+void ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::written(Shard & shard, const _KeyT & key)
+{
+  if (shard.loads_.empty())
+    return;
+  auto load = shard.loads_.find(key);
+  if (load != shard.loads_.end())
+    load->second.written_ = true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+template<class _PutT>
+void ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::store(Shard & shard, const _KeyT & key, _PutT && put)
+{
+  written(shard, key);
+  if (SHARD_COUNTS || !_StatsT::enabled)
+  {
+    put();
+    return;
+  }
+  // NOTE: this shard cache does not report what a put did, so compare its
+  // contents before and after. A new key that is not there afterwards was
+  // rejected, which is neither an insert nor an eviction
+  const bool present = shard.cache_.contains(key);
+  const SizeType before = shard.cache_.size();
+  put();
+  const SizeType after = shard.cache_.size();
+  if (present)
+    shard.stats_.record_update();
+  else if (shard.cache_.contains(key))
+    shard.stats_.record_insert();
+  else
+    return;
+  const SizeType expected = before + (present ? 0 : 1);
+  if (after < expected)
+    shard.stats_.record_eviction(expected - after);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+void ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::release(Shard & shard, std::unique_lock<std::mutex> & lock)
+{
+  if (shard.removed_.empty())
+  {
+    lock.unlock();
+    return;
+  }
+  std::vector<Internal::Removal<_KeyT, _ValueT>> removed;
+  removed.swap(shard.removed_);
+  lock.unlock();
+  if (dispatcher_)
+    dispatcher_->post(std::move(removed));
+  else
+    Internal::notifyRemovals(removed, listener_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _CacheT, class _Hash, class _StatsT>
+template<class _KeyOfT>
+void ShardedCache<_KeyT, _ValueT, _CacheT, _Hash, _StatsT>::groupByShard(SizeType count, _KeyOfT && keyOf, std::vector<SizeType> & order, std::vector<SizeType> & starts) const
+{
+  // Counting sort: count the keys of every shard, then place them
+  std::vector<SizeType> shardOf(count);
+  starts.assign(shards_.size() + 1, 0);
+  for (SizeType i = 0; i < count; ++i)
+  {
+    shardOf[i] = shardIndex(keyOf(i));
+    ++starts[shardOf[i] + 1];
+  }
+  for (SizeType index = 0; index < shards_.size(); ++index)
+    starts[index + 1] += starts[index];
+  std::vector<SizeType> next(starts.begin(), starts.end() - 1);
+  order.resize(count);
+  for (SizeType i = 0; i < count; ++i)
+    order[next[shardOf[i]]++] = i;
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // SHARDED_LRU_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,859 @@
+//----------------------------------------------------------------------------
+#ifndef SHARED_LRU_CACHE_HPP
+#define SHARED_LRU_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+//----------------------------------------------------------------------------
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "mapped_lru_cache.hpp"
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+static constexpr std::uint32_t SHARED_MAGIC   = 0x4D485343; ///< "CSHM" in little-endian byte order.
+static constexpr std::uint32_t SHARED_VERSION = 2;          ///< Bumped on every change of the layout.
+static constexpr std::size_t   SHARED_ALIGN   = 64;         ///< Every region starts on its own cache line.
+//----------------------------------------------------------------------------
+/**
+ * @brief First bytes of the segment of a `SharedCache`: its geometry. Written
+ *        once by the process that creates the segment, which sets `ready_`
+ *        last; the shards follow at `SHARED_ALIGN`.
+ */
+struct SharedHeader
+{
+//----------------------------------------------------------------------------
+  std::uint32_t              magic_;
+  std::uint32_t              version_;
+  std::uint32_t              keySize_;     ///< sizeof of the key type.
+  std::uint32_t              valueSize_;   ///< sizeof of the value type.
+  std::uint32_t              slotSize_;    ///< sizeof of a slot, including padding.
+  std::uint32_t              shards_;      ///< Number of shards.
+  std::uint64_t              capacity_;    ///< Total capacity of all shards.
+  std::uint64_t              shardBytes_;  ///< Size of the region of one shard.
+  std::atomic<std::uint32_t> ready_;       ///< Non-zero once every shard is initialized.
+//----------------------------------------------------------------------------
+}; // struct SharedHeader
+//----------------------------------------------------------------------------
+static_assert(sizeof(SharedHeader) <= SHARED_ALIGN, "SharedHeader must fit in SHARED_ALIGN");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "SharedHeader::ready_ must be lock-free to be shared between processes");
+//----------------------------------------------------------------------------
+/**
+ * @brief Start of the region of one shard of a `SharedCache`: its lock, the
+ *        heads of its lists and its counters. The slot array follows it,
+ *        then the hash buckets.
+ */
+struct alignas(SHARED_ALIGN) SharedShard
+{
+//----------------------------------------------------------------------------
+  pthread_mutex_t mutex_;     ///< Process-shared robust mutex guarding the shard.
+  std::uint64_t   capacity_;
+  std::uint64_t   buckets_;   ///< Number of hash buckets, a power of two.
+  MappedIndexT    head_;      ///< Most recently used slot.
+  MappedIndexT    tail_;      ///< Least recently used slot.
+  MappedIndexT    free_;      ///< First slot of the free list, linked through next_.
+  MappedIndexT    size_;
+  std::uint64_t   hits_;      ///< Lookups of all processes that found the key.
+  std::uint64_t   misses_;    ///< Lookups of all processes that did not find the key.
+  std::uint64_t   inserts_;
+  std::uint64_t   updates_;
+  std::uint64_t   evictions_;
+  std::uint64_t   removals_;
+//----------------------------------------------------------------------------
+}; // struct SharedShard
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Fixed-capacity LRU cache in a POSIX shared-memory segment, shared by
+ *        all the processes of a host that open it by name.
+ *
+ * The segment is split into shards like `ShardedCache`. Each shard is one
+ * region holding a process-shared robust mutex, its slots and its hash
+ * buckets, with 32-bit slot indices as links (see `MappedCache`), so every
+ * process may map the segment at a different address. Pre-forked workers
+ * thus keep one copy of the hot entries instead of one each, and an entry
+ * loaded by one worker is a hit for all the others.
+ *
+ * The first process to open a name creates and initializes the segment; the
+ * others wait until it is ready and attach to it as it is, whatever
+ * capacity and shard count they ask for. The creator holds an `flock` on the
+ * segment until it is ready: if it dies before, the segment is never ready,
+ * and the first process that times out waiting for it unlinks it and
+ * creates a new one. If a process dies while holding a shard lock, the next
+ * process to lock the shard clears it, since its links may be half updated,
+ * and the other shards are untouched. A shard whose lock cannot be taken
+ * any more (`ENOTRECOVERABLE`) behaves as an empty shard that keeps nothing.
+ * The segment outlives the processes until `remove_segment` is called.
+ *
+ * Keys and values must be trivially copyable, and the hash must give the
+ * same result in every process (`std::hash` of integers does). Values are
+ * returned by copy, because a pointer into a shard would outlive the lock.
+ * POSIX only.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+class SharedCache
+{
+//----------------------------------------------------------------------------
+  static_assert(std::is_trivially_copyable<_KeyT>::value, "SharedCache keys must be trivially copyable");
+  static_assert(std::is_trivially_copyable<_ValueT>::value, "SharedCache values must be trivially copyable");
+//----------------------------------------------------------------------------
+  using SizeType = std::size_t; ///< Type representing the size of the cache.
+  using IndexT   = Internal::MappedIndexT; ///< Type of the links between slots.
+  using SlotT    = Internal::MappedSlot<_KeyT, _ValueT>; ///< Type of an entry slot.
+  using ShardT   = Internal::SharedShard; ///< Type of the state of a shard.
+//----------------------------------------------------------------------------
+  static constexpr int ATTACH_TIMEOUT_MS = 1000; ///< How long to wait for another process to initialize the segment.
+//----------------------------------------------------------------------------
+public:
+  /**
+   * @brief Creates the shared-memory segment `name`, or attaches to it if
+   *        another process already did. Check `is_open` for failures.
+   *
+   * If the existing segment is still not ready after `ATTACH_TIMEOUT_MS`
+   * and its creator is gone, it is unlinked and created again, once.
+   *
+   * @param name The name of the segment, "/" followed by up to 254 characters without "/".
+   * @param capacity The maximum number of items that the cache can hold,
+   *        if the segment is created.
+   * @param shardCount The number of shards, if the segment is created. It is
+   *        clamped to [1, capacity] so that every shard can hold at least one item.
+   * @param hash The hash function used for keys.
+   * @param keyEqual The key equality predicate.
+   */
+  SharedCache(const std::string & name, SizeType capacity, SizeType shardCount = 16, const _Hash & hash = _Hash(), const _KeyEqual & keyEqual = _KeyEqual());
+  SharedCache(const SharedCache &) = delete;
+  SharedCache & operator =(const SharedCache &) = delete;
+  /**
+   * @brief Unmaps the segment. The segment and its entries remain.
+   */
+  ~SharedCache();
+  /**
+   * @brief Removes the segment name, like `shm_unlink`. Processes that have it
+   *        open keep using it, and the next one to open the name creates a
+   *        new, empty segment.
+   *
+   * @return True if the segment existed and was removed.
+   */
+  static bool remove_segment(const std::string & name);
+  /**
+   * @brief Tells whether the segment is mapped. If not, the cache is empty
+   *        and has a capacity of zero.
+   */
+  bool is_open() const;
+  /**
+   * @brief Tells whether this process created the segment rather than
+   *        attaching to an existing one.
+   */
+  bool created() const;
+  /**
+   * @brief Retrieves the total capacity of the cache.
+   *
+   * @return The maximum number of items that the cache can hold.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the current number of items in the cache.
+   *
+   * Every shard is locked in turn, so the result is approximate while other
+   * processes write.
+   */
+  SizeType size() const;
+  /**
+   * @brief Retrieves the number of shards.
+   */
+  SizeType shard_count() const;
+  /**
+   * @brief Retrieves the size of the mapped segment in bytes.
+   */
+  SizeType bytes() const;
+  /**
+   * @brief Retrieves the counters of all the processes using the segment.
+   *
+   * Counted are hits, misses, inserts, updates, evictions and removals.
+   */
+  CacheStats stats() const;
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * If the shard is full, its least recently used entry is evicted and its
+   * slot is reused in place.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Removes the value associated with the specified key from the cache.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears all items from the cache, for every process.
+   */
+  void clear();
+  /**
+   * @brief Copies the value associated with the specified key and marks it
+   *        as recently used within its shard.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @param value Receives the value if the key is found.
+   * @return True if the key was found, false otherwise.
+   */
+  bool get(const _KeyT & key, _ValueT & value);
+  /**
+   * @brief Checks if the cache contains a value associated with the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not update position of the associated value
+   */
+  bool contains(const _KeyT & key) const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Holds the lock of a shard, clearing the shard first if its
+   *        previous owner died while holding it. Callers must check `owns`:
+   *        the lock of a shard left inconsistent cannot be taken again.
+   */
+  class ShardLock
+  {
+  public:
+    ShardLock(const SharedCache & cache, ShardT & shard);
+    ShardLock(const ShardLock &) = delete;
+    ShardLock & operator =(const ShardLock &) = delete;
+    ~ShardLock();
+    /**
+     * @brief Tells whether the lock was taken.
+     */
+    bool owns() const;
+  private:
+    ShardT & shard_;
+    bool     owns_;  ///< Whether the lock was taken.
+  };
+//----------------------------------------------------------------------------
+  /**
+   * @brief Size of the region of a shard of the given capacity.
+   */
+  static SizeType shardBytes(SizeType capacity, SizeType buckets);
+  /**
+   * @brief Creates and initializes a new segment on the open descriptor.
+   */
+  bool create(SizeType capacity, SizeType shardCount);
+  /**
+   * @brief Waits up to `timeout` milliseconds until the creator of the
+   *        segment has initialized it, then maps it.
+   */
+  bool attach(int timeout);
+  /**
+   * @brief Tells whether the segment that `attach` timed out on was left
+   *        unready by a creator that died, unlinking its name if it still
+   *        refers to it. The lock it takes is released by `close`.
+   *
+   * @return True if opening the name again may succeed.
+   */
+  bool abandoned(const std::string & name);
+  /**
+   * @brief Tells whether the mapped header describes a cache of this type.
+   */
+  bool matches(SizeType segmentBytes) const;
+  /**
+   * @brief Unmaps the segment and closes it.
+   */
+  void close();
+  /**
+   * @brief Empties a shard. Must hold its lock, or own it exclusively.
+   */
+  void reset(ShardT & shard) const;
+  /**
+   * @brief Returns the shard with the specified index.
+   */
+  ShardT & shardAt(SizeType index) const;
+  /**
+   * @brief Hashes a key and mixes the bits, since both the shard and the
+   *        bucket are picked from them.
+   */
+  SizeType hashOf(const _KeyT & key) const;
+  /**
+   * @brief Picks the shard of a key hash.
+   */
+  ShardT & shardFor(SizeType hash) const;
+  /**
+   * @brief Returns the slot array of a shard.
+   */
+  SlotT * slotsOf(ShardT & shard) const;
+  /**
+   * @brief Returns the hash buckets of a shard.
+   */
+  IndexT * bucketsOf(ShardT & shard) const;
+  /**
+   * @brief Returns the address of the link that points to the slot with the
+   *        specified key, or of the NIL link at the end of its chain.
+   */
+  IndexT * find(ShardT & shard, IndexT hash, const _KeyT & key) const;
+  /**
+   * @brief Unlinks the slot from its hash bucket chain.
+   */
+  void unchain(ShardT & shard, IndexT index) const;
+//----------------------------------------------------------------------------
+  void unlink(ShardT & shard, IndexT index) const;
+  void linkFront(ShardT & shard, IndexT index) const;
+  void toFront(ShardT & shard, IndexT index) const;
+//----------------------------------------------------------------------------
+  int                      fd_;       ///< The open segment, -1 if none.
+  char *                   map_;      ///< Start of the mapping, nullptr if none.
+  SizeType                 mapSize_;  ///< Length of the mapping.
+  bool                     created_;  ///< Whether this process created the segment.
+  Internal::SharedHeader * header_;   ///< Header at the start of the mapping.
+  _Hash                    hash_;     ///< The hash function used for keys.
+  _KeyEqual                keyEqual_; ///< The key equality predicate.
+//----------------------------------------------------------------------------
+}; // class SharedCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::ShardLock::ShardLock(const SharedCache & cache, ShardT & shard) :
+  shard_(shard),
+  owns_(false)
+{
+  // NOTE: ENOTRECOVERABLE if a process saw EOWNERDEAD and died or unlocked
+  // without marking the mutex consistent; nothing can lock it again
+  const int error = ::pthread_mutex_lock(&shard_.mutex_);
+  owns_ = error == 0 || error == EOWNERDEAD;
+  if (error == EOWNERDEAD)
+  {
+    // The owner died in the middle of an update: the links cannot be trusted
+    cache.reset(shard_);
+    ::pthread_mutex_consistent(&shard_.mutex_);
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::ShardLock::~ShardLock()
+{
+  if (owns_)
+    ::pthread_mutex_unlock(&shard_.mutex_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::ShardLock::owns() const
+{
+  return owns_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SharedCache(const std::string & name, SizeType capacity, SizeType shardCount, const _Hash & hash, const _KeyEqual & keyEqual) :
+  fd_(-1),
+  map_(nullptr),
+  mapSize_(0),
+  created_(false),
+  header_(nullptr),
+  hash_(hash),
+  keyEqual_(keyEqual)
+{
+  for (int attempt = 0; attempt < 2; ++attempt)
+  {
+    fd_ = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd_ >= 0)
+    {
+      created_ = true;
+      if (!create(capacity, shardCount))
+      {
+        close();
+        ::shm_unlink(name.c_str());
+      }
+      return;
+    }
+    if (errno != EEXIST)
+      return;
+    fd_ = ::shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd_ >= 0 && attach(ATTACH_TIMEOUT_MS))
+      return;
+    // Removed in between, or never made ready: open the name again
+    const bool retry = fd_ < 0 ? errno == ENOENT : abandoned(name);
+    close();
+    if (!retry)
+      return;
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::~SharedCache()
+{
+  close();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::remove_segment(const std::string & name)
+{
+  return ::shm_unlink(name.c_str()) == 0;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::is_open() const
+{
+  return map_ != nullptr;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::created() const
+{
+  return created_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::capacity() const
+{
+  return map_ == nullptr ? 0 : static_cast<SizeType>(header_->capacity_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::size() const
+{
+  SizeType size = 0;
+  for (SizeType i = 0; i < shard_count(); ++i)
+  {
+    ShardT & shard = shardAt(i);
+    ShardLock lock(*this, shard);
+    if (lock.owns())
+      size += shard.size_;
+  }
+  return size;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::shard_count() const
+{
+  return map_ == nullptr ? 0 : header_->shards_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::bytes() const
+{
+  return mapSize_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+CacheStats SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::stats() const
+{
+  CacheStats stats = CacheStats();
+  for (SizeType i = 0; i < shard_count(); ++i)
+  {
+    ShardT & shard = shardAt(i);
+    ShardLock lock(*this, shard);
+    if (!lock.owns())
+      continue;
+    stats.hits_      += shard.hits_;
+    stats.misses_    += shard.misses_;
+    stats.inserts_   += shard.inserts_;
+    stats.updates_   += shard.updates_;
+    stats.evictions_ += shard.evictions_;
+    stats.removals_  += shard.removals_;
+  }
+  return stats;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, const _ValueT & value)
+{
+  if (map_ == nullptr)
+    return;
+  const SizeType hash  = hashOf(key);
+  ShardT &       shard = shardFor(hash);
+  const IndexT   mixed = static_cast<IndexT>(hash / header_->shards_);
+  ShardLock lock(*this, shard);
+  if (!lock.owns() || shard.capacity_ == 0)
+    return;
+  SlotT * slots = slotsOf(shard);
+  IndexT  index = *find(shard, mixed, key);
+  if (index != Internal::MAPPED_NIL)
+  {
+    slots[index].value_ = value;
+    toFront(shard, index);
+    ++shard.updates_;
+    return;
+  }
+  index = shard.free_;
+  if (index == Internal::MAPPED_NIL)
+  {
+    // Reuse the slot of the least recently used entry in place
+    index = shard.tail_;
+    unchain(shard, index);
+    unlink(shard, index);
+    ++shard.evictions_;
+  }
+  else
+  {
+    shard.free_ = slots[index].next_;
+    ++shard.size_;
+  }
+  SlotT & slot = slots[index];
+  slot.key_   = key;
+  slot.value_ = value;
+  IndexT & bucket = bucketsOf(shard)[mixed & (shard.buckets_ - 1)];
+  slot.hash_  = mixed;
+  slot.chain_ = bucket;
+  bucket      = index;
+  linkFront(shard, index);
+  ++shard.inserts_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::remove(const _KeyT & key)
+{
+  if (map_ == nullptr)
+    return false;
+  const SizeType hash  = hashOf(key);
+  ShardT &       shard = shardFor(hash);
+  ShardLock lock(*this, shard);
+  if (!lock.owns())
+    return false;
+  IndexT * link  = find(shard, static_cast<IndexT>(hash / header_->shards_), key);
+  IndexT   index = *link;
+  if (index == Internal::MAPPED_NIL)
+    return false;
+  SlotT & slot = slotsOf(shard)[index];
+  *link = slot.chain_;
+  unlink(shard, index);
+  slot.next_  = shard.free_;
+  shard.free_ = index;
+  --shard.size_;
+  ++shard.removals_;
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::clear()
+{
+  for (SizeType i = 0; i < shard_count(); ++i)
+  {
+    ShardT & shard = shardAt(i);
+    ShardLock lock(*this, shard);
+    if (lock.owns())
+      reset(shard);
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key, _ValueT & value)
+{
+  if (map_ == nullptr)
+    return false;
+  const SizeType hash  = hashOf(key);
+  ShardT &       shard = shardFor(hash);
+  ShardLock lock(*this, shard);
+  if (!lock.owns())
+    return false;
+  const IndexT index = *find(shard, static_cast<IndexT>(hash / header_->shards_), key);
+  if (index == Internal::MAPPED_NIL)
+  {
+    ++shard.misses_;
+    return false;
+  }
+  ++shard.hits_;
+  toFront(shard, index);
+  value = slotsOf(shard)[index].value_;
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::contains(const _KeyT & key) const
+{
+  if (map_ == nullptr)
+    return false;
+  const SizeType hash  = hashOf(key);
+  ShardT &       shard = shardFor(hash);
+  ShardLock lock(*this, shard);
+  if (!lock.owns())
+    return false;
+  return *find(shard, static_cast<IndexT>(hash / header_->shards_), key) != Internal::MAPPED_NIL;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::shardBytes(SizeType capacity, SizeType buckets)
+{
+  const SizeType bytes = sizeof(ShardT) + capacity * sizeof(SlotT) + buckets * sizeof(IndexT);
+  return (bytes + Internal::SHARED_ALIGN - 1) / Internal::SHARED_ALIGN * Internal::SHARED_ALIGN;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::create(SizeType capacity, SizeType shardCount)
+{
+  shardCount = std::max<SizeType>(std::min(shardCount, capacity), 1);
+  const SizeType shardCapacity = (capacity + shardCount - 1) / shardCount;
+  if (shardCapacity >= Internal::MAPPED_NIL)
+    return false;
+  SizeType buckets = 1;
+  while (buckets < shardCapacity)
+    buckets *= 2;
+  const SizeType regionBytes = shardBytes(shardCapacity, buckets);
+  const SizeType bytes       = Internal::SHARED_ALIGN + shardCount * regionBytes;
+  // Held until ready_ is set, so that waiters can tell a dead creator from a slow one
+  if (::flock(fd_, LOCK_EX) != 0)
+    return false;
+  if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0)
+    return false;
+  void * address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (address == MAP_FAILED)
+    return false;
+  map_     = static_cast<char *>(address);
+  mapSize_ = bytes;
+  header_  = reinterpret_cast<Internal::SharedHeader *>(map_);
+  header_->magic_      = Internal::SHARED_MAGIC;
+  header_->version_    = Internal::SHARED_VERSION;
+  header_->keySize_    = sizeof(_KeyT);
+  header_->valueSize_  = sizeof(_ValueT);
+  header_->slotSize_   = sizeof(SlotT);
+  header_->shards_     = static_cast<std::uint32_t>(shardCount);
+  header_->capacity_   = capacity;
+  header_->shardBytes_ = regionBytes;
+
+  pthread_mutexattr_t attributes;
+  ::pthread_mutexattr_init(&attributes);
+  ::pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+  ::pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+  for (SizeType i = 0; i < shardCount; ++i)
+  {
+    ShardT & shard = *new (&shardAt(i)) ShardT();
+    ::pthread_mutex_init(&shard.mutex_, &attributes);
+    shard.capacity_ = capacity / shardCount + (i < capacity % shardCount ? 1 : 0);
+    shard.buckets_  = buckets;
+    reset(shard);
+  }
+  ::pthread_mutexattr_destroy(&attributes);
+  header_->ready_.store(1, std::memory_order_release);
+  ::flock(fd_, LOCK_UN);
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::attach(int timeout)
+{
+  // The creator sizes the segment, then initializes it: wait for both
+  struct stat status;
+  for (int waited = 0; ; ++waited)
+  {
+    if (::fstat(fd_, &status) != 0)
+      return false;
+    if (static_cast<SizeType>(status.st_size) >= Internal::SHARED_ALIGN)
+    {
+      if (map_ == nullptr)
+      {
+        void * address = ::mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (address == MAP_FAILED)
+          return false;
+        map_     = static_cast<char *>(address);
+        mapSize_ = static_cast<SizeType>(status.st_size);
+        header_  = reinterpret_cast<Internal::SharedHeader *>(map_);
+      }
+      if (header_->ready_.load(std::memory_order_acquire) != 0)
+        return matches(mapSize_);
+    }
+    if (waited >= timeout)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::abandoned(const std::string & name)
+{
+  if (header_ != nullptr && header_->ready_.load(std::memory_order_acquire) != 0)
+    return false;
+  // The creator holds the lock until the segment is ready, and so does a
+  // process recovering it until the name is unlinked
+  if (::flock(fd_, LOCK_EX) != 0)
+    return false;
+  if (attach(0) || (header_ != nullptr && header_->ready_.load(std::memory_order_acquire) != 0))
+    return true;
+  struct stat ours;
+  struct stat current;
+  if (::fstat(fd_, &ours) != 0)
+    return false;
+  const int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0)
+    return errno == ENOENT;
+  const bool same = ::fstat(fd, &current) == 0 && current.st_dev == ours.st_dev && current.st_ino == ours.st_ino;
+  ::close(fd);
+  // NOTE: another segment under the name was created by a process that recovered it first
+  return !same || ::shm_unlink(name.c_str()) == 0 || errno == ENOENT;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::matches(SizeType segmentBytes) const
+{
+  const Internal::SharedHeader & header = *header_;
+  return header.magic_ == Internal::SHARED_MAGIC && header.version_ == Internal::SHARED_VERSION &&
+         header.keySize_ == sizeof(_KeyT) && header.valueSize_ == sizeof(_ValueT) && header.slotSize_ == sizeof(SlotT) &&
+         header.shards_ != 0 && Internal::SHARED_ALIGN + header.shards_ * header.shardBytes_ == segmentBytes;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::close()
+{
+  if (map_ != nullptr)
+    ::munmap(map_, mapSize_);
+  if (fd_ >= 0)
+    ::close(fd_);
+  fd_      = -1;
+  map_     = nullptr;
+  mapSize_ = 0;
+  header_  = nullptr;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::reset(ShardT & shard) const
+{
+  SlotT *  slots    = slotsOf(shard);
+  IndexT * buckets  = bucketsOf(shard);
+  const SizeType capacity = static_cast<SizeType>(shard.capacity_);
+  shard.head_ = Internal::MAPPED_NIL;
+  shard.tail_ = Internal::MAPPED_NIL;
+  shard.free_ = capacity == 0 ? Internal::MAPPED_NIL : 0;
+  shard.size_ = 0;
+  for (SizeType index = 0; index < capacity; ++index)
+    slots[index].next_ = static_cast<IndexT>(index + 1 < capacity ? index + 1 : Internal::MAPPED_NIL);
+  for (SizeType bucket = 0; bucket < shard.buckets_; ++bucket)
+    buckets[bucket] = Internal::MAPPED_NIL;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::ShardT & SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::shardAt(SizeType index) const
+{
+  return *reinterpret_cast<ShardT *>(map_ + Internal::SHARED_ALIGN + index * header_->shardBytes_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::hashOf(const _KeyT & key) const
+{
+  // NOTE: std::hash is the identity for integers, so keys with a common
+  // stride would share a shard and a few chains without mixing
+  std::uint64_t hash = static_cast<std::uint64_t>(hash_(key));
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDull;
+  hash ^= hash >> 33;
+  return static_cast<SizeType>(hash);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::ShardT & SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::shardFor(SizeType hash) const
+{
+  return shardAt(hash % header_->shards_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SlotT * SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::slotsOf(ShardT & shard) const
+{
+  return reinterpret_cast<SlotT *>(reinterpret_cast<char *>(&shard) + sizeof(ShardT));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::IndexT * SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::bucketsOf(ShardT & shard) const
+{
+  // Every shard has room for as many slots as the largest one
+  const SizeType maxCapacity = (header_->capacity_ + header_->shards_ - 1) / header_->shards_;
+  return reinterpret_cast<IndexT *>(reinterpret_cast<char *>(&shard) + sizeof(ShardT) + maxCapacity * sizeof(SlotT));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::IndexT * SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::find(ShardT & shard, IndexT hash, const _KeyT & key) const
+{
+  SlotT *  slots = slotsOf(shard);
+  IndexT * link  = &bucketsOf(shard)[hash & (shard.buckets_ - 1)];
+  while (*link != Internal::MAPPED_NIL)
+  {
+    SlotT & slot = slots[*link];
+    if (slot.hash_ == hash && keyEqual_(slot.key_, key))
+      break;
+    link = &slot.chain_;
+  }
+  return link;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::unchain(ShardT & shard, IndexT index) const
+{
+  SlotT *  slots = slotsOf(shard);
+  IndexT * link  = &bucketsOf(shard)[slots[index].hash_ & (shard.buckets_ - 1)];
+  while (*link != index)
+    link = &slots[*link].chain_;
+  *link = slots[index].chain_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::unlink(ShardT & shard, IndexT index) const
+{
+  SlotT * slots = slotsOf(shard);
+  SlotT & slot  = slots[index];
+  if (slot.prev_ == Internal::MAPPED_NIL)
+    shard.head_ = slot.next_;
+  else
+    slots[slot.prev_].next_ = slot.next_;
+  if (slot.next_ == Internal::MAPPED_NIL)
+    shard.tail_ = slot.prev_;
+  else
+    slots[slot.next_].prev_ = slot.prev_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::linkFront(ShardT & shard, IndexT index) const
+{
+  SlotT * slots = slotsOf(shard);
+  SlotT & slot  = slots[index];
+  slot.prev_ = Internal::MAPPED_NIL;
+  slot.next_ = shard.head_;
+  if (shard.head_ == Internal::MAPPED_NIL)
+    shard.tail_ = index;
+  else
+    slots[shard.head_].prev_ = index;
+  shard.head_ = index;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SharedCache<_KeyT, _ValueT, _Hash, _KeyEqual>::toFront(ShardT & shard, IndexT index) const
+{
+  if (shard.head_ == index)
+    return;
+  unlink(shard, index);
+  linkFront(shard, index);
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // SHARED_LRU_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
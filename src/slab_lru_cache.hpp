@@ -0,0 +1,533 @@
+//----------------------------------------------------------------------------
+#ifndef SLAB_LRU_CACHE_HPP
+#define SLAB_LRU_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <functional>
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+using SlotIndexT = std::uint32_t;
+//----------------------------------------------------------------------------
+static constexpr SlotIndexT NIL_SLOT = 0xFFFFFFFF; ///< Marks the end of a list or of a hash chain.
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT>
+struct SlabSlot
+{
+//----------------------------------------------------------------------------
+  SlotIndexT prev_;  ///< More recently used slot.
+  SlotIndexT next_;  ///< Less recently used slot, or the next free slot.
+  SlotIndexT chain_; ///< Next slot in the same hash bucket.
+  SlotIndexT hash_;  ///< Low 32 bits of the mixed key hash.
+  union
+  {
+    _KeyT    key_; ///< Constructed only while the slot is linked into the LRU list.
+  };
+  union
+  {
+    _ValueT  value_; ///< Constructed only while the slot is linked into the LRU list.
+  };
+//----------------------------------------------------------------------------
+  SlabSlot();
+  ~SlabSlot();
+//----------------------------------------------------------------------------
+}; // struct SlabSlot
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Fixed-capacity LRU cache that preallocates every entry slot.
+ *
+ * All slots live in one contiguous array reserved at construction, and the
+ * hash index is a preallocated array of bucket heads. The LRU list and the
+ * hash chains are 32-bit slot indices rather than pointers. Eviction reuses the
+ * victim's slot in place, so once the cache is constructed `put`, `get` and
+ * eviction never call the allocator (the key and value types may still
+ * allocate on their own).
+ *
+ * The API mirrors `LRUCache::Cache`, but this is a separate class rather than
+ * a configuration of it: `Cache` is built from a node-based list and map whose
+ * iterators its policies, weighers and listeners hold on to, and neither
+ * 32-bit slot links nor in-place slot reuse fit behind those template
+ * parameters. A slab also fixes the number of entries, which a weighted
+ * `Cache` does not have. To keep a `Cache` and still stop calling the global
+ * allocator, give it a `std::pmr` resource instead (see `Cache(capacity, alloc)`).
+ *
+ * The capacity is limited to 2^32 - 2 entries: a larger capacity is rejected
+ * and leaves the cache with a capacity of 0, like `MappedCache::open`.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+class SlabCache
+{
+//----------------------------------------------------------------------------
+  using SizeType   = std::size_t; ///< Type representing the size of the cache.
+  using IndexT     = Internal::SlotIndexT; ///< Type of the links between slots.
+  using SlotT      = Internal::SlabSlot<_KeyT, _ValueT>; ///< Type of an entry slot.
+//----------------------------------------------------------------------------
+public:
+  /**
+   * @brief Default constructor for the SlabCache class.
+   *
+   * Initializes an empty cache with the default capacity. Nothing is allocated.
+   */
+  SlabCache();
+  /**
+   * @brief Constructs a SlabCache and reserves all of its slots.
+   *
+   * @param capacity The maximum number of items that the cache can hold.
+   *                 Capacities of 2^32 - 1 or more are rejected: nothing is
+   *                 reserved and the capacity is 0.
+   * @param hash The hash function used for keys.
+   * @param keyEqual The key equality predicate.
+   */
+  SlabCache(SizeType capacity, const _Hash & hash = _Hash(), const _KeyEqual & keyEqual = _KeyEqual());
+  SlabCache(const SlabCache &) = delete;
+  SlabCache & operator =(const SlabCache &) = delete;
+  ~SlabCache();
+  /**
+   * @brief Retrieves the current capacity of the cache.
+   *
+   * @return The maximum number of items that the cache can hold.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the current number of items in the cache.
+   *
+   * @return The number of items currently stored in the cache.
+   */
+  SizeType size() const;
+  /**
+   * @brief Retrieves the number of bytes reserved by the slot array and the index.
+   *
+   * @return The memory reserved at construction, not counting memory owned by
+   *         the keys and values themselves.
+   */
+  SizeType memory() const;
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * If the cache is full, the least recently used entry is evicted and its slot
+   * is reused in place.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * This overload accepts an rvalue reference for the value, allowing for efficient
+   * moves of temporary objects into the cache.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, _ValueT && value);
+  /**
+   * @brief Constructs and inserts a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be constructed and inserted or updated.
+   * @param args The arguments used to construct the value.
+   */
+  template<class ...Args>
+  void emplace(const _KeyT & key, Args && ...args);
+  /**
+   * @brief Removes the value associated with the specified key from the cache.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears all items from the cache. The slots stay reserved.
+   */
+  void clear();
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key
+   *        and marks it as recently used.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache.
+   */
+  _ValueT * get(const _KeyT & key);
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache.
+   * @note Does not update position of the associated value
+   */
+  const _ValueT * get(const _KeyT & key) const;
+  /**
+   * @brief Checks if the cache contains a value associated with the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not update position of the associated value
+   */
+  bool contains(const _KeyT & key) const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Hashes a key, mixing the bits since the bucket is picked by
+   *        masking the low bits, and keeps the low 32 bits.
+   */
+  IndexT hashOf(const _KeyT & key) const;
+  /**
+   * @brief Returns the address of the link that points to the slot with the
+   *        specified key, or of the NIL link at the end of its chain.
+   */
+  const IndexT * find(IndexT hash, const _KeyT & key) const;
+  /**
+   * @brief Inserts a new entry into a free slot, or into the slot of the least
+   *        recently used entry if the cache is full.
+   */
+  template<class ...Args>
+  void insert(IndexT hash, const _KeyT & key, Args && ...args);
+  /**
+   * @brief Unlinks the slot from its hash bucket chain.
+   */
+  void unchain(IndexT index);
+//----------------------------------------------------------------------------
+  void unlink(IndexT index);
+  void linkFront(IndexT index);
+  void toFront(IndexT index);
+//----------------------------------------------------------------------------
+  SizeType            capacity_; ///< The maximum number of items that the cache can hold.
+  SizeType            size_; ///< The number of items currently stored in the cache.
+  std::vector<SlotT>  slots_; ///< Slot array. Only the slots linked into the LRU list hold constructed keys and values.
+  std::vector<IndexT> buckets_; ///< Hash buckets, the size is always zero or a power of two.
+  IndexT              head_; ///< Most recently used slot.
+  IndexT              tail_; ///< Least recently used slot.
+  IndexT              free_; ///< First slot of the free list, linked through next_.
+  _Hash               hash_; ///< The hash function used for keys.
+  _KeyEqual           keyEqual_; ///< The key equality predicate.
+//----------------------------------------------------------------------------
+}; // class SlabCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT>
+SlabSlot<_KeyT, _ValueT>::SlabSlot()
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT>
+SlabSlot<_KeyT, _ValueT>::~SlabSlot()
+{
+}
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SlabCache() :
+  capacity_(0),
+  size_(0),
+  head_(Internal::NIL_SLOT),
+  tail_(Internal::NIL_SLOT),
+  free_(Internal::NIL_SLOT)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SlabCache(SizeType capacity, const _Hash & hash, const _KeyEqual & keyEqual) :
+  capacity_(capacity < Internal::NIL_SLOT ? capacity : 0),
+  size_(0),
+  slots_(capacity_),
+  head_(Internal::NIL_SLOT),
+  tail_(Internal::NIL_SLOT),
+  free_(Internal::NIL_SLOT),
+  hash_(hash),
+  keyEqual_(keyEqual)
+{
+  if (capacity_ == 0)
+    return;
+  SizeType bucketCount = 1;
+  while (bucketCount < capacity_)
+    bucketCount *= 2;
+  buckets_.assign(bucketCount, Internal::NIL_SLOT);
+  clear();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::~SlabCache()
+{
+  clear();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::capacity() const
+{
+  return capacity_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::size() const
+{
+  return size_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::memory() const
+{
+  return capacity_ * sizeof(SlotT) + buckets_.size() * sizeof(IndexT);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, const _ValueT & value)
+{
+  const IndexT hash  = hashOf(key);
+  const IndexT index = *find(hash, key);
+  if (index == Internal::NIL_SLOT)
+  {
+    insert(hash, key, value);
+    return;
+  }
+  slots_[index].value_ = value;
+  toFront(index);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, _ValueT && value)
+{
+  const IndexT hash  = hashOf(key);
+  const IndexT index = *find(hash, key);
+  if (index == Internal::NIL_SLOT)
+  {
+    insert(hash, key, std::forward<_ValueT>(value));
+    return;
+  }
+  slots_[index].value_ = std::forward<_ValueT>(value);
+  toFront(index);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::emplace(const _KeyT & key, Args && ...args)
+{
+  const IndexT hash  = hashOf(key);
+  const IndexT index = *find(hash, key);
+  if (index == Internal::NIL_SLOT)
+  {
+    insert(hash, key, std::forward<Args>(args)...);
+    return;
+  }
+  slots_[index].value_ = _ValueT(std::forward<Args>(args)...);
+  toFront(index);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::remove(const _KeyT & key)
+{
+  IndexT * link  = const_cast<IndexT *>(find(hashOf(key), key));
+  IndexT   index = *link;
+  if (index == Internal::NIL_SLOT)
+    return false;
+  SlotT & slot = slots_[index];
+  *link = slot.chain_;
+  unlink(index);
+  slot.key_.~_KeyT();
+  slot.value_.~_ValueT();
+  slot.next_ = free_;
+  free_      = index;
+  --size_;
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::clear()
+{
+  for (IndexT index = head_; index != Internal::NIL_SLOT; index = slots_[index].next_)
+  {
+    slots_[index].key_.~_KeyT();
+    slots_[index].value_.~_ValueT();
+  }
+  for (SizeType index = 0; index < capacity_; ++index)
+    slots_[index].next_ = static_cast<IndexT>(index + 1 < capacity_ ? index + 1 : Internal::NIL_SLOT);
+  std::fill(buckets_.begin(), buckets_.end(), Internal::NIL_SLOT);
+  head_ = Internal::NIL_SLOT;
+  tail_ = Internal::NIL_SLOT;
+  free_ = capacity_ == 0 ? Internal::NIL_SLOT : 0;
+  size_ = 0;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+_ValueT * SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key)
+{
+  const IndexT index = *find(hashOf(key), key);
+  if (index == Internal::NIL_SLOT)
+    return nullptr;
+  toFront(index);
+  return &(slots_[index].value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+const _ValueT * SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key) const
+{
+  const IndexT index = *find(hashOf(key), key);
+  if (index == Internal::NIL_SLOT)
+    return nullptr;
+  return &(slots_[index].value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::contains(const _KeyT & key) const
+{
+  return *find(hashOf(key), key) != Internal::NIL_SLOT;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::IndexT SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::hashOf(const _KeyT & key) const
+{
+  // NOTE: std::hash is the identity for integers, so keys with a common
+  // stride would share their low bits and a few chains without mixing
+  std::uint64_t hash = static_cast<std::uint64_t>(hash_(key));
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDull;
+  hash ^= hash >> 33;
+  return static_cast<IndexT>(hash);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+const typename SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::IndexT * SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::find(IndexT hash, const _KeyT & key) const
+{
+  static const IndexT nil = Internal::NIL_SLOT;
+  if (buckets_.empty())
+    return &nil;
+  const IndexT * link = &buckets_[hash & (buckets_.size() - 1)];
+  while (*link != Internal::NIL_SLOT)
+  {
+    const SlotT & slot = slots_[*link];
+    if (slot.hash_ == hash && keyEqual_(slot.key_, key))
+      break;
+    link = &slot.chain_;
+  }
+  return link;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::insert(IndexT hash, const _KeyT & key, Args && ...args)
+{
+  if (capacity_ == 0)
+    return;
+  IndexT index = free_;
+  if (index == Internal::NIL_SLOT)
+  {
+    index = tail_;
+    SlotT & slot = slots_[index];
+    unchain(index);
+    unlink(index);
+    try
+    {
+      slot.key_   = key;
+      slot.value_ = _ValueT(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      slot.key_.~_KeyT();
+      slot.value_.~_ValueT();
+      slot.next_ = free_;
+      free_      = index;
+      --size_;
+      throw;
+    }
+  }
+  else
+  {
+    SlotT & slot = slots_[index];
+    const IndexT nextFree = slot.next_;
+    ::new (static_cast<void *>(&slot.key_)) _KeyT(key);
+    try
+    {
+      ::new (static_cast<void *>(&slot.value_)) _ValueT(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      slot.key_.~_KeyT();
+      throw;
+    }
+    free_ = nextFree;
+    ++size_;
+  }
+  SlotT & slot = slots_[index];
+  IndexT & bucket = buckets_[hash & (buckets_.size() - 1)];
+  slot.hash_  = hash;
+  slot.chain_ = bucket;
+  bucket      = index;
+  linkFront(index);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::unchain(IndexT index)
+{
+  IndexT * link = &buckets_[slots_[index].hash_ & (buckets_.size() - 1)];
+  while (*link != index)
+    link = &slots_[*link].chain_;
+  *link = slots_[index].chain_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::unlink(IndexT index)
+{
+  SlotT & slot = slots_[index];
+  if (slot.prev_ == Internal::NIL_SLOT)
+    head_ = slot.next_;
+  else
+    slots_[slot.prev_].next_ = slot.next_;
+  if (slot.next_ == Internal::NIL_SLOT)
+    tail_ = slot.prev_;
+  else
+    slots_[slot.next_].prev_ = slot.prev_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::linkFront(IndexT index)
+{
+  SlotT & slot = slots_[index];
+  slot.prev_ = Internal::NIL_SLOT;
+  slot.next_ = head_;
+  if (head_ == Internal::NIL_SLOT)
+    tail_ = index;
+  else
+    slots_[head_].prev_ = index;
+  head_ = index;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void SlabCache<_KeyT, _ValueT, _Hash, _KeyEqual>::toFront(IndexT index)
+{
+  if (head_ == index)
+    return;
+  unlink(index);
+  linkFront(index);
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // SLAB_LRU_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
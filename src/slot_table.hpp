@@ -0,0 +1,511 @@
+//----------------------------------------------------------------------------
+#ifndef SLOT_TABLE_HPP
+#define SLOT_TABLE_HPP
+//----------------------------------------------------------------------------
+#include <new>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+static constexpr std::uint32_t TABLE_NIL    = 0xFFFFFFFF; ///< Slot index of an empty index entry, and of no slot.
+static constexpr std::uint32_t TABLE_WRITER = 0x80000000; ///< Writer bit of a locked `TableSlot`.
+//----------------------------------------------------------------------------
+/**
+ * @brief Entry slot of a `SlotTable`. Derives from the per-entry metadata of
+ *        the eviction policy, so that a hit touches a single slot.
+ */
+template<class _KeyT, class _ValueT, class _MetaT>
+struct TableSlot : _MetaT
+{
+//----------------------------------------------------------------------------
+  /// Whether readers copy the slot optimistically and validate the copy,
+  /// rather than count themselves in `state_`.
+  static constexpr bool OPTIMISTIC = std::is_trivially_copyable<_KeyT>::value && std::is_trivially_copyable<_ValueT>::value;
+//----------------------------------------------------------------------------
+  mutable std::atomic<std::uint32_t> state_; ///< If OPTIMISTIC, a sequence number, odd while the slot is written; otherwise `TABLE_WRITER` and the number of readers.
+  bool                               occupied_;
+  std::size_t                        hash_; ///< Mixed hash of the key, while occupied. Read by the writer only.
+  union
+  {
+    _KeyT                            key_; ///< Constructed only while the slot is occupied.
+  };
+  union
+  {
+    _ValueT                          value_; ///< Constructed only while the slot is occupied.
+  };
+//----------------------------------------------------------------------------
+  TableSlot();
+  ~TableSlot();
+//----------------------------------------------------------------------------
+}; // struct TableSlot
+//----------------------------------------------------------------------------
+/**
+ * @brief Fixed array of entry slots with a lock-free lookup, shared by the
+ *        thread-safe caches whose hits must not take a lock.
+ *
+ * Slots are found through a fixed open-addressed index that never rehashes:
+ * a power of two of at least twice the capacity, linearly probed, whose
+ * entries pack the high half of the hash and the slot index in one word.
+ * Removals shift the following entries back inside an odd/even sequence
+ * number, which a lookup re-checks only before reporting a miss.
+ *
+ * For trivially copyable keys and values, a lookup copies the slot and checks
+ * the slot's sequence number did not change, so it writes nothing. For other
+ * types, readers count themselves in the slot, so only readers of the same
+ * entry share a line.
+ *
+ * Every member but `lookup`, `size` and `capacity` must be called by one
+ * writer at a time: the owner serializes them. Which slots are free is up to
+ * the owner too.
+ *
+ * @tparam _KeyT The type of keys.
+ * @tparam _ValueT The type of values.
+ * @tparam _MetaT The per-slot policy metadata, default constructible.
+ * @tparam _Hash The hash function used for keys.
+ * @tparam _KeyEqual The key equality predicate.
+ */
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+class SlotTable
+{
+//----------------------------------------------------------------------------
+  using EntryT = std::uint64_t; ///< Index entry: the high half of the hash, then the slot index.
+//----------------------------------------------------------------------------
+  static constexpr EntryT EMPTY    = ~EntryT(0); ///< Index entry of no slot.
+  static constexpr int    ATTEMPTS = 4;          ///< Probes of a lookup racing with removals, before it misses.
+//----------------------------------------------------------------------------
+public:
+  using SizeType = std::size_t; ///< Type representing the size of the table.
+  using IndexT   = std::uint32_t; ///< Type of a slot index.
+  using SlotT    = TableSlot<_KeyT, _ValueT, _MetaT>; ///< Type of an entry slot.
+//----------------------------------------------------------------------------
+  /**
+   * @brief Constructs a SlotTable with all of its slots free.
+   *
+   * @param capacity The number of slots, clamped to 2^32 - 2.
+   */
+  SlotTable(SizeType capacity);
+  SlotTable(const SlotTable &) = delete;
+  SlotTable & operator =(const SlotTable &) = delete;
+  /**
+   * @brief Retrieves the number of slots.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the number of occupied slots. Takes no lock.
+   */
+  SizeType size() const;
+  /**
+   * @brief Accesses a slot by index.
+   */
+  SlotT & operator [](IndexT index);
+  /**
+   * @brief Accesses a slot by index.
+   */
+  const SlotT & operator [](IndexT index) const;
+  /**
+   * @brief Finalizes the hash of a key: `std::hash` is the identity for
+   *        integers, which would put strided keys in one probe run.
+   */
+  SizeType hash(const _KeyT & key) const;
+  /**
+   * @brief Finds `key` without a lock, and passes its slot and a consistent
+   *        copy of its value to `visit` if found.
+   *
+   * A lookup whose probe raced with a removal is retried a few times, then
+   * reported as a miss.
+   *
+   * @param key The key to look up.
+   * @param visit Called as `visit(const SlotT &, const _ValueT &)` on a hit.
+   * @return True if the key was found, false otherwise.
+   */
+  template<class _VisitT>
+  bool lookup(const _KeyT & key, _VisitT && visit) const;
+  /**
+   * @brief Finds the slot of `key`.
+   *
+   * @param key The key to find.
+   * @param hash The result of `hash(key)`.
+   * @return The slot index, or `TABLE_NIL` if the key is absent.
+   */
+  IndexT find(const _KeyT & key, SizeType hash) const;
+  /**
+   * @brief Constructs an entry in a free slot and publishes it to lookups.
+   *        The slot stays free if a constructor throws.
+   *
+   * @param index A free slot.
+   * @param key The key of the entry, absent from the table.
+   * @param hash The result of `hash(key)`.
+   * @param args The arguments used to construct the value.
+   */
+  template<class ...Args>
+  void insert(IndexT index, const _KeyT & key, SizeType hash, Args && ...args);
+  /**
+   * @brief Replaces the value of an occupied slot.
+   */
+  template<class _V>
+  void assign(IndexT index, _V && value);
+  /**
+   * @brief Removes the entry of an occupied slot from lookups, then destroys it.
+   */
+  void erase(IndexT index);
+  /**
+   * @brief Destroys all entries.
+   */
+  void clear();
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Checks whether a slot holds `key` and passes it to `visit` if so.
+   *        Waits while the writer holds the slot.
+   */
+  template<class _VisitT>
+  bool read(const SlotT & slot, const _KeyT & key, _VisitT && visit) const;
+  /**
+   * @brief Locks a slot against readers.
+   */
+  void beginWrite(SlotT & slot);
+  /**
+   * @brief Unlocks a slot locked by `beginWrite`.
+   */
+  void endWrite(SlotT & slot);
+  /**
+   * @brief Destroys the entry of an occupied slot, already out of the index.
+   */
+  void release(SlotT & slot);
+//----------------------------------------------------------------------------
+  std::vector<SlotT>               slots_; ///< Entry storage.
+  std::vector<std::atomic<EntryT>> index_; ///< Open-addressed, linearly probed.
+  SizeType                         mask_; ///< `index_.size() - 1`.
+  _Hash                            hash_; ///< The hash function used for keys.
+  _KeyEqual                        keyEqual_; ///< The key equality predicate.
+  std::atomic<SizeType>            size_; ///< Occupied slots.
+  alignas(64) std::atomic<std::uint64_t> moves_; ///< Sequence number of the index, odd while entries move back.
+//----------------------------------------------------------------------------
+}; // class SlotTable
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT>
+TableSlot<_KeyT, _ValueT, _MetaT>::TableSlot() :
+  state_(0),
+  occupied_(false),
+  hash_(0)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT>
+TableSlot<_KeyT, _ValueT, _MetaT>::~TableSlot()
+{
+  if (!occupied_)
+    return;
+  key_.~_KeyT();
+  value_.~_ValueT();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::SlotTable(SizeType capacity) :
+  slots_(capacity < TABLE_NIL ? capacity : TABLE_NIL - 1),
+  size_(0),
+  moves_(0)
+{
+  SizeType buckets = 1;
+  while (buckets < 2 * slots_.size())
+    buckets *= 2;
+  index_ = std::vector<std::atomic<EntryT>>(buckets);
+  for (auto & entry : index_)
+    entry.store(EMPTY, std::memory_order_relaxed);
+  mask_ = buckets - 1;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+typename SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::SizeType SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::capacity() const
+{
+  return slots_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+typename SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::SizeType SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::size() const
+{
+  return size_.load(std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+typename SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::SlotT & SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::operator [](IndexT index)
+{
+  return slots_[index];
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+const typename SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::SlotT & SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::operator [](IndexT index) const
+{
+  return slots_[index];
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+typename SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::SizeType SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::hash(const _KeyT & key) const
+{
+  std::uint64_t hash = static_cast<std::uint64_t>(hash_(key));
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDull;
+  hash ^= hash >> 33;
+  return static_cast<SizeType>(hash);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+template<class _VisitT>
+bool SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::lookup(const _KeyT & key, _VisitT && visit) const
+{
+  const SizeType hash = this->hash(key);
+  const EntryT   tag  = static_cast<EntryT>(hash) >> 32 << 32;
+  for (int attempt = 0; attempt < ATTEMPTS; ++attempt)
+  {
+    const std::uint64_t moves = moves_.load(std::memory_order_acquire);
+    if ((moves & 1) == 0)
+    {
+      for (SizeType position = hash & mask_, probes = 0; probes <= mask_; position = (position + 1) & mask_, ++probes)
+      {
+        const EntryT entry = index_[position].load(std::memory_order_acquire);
+        if (entry == EMPTY)
+          break;
+        if ((entry & ~EntryT(TABLE_NIL)) == tag && read(slots_[static_cast<IndexT>(entry)], key, visit))
+          return true;
+      }
+      // NOTE: a hit is always right, but a miss may come from an entry moved
+      // back past the probe: only trust it if no entry moved meanwhile
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (moves_.load(std::memory_order_relaxed) == moves)
+        return false;
+    }
+    std::this_thread::yield();
+  }
+  return false;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+typename SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::IndexT SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::find(const _KeyT & key, SizeType hash) const
+{
+  for (SizeType position = hash & mask_, probes = 0; probes <= mask_; position = (position + 1) & mask_, ++probes)
+  {
+    const EntryT entry = index_[position].load(std::memory_order_relaxed);
+    if (entry == EMPTY)
+      break;
+    const SlotT & slot = slots_[static_cast<IndexT>(entry)];
+    if (slot.hash_ == hash && keyEqual_(slot.key_, key))
+      return static_cast<IndexT>(entry);
+  }
+  return TABLE_NIL;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::insert(IndexT index, const _KeyT & key, SizeType hash, Args && ...args)
+{
+  SlotT & slot = slots_[index];
+  beginWrite(slot);
+  try
+  {
+    ::new (static_cast<void *>(&slot.key_)) _KeyT(key);
+    try
+    {
+      ::new (static_cast<void *>(&slot.value_)) _ValueT(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      slot.key_.~_KeyT();
+      throw;
+    }
+  }
+  catch (...)
+  {
+    endWrite(slot);
+    throw;
+  }
+  slot.occupied_ = true;
+  slot.hash_     = hash;
+  endWrite(slot);
+  // A free position is always found: the index is at most half full
+  SizeType position = hash & mask_;
+  while (index_[position].load(std::memory_order_relaxed) != EMPTY)
+    position = (position + 1) & mask_;
+  index_[position].store((static_cast<EntryT>(hash) >> 32 << 32) | index, std::memory_order_release);
+  size_.store(size_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+template<class _V>
+void SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::assign(IndexT index, _V && value)
+{
+  SlotT & slot = slots_[index];
+  beginWrite(slot);
+  try
+  {
+    slot.value_ = std::forward<_V>(value);
+  }
+  catch (...)
+  {
+    endWrite(slot);
+    throw;
+  }
+  endWrite(slot);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+void SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::erase(IndexT index)
+{
+  SlotT & slot = slots_[index];
+  SizeType hole = slot.hash_ & mask_;
+  while (static_cast<IndexT>(index_[hole].load(std::memory_order_relaxed)) != index)
+    hole = (hole + 1) & mask_;
+  moves_.store(moves_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  // Backward shift: an entry after the hole moves into it unless its home
+  // position lies between the hole and the entry
+  for (SizeType next = (hole + 1) & mask_; ; next = (next + 1) & mask_)
+  {
+    const EntryT entry = index_[next].load(std::memory_order_relaxed);
+    if (entry == EMPTY)
+      break;
+    const SizeType home = slots_[static_cast<IndexT>(entry)].hash_ & mask_;
+    if (((next - home) & mask_) >= ((next - hole) & mask_))
+    {
+      index_[hole].store(entry, std::memory_order_relaxed);
+      hole = next;
+    }
+  }
+  index_[hole].store(EMPTY, std::memory_order_relaxed);
+  moves_.store(moves_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  release(slot);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+void SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::clear()
+{
+  moves_.store(moves_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (auto & entry : index_)
+    entry.store(EMPTY, std::memory_order_relaxed);
+  moves_.store(moves_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  for (auto & slot : slots_)
+    if (slot.occupied_)
+      release(slot);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+template<class _VisitT>
+bool SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::read(const SlotT & slot, const _KeyT & key, _VisitT && visit) const
+{
+  for (;;)
+  {
+    if constexpr (SlotT::OPTIMISTIC)
+    {
+      const std::uint32_t version = slot.state_.load(std::memory_order_acquire);
+      if ((version & 1) != 0)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+      // The copies may be torn: they are used only once the version is
+      // known to be unchanged
+      alignas(_KeyT) unsigned char keyBytes[sizeof(_KeyT)];
+      const bool occupied = slot.occupied_;
+      std::memcpy(keyBytes, static_cast<const void *>(&slot.key_), sizeof(_KeyT));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.state_.load(std::memory_order_relaxed) != version)
+        continue;
+      if (!occupied || !keyEqual_(*std::launder(reinterpret_cast<const _KeyT *>(keyBytes)), key))
+        return false;
+      alignas(_ValueT) unsigned char valueBytes[sizeof(_ValueT)];
+      std::memcpy(valueBytes, static_cast<const void *>(&slot.value_), sizeof(_ValueT));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.state_.load(std::memory_order_relaxed) != version)
+        continue;
+      visit(slot, *std::launder(reinterpret_cast<const _ValueT *>(valueBytes)));
+      return true;
+    }
+    else
+    {
+      if ((slot.state_.fetch_add(1, std::memory_order_acquire) & TABLE_WRITER) != 0)
+      {
+        slot.state_.fetch_sub(1, std::memory_order_relaxed);
+        std::this_thread::yield();
+        continue;
+      }
+      struct Leave
+      {
+        const SlotT & slot_;
+        ~Leave() { slot_.state_.fetch_sub(1, std::memory_order_release); }
+      } leave{slot};
+      if (!slot.occupied_ || !keyEqual_(slot.key_, key))
+        return false;
+      visit(slot, slot.value_);
+      return true;
+    }
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+void SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::beginWrite(SlotT & slot)
+{
+  if constexpr (SlotT::OPTIMISTIC)
+  {
+    slot.state_.store(slot.state_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  else
+  {
+    slot.state_.fetch_or(TABLE_WRITER, std::memory_order_acquire);
+    while ((slot.state_.load(std::memory_order_acquire) & ~TABLE_WRITER) != 0)
+      std::this_thread::yield();
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+void SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::endWrite(SlotT & slot)
+{
+  if constexpr (SlotT::OPTIMISTIC)
+    slot.state_.store(slot.state_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  else
+    slot.state_.fetch_and(~TABLE_WRITER, std::memory_order_release);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _MetaT, class _Hash, class _KeyEqual>
+void SlotTable<_KeyT, _ValueT, _MetaT, _Hash, _KeyEqual>::release(SlotT & slot)
+{
+  beginWrite(slot);
+  slot.key_.~_KeyT();
+  slot.value_.~_ValueT();
+  slot.occupied_ = false;
+  endWrite(slot);
+  size_.store(size_.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // SLOT_TABLE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
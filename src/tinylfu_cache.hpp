@@ -0,0 +1,572 @@
+//----------------------------------------------------------------------------
+#ifndef TINYLFU_CACHE_HPP
+#define TINYLFU_CACHE_HPP
+//----------------------------------------------------------------------------
+#include <list>
+#include <tuple>
+#include <bitset>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <functional>
+#include <unordered_map>
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+/**
+ * @brief Count-min sketch of 4-bit counters that estimates how often a hash
+ *        was seen recently.
+ *
+ * Counters are packed 16 per 64-bit word and the words are grouped into
+ * 64-byte blocks. All four counters of a key live in the same block (one per
+ * pair of words), so an update or estimate touches a single cache line. After
+ * `10 * capacity` increments every counter is halved, which ages out stale
+ * popularity; halving is a shift and a mask per word. The table takes about 8
+ * bytes per cached entry.
+ */
+class FrequencySketch
+{
+//----------------------------------------------------------------------------
+public:
+//----------------------------------------------------------------------------
+  FrequencySketch();
+  /**
+   * @brief Constructs a sketch sized for `capacity` distinct hot keys.
+   */
+  explicit FrequencySketch(std::size_t capacity);
+  /**
+   * @brief Estimated number of recent occurrences of `hash`, between 0 and 15.
+   */
+  unsigned frequency(std::uint64_t hash) const;
+  /**
+   * @brief Records an occurrence of `hash`.
+   */
+  void increment(std::uint64_t hash);
+  /**
+   * @brief Resets all counters to zero.
+   */
+  void clear();
+  /**
+   * @brief Size of the counter table in bytes.
+   */
+  std::size_t memory() const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  struct alignas(64) Block
+  {
+    std::uint64_t words_[8];
+  };
+//----------------------------------------------------------------------------
+  static std::uint64_t mix(std::uint64_t hash);
+  void                 age();
+//----------------------------------------------------------------------------
+  std::vector<Block> blocks_;     ///< Counter table, the size is a power of two.
+  std::size_t        additions_;  ///< Increments since the last aging.
+  std::size_t        sampleSize_; ///< Number of increments that triggers aging.
+//----------------------------------------------------------------------------
+}; // class FrequencySketch
+//----------------------------------------------------------------------------
+enum class TinyLfuSegment : std::uint8_t
+{
+  WINDOW,    ///< Admission window, plain LRU.
+  PROBATION, ///< Main region, entries seen once since they were admitted.
+  PROTECTED  ///< Main region, entries hit again while on probation.
+};
+//----------------------------------------------------------------------------
+template<class _IteratorT, class _ValueT>
+struct TinyLfuEntry
+{
+//----------------------------------------------------------------------------
+  _IteratorT     it_;      ///< Position of the key in the list of its segment.
+  TinyLfuSegment segment_;
+  _ValueT        value_;
+//----------------------------------------------------------------------------
+  template<class ...Args>
+  TinyLfuEntry(const _IteratorT & it, Args && ...args);
+//----------------------------------------------------------------------------
+}; // struct TinyLfuEntry
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+/**
+ * @brief Cache with the W-TinyLFU policy: LRU recency plus a frequency based
+ *        admission filter.
+ *
+ * New entries go to a small LRU window (1% of the capacity). An entry that
+ * falls off the window competes with the LRU victim of the main region and is
+ * only admitted if a `Internal::FrequencySketch` estimates that it is more
+ * popular, so one-hit wonders and scans cannot flush the working set. The main
+ * region is a segmented LRU: a hit on probation promotes the entry to the
+ * protected segment (80% of the main region), and the protected overflow is
+ * demoted back to probation.
+ *
+ * The API mirrors `LRUCache::Cache`.
+ *
+ * @tparam _KeyT The type of keys used in the cache.
+ * @tparam _ValueT The type of values associated with the keys in the cache.
+ * @tparam _Hash The hash function used for keys. Defaults to `std::hash<_KeyT>`.
+ * @tparam _KeyEqual The key equality predicate. Defaults to `std::equal_to<_KeyT>`.
+ */
+template<class _KeyT, class _ValueT, class _Hash = std::hash<_KeyT>, class _KeyEqual = std::equal_to<_KeyT>>
+class TinyLfuCache
+{
+//----------------------------------------------------------------------------
+  using SizeType = std::size_t; ///< Type representing the size of the cache.
+  using SegmentT = Internal::TinyLfuSegment;
+  using ListT    = std::list<_KeyT>; ///< LRU order of the keys of a segment, most recent first.
+  using EntryT   = Internal::TinyLfuEntry<typename ListT::iterator, _ValueT>;
+  using MapT     = std::unordered_map<_KeyT, EntryT, _Hash, _KeyEqual>;
+//----------------------------------------------------------------------------
+public:
+  /**
+   * @brief Default constructor for the TinyLfuCache class.
+   *
+   * Initializes an empty cache with the default capacity.
+   */
+  TinyLfuCache();
+  /**
+   * @brief Constructs a TinyLfuCache with a specified capacity.
+   *
+   * @param capacity The maximum number of items that the cache can hold.
+   * @param hash The hash function used for keys.
+   * @param keyEqual The key equality predicate.
+   */
+  TinyLfuCache(SizeType capacity, const _Hash & hash = _Hash(), const _KeyEqual & keyEqual = _KeyEqual());
+  TinyLfuCache(const TinyLfuCache &) = delete;
+  TinyLfuCache & operator =(const TinyLfuCache &) = delete;
+  /**
+   * @brief Retrieves the current capacity of the cache.
+   *
+   * @return The maximum number of items that the cache can hold.
+   */
+  SizeType capacity() const;
+  /**
+   * @brief Retrieves the current number of items in the cache.
+   *
+   * @return The number of items currently stored in the cache.
+   */
+  SizeType size() const;
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * A new entry enters the admission window, which may push an older entry
+   * into the main region or out of the cache.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be associated with the specified key.
+   */
+  void put(const _KeyT & key, const _ValueT & value);
+  /**
+   * @brief Inserts or updates a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be inserted or updated.
+   * @param value The value to be moved into the cache.
+   */
+  void put(const _KeyT & key, _ValueT && value);
+  /**
+   * @brief Constructs and inserts a value in the cache associated with the specified key.
+   *
+   * @param key The key associated with the value to be constructed and inserted or updated.
+   * @param args The arguments used to construct the value.
+   */
+  template<class ...Args>
+  void emplace(const _KeyT & key, Args && ...args);
+  /**
+   * @brief Removes the value associated with the specified key from the cache.
+   *
+   * @param key The key associated with the value to be removed.
+   * @return True if the key was found and removed, false otherwise.
+   */
+  bool remove(const _KeyT & key);
+  /**
+   * @brief Clears all items and the frequency history from the cache.
+   */
+  void clear();
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key
+   *        and records the access. Misses are recorded as well.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache.
+   */
+  _ValueT * get(const _KeyT & key);
+  /**
+   * @brief Retrieves a pointer to the value associated with the specified key.
+   *
+   * @param key The key associated with the value to be retrieved.
+   * @return A pointer to the value, or nullptr if the key is not in the cache.
+   * @note Does not update position of the associated value
+   */
+  const _ValueT * get(const _KeyT & key) const;
+  /**
+   * @brief Checks if the cache contains a value associated with the specified key.
+   *
+   * @param key The key to check for existence in the cache.
+   * @return True if the key exists in the cache, false otherwise.
+   * @note Does not update position of the associated value
+   */
+  bool contains(const _KeyT & key) const;
+  /**
+   * @brief Size of the frequency sketch in bytes.
+   */
+  SizeType sketch_memory() const;
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Shared implementation of put and emplace.
+   */
+  template<class ...Args>
+  void store(const _KeyT & key, Args && ...args);
+  /**
+   * @brief Moves an entry to the front of its segment, promoting it from
+   *        probation to protected.
+   */
+  void touch(EntryT & entry);
+  /**
+   * @brief Moves the window overflow to the main region and evicts either it
+   *        or the main victim, whichever is less frequent.
+   */
+  void admit();
+  /**
+   * @brief Moves an entry to the front of another segment.
+   */
+  void move(EntryT & entry, SegmentT segment);
+  /**
+   * @brief Removes the entry of the key at the back of a segment.
+   */
+  void evict(SegmentT segment);
+  ListT & list(SegmentT segment);
+  std::uint64_t hash(const _KeyT & key) const;
+//----------------------------------------------------------------------------
+  SizeType                  capacity_;          ///< The maximum number of items that the cache can hold.
+  SizeType                  windowCapacity_;    ///< The maximum number of items in the window.
+  SizeType                  protectedCapacity_; ///< The maximum number of items in the protected segment.
+  ListT                     segments_[3];       ///< Window, probation and protected lists, indexed by `SegmentT`.
+  MapT                      map_;               ///< The map used for fast key-value lookups.
+  Internal::FrequencySketch sketch_;            ///< Popularity estimates of recently seen keys.
+//----------------------------------------------------------------------------
+}; // class TinyLfuCache
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+namespace Internal
+{
+//----------------------------------------------------------------------------
+inline FrequencySketch::FrequencySketch() :
+  FrequencySketch(0)
+{
+}
+//----------------------------------------------------------------------------
+inline FrequencySketch::FrequencySketch(std::size_t capacity) :
+  additions_(0),
+  sampleSize_(10 * (capacity == 0 ? 1 : capacity))
+{
+  // One word (16 counters) per entry, at least one block
+  std::size_t blocks = 1;
+  while (blocks * 8 < capacity)
+    blocks <<= 1;
+  blocks_.resize(blocks);
+  clear();
+}
+//----------------------------------------------------------------------------
+inline unsigned FrequencySketch::frequency(std::uint64_t hash) const
+{
+  const std::uint64_t blockHash   = mix(hash);
+  const std::uint64_t counterHash = mix(blockHash ^ 0x9E3779B97F4A7C15ull);
+  const Block &       block       = blocks_[blockHash & (blocks_.size() - 1)];
+  unsigned result = 15;
+  for (unsigned i = 0; i < 4; ++i)
+  {
+    const std::uint64_t h     = counterHash >> (i << 3);
+    const unsigned      shift = ((h >> 1) & 15) << 2;
+    const unsigned      count = (block.words_[(i << 1) + (h & 1)] >> shift) & 15;
+    result = count < result ? count : result;
+  }
+  return result;
+}
+//----------------------------------------------------------------------------
+inline void FrequencySketch::increment(std::uint64_t hash)
+{
+  const std::uint64_t blockHash   = mix(hash);
+  const std::uint64_t counterHash = mix(blockHash ^ 0x9E3779B97F4A7C15ull);
+  Block &             block       = blocks_[blockHash & (blocks_.size() - 1)];
+  bool added = false;
+  for (unsigned i = 0; i < 4; ++i)
+  {
+    const std::uint64_t h     = counterHash >> (i << 3);
+    const unsigned      shift = ((h >> 1) & 15) << 2;
+    std::uint64_t &     word  = block.words_[(i << 1) + (h & 1)];
+    if (((word >> shift) & 15) != 15)
+    {
+      word += std::uint64_t(1) << shift;
+      added = true;
+    }
+  }
+  if (added && ++additions_ >= sampleSize_)
+    age();
+}
+//----------------------------------------------------------------------------
+inline void FrequencySketch::clear()
+{
+  for (auto & block : blocks_)
+    for (auto & word : block.words_)
+      word = 0;
+  additions_ = 0;
+}
+//----------------------------------------------------------------------------
+inline std::size_t FrequencySketch::memory() const
+{
+  return blocks_.size() * sizeof(Block);
+}
+//----------------------------------------------------------------------------
+inline std::uint64_t FrequencySketch::mix(std::uint64_t hash)
+{
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDull;
+  hash ^= hash >> 33;
+  hash *= 0xC4CEB9FE1A85EC53ull;
+  hash ^= hash >> 33;
+  return hash;
+}
+//----------------------------------------------------------------------------
+inline void FrequencySketch::age()
+{
+  // Halve every counter: shift the word and drop the bit that crossed into
+  // the neighbouring counter. The odd counters lose half an increment each.
+  std::size_t odd = 0;
+  for (auto & block : blocks_)
+    for (auto & word : block.words_)
+    {
+      odd += std::bitset<64>(word & 0x1111111111111111ull).count();
+      word = (word >> 1) & 0x7777777777777777ull;
+    }
+  additions_ = (additions_ - (odd >> 2)) >> 1;
+}
+//----------------------------------------------------------------------------
+template<class _IteratorT, class _ValueT>
+template<class ...Args>
+TinyLfuEntry<_IteratorT, _ValueT>::TinyLfuEntry(const _IteratorT & it, Args && ...args) :
+  it_(it),
+  segment_(TinyLfuSegment::WINDOW),
+  value_(std::forward<Args>(args)...)
+{
+}
+//----------------------------------------------------------------------------
+} // namespace Internal
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::TinyLfuCache() :
+  TinyLfuCache(0)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::TinyLfuCache(SizeType capacity, const _Hash & hash, const _KeyEqual & keyEqual) :
+  capacity_(capacity),
+  windowCapacity_(capacity / 100 == 0 ? 1 : capacity / 100),
+  protectedCapacity_(capacity > windowCapacity_ ? (capacity - windowCapacity_) * 4 / 5 : 0),
+  map_(0, hash, keyEqual),
+  sketch_(capacity)
+{
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::capacity() const
+{
+  return capacity_;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::size() const
+{
+  return map_.size();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, const _ValueT & value)
+{
+  store(key, value);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::put(const _KeyT & key, _ValueT && value)
+{
+  store(key, std::move(value));
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::emplace(const _KeyT & key, Args && ...args)
+{
+  store(key, std::forward<Args>(args)...);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::remove(const _KeyT & key)
+{
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return false;
+  list(it->second.segment_).erase(it->second.it_);
+  map_.erase(it);
+  return true;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::clear()
+{
+  for (auto & segment : segments_)
+    segment.clear();
+  map_.clear();
+  sketch_.clear();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+_ValueT * TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key)
+{
+  sketch_.increment(hash(key));
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return nullptr;
+  touch(it->second);
+  return &(it->second.value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+const _ValueT * TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::get(const _KeyT & key) const
+{
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return nullptr;
+  return &(it->second.value_);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+bool TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::contains(const _KeyT & key) const
+{
+  return map_.find(key) != map_.end();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::SizeType TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::sketch_memory() const
+{
+  return sketch_.memory();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+template<class ...Args>
+void TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::store(const _KeyT & key, Args && ...args)
+{
+  if (capacity_ == 0)
+    return;
+  sketch_.increment(hash(key));
+  auto it = map_.find(key);
+  if (it != map_.end())
+  {
+    it->second.value_ = _ValueT(std::forward<Args>(args)...);
+    touch(it->second);
+    return;
+  }
+  ListT & window = list(SegmentT::WINDOW);
+  window.push_front(key);
+  try
+  {
+    map_.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(window.begin(), std::forward<Args>(args)...));
+  }
+  catch (...)
+  {
+    window.pop_front();
+    throw;
+  }
+  admit();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::touch(EntryT & entry)
+{
+  if (entry.segment_ != SegmentT::PROBATION)
+  {
+    ListT & segment = list(entry.segment_);
+    segment.splice(segment.begin(), segment, entry.it_);
+    return;
+  }
+  move(entry, SegmentT::PROTECTED);
+  if (list(SegmentT::PROTECTED).size() > protectedCapacity_)
+    move(map_.find(list(SegmentT::PROTECTED).back())->second, SegmentT::PROBATION);
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::admit()
+{
+  ListT & window    = list(SegmentT::WINDOW);
+  ListT & probation = list(SegmentT::PROBATION);
+  ListT & protect   = list(SegmentT::PROTECTED);
+  if (window.size() <= windowCapacity_)
+    return;
+  move(map_.find(window.back())->second, SegmentT::PROBATION);
+  if (map_.size() <= capacity_)
+    return;
+  // The candidate is at the front of probation, the victim is the least
+  // recently used entry of the main region other than the candidate
+  if (probation.size() == 1 && protect.empty())
+  {
+    evict(SegmentT::PROBATION);
+    return;
+  }
+  const SegmentT victim = probation.size() > 1 ? SegmentT::PROBATION : SegmentT::PROTECTED;
+  if (sketch_.frequency(hash(probation.front())) > sketch_.frequency(hash(list(victim).back())))
+    evict(victim);
+  else
+  {
+    auto candidate = map_.find(probation.front());
+    probation.pop_front();
+    map_.erase(candidate);
+  }
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::move(EntryT & entry, SegmentT segment)
+{
+  ListT & to = list(segment);
+  to.splice(to.begin(), list(entry.segment_), entry.it_);
+  entry.segment_ = segment;
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+void TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::evict(SegmentT segment)
+{
+  ListT & from = list(segment);
+  map_.erase(from.back());
+  from.pop_back();
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+typename TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::ListT & TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::list(SegmentT segment)
+{
+  return segments_[static_cast<std::size_t>(segment)];
+}
+//----------------------------------------------------------------------------
+template<class _KeyT, class _ValueT, class _Hash, class _KeyEqual>
+std::uint64_t TinyLfuCache<_KeyT, _ValueT, _Hash, _KeyEqual>::hash(const _KeyT & key) const
+{
+  return static_cast<std::uint64_t>(map_.hash_function()(key));
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // TINYLFU_CACHE_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
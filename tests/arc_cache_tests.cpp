@@ -0,0 +1,107 @@
+//----------------------------------------------------------------------------
+#include <string>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "arc_cache.hpp"
+//----------------------------------------------------------------------------
+TEST(ArcCacheTest, Initialization)
+{
+  LRUCache::ArcCache<int, int> empty;
+  empty.put(1, 1);
+  EXPECT_EQ(0, empty.size());
+  EXPECT_EQ(nullptr, empty.get(1));
+
+  LRUCache::ArcCache<int, int> cache(10);
+  EXPECT_EQ(10, cache.capacity());
+  EXPECT_EQ(0, cache.target());
+  for (int i = 0; i < 20; ++i)
+    cache.put(i, i);
+  EXPECT_EQ(10, cache.size());
+  for (int i = 10; i < 20; ++i)
+    EXPECT_EQ(i, *cache.get(i));
+  for (int i = 0; i < 10; ++i)
+    EXPECT_FALSE(cache.contains(i));
+}
+//----------------------------------------------------------------------------
+TEST(ArcCacheTest, PutGetRemove)
+{
+  LRUCache::ArcCache<int, std::string> cache(10);
+  cache.put(1, "1");
+  cache.put(2, std::string("2"));
+  cache.emplace(3, 3, '3');
+  EXPECT_EQ("1", *cache.get(1));
+  EXPECT_EQ("333", *cache.get(3));
+  cache.put(1, "one");
+  const auto & constCache = cache;
+  EXPECT_EQ("one", *constCache.get(1));
+  EXPECT_TRUE(cache.remove(2));
+  EXPECT_FALSE(cache.remove(2));
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_EQ(2, cache.size());
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(nullptr, cache.get(1));
+}
+//----------------------------------------------------------------------------
+TEST(ArcCacheTest, FrequentEntriesSurviveScan)
+{
+  LRUCache::ArcCache<int, int> cache(10);
+  for (int i = 0; i < 5; ++i)
+  {
+    cache.put(i, i);
+    cache.get(i);
+  }
+  for (int i = 100; i < 200; ++i)
+    if (cache.get(i) == nullptr)
+      cache.put(i, i);
+  for (int i = 0; i < 5; ++i)
+    EXPECT_TRUE(cache.contains(i));
+}
+//----------------------------------------------------------------------------
+TEST(ArcCacheTest, GhostHitsAdaptTarget)
+{
+  LRUCache::ArcCache<int, int> cache(4);
+  // Fill T2 with frequent entries, then push recency misses through T1
+  for (int i = 0; i < 4; ++i)
+  {
+    cache.put(i, i);
+    cache.get(i);
+  }
+  cache.put(10, 10);
+  cache.put(11, 11);
+  EXPECT_EQ(0, cache.target());
+  // 10 went to B1, re-requesting it means T1 was too small
+  ASSERT_FALSE(cache.contains(10));
+  cache.put(10, 10);
+  EXPECT_EQ(1, cache.target());
+  EXPECT_TRUE(cache.contains(10));
+  // Keys evicted from T2 went to B2, re-requesting one shrinks T1 again
+  int evictedFrequent = -1;
+  for (int i = 0; i < 4; ++i)
+    if (!cache.contains(i))
+      evictedFrequent = i;
+  ASSERT_NE(-1, evictedFrequent);
+  cache.put(evictedFrequent, evictedFrequent);
+  EXPECT_EQ(0, cache.target());
+  EXPECT_EQ(4, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(ArcCacheTest, NeverExceedsCapacity)
+{
+  for (int capacity : {1, 2, 3, 17})
+  {
+    LRUCache::ArcCache<int, int> cache(capacity);
+    for (int i = 0; i < 2000; ++i)
+    {
+      const int key = (i * 7919) % 61;
+      if (cache.get(key) == nullptr)
+        cache.put(key, key);
+      if (i % 13 == 0)
+        cache.remove(i % 61);
+      EXPECT_LE(cache.size(), static_cast<std::size_t>(capacity));
+      EXPECT_LE(cache.target(), static_cast<std::size_t>(capacity));
+    }
+  }
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,201 @@
+//----------------------------------------------------------------------------
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <stdexcept>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "async_cache.hpp"
+//----------------------------------------------------------------------------
+/**
+ * @brief Loader that blocks until the test opens it, and counts its calls.
+ */
+struct GatedLoader
+{
+  std::promise<void>       gate_;
+  std::shared_future<void> open_ = gate_.get_future().share();
+  std::atomic<int>         calls_{0};
+
+  std::string operator ()(int key)
+  {
+    ++calls_;
+    open_.wait();
+    if (key < 0)
+      throw std::runtime_error("negative key");
+    return std::to_string(key);
+  }
+};
+//----------------------------------------------------------------------------
+static bool isReady(const std::shared_future<std::string> & future)
+{
+  return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+//----------------------------------------------------------------------------
+static bool isBroken(const std::shared_future<std::string> & future)
+{
+  try
+  {
+    future.get();
+  }
+  catch (const std::future_error & error)
+  {
+    return error.code() == std::future_errc::broken_promise;
+  }
+  return false;
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Waits until the loader has started `calls` loads.
+ */
+static void waitForCalls(const GatedLoader & loader, int calls)
+{
+  while (loader.calls_.load() < calls)
+    std::this_thread::yield();
+}
+//----------------------------------------------------------------------------
+TEST(AsyncCacheTest, HitIsReady)
+{
+  int calls = 0;
+  LRUCache::AsyncCache<int, std::string> cache(10, [&calls](int key) { ++calls; return std::to_string(key); }, 2);
+  EXPECT_EQ(10, cache.capacity());
+  cache.put(1, "one");
+  auto future = cache.get_async(1);
+  ASSERT_TRUE(isReady(future));
+  EXPECT_EQ("one", future.get());
+  EXPECT_EQ("2", cache.get_async(2).get());
+  EXPECT_TRUE(isReady(cache.get_async(2)));
+  EXPECT_EQ(1, calls);
+  EXPECT_EQ(2, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(AsyncCacheTest, MissesAreDeduplicated)
+{
+  GatedLoader loader;
+  LRUCache::AsyncCache<int, std::string> cache(10, std::ref(loader), 4);
+  auto first  = cache.get_async(5);
+  auto second = cache.get_async(5);
+  EXPECT_FALSE(isReady(first));
+  EXPECT_TRUE(cache.contains(5));
+  loader.gate_.set_value();
+  EXPECT_EQ("5", first.get());
+  EXPECT_EQ("5", second.get());
+  EXPECT_EQ(1, loader.calls_.load());
+}
+//----------------------------------------------------------------------------
+TEST(AsyncCacheTest, PendingEntriesCountTowardCapacity)
+{
+  GatedLoader loader;
+  LRUCache::AsyncCache<int, std::string> cache(2, std::ref(loader), 1);
+  auto first = cache.get_async(1);
+  waitForCalls(loader, 1);
+  cache.get_async(2);
+  cache.get_async(3);
+  EXPECT_EQ(2, cache.size());
+  EXPECT_FALSE(cache.contains(1));
+  loader.gate_.set_value();
+  // The evicted load had started, so it still completes its waiters
+  EXPECT_EQ("1", first.get());
+  EXPECT_EQ("3", cache.get_async(3).get());
+  EXPECT_FALSE(cache.contains(1));
+}
+//----------------------------------------------------------------------------
+TEST(AsyncCacheTest, FailedLoadIsNotCached)
+{
+  GatedLoader loader;
+  loader.gate_.set_value();
+  LRUCache::AsyncCache<int, std::string> cache(10, std::ref(loader), 2);
+  auto future = cache.get_async(-1);
+  EXPECT_THROW(future.get(), std::runtime_error);
+  EXPECT_FALSE(cache.contains(-1));
+  EXPECT_THROW(cache.get_async(-1).get(), std::runtime_error);
+  EXPECT_EQ(2, loader.calls_.load());
+}
+//----------------------------------------------------------------------------
+TEST(AsyncCacheTest, RemoveCancelsPendingLoad)
+{
+  GatedLoader loader;
+  LRUCache::AsyncCache<int, std::string> cache(10, std::ref(loader), 1);
+  // The only worker is busy with 1, so the load of 2 is still queued
+  auto first  = cache.get_async(1);
+  auto second = cache.get_async(2);
+  EXPECT_TRUE(cache.remove(2));
+  EXPECT_FALSE(cache.remove(2));
+  loader.gate_.set_value();
+  EXPECT_EQ("1", first.get());
+  try
+  {
+    second.get();
+    FAIL() << "cancelled load completed";
+  }
+  catch (const std::future_error & error)
+  {
+    EXPECT_EQ(std::future_errc::broken_promise, error.code());
+  }
+  EXPECT_EQ(1, loader.calls_.load());
+}
+//----------------------------------------------------------------------------
+TEST(AsyncCacheTest, PutReplacesPendingLoad)
+{
+  GatedLoader loader;
+  LRUCache::AsyncCache<int, std::string> cache(10, std::ref(loader), 1);
+  auto first = cache.get_async(1);
+  cache.get_async(2);
+  cache.put(2, "two");
+  EXPECT_EQ("two", cache.get_async(2).get());
+  loader.gate_.set_value();
+  EXPECT_EQ("1", first.get());
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(AsyncCacheTest, EvictionCancelsPendingLoad)
+{
+  GatedLoader loader;
+  LRUCache::AsyncCache<int, std::string> cache(1, std::ref(loader), 1);
+  auto first = cache.get_async(1);
+  waitForCalls(loader, 1);
+  // The load of 2 is queued behind 1, then evicted by 3
+  auto second = cache.get_async(2);
+  auto third  = cache.get_async(3);
+  EXPECT_FALSE(cache.contains(2));
+  loader.gate_.set_value();
+  EXPECT_EQ("1", first.get());
+  EXPECT_TRUE(isBroken(second));
+  EXPECT_EQ("3", third.get());
+  EXPECT_EQ(2, loader.calls_.load());
+}
+//----------------------------------------------------------------------------
+TEST(AsyncCacheTest, ClearCancelsPendingLoads)
+{
+  GatedLoader loader;
+  LRUCache::AsyncCache<int, std::string> cache(10, std::ref(loader), 1);
+  auto first = cache.get_async(1);
+  waitForCalls(loader, 1);
+  auto second = cache.get_async(2);
+  cache.clear();
+  loader.gate_.set_value();
+  EXPECT_EQ("1", first.get());
+  EXPECT_TRUE(isBroken(second));
+  EXPECT_EQ(1, loader.calls_.load());
+  EXPECT_EQ(0, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(AsyncCacheTest, FullQueueRejectsLoad)
+{
+  GatedLoader loader;
+  LRUCache::AsyncCache<int, std::string> cache(10, std::ref(loader), 1, 1);
+  auto first = cache.get_async(1);
+  waitForCalls(loader, 1);
+  auto second = cache.get_async(2);
+  auto third  = cache.get_async(3);
+  EXPECT_FALSE(cache.contains(3));
+  EXPECT_TRUE(isBroken(third));
+  loader.gate_.set_value();
+  EXPECT_EQ("1", first.get());
+  EXPECT_EQ("2", second.get());
+  EXPECT_EQ("3", cache.get_async(3).get());
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
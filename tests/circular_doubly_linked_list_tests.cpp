@@ -1,29 +1,72 @@
 //----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <iterator>
+#include <memory_resource>
+//----------------------------------------------------------------------------
 #include <gtest/gtest.h>
 //----------------------------------------------------------------------------
+#include "lru_cache.hpp"
 #include "circular_doubly_linked_list.hpp"
 //----------------------------------------------------------------------------
+namespace
+{
+//----------------------------------------------------------------------------
+template<class _ListT>
+std::vector<int> items(const _ListT & list)
+{
+  return std::vector<int>(list.begin(), list.end());
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Memory resource that counts the blocks it hands out.
+ */
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+  std::size_t allocations_   = 0;
+  std::size_t deallocations_ = 0;
+private:
+  void * do_allocate(std::size_t bytes, std::size_t alignment) override
+  {
+    ++allocations_;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void * p, std::size_t bytes, std::size_t alignment) override
+  {
+    ++deallocations_;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override
+  {
+    return this == &other;
+  }
+};
+//----------------------------------------------------------------------------
+} // namespace
+//----------------------------------------------------------------------------
 TEST(CircularDoublyLinkedListTest, Initialization)
 {
   {
-    CircularDoublyLinkedList<int> list;
+    LRUCache::CircularDoublyLinkedList<int> list;
     EXPECT_EQ(0, list.size());
     EXPECT_TRUE(list.empty());
+    EXPECT_TRUE(list.begin() == list.end());
   }
   {
-    CircularDoublyLinkedList<int> list = {1};
+    LRUCache::CircularDoublyLinkedList<int> list = {1};
     ASSERT_EQ(1, list.size());
     EXPECT_EQ(1, list.back());
     EXPECT_EQ(1, list.front());
   }
   {
-    CircularDoublyLinkedList<int> list = {1, 2};
+    LRUCache::CircularDoublyLinkedList<int> list = {1, 2};
     ASSERT_EQ(2, list.size());
     EXPECT_EQ(1, list.front());
     EXPECT_EQ(2, list.back());
   }
   {
-    CircularDoublyLinkedList<int> list = {1, 2, 3};
+    LRUCache::CircularDoublyLinkedList<int> list = {1, 2, 3};
     ASSERT_EQ(3, list.size());
     EXPECT_EQ(1, list.front());
     EXPECT_EQ(3, list.back());
@@ -33,53 +76,61 @@ TEST(CircularDoublyLinkedListTest, Initialization)
 TEST(CircularDoublyLinkedListTest, Iterators)
 {
   {
-    CircularDoublyLinkedList<int> list = {1};
-    auto it = list.begin();
+    LRUCache::CircularDoublyLinkedList<int> list = {1};
     std::size_t times = 0;
-    for ( ; it != list.end(); ++it)
+    for (auto it = list.begin(); it != list.end(); ++it)
       ++times;
     EXPECT_EQ(1, times);
   }
   {
-    CircularDoublyLinkedList<int> list = {1, 2, 3};
+    LRUCache::CircularDoublyLinkedList<int> list = {1, 2, 3};
     auto it = list.begin();
     auto end = list.end();
     EXPECT_FALSE(it == end);
-    EXPECT_EQ(1, it->value_);
+    EXPECT_EQ(1, *it);
     ++it;
     --it;
-    EXPECT_FALSE(it == end);
+    EXPECT_EQ(1, *it);
     ++it;
-    EXPECT_EQ(2, it->value_);
+    EXPECT_EQ(2, *it);
     ++it;
-    EXPECT_EQ(3, it->value_);
+    EXPECT_EQ(3, *it);
     ++it;
     EXPECT_TRUE(it == end);
-    EXPECT_EQ(1, it->value_);
+    EXPECT_EQ(3, *std::prev(end));
+    EXPECT_EQ(3, std::distance(list.begin(), list.end()));
+    EXPECT_EQ(std::vector<int>({3, 2, 1}), std::vector<int>(list.rbegin(), list.rend()));
+    // One pointer per iterator
+    EXPECT_EQ(sizeof(void *), sizeof(it));
+  }
+  {
+    LRUCache::CircularDoublyLinkedList<std::string> list = {"a"};
+    LRUCache::CircularDoublyLinkedList<std::string>::const_iterator it = list.begin();
+    EXPECT_EQ(1, it->size());
   }
 }
 //----------------------------------------------------------------------------
 TEST(CircularDoublyLinkedListTest, PushBack)
 {
   {
-    CircularDoublyLinkedList<int> list;
+    LRUCache::CircularDoublyLinkedList<int> list;
     ASSERT_TRUE(list.empty());
 
-    list.pushBack(1);
+    list.push_back(1);
     ASSERT_EQ(1, list.size());
     EXPECT_EQ(1, list.front());
     EXPECT_EQ(1, list.back());
 
-    list.pushBack(2);
+    list.push_back(2);
     ASSERT_EQ(2, list.size());
     EXPECT_EQ(1, list.front());
     EXPECT_EQ(2, list.back());
   }
   {
-    CircularDoublyLinkedList<int> list;
+    LRUCache::CircularDoublyLinkedList<int> list;
 
     for (int i = 0; i < 1000; ++i)
-      list.pushBack(i);
+      list.push_back(i);
 
     EXPECT_EQ(1000, list.size());
     EXPECT_EQ(0, list.front());
@@ -90,54 +141,56 @@ TEST(CircularDoublyLinkedListTest, PushBack)
 TEST(CircularDoublyLinkedListTest, PopBack)
 {
   {
-    CircularDoublyLinkedList<int> list;
+    LRUCache::CircularDoublyLinkedList<int> list;
 
-    list.pushBack(1);
-    list.popBack();
+    list.push_back(1);
+    list.pop_back();
     ASSERT_EQ(0, list.size());
   }
   {
-    CircularDoublyLinkedList<int> list;
+    LRUCache::CircularDoublyLinkedList<int> list;
 
-    list.pushBack(1);
-    list.pushBack(2);
-    list.pushBack(3);
-    list.popBack();
+    list.push_back(1);
+    list.push_back(2);
+    list.push_back(3);
+    list.pop_back();
     ASSERT_EQ(2, list.size());
     EXPECT_EQ(1, list.front());
     EXPECT_EQ(2, list.back());
   }
   {
-    CircularDoublyLinkedList<int> list;
+    LRUCache::CircularDoublyLinkedList<int> list;
 
     for (int i = 0; i < 1000; ++i)
-      list.pushBack(i);
+      list.push_back(i);
     while (list.empty() == false)
-      list.popBack();
+      list.pop_back();
+    EXPECT_TRUE(list.begin() == list.end());
   }
 }
 //----------------------------------------------------------------------------
 TEST(CircularDoublyLinkedListTest, PushFront)
 {
   {
-    CircularDoublyLinkedList<int> list;
+    LRUCache::CircularDoublyLinkedList<int> list;
 
-    list.pushFront(1);
+    list.push_front(1);
     ASSERT_EQ(1, list.size());
     EXPECT_EQ(1, list.front());
-    list.pushFront(2);
+    list.push_front(2);
     ASSERT_EQ(2, list.size());
     EXPECT_EQ(2, list.front());
-    list.pushFront(3);
+    list.emplace_front(3);
     ASSERT_EQ(3, list.size());
     EXPECT_EQ(3, list.front());
+    EXPECT_EQ(std::vector<int>({3, 2, 1}), items(list));
   }
   {
-    CircularDoublyLinkedList<int> list;
+    LRUCache::CircularDoublyLinkedList<int> list;
 
-    for (std::size_t i = 0; i < 1000; ++i)
+    for (int i = 0; i < 1000; ++i)
     {
-      list.pushFront(i);
+      list.push_front(i);
       EXPECT_EQ(i, list.front());
     }
   }
@@ -146,120 +199,198 @@ TEST(CircularDoublyLinkedListTest, PushFront)
 TEST(CircularDoublyLinkedListTest, PopFront)
 {
   {
-    CircularDoublyLinkedList<int> list;
+    LRUCache::CircularDoublyLinkedList<int> list;
 
-    list.pushFront(1);
-    list.popFront();
+    list.push_front(1);
+    list.pop_front();
     ASSERT_EQ(0, list.size());
   }
   {
-    CircularDoublyLinkedList<int> list;
+    LRUCache::CircularDoublyLinkedList<int> list;
 
-    list.pushFront(1);
-    list.pushFront(2);
-    list.pushFront(3);
+    list.push_front(1);
+    list.push_front(2);
+    list.push_front(3);
     ASSERT_EQ(3, list.size());
-    list.popFront();
+    list.pop_front();
     ASSERT_EQ(2, list.size());
     EXPECT_EQ(2, list.front());
     EXPECT_EQ(1, list.back());
-    list.popFront();
+    list.pop_front();
     ASSERT_EQ(1, list.size());
     EXPECT_EQ(1, list.front());
     EXPECT_EQ(1, list.back());
   }
-  {
-    CircularDoublyLinkedList<int> list;
-
-    for (std::size_t i = 0; i < 10; ++i)
-      list.pushFront(i);
-    while (list.empty() == false)
-      list.popFront();
-  }
+}
+//----------------------------------------------------------------------------
+TEST(CircularDoublyLinkedListTest, Erase)
+{
+  LRUCache::CircularDoublyLinkedList<int> list = {1, 2, 3, 4, 5};
+  auto it = list.erase(std::next(list.begin()));
+  EXPECT_EQ(3, *it);
+  EXPECT_EQ(std::vector<int>({1, 3, 4, 5}), items(list));
+  it = list.erase(it, std::prev(list.end()));
+  EXPECT_EQ(5, *it);
+  EXPECT_EQ(std::vector<int>({1, 5}), items(list));
+  it = list.insert(it, 4);
+  EXPECT_EQ(std::vector<int>({1, 4, 5}), items(list));
+  list.erase(list.begin(), list.end());
+  EXPECT_TRUE(list.empty());
 }
 //----------------------------------------------------------------------------
 TEST(CircularDoublyLinkedListTest, ToFront)
 {
   {
-    CircularDoublyLinkedList<int> list;
-
-    list.pushFront(10);
-    EXPECT_EQ(10, list.front());
-
-    auto it = list.begin();
-    list.toFront(it);
-
+    LRUCache::CircularDoublyLinkedList<int> list = {10};
+    list.splice(list.begin(), list, list.begin());
     EXPECT_EQ(10, list.front());
   }
   {
-    CircularDoublyLinkedList<int> list;
-
-    list.pushFront(20);
-    list.pushFront(10);
-    EXPECT_EQ(10, list.front());
-    EXPECT_EQ(20, list.back());
-    auto it = list.begin();
-    ++it;
-    list.toFront(it);
+    LRUCache::CircularDoublyLinkedList<int> list = {10, 20};
+    list.splice(list.begin(), list, std::next(list.begin()));
     EXPECT_EQ(20, list.front());
     EXPECT_EQ(10, list.back());
   }
   {
-    CircularDoublyLinkedList<int> list;
-
-    list.pushFront(30);
-    list.pushFront(20);
-    list.pushFront(10);
-    EXPECT_EQ(10, list.front());
-    EXPECT_EQ(30, list.back());
-    auto it = list.begin();
-    ++it;
-    list.toFront(it);
-    EXPECT_EQ(20, list.front());
-    EXPECT_EQ(30, list.back());
+    LRUCache::CircularDoublyLinkedList<int> list = {10, 20, 30};
+    auto it = std::next(list.begin());
+    list.splice(list.begin(), list, it);
+    EXPECT_EQ(std::vector<int>({20, 10, 30}), items(list));
+    // The iterator still points to the moved element
+    EXPECT_EQ(20, *it);
+    EXPECT_EQ(3, list.size());
   }
 }
 //----------------------------------------------------------------------------
 TEST(CircularDoublyLinkedListTest, ToBack)
 {
   {
-    CircularDoublyLinkedList<int> list;
-
-    list.pushFront(10);
-    EXPECT_EQ(10, list.front());
-
-    auto it = list.begin();
-    list.toBack(it);
-
+    LRUCache::CircularDoublyLinkedList<int> list = {10};
+    list.splice(list.end(), list, list.begin());
     EXPECT_EQ(10, list.front());
   }
   {
-    CircularDoublyLinkedList<int> list;
-
-    list.pushFront(20);
-    list.pushFront(10);
-    EXPECT_EQ(10, list.front());
-    EXPECT_EQ(20, list.back());
-
-    auto it = list.begin();
-    list.toBack(it);
-
+    LRUCache::CircularDoublyLinkedList<int> list = {10, 20};
+    list.splice(list.end(), list, list.begin());
     EXPECT_EQ(20, list.front());
     EXPECT_EQ(10, list.back());
   }
   {
-    CircularDoublyLinkedList<int> list;
+    LRUCache::CircularDoublyLinkedList<int> list = {10, 20, 30};
+    list.splice(list.end(), list, std::next(list.begin()));
+    EXPECT_EQ(std::vector<int>({10, 30, 20}), items(list));
+  }
+  {
+    LRUCache::CircularDoublyLinkedList<int> from = {1, 2};
+    LRUCache::CircularDoublyLinkedList<int> to = {3};
+    to.splice(to.end(), from, from.begin());
+    EXPECT_EQ(std::vector<int>({2}), items(from));
+    EXPECT_EQ(std::vector<int>({3, 1}), items(to));
+    EXPECT_EQ(1, from.size());
+    EXPECT_EQ(2, to.size());
+  }
+}
+//----------------------------------------------------------------------------
+TEST(CircularDoublyLinkedListTest, CopyAndMove)
+{
+  LRUCache::CircularDoublyLinkedList<std::string> list = {"a", "b", "c"};
+  LRUCache::CircularDoublyLinkedList<std::string> copy(list);
+  EXPECT_EQ(3, copy.size());
+  EXPECT_EQ("a", copy.front());
+
+  LRUCache::CircularDoublyLinkedList<std::string> moved(std::move(copy));
+  EXPECT_TRUE(copy.empty());
+  EXPECT_TRUE(copy.begin() == copy.end());
+  ASSERT_EQ(3, moved.size());
+  EXPECT_EQ("c", *std::prev(moved.end()));
+  EXPECT_EQ("a", *std::prev(moved.end(), 3));
+
+  copy = moved;
+  moved.clear();
+  moved = std::move(copy);
+  EXPECT_EQ(3, moved.size());
+  EXPECT_EQ("b", *std::next(moved.begin()));
+
+  // Another resource: the elements are moved into new nodes
+  CountingResource resource;
+  LRUCache::CircularDoublyLinkedList<std::string> other(&resource);
+  other = std::move(moved);
+  EXPECT_TRUE(moved.empty());
+  EXPECT_EQ(3, other.size());
+  EXPECT_EQ(3, resource.allocations_);
+}
+//----------------------------------------------------------------------------
+TEST(CircularDoublyLinkedListTest, MemoryResource)
+{
+  CountingResource resource;
+  {
+    LRUCache::CircularDoublyLinkedList<int> list(&resource);
+    EXPECT_EQ(&resource, list.get_allocator().resource());
+    for (int i = 0; i < 100; ++i)
+      list.push_back(i);
+    EXPECT_EQ(100, resource.allocations_);
+    // Erased nodes are kept for the next insertions, up to MAX_SPARES
+    list.pop_front();
+    list.push_back(100);
+    EXPECT_EQ(100, resource.allocations_);
+    EXPECT_EQ(0, resource.deallocations_);
+    list.erase(list.begin(), list.end());
+    EXPECT_EQ(100 - list.MAX_SPARES, resource.deallocations_);
+    list.clear();
+    EXPECT_EQ(100, resource.deallocations_);
+  }
+  EXPECT_EQ(100, resource.deallocations_);
+}
+//----------------------------------------------------------------------------
+TEST(CircularDoublyLinkedListTest, CacheList)
+{
+  using ListT = LRUCache::CircularDoublyLinkedList<int>;
+  std::pmr::unsynchronized_pool_resource pool;
+  LRUCache::Cache<int, int, ListT> cache(3, &pool);
+  cache.put(1, 1);
+  cache.put(2, 2);
+  cache.put(3, 3);
+  ASSERT_NE(nullptr, cache.get(1));
+  cache.put(4, 4);
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_TRUE(cache.remove(3));
+  EXPECT_EQ(2, cache.size());
+  cache.clear();
+  EXPECT_EQ(nullptr, cache.get(1));
 
-    list.pushFront(30);
-    list.pushFront(20);
-    list.pushFront(10);
-    EXPECT_EQ(10, list.front());
-    EXPECT_EQ(30, list.back());
-    auto it = list.begin();
-    ++it;
-    list.toBack(it);
-    EXPECT_EQ(10, list.front());
-    EXPECT_EQ(20, list.back());
+  // Every node comes from the resource
+  CountingResource resource;
+  using LfuListT = LRUCache::CircularDoublyLinkedList<LRUCache::Internal::LfuEntry<int>>;
+  LRUCache::Cache<int, int, LfuListT, LRUCache::Internal::MapT<int, int, LfuListT>, LRUCache::UnitWeigher, LRUCache::LfuPolicy> lfu(2, &resource);
+  lfu.put(1, 1);
+  lfu.put(2, 2);
+  lfu.get(1);
+  lfu.put(3, 3);
+  EXPECT_TRUE(lfu.contains(1));
+  EXPECT_FALSE(lfu.contains(2));
+  // The node of the evicted entry holds the new one
+  EXPECT_EQ(2, resource.allocations_);
+  EXPECT_EQ(0, resource.deallocations_);
+}
+//----------------------------------------------------------------------------
+TEST(CircularDoublyLinkedListTest, CacheMap)
+{
+  using ListT = LRUCache::CircularDoublyLinkedList<int>;
+  using MapT  = LRUCache::Internal::PmrHashMapT<int, int, ListT>;
+  CountingResource resource;
+  {
+    LRUCache::Cache<int, int, ListT, MapT> cache(2, &resource);
+    cache.put(1, 1);
+    cache.put(2, 2);
+    // 2 list nodes, 2 map nodes and the buckets
+    EXPECT_LT(4, resource.allocations_);
+    // Evictions free map nodes back to the resource, not to the heap
+    for (int i = 3; i < 100; ++i)
+      cache.put(i, i);
+    EXPECT_EQ(2, cache.size());
+    EXPECT_LT(0, resource.deallocations_);
   }
+  EXPECT_EQ(resource.allocations_, resource.deallocations_);
 }
 //----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,143 @@
+//----------------------------------------------------------------------------
+#include <thread>
+#include <vector>
+#include <string>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "clock_cache.hpp"
+//----------------------------------------------------------------------------
+TEST(ClockCacheTest, Initialization)
+{
+  LRUCache::ClockCache<int, int> empty(0);
+  empty.put(1, 1);
+  EXPECT_EQ(0, empty.size());
+  EXPECT_FALSE(empty.contains(1));
+
+  LRUCache::ClockCache<int, int> cache(10);
+  EXPECT_EQ(10, cache.capacity());
+  EXPECT_EQ(0, cache.size());
+  int value = 0;
+  EXPECT_FALSE(cache.get(1, value));
+}
+//----------------------------------------------------------------------------
+TEST(ClockCacheTest, PutGetRemove)
+{
+  LRUCache::ClockCache<int, std::string> cache(10);
+  cache.put(1, "1");
+  cache.put(2, std::string("2"));
+  cache.emplace(3, 3, '3');
+  std::string value;
+  ASSERT_TRUE(cache.get(3, value));
+  EXPECT_EQ("333", value);
+  cache.put(3, "three");
+  ASSERT_TRUE(cache.get(3, value));
+  EXPECT_EQ("three", value);
+  EXPECT_EQ(3, cache.size());
+  EXPECT_TRUE(cache.remove(2));
+  EXPECT_FALSE(cache.remove(2));
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_EQ(2, cache.size());
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_FALSE(cache.get(1, value));
+}
+//----------------------------------------------------------------------------
+TEST(ClockCacheTest, SecondChance)
+{
+  LRUCache::ClockCache<int, int> cache(3);
+  cache.put(1, 1);
+  cache.put(2, 2);
+  cache.put(3, 3);
+  int value = 0;
+  ASSERT_TRUE(cache.get(1, value));
+  cache.put(4, 4);
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(3));
+  EXPECT_TRUE(cache.contains(4));
+  EXPECT_EQ(3, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(ClockCacheTest, RemovedSlotsAreReused)
+{
+  LRUCache::ClockCache<int, int> cache(4);
+  for (int i = 0; i < 4; ++i)
+    cache.put(i, i);
+  EXPECT_TRUE(cache.remove(1));
+  cache.put(10, 10);
+  for (int i : {0, 2, 3, 10})
+    EXPECT_TRUE(cache.contains(i));
+  EXPECT_EQ(4, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(ClockCacheTest, ConcurrentAccess)
+{
+  LRUCache::ClockCache<int, int> cache(500);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t)
+  {
+    threads.emplace_back([&cache, t]()
+    {
+      for (int i = 0; i < 20000; ++i)
+      {
+        const int key = (i * 13 + t) % 2000;
+        int value = 0;
+        if (cache.get(key, value))
+          EXPECT_EQ(key, value);
+        else
+          cache.put(key, key);
+        if (i % 97 == 0)
+          cache.remove(key);
+      }
+    });
+  }
+  for (auto & thread : threads)
+    thread.join();
+  EXPECT_LE(cache.size(), cache.capacity());
+}
+//----------------------------------------------------------------------------
+TEST(ClockCacheTest, StridedKeysSurviveRemovals)
+{
+  // Strided keys collide under an identity hash; removals shift their probe runs back
+  LRUCache::ClockCache<int, int> cache(64);
+  for (int i = 0; i < 64; ++i)
+    cache.put(i * 1024, i);
+  for (int i = 0; i < 64; i += 2)
+    EXPECT_TRUE(cache.remove(i * 1024));
+  int value = 0;
+  for (int i = 0; i < 64; ++i)
+  {
+    EXPECT_EQ(i % 2 == 1, cache.get(i * 1024, value));
+    if (i % 2 == 1)
+      EXPECT_EQ(i, value);
+  }
+  EXPECT_EQ(32, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(ClockCacheTest, ConcurrentStringValues)
+{
+  LRUCache::ClockCache<int, std::string> cache(64);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&cache, t]()
+    {
+      for (int i = 0; i < 20000; ++i)
+      {
+        const int key = (i * 7 + t) % 256;
+        std::string value;
+        if (cache.get(key, value))
+          EXPECT_EQ(std::string(64, static_cast<char>('a' + key % 26)), value);
+        else
+          cache.put(key, std::string(64, static_cast<char>('a' + key % 26)));
+        if (i % 31 == 0)
+          cache.remove(key);
+      }
+    });
+  }
+  for (auto & thread : threads)
+    thread.join();
+  EXPECT_LE(cache.size(), cache.capacity());
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,206 @@
+//----------------------------------------------------------------------------
+#include <chrono>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "expiring_cache.hpp"
+//----------------------------------------------------------------------------
+namespace
+{
+//----------------------------------------------------------------------------
+struct ManualClock
+{
+  using duration   = std::chrono::milliseconds;
+  using rep        = duration::rep;
+  using period     = duration::period;
+  using time_point = std::chrono::time_point<ManualClock>;
+  static constexpr bool is_steady = true;
+
+  time_point * now_;
+
+  time_point now() const
+  {
+    return *now_;
+  }
+};
+//----------------------------------------------------------------------------
+using Ms   = std::chrono::milliseconds;
+using Time = ManualClock::time_point;
+//----------------------------------------------------------------------------
+} // namespace
+//----------------------------------------------------------------------------
+TEST(ExpiringCacheTest, Initialization)
+{
+  LRUCache::ExpiringCache<int, int> empty;
+  empty.put(1, 1);
+  EXPECT_EQ(0, empty.size());
+  EXPECT_EQ(nullptr, empty.get(1));
+
+  LRUCache::ExpiringCache<int, int> cache(10);
+  EXPECT_EQ(10, cache.capacity());
+  EXPECT_EQ(std::chrono::steady_clock::duration::max(), cache.ttl());
+  for (int i = 0; i < 20; ++i)
+    cache.put(i, i);
+  EXPECT_EQ(10, cache.size());
+  EXPECT_EQ(nullptr, cache.get(9));
+  EXPECT_EQ(19, *cache.get(19));
+}
+//----------------------------------------------------------------------------
+TEST(ExpiringCacheTest, DefaultTtl)
+{
+  Time now;
+  LRUCache::ExpiringCache<int, std::string, ManualClock> cache(10, Ms(100), ManualClock{&now});
+  cache.put(1, "1");
+  cache.emplace(2, 1, '2');
+  now += Ms(99);
+  ASSERT_NE(nullptr, cache.get(1));
+  EXPECT_EQ("2", *cache.get(2));
+  now += Ms(1);
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_EQ(nullptr, cache.get(1));
+  EXPECT_EQ(nullptr, cache.get(2));
+  EXPECT_EQ(0, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(ExpiringCacheTest, PerEntryTtl)
+{
+  Time now;
+  LRUCache::ExpiringCache<int, int, ManualClock> cache(10, Ms(1000), ManualClock{&now});
+  cache.put(1, 1);
+  cache.put(2, 2, Ms(10));
+  cache.emplace_for(3, Ms::max(), 3);
+  cache.put(4, 4, Ms(0));
+  EXPECT_FALSE(cache.contains(4));
+  now += Ms(10);
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(1));
+  // Updating an entry restarts its TTL
+  now += Ms(900);
+  cache.put(1, 10, Ms(200));
+  now += Ms(150);
+  EXPECT_EQ(10, *cache.get(1));
+  now += Ms(50);
+  EXPECT_EQ(nullptr, cache.get(1));
+  now += std::chrono::hours(24 * 365);
+  EXPECT_EQ(3, *cache.get(3));
+  EXPECT_FALSE(cache.remove(1));
+  EXPECT_TRUE(cache.remove(3));
+  EXPECT_EQ(0, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(ExpiringCacheTest, ReclaimsWithoutLookup)
+{
+  Time now;
+  LRUCache::ExpiringCache<int, int, ManualClock> cache(1000, Ms::max(), ManualClock{&now});
+  for (int i = 0; i < 500; ++i)
+    cache.put(i, i, Ms(1 + i * 997 % 200000));
+  cache.put(-1, -1);
+  EXPECT_EQ(501, cache.size());
+  now += Ms(100000);
+  cache.purge();
+  EXPECT_LT(cache.size(), 501u);
+  EXPECT_GT(cache.size(), 1u);
+  now += Ms(100000);
+  cache.purge();
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(-1, *cache.get(-1));
+}
+//----------------------------------------------------------------------------
+TEST(ExpiringCacheTest, CapacityEvictsLeastRecentlyUsed)
+{
+  Time now;
+  LRUCache::ExpiringCache<int, int, ManualClock> cache(2, Ms(100), ManualClock{&now});
+  cache.put(1, 1);
+  cache.put(2, 2);
+  cache.get(1);
+  cache.put(3, 3);
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(3));
+  // The evicted entry's timer must be gone as well
+  now += Ms(100);
+  cache.purge();
+  EXPECT_EQ(0, cache.size());
+  cache.clear();
+  cache.put(4, 4);
+  EXPECT_EQ(4, *cache.get(4));
+}
+//----------------------------------------------------------------------------
+TEST(ExpiringCacheTest, RemovalListener)
+{
+  Time now;
+  LRUCache::ExpiringCache<int, int, ManualClock> cache(2, Ms(100), ManualClock{&now});
+  std::vector<std::pair<int, LRUCache::RemovalCause>> removed;
+  cache.set_removal_listener([&removed](int key, int, LRUCache::RemovalCause cause)
+  {
+    removed.emplace_back(key, cause);
+  });
+  cache.put(1, 1);
+  cache.put(2, 2, Ms(10));
+  cache.put(1, 10);
+  cache.put(3, 3);
+  now += Ms(100);
+  cache.purge();
+  cache.put(4, 4);
+  cache.remove(4);
+  using Cause = LRUCache::RemovalCause;
+  const std::vector<std::pair<int, Cause>> expected = {
+    {1, Cause::REPLACED}, {2, Cause::SIZE}, {1, Cause::EXPIRED}, {3, Cause::EXPIRED}, {4, Cause::EXPLICIT}
+  };
+  EXPECT_EQ(expected, removed);
+}
+//----------------------------------------------------------------------------
+TEST(TimerWheelTest, FiresEveryTimerOnceAtItsTick)
+{
+  struct Timer : LRUCache::Internal::TimerNode
+  {
+    std::uint64_t fired_ = 0;
+  };
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<std::uint64_t> delays(1, 1u << 26);
+  std::vector<Timer> timers(2000);
+  LRUCache::Internal::TimerWheel wheel;
+  for (auto & timer : timers)
+    wheel.schedule(&timer, delays(gen));
+
+  std::uint64_t now = 0;
+  std::uniform_int_distribution<std::uint64_t> steps(1, 1u << 16);
+  while (now <= (1u << 26) + 1)
+  {
+    const std::uint64_t previous = now;
+    now += steps(gen);
+    wheel.advance(now, [now, previous](LRUCache::Internal::TimerNode * node)
+    {
+      auto & timer = static_cast<Timer &>(*node);
+      EXPECT_LE(timer.expiry_, now);
+      EXPECT_GT(timer.expiry_, previous);
+      ++timer.fired_;
+    });
+  }
+  for (const auto & timer : timers)
+    EXPECT_EQ(1u, timer.fired_);
+}
+//----------------------------------------------------------------------------
+TEST(TimerWheelTest, Cancel)
+{
+  LRUCache::Internal::TimerNode first, second;
+  LRUCache::Internal::TimerWheel wheel;
+  wheel.schedule(&first, 10);
+  wheel.schedule(&second, 10);
+  LRUCache::Internal::TimerWheel::cancel(&first);
+  LRUCache::Internal::TimerWheel::cancel(&first);
+  int fired = 0;
+  wheel.advance(100, [&fired, &second](LRUCache::Internal::TimerNode * node)
+  {
+    EXPECT_EQ(&second, node);
+    ++fired;
+  });
+  EXPECT_EQ(1, fired);
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
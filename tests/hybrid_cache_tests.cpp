@@ -0,0 +1,180 @@
+//----------------------------------------------------------------------------
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <utility>
+#include <functional>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "hybrid_cache.hpp"
+//----------------------------------------------------------------------------
+namespace
+{
+//----------------------------------------------------------------------------
+std::string logPath(const char * name)
+{
+  const std::string path = ::testing::TempDir() + name;
+  std::remove(path.c_str());
+  return path;
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Decodes like the default serializer, but first runs `hook_` once,
+ *        so that a test can act in the middle of a `get`.
+ */
+struct HookedSerializer : LRUCache::Serializer<int>
+{
+  static inline std::function<void()> hook_;
+
+  bool read(const char *& data, const char * end, int & value) const
+  {
+    if (hook_)
+      std::exchange(hook_, nullptr)();
+    return LRUCache::Serializer<int>::read(data, end, value);
+  }
+};
+//----------------------------------------------------------------------------
+} // namespace
+//----------------------------------------------------------------------------
+TEST(HybridCacheTest, DemoteAndPromote)
+{
+  LRUCache::HybridCache<int, std::string> cache(2, logPath("hybrid_demote.log"), 4, 4096);
+  ASSERT_TRUE(cache.is_open());
+  EXPECT_EQ(4 * 4096, cache.disk_capacity());
+  cache.put(1, "one");
+  cache.put(2, "two");
+  cache.put(3, "three");
+  cache.flush();
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(1, cache.disk_size());
+  EXPECT_TRUE(cache.contains(1));
+
+  // A disk hit moves the entry back to memory, and demotes the LRU one
+  std::string * value = cache.get(1);
+  ASSERT_NE(nullptr, value);
+  EXPECT_EQ("one", *value);
+  cache.flush();
+  EXPECT_EQ(1, cache.disk_size());
+  EXPECT_TRUE(cache.contains(2));
+  EXPECT_EQ(nullptr, cache.get(4));
+
+  const LRUCache::HybridCacheStats stats = cache.stats();
+  EXPECT_EQ(1, stats.diskHits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(2, stats.demotions_);
+  EXPECT_DOUBLE_EQ(0.5, stats.hit_ratio());
+}
+//----------------------------------------------------------------------------
+TEST(HybridCacheTest, PutAndRemove)
+{
+  LRUCache::HybridCache<int, std::string> cache(1, logPath("hybrid_put.log"), 4, 4096);
+  cache.put(1, "one");
+  cache.put(2, "two");
+  cache.flush();
+  // Overwriting a key on disk drops the disk copy
+  cache.put(1, "uno");
+  cache.flush();
+  EXPECT_EQ(1, cache.disk_size());
+  EXPECT_EQ("uno", *cache.get(1));
+  EXPECT_EQ("two", *cache.get(2));
+  cache.flush();
+  EXPECT_TRUE(cache.remove(1));
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_TRUE(cache.remove(2));
+  EXPECT_FALSE(cache.remove(2));
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(0, cache.disk_size());
+  cache.put(3, "three");
+  cache.put(4, "four");
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(0, cache.disk_size());
+}
+//----------------------------------------------------------------------------
+TEST(HybridCacheTest, ReclaimOldestRegion)
+{
+  // 12-byte records: 20 per region, 80 on disk at most
+  LRUCache::HybridCache<int, int> cache(10, logPath("hybrid_reclaim.log"), 4, 240);
+  for (int i = 0; i < 1000; ++i)
+    cache.put(i, i);
+  cache.flush();
+  EXPECT_LE(cache.disk_size(), 80);
+  EXPECT_GT(cache.disk_size(), 20);
+  const LRUCache::HybridCacheStats stats = cache.stats();
+  EXPECT_GT(stats.reclaims_, 0);
+  EXPECT_EQ(990, stats.demotions_ + stats.dropped_);
+  EXPECT_EQ(stats.demotions_, stats.diskEvictions_ + cache.disk_size());
+  EXPECT_FALSE(cache.contains(0));
+  EXPECT_TRUE(cache.contains(989));
+  EXPECT_EQ(989, *cache.get(989));
+}
+//----------------------------------------------------------------------------
+TEST(HybridCacheTest, CompactSparseRegion)
+{
+  LRUCache::HybridCache<int, int> cache(1, logPath("hybrid_compact.log"), 4, 240);
+  for (int i = 0; i < 60; ++i)
+  {
+    cache.put(i, i);
+    cache.flush();
+  }
+  EXPECT_EQ(0, cache.stats().compactions_);
+  // Nine records in ten become dead
+  for (int i = 0; i < 59; ++i)
+    if (i % 10 != 0)
+      cache.remove(i);
+  cache.put(100, 100);
+  cache.flush();
+  const LRUCache::HybridCacheStats stats = cache.stats();
+  EXPECT_GT(stats.compactions_, 0);
+  EXPECT_EQ(0, stats.diskEvictions_);
+  for (int i = 0; i < 59; i += 10)
+  {
+    int * value = cache.get(i);
+    ASSERT_NE(nullptr, value);
+    EXPECT_EQ(i, *value);
+  }
+}
+//----------------------------------------------------------------------------
+TEST(HybridCacheTest, GetDuringCompaction)
+{
+  using CacheT = LRUCache::HybridCache<int, int, LRUCache::Cache<int, int>, std::hash<int>, LRUCache::Serializer<int>, HookedSerializer>;
+  // The layout of CompactSparseRegion: two live records in each region
+  CacheT cache(1, logPath("hybrid_get_compact.log"), 4, 240);
+  for (int i = 0; i < 60; ++i)
+  {
+    cache.put(i, i);
+    cache.flush();
+  }
+  for (int i = 0; i < 59; ++i)
+    if (i % 10 != 0)
+      cache.remove(i);
+  // While `get` decodes key 10, demoting 59 makes the background thread
+  // compact the region it was read from
+  HookedSerializer::hook_ = [&cache]()
+  {
+    cache.put(100, 100);
+    while (cache.stats().compactions_ == 0)
+      std::this_thread::yield();
+  };
+  int * value = cache.get(10);
+  ASSERT_NE(nullptr, value);
+  EXPECT_EQ(10, *value);
+  EXPECT_GT(cache.stats().compactions_, 0);
+}
+//----------------------------------------------------------------------------
+TEST(HybridCacheTest, MemoryOnly)
+{
+  // Too few regions: the disk tier is disabled
+  LRUCache::HybridCache<int, int> cache(2, logPath("hybrid_memory.log"), 2, 240);
+  EXPECT_FALSE(cache.is_open());
+  EXPECT_EQ(0, cache.disk_capacity());
+  cache.put(1, 1);
+  cache.put(2, 2);
+  cache.put(3, 3);
+  cache.flush();
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_EQ(0, cache.disk_size());
+  EXPECT_EQ(3, *cache.get(3));
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,121 @@
+//----------------------------------------------------------------------------
+#include <string>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "intrusive_lru_cache.hpp"
+//----------------------------------------------------------------------------
+TEST(IntrusiveLRUCacheTest, Initialization)
+{
+  {
+    LRUCache::IntrusiveCache<int, int> cache;
+    ASSERT_EQ(0, cache.capacity());
+    EXPECT_EQ(nullptr, cache.get(1));
+    cache.put(1, 10);
+    EXPECT_EQ(0, cache.size());
+    EXPECT_EQ(nullptr, cache.get(1));
+  }
+  {
+    LRUCache::IntrusiveCache<int, int> cache(10);
+    ASSERT_EQ(10, cache.capacity());
+    for (int i = 1; i <= 10; ++i)
+      EXPECT_EQ(nullptr, cache.get(i));
+    for (int i = 1; i <= 10; ++i)
+      cache.put(i, i);
+    for (int i = 1; i <= 10; ++i)
+      EXPECT_EQ(i, *cache.get(i));
+    EXPECT_EQ(10, cache.size());
+  }
+}
+//----------------------------------------------------------------------------
+TEST(IntrusiveLRUCacheTest, Emplace)
+{
+  LRUCache::IntrusiveCache<int, std::string> cache(2);
+  cache.emplace(1, 3, 'a');
+  ASSERT_NE(nullptr, cache.get(1));
+  EXPECT_EQ("aaa", *cache.get(1));
+  cache.emplace(1, 2, 'b');
+  EXPECT_EQ("bb", *cache.get(1));
+  EXPECT_EQ(1, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(IntrusiveLRUCacheTest, Remove)
+{
+  LRUCache::IntrusiveCache<int, int> cache(100);
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_FALSE(cache.remove(i));
+  for (int i = 0; i < 100; ++i)
+    cache.put(i, i);
+  for (int i = 0; i < 100; i += 2)
+    EXPECT_TRUE(cache.remove(i));
+  EXPECT_EQ(50, cache.size());
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(i % 2 == 1, cache.contains(i));
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_FALSE(cache.contains(1));
+}
+//----------------------------------------------------------------------------
+TEST(IntrusiveLRUCacheTest, EvictionOrder)
+{
+  LRUCache::IntrusiveCache<std::string, int> cache(3);
+  cache.put("1", 1);
+  cache.put("2", 2);
+  cache.put("3", 3);
+  cache.get("1");
+  cache.put("4", 4);
+  EXPECT_EQ(nullptr, cache.get("2"));
+  EXPECT_EQ(1, *cache.get("1"));
+  EXPECT_EQ(3, *cache.get("3"));
+  EXPECT_EQ(4, *cache.get("4"));
+  cache.put("3", 30);
+  cache.put("5", 5);
+  EXPECT_FALSE(cache.contains("1"));
+  EXPECT_EQ(30, *cache.get("3"));
+}
+//----------------------------------------------------------------------------
+TEST(IntrusiveLRUCacheTest, ConstGetDoesNotPromote)
+{
+  LRUCache::IntrusiveCache<int, int> cache(2);
+  cache.put(1, 1);
+  cache.put(2, 2);
+  const auto & constCache = cache;
+  EXPECT_EQ(1, *constCache.get(1));
+  cache.put(3, 3);
+  EXPECT_FALSE(cache.contains(1));
+}
+//----------------------------------------------------------------------------
+TEST(IntrusiveLRUCacheTest, HashCollisions)
+{
+  struct BadHash
+  {
+    std::size_t operator ()(int key) const
+    {
+      return key % 4;
+    }
+  };
+  LRUCache::IntrusiveCache<int, int, BadHash> cache(64);
+  for (int i = 0; i < 128; ++i)
+    cache.put(i, i);
+  for (int i = 0; i < 64; ++i)
+    EXPECT_EQ(nullptr, cache.get(i));
+  for (int i = 64; i < 128; ++i)
+    EXPECT_EQ(i, *cache.get(i));
+  for (int i = 64; i < 128; i += 3)
+    EXPECT_TRUE(cache.remove(i));
+  for (int i = 64; i < 128; ++i)
+    EXPECT_EQ((i - 64) % 3 != 0, cache.contains(i));
+}
+//----------------------------------------------------------------------------
+TEST(IntrusiveLRUCacheTest, StressTest)
+{
+  LRUCache::IntrusiveCache<int, int> cache(100000);
+  for (int i = 0; i < 200000; ++i)
+    cache.put(i, i);
+  EXPECT_EQ(100000, cache.size());
+  for (int i = 0; i < 100000; ++i)
+    EXPECT_EQ(nullptr, cache.get(i));
+  for (int i = 100000; i < 200000; ++i)
+    EXPECT_EQ(i, *cache.get(i));
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -1,4 +1,15 @@
 //----------------------------------------------------------------------------
+#include <tuple>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include <string_view>
+//----------------------------------------------------------------------------
 #include <gtest/gtest.h>
 //----------------------------------------------------------------------------
 #include "lru_cache.hpp"
@@ -109,6 +120,15 @@ TEST(LRUCacheTest, Emplace)
     EXPECT_EQ('1', cacheEntry->b_);
     EXPECT_EQ("1", cacheEntry->c_);
   }
+  {
+    // A throwing constructor reaches the caller and leaves the cache as it was
+    LRUCache::Cache<int, std::string> cache(2);
+    cache.put(1, "1");
+    EXPECT_THROW(cache.emplace(2, std::string("2"), 5), std::out_of_range);
+    EXPECT_FALSE(cache.contains(2));
+    ASSERT_NE(nullptr, cache.get(1));
+    EXPECT_EQ(1, cache.size());
+  }
 }
 //----------------------------------------------------------------------------
 TEST(LRUCacheTest, Remove)
@@ -182,4 +202,432 @@ TEST(LRUCacheTest, StressTest) {
   for (int i = 100000; i < 200000; ++i)
     EXPECT_EQ(i, *cache.get(i));
 }
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, Contains) {
+  LRUCache::Cache<int, int> cache(2);
+  EXPECT_FALSE(cache.contains(1));
+  cache.put(1, 1);
+  EXPECT_TRUE(cache.contains(1));
+  cache.put(2, 2);
+  cache.put(3, 3);
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_TRUE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(3));
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, TreeCache) {
+  LRUCache::TreeCache<int, int> cache(3);
+  cache.put(1, 1);
+  cache.put(2, 2);
+  cache.put(3, 3);
+  cache.get(1);
+  cache.put(4, 4);
+  EXPECT_EQ(nullptr, cache.get(2));
+  EXPECT_EQ(1, *cache.get(1));
+  EXPECT_EQ(3, *cache.get(3));
+  EXPECT_EQ(4, *cache.get(4));
+  EXPECT_TRUE(cache.remove(4));
+  EXPECT_EQ(2, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, HashCacheCustomHashAndEquality) {
+  struct CaseInsensitiveHash
+  {
+    std::size_t operator ()(const std::string & key) const
+    {
+      std::string lower(key);
+      for (auto & c : lower)
+        c = std::tolower(c);
+      return std::hash<std::string>()(lower);
+    }
+  };
+  struct CaseInsensitiveEqual
+  {
+    bool operator ()(const std::string & lhs, const std::string & rhs) const
+    {
+      if (lhs.size() != rhs.size())
+        return false;
+      for (std::size_t i = 0; i < lhs.size(); ++i)
+        if (std::tolower(lhs[i]) != std::tolower(rhs[i]))
+          return false;
+      return true;
+    }
+  };
+  LRUCache::HashCache<std::string, int, CaseInsensitiveHash, CaseInsensitiveEqual> cache(2);
+  cache.put("Key", 1);
+  ASSERT_NE(nullptr, cache.get("KEY"));
+  EXPECT_EQ(1, *cache.get("key"));
+  cache.put("KEY", 2);
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(2, *cache.get("Key"));
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, StringCacheHeterogeneousLookup) {
+  LRUCache::StringCache<int> cache(2);
+  cache.put(std::string_view("first"), 1);
+  cache.put("second", 2);
+  cache.put(std::string("third"), 3);
+  EXPECT_EQ(2, cache.size());
+  EXPECT_FALSE(cache.contains(std::string_view("first")));
+  ASSERT_NE(nullptr, cache.get(std::string_view("second")));
+  EXPECT_EQ(2, *cache.get("second"));
+  // "second" was promoted, so "third" is evicted next
+  cache.put(std::string_view("fourth"), 4);
+  EXPECT_FALSE(cache.contains("third"));
+  EXPECT_TRUE(cache.contains(std::string("fourth")));
+  cache.put(std::string_view("fourth"), 40);
+  EXPECT_EQ(40, *cache.get(std::string_view("fourth")));
+  EXPECT_TRUE(cache.remove(std::string_view("fourth")));
+  EXPECT_FALSE(cache.remove("fourth"));
+  EXPECT_EQ(1, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, TreeCacheHeterogeneousLookup) {
+  LRUCache::TreeCache<std::string, int, std::less<>> cache(2);
+  cache.put("a", 1);
+  cache.put(std::string_view("b"), 2);
+  const auto & constCache = cache;
+  ASSERT_NE(nullptr, constCache.get(std::string_view("a")));
+  EXPECT_EQ(1, *constCache.get("a"));
+  // const get does not promote, so "a" is still the least recently used
+  cache.put("c", 3);
+  EXPECT_FALSE(cache.contains("a"));
+  EXPECT_TRUE(cache.contains(std::string_view("b")));
+  EXPECT_TRUE(cache.contains("c"));
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, WeightedEviction) {
+  struct SizeWeigher
+  {
+    std::size_t operator ()(int, const std::string & value) const
+    {
+      return value.size();
+    }
+  };
+  LRUCache::WeightedCache<int, std::string, SizeWeigher> cache(10);
+  EXPECT_EQ(10, cache.max_weight());
+  cache.put(1, std::string(4, 'a'));
+  cache.put(2, std::string(4, 'b'));
+  EXPECT_EQ(8, cache.weight());
+  // One heavy entry evicts several light ones
+  cache.put(3, std::string(9, 'c'));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(9, cache.weight());
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_FALSE(cache.contains(2));
+  // Updating a value re-weighs it
+  cache.put(3, std::string(2, 'c'));
+  cache.emplace(4, 8, 'd');
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(10, cache.weight());
+  EXPECT_TRUE(cache.remove(3));
+  EXPECT_EQ(8, cache.weight());
+  cache.clear();
+  EXPECT_EQ(0, cache.weight());
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, WeightedOversizedEntry) {
+  auto weigher = [](int, int value) -> std::size_t { return static_cast<std::size_t>(value); };
+  LRUCache::WeightedCache<int, int, decltype(weigher)> cache(100, weigher);
+  cache.put(1, 10);
+  cache.put(2, 20);
+  // Heavier than the whole budget: not stored, nothing else is evicted
+  cache.put(3, 101);
+  EXPECT_FALSE(cache.contains(3));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(30, cache.weight());
+  // An oversized update drops the stale value
+  cache.put(1, 200);
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_EQ(20, cache.weight());
+  cache.put(4, 100);
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(100, *cache.get(4));
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, UnitWeight) {
+  LRUCache::Cache<int, int> cache(3);
+  for (int i = 0; i < 5; ++i)
+    cache.put(i, i);
+  EXPECT_EQ(cache.size(), cache.weight());
+  EXPECT_EQ(cache.capacity(), cache.max_weight());
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, FifoPolicy) {
+  LRUCache::FifoCache<int, int> cache(3);
+  cache.put(1, 1);
+  cache.put(2, 2);
+  cache.put(3, 3);
+  EXPECT_EQ(1, *cache.get(1));
+  cache.put(2, 20);
+  cache.put(4, 4);
+  // Neither the hit nor the update protects 1 and 2
+  EXPECT_FALSE(cache.contains(1));
+  cache.put(5, 5);
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(3));
+  EXPECT_EQ(3, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, LfuPolicy) {
+  LRUCache::LfuCache<int, int> cache(3);
+  cache.put(1, 1);
+  cache.put(2, 2);
+  cache.put(3, 3);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ(1, *cache.get(1));
+  EXPECT_EQ(2, *cache.get(2));
+  cache.put(4, 4);
+  EXPECT_FALSE(cache.contains(3));
+  // 4 is the only entry with a single access
+  cache.put(5, 5);
+  EXPECT_FALSE(cache.contains(4));
+  EXPECT_EQ(5, *cache.get(5));
+  EXPECT_EQ(5, *cache.get(5));
+  // 2 is now the least frequently used
+  cache.put(6, 6);
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_TRUE(cache.contains(5));
+  EXPECT_TRUE(cache.remove(1));
+  cache.put(7, 7);
+  cache.put(8, 8);
+  EXPECT_FALSE(cache.contains(6));
+  EXPECT_TRUE(cache.contains(7));
+  EXPECT_TRUE(cache.contains(8));
+  EXPECT_EQ(3, cache.size());
+  cache.clear();
+  cache.put(9, 9);
+  EXPECT_EQ(9, *cache.get(9));
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, LfuPolicyTies) {
+  LRUCache::LfuCache<int, int> cache(3);
+  cache.put(1, 1);
+  cache.put(2, 2);
+  cache.put(3, 3);
+  cache.get(1);
+  cache.get(2);
+  cache.get(3);
+  // All at count 2: 1 reached it first
+  cache.put(4, 4);
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_TRUE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(3));
+  cache.get(3);
+  cache.get(2);
+  cache.get(4);
+  cache.get(4);
+  // All at count 3: 3 reached it first, then 2, then 4
+  cache.put(5, 5);
+  EXPECT_FALSE(cache.contains(3));
+  EXPECT_TRUE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(4));
+  EXPECT_TRUE(cache.contains(5));
+}
+//----------------------------------------------------------------------------
+// Evicts the most recently used entry
+template<class _ListT>
+struct MruPolicy : LRUCache::LruPolicy<_ListT>
+{
+  typename _ListT::iterator select_victim(_ListT & list)
+  {
+    return list.begin();
+  }
+};
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, CustomPolicy) {
+  LRUCache::Cache<int, int, LRUCache::Internal::ListT<int>, LRUCache::Internal::MapT<int, int, LRUCache::Internal::ListT<int>>, LRUCache::UnitWeigher, MruPolicy> cache(2);
+  cache.put(1, 1);
+  cache.put(2, 2);
+  cache.get(1);
+  cache.put(3, 3);
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_TRUE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(3));
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, MultiGetPut) {
+  LRUCache::Cache<int, int> cache(40);
+  std::vector<std::pair<int, int>> entries;
+  for (int i = 0; i < 40; ++i)
+    entries.emplace_back(i, i * 10);
+  cache.multi_put(entries);
+  EXPECT_EQ(40, cache.size());
+  // More keys than one prefetch group, with misses and a duplicate
+  std::vector<int> keys;
+  for (int i = 0; i < 40; i += 2)
+    keys.push_back(i);
+  keys.push_back(100);
+  keys.push_back(0);
+  std::vector<int *> values(keys.size());
+  EXPECT_EQ(21, cache.multi_get(keys, values));
+  for (std::size_t i = 0; i < keys.size(); ++i)
+  {
+    if (keys[i] == 100)
+      EXPECT_EQ(nullptr, values[i]);
+    else
+      EXPECT_EQ(keys[i] * 10, *values[i]);
+  }
+  // The hits were promoted in order, so the odd keys are evicted first
+  for (int i = 0; i < 20; ++i)
+    cache.put(1000 + i, i);
+  for (int i = 0; i < 40; ++i)
+    EXPECT_EQ(i % 2 == 0, cache.contains(i));
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, Stats) {
+  LRUCache::StatsCache<int, int> cache(2);
+  cache.put(1, 1);
+  cache.put(2, 2);
+  cache.put(1, 10);
+  cache.put(3, 3);
+  cache.get(1);
+  cache.get(2);
+  cache.remove(3);
+  cache.remove(3);
+  auto stats = cache.stats();
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(3, stats.inserts_);
+  EXPECT_EQ(1, stats.updates_);
+  EXPECT_EQ(1, stats.evictions_);
+  EXPECT_EQ(1, stats.removals_);
+  EXPECT_DOUBLE_EQ(0.5, stats.hit_ratio());
+  // Disabled by default
+  LRUCache::Cache<int, int> plain(2);
+  plain.put(1, 1);
+  plain.get(1);
+  EXPECT_EQ(0, plain.stats().hits_);
+  EXPECT_EQ(0, plain.stats().inserts_);
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, RemovalListener) {
+  LRUCache::Cache<int, std::string> cache(2);
+  std::vector<std::tuple<int, std::string, LRUCache::RemovalCause>> removed;
+  cache.set_removal_listener([&](int key, std::string value, LRUCache::RemovalCause cause) {
+    // Called once the cache is consistent again, so it can be used here
+    EXPECT_FALSE(cache.contains(key) && cause != LRUCache::RemovalCause::REPLACED);
+    removed.emplace_back(key, std::move(value), cause);
+  });
+  cache.put(1, "one");
+  cache.put(2, "two");
+  cache.put(1, "uno");
+  cache.put(3, "three");
+  cache.remove(1);
+  cache.put(4, "four");
+  cache.clear();
+  using Cause = LRUCache::RemovalCause;
+  const std::vector<std::tuple<int, std::string, Cause>> expected = {
+    {1, "one", Cause::REPLACED}, {2, "two", Cause::SIZE}, {1, "uno", Cause::EXPLICIT}, {3, "three", Cause::EXPLICIT}, {4, "four", Cause::EXPLICIT}
+  };
+  // clear reports the remaining entries in map order
+  std::sort(removed.begin() + 3, removed.end());
+  EXPECT_EQ(expected, removed);
+  // Without a listener, nothing is queued
+  cache.set_removal_listener(nullptr);
+  cache.put(5, "five");
+  cache.remove(5);
+  EXPECT_EQ(5u, removed.size());
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, SaveLoad) {
+  const std::string path = ::testing::TempDir() + "lru_cache_snapshot.bin";
+  LRUCache::Cache<std::string, std::string> cache(4);
+  for (int i = 0; i < 6; ++i)
+    cache.put("key" + std::to_string(i), std::string(i * 10, 'a' + i));
+  cache.get("key2");
+  ASSERT_TRUE(cache.save(path));
+
+  LRUCache::Cache<std::string, std::string> restored(4);
+  restored.put("stale", "value");
+  ASSERT_TRUE(restored.load(path));
+  EXPECT_EQ(4, restored.size());
+  EXPECT_FALSE(restored.contains("stale"));
+  ASSERT_NE(nullptr, restored.get("key2"));
+  EXPECT_EQ(std::string(20, 'c'), *restored.get("key2"));
+  // The recency order survives: key3 is now the least recently used
+  restored.put("new", "entry");
+  EXPECT_FALSE(restored.contains("key3"));
+  EXPECT_TRUE(restored.contains("key4"));
+
+  // A smaller cache keeps the most recently used entries
+  LRUCache::Cache<std::string, std::string> small(2);
+  ASSERT_TRUE(small.load(path));
+  EXPECT_TRUE(small.contains("key2"));
+  EXPECT_TRUE(small.contains("key5"));
+  std::remove(path.c_str());
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, LoadRejectsCorruptSnapshot) {
+  const std::string path = ::testing::TempDir() + "lru_cache_corrupt.bin";
+  LRUCache::Cache<int, double> cache(100);
+  for (int i = 0; i < 100; ++i)
+    cache.put(i, i * 0.5);
+  ASSERT_TRUE(cache.save(path));
+  std::FILE * file = std::fopen(path.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  std::fseek(file, 100, SEEK_SET);
+  std::fputc(0x5A, file);
+  std::fclose(file);
+
+  LRUCache::Cache<int, double> restored(100);
+  restored.put(1, 1.0);
+  EXPECT_FALSE(restored.load(path));
+  EXPECT_FALSE(restored.load(path + ".missing"));
+  EXPECT_EQ(1, restored.size());
+
+  // A checksummed file can still claim more entries than it holds
+  ASSERT_TRUE(cache.save(path));
+  std::string data;
+  std::uint64_t count = 0;
+  ASSERT_NE(nullptr, LRUCache::Internal::readSnapshot(path, data, count));
+  count = 1ull << 60;
+  std::memcpy(&data[2 * sizeof(std::uint32_t)], &count, sizeof(count));
+  const std::uint32_t crc = LRUCache::Internal::crc32(0, data.data(), data.size() - sizeof(crc));
+  std::memcpy(&data[data.size() - sizeof(crc)], &crc, sizeof(crc));
+  file = std::fopen(path.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  std::fwrite(data.data(), 1, data.size(), file);
+  std::fclose(file);
+  EXPECT_FALSE(restored.load(path));
+  std::remove(path.c_str());
+}
+//----------------------------------------------------------------------------
+TEST(LRUCacheTest, SaveLoadCustomSerializer) {
+  struct Point
+  {
+    int x_, y_;
+    Point() : x_(0), y_(0) {}
+    Point(int x, int y) : x_(x), y_(y) {}
+    Point(const Point & other) : x_(other.x_), y_(other.y_) {}
+    Point & operator =(const Point & other) { x_ = other.x_; y_ = other.y_; return *this; }
+  };
+  struct PointSerializer
+  {
+    void write(std::string & out, const Point & point) const
+    {
+      out += std::to_string(point.x_) + ',' + std::to_string(point.y_) + ';';
+    }
+    bool read(const char *& data, const char * end, Point & point) const
+    {
+      const char * stop = std::find(data, end, ';');
+      if (stop == end || std::sscanf(std::string(data, stop).c_str(), "%d,%d", &point.x_, &point.y_) != 2)
+        return false;
+      data = stop + 1;
+      return true;
+    }
+  };
+  const std::string path = ::testing::TempDir() + "lru_cache_points.bin";
+  LRUCache::Cache<int, Point> cache(10);
+  cache.put(1, Point(3, 4));
+  cache.put(2, Point(-5, 6));
+  ASSERT_TRUE(cache.save(path, LRUCache::Serializer<int>(), PointSerializer()));
+  LRUCache::Cache<int, Point> restored(10);
+  ASSERT_TRUE(restored.load(path, LRUCache::Serializer<int>(), PointSerializer()));
+  ASSERT_NE(nullptr, restored.get(2));
+  EXPECT_EQ(-5, restored.get(2)->x_);
+  EXPECT_EQ(6, restored.get(2)->y_);
+  std::remove(path.c_str());
+}
 //----------------------------------------------------------------------------
\ No newline at end of file
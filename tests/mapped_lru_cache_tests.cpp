@@ -0,0 +1,166 @@
+//----------------------------------------------------------------------------
+#include <cstdio>
+#include <cstddef>
+#include <string>
+#include <cstdint>
+//----------------------------------------------------------------------------
+#include <fcntl.h>
+#include <unistd.h>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "mapped_lru_cache.hpp"
+//----------------------------------------------------------------------------
+namespace
+{
+//----------------------------------------------------------------------------
+std::string mappedPath(const char * name)
+{
+  const std::string path = ::testing::TempDir() + name;
+  std::remove(path.c_str());
+  return path;
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Overwrites bytes of the file in place, as a crash half way through
+ *        an update could leave them.
+ */
+void patch(const std::string & path, std::size_t offset, const void * data, std::size_t size)
+{
+  const int fd = ::open(path.c_str(), O_RDWR);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(static_cast<ssize_t>(size), ::pwrite(fd, data, size, static_cast<off_t>(offset)));
+  ::close(fd);
+}
+//----------------------------------------------------------------------------
+} // namespace
+//----------------------------------------------------------------------------
+TEST(MappedLRUCacheTest, Lru)
+{
+  const std::string path = mappedPath("mapped_lru.bin");
+  LRUCache::MappedCache<int, double> cache(path, 3);
+  ASSERT_TRUE(cache.is_open());
+  EXPECT_FALSE(cache.reopened());
+  EXPECT_EQ(3, cache.capacity());
+  cache.put(1, 1.5);
+  cache.put(2, 2.5);
+  cache.put(3, 3.5);
+  ASSERT_NE(nullptr, cache.get(1));
+  cache.put(4, 4.5);
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_EQ(1.5, *cache.get(1));
+  cache.put(3, 30.5);
+  EXPECT_EQ(30.5, *cache.get(3));
+  EXPECT_TRUE(cache.remove(4));
+  EXPECT_FALSE(cache.remove(4));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_TRUE(cache.verify());
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(nullptr, cache.get(1));
+  std::remove(path.c_str());
+}
+//----------------------------------------------------------------------------
+TEST(MappedLRUCacheTest, Reopen)
+{
+  const std::string path = mappedPath("mapped_reopen.bin");
+  {
+    LRUCache::MappedCache<std::uint64_t, std::uint64_t> cache(path, 100);
+    for (std::uint64_t i = 0; i < 150; ++i)
+      cache.put(i, i * i);
+    cache.get(60);
+  }
+  {
+    LRUCache::MappedCache<std::uint64_t, std::uint64_t> cache(path, 100);
+    ASSERT_TRUE(cache.reopened());
+    EXPECT_EQ(100, cache.size());
+    EXPECT_FALSE(cache.contains(49));
+    ASSERT_NE(nullptr, cache.get(149));
+    EXPECT_EQ(149u * 149u, *cache.get(149));
+    // The recency order survives: 50 is the least recently used, not 60
+    cache.put(1000, 0);
+    EXPECT_FALSE(cache.contains(50));
+    EXPECT_TRUE(cache.contains(60));
+  }
+  {
+    // Another capacity: the file is replaced
+    LRUCache::MappedCache<std::uint64_t, std::uint64_t> cache(path, 10);
+    EXPECT_FALSE(cache.reopened());
+    EXPECT_EQ(0, cache.size());
+  }
+  std::remove(path.c_str());
+}
+//----------------------------------------------------------------------------
+TEST(MappedLRUCacheTest, ReadOnly)
+{
+  const std::string path = mappedPath("mapped_read_only.bin");
+  LRUCache::MappedCache<int, int> missing(path, 10, LRUCache::MapMode::READ_ONLY);
+  EXPECT_FALSE(missing.is_open());
+  EXPECT_EQ(0, missing.capacity());
+
+  LRUCache::MappedCache<int, int> writer(path, 10);
+  writer.put(1, 10);
+  writer.put(2, 20);
+  ASSERT_TRUE(writer.flush());
+  LRUCache::MappedCache<int, int> reader(path, 0, LRUCache::MapMode::READ_ONLY);
+  ASSERT_TRUE(reader.is_open());
+  EXPECT_EQ(10, reader.capacity());
+  const auto & view = reader;
+  ASSERT_NE(nullptr, view.get(1));
+  EXPECT_EQ(10, *view.get(1));
+  // The mapping is PROT_READ: no writable pointer into it
+  EXPECT_EQ(nullptr, reader.get(1));
+  reader.put(3, 30);
+  EXPECT_FALSE(reader.remove(1));
+  EXPECT_FALSE(reader.contains(3));
+  // Both map the same pages
+  writer.put(2, 200);
+  EXPECT_EQ(200, *view.get(2));
+  std::remove(path.c_str());
+}
+//----------------------------------------------------------------------------
+TEST(MappedLRUCacheTest, CrashRecovery)
+{
+  const std::string path = mappedPath("mapped_crash.bin");
+  {
+    LRUCache::MappedCache<int, int> cache(path, 16);
+    for (int i = 0; i < 10; ++i)
+      cache.put(i, i);
+  }
+  // Dirty but consistent: checked, then reused
+  const std::uint32_t dirty = 1;
+  patch(path, offsetof(LRUCache::Internal::MappedHeader, state_), &dirty, sizeof(dirty));
+  {
+    LRUCache::MappedCache<int, int> cache(path, 16);
+    EXPECT_TRUE(cache.reopened());
+    EXPECT_EQ(10, cache.size());
+  }
+  // Dirty with a value torn by an update in place: cleared
+  patch(path, offsetof(LRUCache::Internal::MappedHeader, state_), &dirty, sizeof(dirty));
+  using SlotT = LRUCache::Internal::MappedSlot<int, int>;
+  const int torn = 12345;
+  patch(path, LRUCache::Internal::MAPPED_HEADER_SIZE + offsetof(SlotT, value_), &torn, sizeof(torn));
+  {
+    LRUCache::MappedCache<int, int> cache(path, 16);
+    EXPECT_FALSE(cache.reopened());
+    EXPECT_EQ(0, cache.size());
+    for (int i = 0; i < 10; ++i)
+      cache.put(i, i);
+  }
+  // Dirty with a broken link: cleared
+  patch(path, offsetof(LRUCache::Internal::MappedHeader, state_), &dirty, sizeof(dirty));
+  const std::uint32_t badLink = 5;
+  patch(path, LRUCache::Internal::MAPPED_HEADER_SIZE + offsetof(SlotT, next_), &badLink, sizeof(badLink));
+  {
+    LRUCache::MappedCache<int, int> reader(path, 0, LRUCache::MapMode::READ_ONLY);
+    EXPECT_FALSE(reader.is_open());
+    LRUCache::MappedCache<int, int> cache(path, 16);
+    ASSERT_TRUE(cache.is_open());
+    EXPECT_FALSE(cache.reopened());
+    EXPECT_EQ(0, cache.size());
+    cache.put(1, 1);
+    EXPECT_EQ(1, *cache.get(1));
+  }
+  std::remove(path.c_str());
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
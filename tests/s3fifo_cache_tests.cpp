@@ -0,0 +1,198 @@
+//----------------------------------------------------------------------------
+#include <random>
+#include <thread>
+#include <vector>
+#include <string>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "s3fifo_cache.hpp"
+//----------------------------------------------------------------------------
+TEST(S3FifoCacheTest, Initialization)
+{
+  LRUCache::S3FifoCache<int, int> empty(0);
+  empty.put(1, 1);
+  EXPECT_EQ(0, empty.size());
+  EXPECT_FALSE(empty.contains(1));
+
+  LRUCache::S3FifoCache<int, int> cache(10);
+  EXPECT_EQ(10, cache.capacity());
+  EXPECT_EQ(0, cache.size());
+  int value = 0;
+  EXPECT_FALSE(cache.get(1, value));
+  for (int i = 0; i < 20; ++i)
+    cache.put(i, i);
+  EXPECT_EQ(10, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(S3FifoCacheTest, PutGetRemove)
+{
+  LRUCache::S3FifoCache<int, std::string> cache(10);
+  cache.put(1, "1");
+  cache.put(2, std::string("2"));
+  cache.emplace(3, 3, '3');
+  std::string value;
+  ASSERT_TRUE(cache.get(3, value));
+  EXPECT_EQ("333", value);
+  cache.put(3, "three");
+  ASSERT_TRUE(cache.get(3, value));
+  EXPECT_EQ("three", value);
+  EXPECT_EQ(3, cache.size());
+  EXPECT_TRUE(cache.remove(2));
+  EXPECT_FALSE(cache.remove(2));
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_EQ(2, cache.size());
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_FALSE(cache.get(1, value));
+}
+//----------------------------------------------------------------------------
+TEST(S3FifoCacheTest, OneHitWondersLeaveFirst)
+{
+  LRUCache::S3FifoCache<int, int> cache(10);
+  for (int i = 0; i < 10; ++i)
+    cache.put(i, i);
+  int value = 0;
+  ASSERT_TRUE(cache.get(0, value));
+  // 0 moves to the main queue, the entries that were never hit leave in order
+  for (int i = 10; i < 19; ++i)
+    cache.put(i, i);
+  EXPECT_TRUE(cache.contains(0));
+  for (int i = 1; i < 10; ++i)
+    EXPECT_FALSE(cache.contains(i));
+  for (int i = 10; i < 19; ++i)
+    EXPECT_TRUE(cache.contains(i));
+  // a long run of new keys still does not reach the main queue
+  for (int i = 100; i < 200; ++i)
+    cache.put(i, i);
+  EXPECT_TRUE(cache.contains(0));
+  EXPECT_EQ(10, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(S3FifoCacheTest, GhostHitGoesToMain)
+{
+  LRUCache::S3FifoCache<int, int> cache(10);
+  for (int i = 0; i < 10; ++i)
+    cache.put(i, i);
+  // 0..4 are evicted from the small queue and remembered as ghosts
+  for (int i = 10; i < 15; ++i)
+    cache.put(i, i);
+  EXPECT_FALSE(cache.contains(3));
+  cache.put(3, 3);
+  // 3 was readmitted into the main queue, so new keys evict around it
+  for (int i = 100; i < 150; ++i)
+    cache.put(i, i);
+  EXPECT_TRUE(cache.contains(3));
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_EQ(10, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(S3FifoCacheTest, MainQueueDecaysFrequency)
+{
+  LRUCache::S3FifoCache<int, int> cache(10);
+  for (int i = 0; i < 10; ++i)
+    cache.put(i, i);
+  int value = 0;
+  for (int i = 0; i < 9; ++i)
+    ASSERT_TRUE(cache.get(i, value));
+  // 0..8 fill the main queue with their counters reset, 9 leaves
+  cache.put(10, 10);
+  EXPECT_FALSE(cache.contains(9));
+  ASSERT_TRUE(cache.get(0, value));
+  cache.put(11, 11);
+  // the ghost hit empties the small queue, so the next miss evicts from main
+  cache.put(10, 10);
+  cache.put(12, 12);
+  EXPECT_TRUE(cache.contains(0));
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_TRUE(cache.contains(10));
+  EXPECT_TRUE(cache.contains(12));
+  EXPECT_EQ(10, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(S3FifoCacheTest, RemovedSlotsAreReused)
+{
+  LRUCache::S3FifoCache<int, int> cache(4);
+  for (int i = 0; i < 4; ++i)
+    cache.put(i, i);
+  EXPECT_TRUE(cache.remove(1));
+  cache.put(10, 10);
+  cache.put(11, 11);
+  EXPECT_EQ(4, cache.size());
+  EXPECT_TRUE(cache.contains(11));
+  EXPECT_FALSE(cache.contains(1));
+}
+//----------------------------------------------------------------------------
+TEST(S3FifoCacheTest, RemoveThenPutKeepsCapacity)
+{
+  LRUCache::S3FifoCache<int, int> cache(10);
+  for (int i = 0; i < 10; ++i)
+    cache.put(i, i);
+  EXPECT_TRUE(cache.remove(9));
+  cache.put(100, 100);
+  // The removed slot holds the new entry: nothing is evicted
+  EXPECT_EQ(10, cache.size());
+  for (int i = 0; i < 9; ++i)
+    EXPECT_TRUE(cache.contains(i));
+
+  // Removes and puts in any order never lose capacity
+  LRUCache::S3FifoCache<int, int> fuzzed(64);
+  std::mt19937 gen(7);
+  for (int i = 0; i < 100000; ++i)
+  {
+    const int key = std::uniform_int_distribution<int>(0, 255)(gen);
+    if (gen() % 3 == 0)
+      fuzzed.remove(key);
+    else
+      fuzzed.put(key, key);
+  }
+  for (int key = 1000; key < 1064; ++key)
+    fuzzed.put(key, key);
+  EXPECT_EQ(64, fuzzed.size());
+}
+//----------------------------------------------------------------------------
+TEST(S3FifoCacheTest, StaleItemDoesNotPromoteReusedSlot)
+{
+  LRUCache::S3FifoCache<int, int> cache(10);
+  for (int i = 0; i < 10; ++i)
+    cache.put(i, i);
+  int value = 0;
+  ASSERT_TRUE(cache.get(0, value));
+  // 0 moves to the main queue, then its slot is reused by 100 in the small queue
+  cache.put(10, 10);
+  EXPECT_TRUE(cache.remove(0));
+  cache.put(100, 100);
+  // 100 was never hit: it leaves with the other one-hit wonders, and the
+  // stale item of 0 in the main queue does not keep it
+  for (int i = 200; i < 210; ++i)
+    cache.put(i, i);
+  EXPECT_FALSE(cache.contains(100));
+  EXPECT_EQ(10, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(S3FifoCacheTest, ConcurrentAccess)
+{
+  LRUCache::S3FifoCache<int, int> cache(500);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t)
+  {
+    threads.emplace_back([&cache, t]()
+    {
+      for (int i = 0; i < 20000; ++i)
+      {
+        const int key = (i * 13 + t) % 2000;
+        int value = 0;
+        if (cache.get(key, value))
+          EXPECT_EQ(key, value);
+        else
+          cache.put(key, key);
+        if (i % 97 == 0)
+          cache.remove(key);
+      }
+    });
+  }
+  for (auto & thread : threads)
+    thread.join();
+  EXPECT_LE(cache.size(), cache.capacity());
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
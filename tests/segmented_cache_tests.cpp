@@ -0,0 +1,100 @@
+//----------------------------------------------------------------------------
+#include <string>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "segmented_cache.hpp"
+//----------------------------------------------------------------------------
+TEST(SegmentedCacheTest, Initialization)
+{
+  LRUCache::SegmentedCache<int, int> empty;
+  empty.put(1, 1);
+  EXPECT_EQ(0, empty.size());
+  EXPECT_EQ(nullptr, empty.get(1));
+
+  LRUCache::SegmentedCache<int, int> cache(10);
+  EXPECT_EQ(10, cache.capacity());
+  EXPECT_EQ(8, cache.protected_capacity());
+  EXPECT_EQ(5, (LRUCache::SegmentedCache<int, int>(10, 0.5).protected_capacity()));
+  EXPECT_EQ(10, (LRUCache::SegmentedCache<int, int>(10, 2.0).protected_capacity()));
+  for (int i = 0; i < 20; ++i)
+    cache.put(i, i);
+  EXPECT_EQ(10, cache.size());
+  EXPECT_EQ(0, cache.protected_size());
+  for (int i = 10; i < 20; ++i)
+    EXPECT_EQ(i, *cache.get(i));
+  EXPECT_EQ(8, cache.protected_size());
+}
+//----------------------------------------------------------------------------
+TEST(SegmentedCacheTest, PutGetRemove)
+{
+  LRUCache::SegmentedCache<int, std::string> cache(10);
+  cache.put(1, "1");
+  cache.put(2, std::string("2"));
+  cache.emplace(3, 3, '3');
+  EXPECT_EQ("1", *cache.get(1));
+  EXPECT_EQ("333", *cache.get(3));
+  cache.put(1, "one");
+  const auto & constCache = cache;
+  EXPECT_EQ("one", *constCache.get(1));
+  EXPECT_TRUE(cache.remove(1));
+  EXPECT_TRUE(cache.remove(2));
+  EXPECT_FALSE(cache.remove(2));
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(1, cache.protected_size());
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(0, cache.protected_size());
+}
+//----------------------------------------------------------------------------
+TEST(SegmentedCacheTest, ScanKeepsProtectedEntries)
+{
+  LRUCache::SegmentedCache<int, int> cache(100, 0.5);
+  for (int i = 0; i < 50; ++i)
+  {
+    cache.put(i, i);
+    cache.get(i);
+  }
+  EXPECT_EQ(50, cache.protected_size());
+  for (int i = 1000; i < 100000; ++i)
+    if (cache.get(i) == nullptr)
+      cache.put(i, i);
+  for (int i = 0; i < 50; ++i)
+    EXPECT_TRUE(cache.contains(i));
+  EXPECT_EQ(100, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(SegmentedCacheTest, ProtectedOverflowIsDemoted)
+{
+  LRUCache::SegmentedCache<int, int> cache(4, 0.5);
+  for (int i = 0; i < 3; ++i)
+  {
+    cache.put(i, i);
+    cache.get(i);
+  }
+  // 0 was demoted to probation when 2 was promoted, so it is evicted first
+  EXPECT_EQ(2, cache.protected_size());
+  cache.put(3, 3);
+  cache.put(4, 4);
+  EXPECT_FALSE(cache.contains(0));
+  EXPECT_TRUE(cache.contains(3));
+  cache.put(5, 5);
+  EXPECT_FALSE(cache.contains(3));
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_TRUE(cache.contains(2));
+}
+//----------------------------------------------------------------------------
+TEST(SegmentedCacheTest, ZeroProtectedRatioIsLru)
+{
+  LRUCache::SegmentedCache<int, int> cache(3, 0.0);
+  cache.put(1, 1);
+  cache.put(2, 2);
+  cache.put(3, 3);
+  cache.get(1);
+  cache.put(4, 4);
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_EQ(0, cache.protected_size());
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
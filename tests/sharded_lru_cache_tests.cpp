@@ -0,0 +1,336 @@
+//----------------------------------------------------------------------------
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <utility>
+#include <optional>
+#include <stdexcept>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "sharded_lru_cache.hpp"
+#include "intrusive_lru_cache.hpp"
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, Initialization)
+{
+  LRUCache::ShardedCache<int, int> cache(100, 8);
+  EXPECT_EQ(100, cache.capacity());
+  EXPECT_EQ(8, cache.shards());
+  EXPECT_EQ(0, cache.size());
+  int value = 0;
+  EXPECT_FALSE(cache.get(1, value));
+  EXPECT_GE((LRUCache::ShardedCache<int, int>::defaultShardCount()), 4);
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, PutGetRemove)
+{
+  LRUCache::ShardedCache<int, std::string> cache(1000, 4);
+  for (int i = 0; i < 100; ++i)
+    cache.put(i, std::to_string(i));
+  EXPECT_EQ(100, cache.size());
+  for (int i = 0; i < 100; ++i)
+  {
+    std::string value;
+    ASSERT_TRUE(cache.get(i, value));
+    EXPECT_EQ(std::to_string(i), value);
+  }
+  cache.emplace(5, 3, 'x');
+  std::string value;
+  ASSERT_TRUE(cache.get(5, value));
+  EXPECT_EQ("xxx", value);
+  EXPECT_TRUE(cache.contains(7));
+  EXPECT_TRUE(cache.remove(7));
+  EXPECT_FALSE(cache.remove(7));
+  EXPECT_FALSE(cache.contains(7));
+  EXPECT_EQ(99, cache.size());
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, CapacityIsSplitAcrossShards)
+{
+  LRUCache::ShardedCache<int, int> cache(10, 3);
+  for (int i = 0; i < 1000; ++i)
+    cache.put(i, i);
+  EXPECT_EQ(10, cache.size());
+  EXPECT_EQ(10, cache.capacity());
+
+  // Fewer items than shards: no shard is left without capacity
+  LRUCache::ShardedCache<int, int> small(3, 16);
+  EXPECT_EQ(3, small.shards());
+  for (int i = 0; i < 100; ++i)
+  {
+    small.put(i, i);
+    EXPECT_TRUE(small.contains(i));
+  }
+  EXPECT_LE(small.size(), 3);
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, Stats)
+{
+  LRUCache::ShardedCache<int, int> cache(100, 4);
+  cache.put(1, 1);
+  int value = 0;
+  cache.get(1, value);
+  cache.get(1, value);
+  cache.get(2, value);
+  auto stats = cache.stats();
+  EXPECT_EQ(2, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, StatsWrites)
+{
+  LRUCache::ShardedCache<int, int> cache(1, 1);
+  cache.put(1, 1);
+  cache.put(1, 2);
+  cache.put(2, 2);
+  cache.remove(2);
+  EXPECT_EQ(7, cache.get_or_load(3, [](int key) { return key * 2 + 1; }));
+  EXPECT_THROW(cache.get_or_load(4, [](int) -> int { throw std::runtime_error("load"); }), std::runtime_error);
+  auto stats = cache.stats();
+  EXPECT_EQ(3, stats.inserts_);
+  EXPECT_EQ(1, stats.updates_);
+  EXPECT_EQ(1, stats.evictions_);
+  EXPECT_EQ(1, stats.removals_);
+  EXPECT_EQ(1, stats.loadSuccesses_);
+  EXPECT_EQ(1, stats.loadFailures_);
+  EXPECT_EQ(2, stats.misses_);
+
+  // A rejected insert is neither an insert nor an eviction
+  LRUCache::ShardedCache<int, int> empty(0, 1);
+  empty.put(1, 1);
+  EXPECT_EQ(0, empty.stats().inserts_);
+  EXPECT_EQ(0, empty.stats().evictions_);
+  LRUCache::ShardedCache<int, int, LRUCache::IntrusiveCache<int, int>> emptyIntrusive(0, 1);
+  emptyIntrusive.put(1, 1);
+  EXPECT_EQ(0, emptyIntrusive.stats().inserts_);
+  EXPECT_EQ(0, emptyIntrusive.stats().evictions_);
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, NoStats)
+{
+  LRUCache::ShardedCache<int, int, LRUCache::Cache<int, int>, std::hash<int>, LRUCache::NoStats> cache(100, 4);
+  cache.put(1, 1);
+  int value = 0;
+  EXPECT_TRUE(cache.get(1, value));
+  EXPECT_EQ(0, cache.stats().hits_);
+  EXPECT_EQ(0, cache.stats().inserts_);
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, RemovalListener)
+{
+  LRUCache::ShardedCache<int, std::string> cache(2, 1);
+  std::vector<std::pair<int, LRUCache::RemovalCause>> removed;
+  cache.set_removal_listener([&](int key, std::string, LRUCache::RemovalCause cause)
+  {
+    // Would deadlock if the shard were still locked
+    EXPECT_FALSE(cache.contains(key) && cause != LRUCache::RemovalCause::REPLACED);
+    removed.emplace_back(key, cause);
+  });
+  cache.put(1, "one");
+  cache.put(1, "uno");
+  cache.put(2, "two");
+  cache.put(3, "three");
+  cache.remove(2);
+  using Cause = LRUCache::RemovalCause;
+  const std::vector<std::pair<int, Cause>> expected = {{1, Cause::REPLACED}, {1, Cause::SIZE}, {2, Cause::EXPLICIT}};
+  EXPECT_EQ(expected, removed);
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, BackgroundRemovalListener)
+{
+  std::atomic<int> removed(0);
+  std::atomic<bool> callerThread(false);
+  const std::thread::id caller = std::this_thread::get_id();
+  {
+    LRUCache::ShardedCache<int, int> cache(10, 2);
+    cache.set_removal_listener([&](int, int, LRUCache::RemovalCause)
+    {
+      if (std::this_thread::get_id() == caller)
+        callerThread = true;
+      ++removed;
+    }, true);
+    for (int i = 0; i < 100; ++i)
+      cache.put(i, i);
+  }
+  // The pending batches are delivered before the cache is destroyed
+  EXPECT_EQ(90, removed.load());
+  EXPECT_FALSE(callerThread.load());
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, CustomShardCache)
+{
+  LRUCache::ShardedCache<int, int, LRUCache::IntrusiveCache<int, int>> cache(64, 4);
+  for (int i = 0; i < 64; ++i)
+    cache.put(i, i * 2);
+  int value = 0;
+  ASSERT_TRUE(cache.get(10, value));
+  EXPECT_EQ(20, value);
+  EXPECT_EQ(64, cache.stats().inserts_);
+  EXPECT_EQ(1, cache.stats().hits_);
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, ConcurrentAccess)
+{
+  LRUCache::ShardedCache<int, int> cache(1000, 16);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t)
+  {
+    threads.emplace_back([&cache, t]()
+    {
+      for (int i = 0; i < 20000; ++i)
+      {
+        const int key = (i * 7 + t) % 3000;
+        int value = 0;
+        if (cache.get(key, value))
+          EXPECT_EQ(key, value);
+        else
+          cache.put(key, key);
+        if (i % 100 == 0)
+          cache.remove(key);
+      }
+    });
+  }
+  for (auto & thread : threads)
+    thread.join();
+  EXPECT_LE(cache.size(), cache.capacity());
+  auto stats = cache.stats();
+  EXPECT_EQ(8 * 20000, stats.hits_ + stats.misses_);
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, GetOrLoad)
+{
+  LRUCache::ShardedCache<int, std::string> cache(10, 2);
+  int loads = 0;
+  auto loader = [&loads](int key)
+  {
+    ++loads;
+    return std::to_string(key);
+  };
+  EXPECT_EQ("1", cache.get_or_load(1, loader));
+  EXPECT_EQ("1", cache.get_or_load(1, loader));
+  EXPECT_EQ(1, loads);
+  std::string value;
+  ASSERT_TRUE(cache.get(1, value));
+  EXPECT_EQ("1", value);
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, GetOrLoadSingleFlight)
+{
+  constexpr int threadCount = 16;
+  LRUCache::ShardedCache<int, int> cache(100, 4);
+  std::atomic<int> loads(0);
+  // The loader only returns once every thread has missed, so all but one wait
+  auto loader = [&cache, &loads](int key)
+  {
+    ++loads;
+    while (cache.stats().misses_ < threadCount)
+      std::this_thread::yield();
+    return key * 2;
+  };
+  std::vector<std::thread> threads;
+  std::vector<int> results(threadCount, 0);
+  for (int t = 0; t < threadCount; ++t)
+    threads.emplace_back([&cache, &loader, &results, t]()
+    {
+      results[t] = cache.get_or_load(21, loader);
+    });
+  for (auto & thread : threads)
+    thread.join();
+  EXPECT_EQ(1, loads.load());
+  for (int result : results)
+    EXPECT_EQ(42, result);
+  EXPECT_TRUE(cache.contains(21));
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, GetOrLoadException)
+{
+  constexpr int threadCount = 8;
+  LRUCache::ShardedCache<int, int> cache(100, 4);
+  std::atomic<int> loads(0);
+  std::atomic<int> failures(0);
+  auto failingLoader = [&cache, &loads](int) -> int
+  {
+    ++loads;
+    while (cache.stats().misses_ < threadCount)
+      std::this_thread::yield();
+    throw std::runtime_error("unavailable");
+  };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t)
+    threads.emplace_back([&cache, &failingLoader, &failures]()
+    {
+      try
+      {
+        cache.get_or_load(7, failingLoader);
+      }
+      catch (const std::runtime_error &)
+      {
+        ++failures;
+      }
+    });
+  for (auto & thread : threads)
+    thread.join();
+  EXPECT_EQ(1, loads.load());
+  EXPECT_EQ(threadCount, failures.load());
+  // The failure is not cached
+  EXPECT_FALSE(cache.contains(7));
+  EXPECT_EQ(7, cache.get_or_load(7, [](int key) { return key; }));
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, GetOrLoadWrittenDuringLoad)
+{
+  LRUCache::ShardedCache<int, int> cache(100, 4);
+  // A put made during the load is newer than the loaded value
+  EXPECT_EQ(1, cache.get_or_load(1, [&cache](int key) { cache.put(key, 10); return key; }));
+  int value = 0;
+  ASSERT_TRUE(cache.get(1, value));
+  EXPECT_EQ(10, value);
+  // So is a remove
+  EXPECT_EQ(3, cache.get_or_load(3, [&cache](int key) { cache.remove(key); return key; }));
+  EXPECT_FALSE(cache.contains(3));
+  cache.clear();
+  EXPECT_EQ(4, cache.get_or_load(4, [&cache](int key) { cache.clear(); return key; }));
+  EXPECT_FALSE(cache.contains(4));
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, GetOrLoadListenerThrows)
+{
+  LRUCache::ShardedCache<int, int> cache(1, 1);
+  cache.put(1, 1);
+  cache.set_removal_listener([](int, int, LRUCache::RemovalCause) { throw std::logic_error("listener"); });
+  // The load succeeded and its value is cached: only the caller sees the
+  // exception of the listener told about the eviction it caused
+  EXPECT_THROW(cache.get_or_load(2, [](int key) { return key; }), std::logic_error);
+  EXPECT_TRUE(cache.contains(2));
+  EXPECT_EQ(2, cache.get_or_load(2, [](int) -> int { throw std::runtime_error("reloaded"); }));
+  const auto stats = cache.stats();
+  EXPECT_EQ(1, stats.loadSuccesses_);
+  EXPECT_EQ(0, stats.loadFailures_);
+}
+//----------------------------------------------------------------------------
+TEST(ShardedLRUCacheTest, MultiGetPut)
+{
+  LRUCache::ShardedCache<int, int> cache(1000, 8);
+  std::vector<std::pair<int, int>> entries;
+  for (int i = 0; i < 100; ++i)
+    entries.emplace_back(i, i + 1);
+  entries.emplace_back(5, 50);
+  cache.multi_put(entries);
+  EXPECT_EQ(100, cache.size());
+  std::vector<int> keys = {5, 200, 7, 99, -1};
+  std::vector<std::optional<int>> values(keys.size());
+  EXPECT_EQ(3, cache.multi_get(keys, values));
+  // The later entry of a key wins, as with successive puts
+  EXPECT_EQ(50, values[0]);
+  EXPECT_FALSE(values[1].has_value());
+  EXPECT_EQ(8, values[2]);
+  EXPECT_EQ(100, values[3]);
+  EXPECT_FALSE(values[4].has_value());
+  auto stats = cache.stats();
+  EXPECT_EQ(3, stats.hits_);
+  EXPECT_EQ(2, stats.misses_);
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
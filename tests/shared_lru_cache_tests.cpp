@@ -0,0 +1,236 @@
+//----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "shared_lru_cache.hpp"
+//----------------------------------------------------------------------------
+namespace
+{
+//----------------------------------------------------------------------------
+std::string segmentName(const char * name)
+{
+  const std::string segment = std::string("/lru_cache_test_") + name + "_" + std::to_string(::getpid());
+  LRUCache::SharedCache<int, int>::remove_segment(segment);
+  return segment;
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Runs `body` in a child process and waits for it to exit.
+ *
+ * @return The exit status of the child.
+ */
+template<class _BodyT>
+int inChild(_BodyT body)
+{
+  const pid_t pid = ::fork();
+  if (pid == 0)
+    ::_exit(body());
+  int status = -1;
+  ::waitpid(pid, &status, 0);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+//----------------------------------------------------------------------------
+} // namespace
+//----------------------------------------------------------------------------
+TEST(SharedLRUCacheTest, Lru)
+{
+  const std::string name = segmentName("lru");
+  LRUCache::SharedCache<int, double> cache(name, 3, 1);
+  ASSERT_TRUE(cache.is_open());
+  EXPECT_TRUE(cache.created());
+  EXPECT_EQ(3, cache.capacity());
+  cache.put(1, 1.5);
+  cache.put(2, 2.5);
+  cache.put(3, 3.5);
+  double value = 0;
+  EXPECT_TRUE(cache.get(1, value));
+  cache.put(4, 4.5);
+  EXPECT_FALSE(cache.contains(2));
+  cache.put(3, 30.5);
+  EXPECT_TRUE(cache.get(3, value));
+  EXPECT_EQ(30.5, value);
+  EXPECT_TRUE(cache.remove(4));
+  EXPECT_FALSE(cache.remove(4));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_FALSE(cache.get(4, value));
+
+  const LRUCache::CacheStats stats = cache.stats();
+  EXPECT_EQ(2, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(4, stats.inserts_);
+  EXPECT_EQ(1, stats.updates_);
+  EXPECT_EQ(1, stats.evictions_);
+  EXPECT_EQ(1, stats.removals_);
+
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_TRUE((LRUCache::SharedCache<int, double>::remove_segment(name)));
+
+  // Fewer items than shards: no shard is left without capacity
+  const std::string small = segmentName("lru_small");
+  LRUCache::SharedCache<int, double> few(small, 3, 16);
+  ASSERT_TRUE(few.is_open());
+  EXPECT_EQ(3, few.shard_count());
+  for (int i = 0; i < 100; ++i)
+  {
+    few.put(i, i);
+    EXPECT_TRUE(few.contains(i));
+  }
+  EXPECT_LE(few.size(), 3);
+  EXPECT_TRUE((LRUCache::SharedCache<int, double>::remove_segment(small)));
+}
+//----------------------------------------------------------------------------
+TEST(SharedLRUCacheTest, Attach)
+{
+  const std::string name = segmentName("attach");
+  LRUCache::SharedCache<int, int> first(name, 64, 4);
+  first.put(1, 10);
+  // The geometry of the existing segment wins
+  LRUCache::SharedCache<int, int> second(name, 1000, 16);
+  ASSERT_TRUE(second.is_open());
+  EXPECT_FALSE(second.created());
+  EXPECT_EQ(64, second.capacity());
+  EXPECT_EQ(4, second.shard_count());
+  EXPECT_EQ(first.bytes(), second.bytes());
+  int value = 0;
+  EXPECT_TRUE(second.get(1, value));
+  EXPECT_EQ(10, value);
+  second.put(2, 20);
+  EXPECT_TRUE(first.contains(2));
+  EXPECT_EQ(1, first.stats().hits_);
+  // Another entry layout is refused
+  LRUCache::SharedCache<int, double> other(name, 64);
+  EXPECT_FALSE(other.is_open());
+  EXPECT_EQ(0, other.capacity());
+  LRUCache::SharedCache<int, int>::remove_segment(name);
+}
+//----------------------------------------------------------------------------
+TEST(SharedLRUCacheTest, Processes)
+{
+  const std::string name = segmentName("processes");
+  LRUCache::SharedCache<int, int> cache(name, 4096, 8);
+  std::vector<pid_t> children;
+  for (int worker = 0; worker < 4; ++worker)
+  {
+    const pid_t pid = ::fork();
+    if (pid == 0)
+    {
+      LRUCache::SharedCache<int, int> shared(name, 4096, 8);
+      for (int i = 0; i < 250; ++i)
+        shared.put(worker * 250 + i, i);
+      ::_exit(shared.created() ? 1 : 0);
+    }
+    children.push_back(pid);
+  }
+  for (pid_t pid : children)
+  {
+    int status = -1;
+    ::waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+  EXPECT_EQ(1000, cache.size());
+  int value = 0;
+  EXPECT_TRUE(cache.get(3 * 250 + 7, value));
+  EXPECT_EQ(7, value);
+  EXPECT_EQ(0, inChild([&name]()
+  {
+    LRUCache::SharedCache<int, int> shared(name, 0);
+    int found = 0;
+    return shared.get(7, found) && found == 7 && shared.stats().hits_ == 2 ? 0 : 1;
+  }));
+  LRUCache::SharedCache<int, int>::remove_segment(name);
+}
+//----------------------------------------------------------------------------
+TEST(SharedLRUCacheTest, OwnerDied)
+{
+  const std::string name = segmentName("owner_died");
+  LRUCache::SharedCache<int, int> cache(name, 64, 2);
+  for (int i = 0; i < 16; ++i)
+    cache.put(i, i);
+  // A worker dies in the middle of an update of shard 0
+  EXPECT_EQ(0, inChild([&name, &cache]()
+  {
+    const int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+    void * address = ::mmap(nullptr, cache.bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    auto * shard = reinterpret_cast<LRUCache::Internal::SharedShard *>(static_cast<char *>(address) + LRUCache::Internal::SHARED_ALIGN);
+    ::pthread_mutex_lock(&shard->mutex_);
+    shard->head_ = 12345;
+    return 0;
+  }));
+  // The next lock clears shard 0 only, and the cache is usable again
+  int kept = 0;
+  for (int i = 0; i < 16; ++i)
+    kept += cache.contains(i) ? 1 : 0;
+  EXPECT_LT(0, kept);
+  EXPECT_GT(16, kept);
+  EXPECT_EQ(kept, cache.size());
+  cache.put(100, 100);
+  int value = 0;
+  EXPECT_TRUE(cache.get(100, value));
+  EXPECT_EQ(100, value);
+  LRUCache::SharedCache<int, int>::remove_segment(name);
+}
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+TEST(SharedLRUCacheTest, NeverReady)
+{
+  const std::string name = segmentName("never_ready");
+  // The creator dies after sizing the segment, before it is ready
+  EXPECT_EQ(0, inChild([&name]()
+  {
+    const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    return fd >= 0 && ::ftruncate(fd, 4096) == 0 ? 0 : 1;
+  }));
+  // The segment is recreated instead of timing out on every open
+  LRUCache::SharedCache<int, int> cache(name, 64, 2);
+  ASSERT_TRUE(cache.is_open());
+  EXPECT_TRUE(cache.created());
+  EXPECT_EQ(64, cache.capacity());
+  cache.put(1, 1);
+  LRUCache::SharedCache<int, int> other(name, 0);
+  ASSERT_TRUE(other.is_open());
+  EXPECT_FALSE(other.created());
+  EXPECT_TRUE(other.contains(1));
+  LRUCache::SharedCache<int, int>::remove_segment(name);
+}
+//----------------------------------------------------------------------------
+TEST(SharedLRUCacheTest, NotRecoverable)
+{
+  const std::string name = segmentName("not_recoverable");
+  LRUCache::SharedCache<int, int> cache(name, 64, 1);
+  cache.put(1, 1);
+  EXPECT_EQ(0, inChild([&name, &cache]()
+  {
+    const int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+    void * address = ::mmap(nullptr, cache.bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    auto * dead = reinterpret_cast<LRUCache::Internal::SharedShard *>(static_cast<char *>(address) + LRUCache::Internal::SHARED_ALIGN);
+    ::pthread_mutex_lock(&dead->mutex_);
+    return 0;
+  }));
+  // A process sees the owner died and unlocks without marking the mutex consistent
+  const int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+  void * address = ::mmap(nullptr, cache.bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  auto * shard = reinterpret_cast<LRUCache::Internal::SharedShard *>(static_cast<char *>(address) + LRUCache::Internal::SHARED_ALIGN);
+  EXPECT_EQ(EOWNERDEAD, ::pthread_mutex_lock(&shard->mutex_));
+  ::pthread_mutex_unlock(&shard->mutex_);
+  // The shard cannot be locked any more: it keeps nothing, and nothing hangs
+  EXPECT_FALSE(cache.contains(1));
+  cache.put(2, 2);
+  int value = 0;
+  EXPECT_FALSE(cache.get(2, value));
+  EXPECT_FALSE(cache.remove(1));
+  EXPECT_EQ(0, cache.size());
+  cache.clear();
+  ::munmap(address, cache.bytes());
+  ::close(fd);
+  LRUCache::SharedCache<int, int>::remove_segment(name);
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
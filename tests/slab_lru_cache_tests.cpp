@@ -0,0 +1,172 @@
+//----------------------------------------------------------------------------
+#include <string>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "slab_lru_cache.hpp"
+//----------------------------------------------------------------------------
+TEST(SlabLRUCacheTest, Initialization)
+{
+  {
+    LRUCache::SlabCache<int, int> cache;
+    ASSERT_EQ(0, cache.capacity());
+    EXPECT_EQ(nullptr, cache.get(1));
+    cache.put(1, 10);
+    EXPECT_EQ(0, cache.size());
+    EXPECT_EQ(nullptr, cache.get(1));
+  }
+  {
+    LRUCache::SlabCache<int, int> cache(10);
+    ASSERT_EQ(10, cache.capacity());
+    for (int i = 1; i <= 10; ++i)
+      EXPECT_EQ(nullptr, cache.get(i));
+    for (int i = 1; i <= 10; ++i)
+      cache.put(i, i);
+    for (int i = 1; i <= 10; ++i)
+      EXPECT_EQ(i, *cache.get(i));
+    EXPECT_EQ(10, cache.size());
+  }
+  {
+    // Links are 32-bit: capacities that do not fit are rejected, not truncated
+    LRUCache::SlabCache<int, int> cache(std::size_t(0xFFFFFFFF) + 1);
+    ASSERT_EQ(0, cache.capacity());
+    cache.put(1, 10);
+    EXPECT_EQ(0, cache.size());
+    EXPECT_EQ(0, cache.memory());
+  }
+}
+//----------------------------------------------------------------------------
+TEST(SlabLRUCacheTest, Emplace)
+{
+  LRUCache::SlabCache<int, std::string> cache(2);
+  cache.emplace(1, 3, 'a');
+  ASSERT_NE(nullptr, cache.get(1));
+  EXPECT_EQ("aaa", *cache.get(1));
+  cache.emplace(1, 2, 'b');
+  EXPECT_EQ("bb", *cache.get(1));
+  EXPECT_EQ(1, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(SlabLRUCacheTest, Remove)
+{
+  LRUCache::SlabCache<int, int> cache(100);
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_FALSE(cache.remove(i));
+  for (int i = 0; i < 100; ++i)
+    cache.put(i, i);
+  for (int i = 0; i < 100; i += 2)
+    EXPECT_TRUE(cache.remove(i));
+  EXPECT_EQ(50, cache.size());
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(i % 2 == 1, cache.contains(i));
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_FALSE(cache.contains(1));
+}
+//----------------------------------------------------------------------------
+TEST(SlabLRUCacheTest, EvictionOrder)
+{
+  LRUCache::SlabCache<std::string, int> cache(3);
+  cache.put("1", 1);
+  cache.put("2", 2);
+  cache.put("3", 3);
+  cache.get("1");
+  cache.put("4", 4);
+  EXPECT_EQ(nullptr, cache.get("2"));
+  EXPECT_EQ(1, *cache.get("1"));
+  EXPECT_EQ(3, *cache.get("3"));
+  EXPECT_EQ(4, *cache.get("4"));
+  cache.put("3", 30);
+  cache.put("5", 5);
+  EXPECT_FALSE(cache.contains("1"));
+  EXPECT_EQ(30, *cache.get("3"));
+}
+//----------------------------------------------------------------------------
+TEST(SlabLRUCacheTest, ConstGetDoesNotPromote)
+{
+  LRUCache::SlabCache<int, int> cache(2);
+  cache.put(1, 1);
+  cache.put(2, 2);
+  const auto & constCache = cache;
+  EXPECT_EQ(1, *constCache.get(1));
+  cache.put(3, 3);
+  EXPECT_FALSE(cache.contains(1));
+}
+//----------------------------------------------------------------------------
+TEST(SlabLRUCacheTest, HashCollisions)
+{
+  struct BadHash
+  {
+    std::size_t operator ()(int key) const
+    {
+      return key % 4;
+    }
+  };
+  LRUCache::SlabCache<int, int, BadHash> cache(64);
+  for (int i = 0; i < 128; ++i)
+    cache.put(i, i);
+  for (int i = 0; i < 64; ++i)
+    EXPECT_EQ(nullptr, cache.get(i));
+  for (int i = 64; i < 128; ++i)
+    EXPECT_EQ(i, *cache.get(i));
+  for (int i = 64; i < 128; i += 3)
+    EXPECT_TRUE(cache.remove(i));
+  for (int i = 64; i < 128; ++i)
+    EXPECT_EQ((i - 64) % 3 != 0, cache.contains(i));
+}
+//----------------------------------------------------------------------------
+TEST(SlabLRUCacheTest, StressTest)
+{
+  LRUCache::SlabCache<int, int> cache(100000);
+  for (int i = 0; i < 200000; ++i)
+    cache.put(i, i);
+  EXPECT_EQ(100000, cache.size());
+  for (int i = 0; i < 100000; ++i)
+    EXPECT_EQ(nullptr, cache.get(i));
+  for (int i = 100000; i < 200000; ++i)
+    EXPECT_EQ(i, *cache.get(i));
+}
+//----------------------------------------------------------------------------
+TEST(SlabLRUCacheTest, ValueLifetime)
+{
+  struct Counted
+  {
+    static int & alive()
+    {
+      static int count = 0;
+      return count;
+    }
+    Counted()                  { ++alive(); }
+    Counted(const Counted &)   { ++alive(); }
+    Counted & operator =(const Counted &) = default;
+    ~Counted()                 { --alive(); }
+  };
+  {
+    LRUCache::SlabCache<int, Counted> cache(4);
+    EXPECT_EQ(0, Counted::alive());
+    for (int i = 0; i < 10; ++i)
+      cache.put(i, Counted());
+    EXPECT_EQ(4, Counted::alive());
+    EXPECT_TRUE(cache.remove(9));
+    EXPECT_EQ(3, Counted::alive());
+    cache.emplace(100);
+    EXPECT_EQ(4, Counted::alive());
+    cache.clear();
+    EXPECT_EQ(0, Counted::alive());
+    cache.put(1, Counted());
+  }
+  EXPECT_EQ(0, Counted::alive());
+}
+//----------------------------------------------------------------------------
+TEST(SlabLRUCacheTest, Memory)
+{
+  LRUCache::SlabCache<int, int> empty;
+  EXPECT_EQ(0, empty.memory());
+  LRUCache::SlabCache<int, int> cache(1000);
+  EXPECT_GE(cache.memory(), 1000 * (4 * sizeof(std::uint32_t) + 2 * sizeof(int)));
+  for (int i = 0; i < 5000; ++i)
+    cache.put(i, i);
+  EXPECT_EQ(1000, cache.size());
+  EXPECT_EQ(4999, *cache.get(4999));
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
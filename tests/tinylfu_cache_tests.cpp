@@ -0,0 +1,106 @@
+//----------------------------------------------------------------------------
+#include <string>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "tinylfu_cache.hpp"
+//----------------------------------------------------------------------------
+TEST(TinyLfuCacheTest, Initialization)
+{
+  LRUCache::TinyLfuCache<int, int> empty;
+  empty.put(1, 1);
+  EXPECT_EQ(0, empty.size());
+  EXPECT_EQ(nullptr, empty.get(1));
+
+  LRUCache::TinyLfuCache<int, int> cache(10);
+  EXPECT_EQ(10, cache.capacity());
+  EXPECT_EQ(0, cache.size());
+  for (int i = 0; i < 10; ++i)
+    cache.put(i, i);
+  EXPECT_EQ(10, cache.size());
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(i, *cache.get(i));
+}
+//----------------------------------------------------------------------------
+TEST(TinyLfuCacheTest, PutGetRemove)
+{
+  LRUCache::TinyLfuCache<int, std::string> cache(100);
+  cache.put(1, "1");
+  cache.put(2, std::string("2"));
+  cache.emplace(3, 3, '3');
+  EXPECT_EQ("1", *cache.get(1));
+  EXPECT_EQ("333", *cache.get(3));
+  cache.put(1, "one");
+  const auto & constCache = cache;
+  EXPECT_EQ("one", *constCache.get(1));
+  EXPECT_TRUE(cache.contains(2));
+  EXPECT_TRUE(cache.remove(2));
+  EXPECT_FALSE(cache.remove(2));
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_EQ(2, cache.size());
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(nullptr, cache.get(1));
+}
+//----------------------------------------------------------------------------
+TEST(TinyLfuCacheTest, NeverExceedsCapacity)
+{
+  for (int capacity : {1, 2, 3, 50, 101})
+  {
+    LRUCache::TinyLfuCache<int, int> cache(capacity);
+    for (int i = 0; i < 1000; ++i)
+    {
+      cache.put(i % 137, i);
+      cache.get(i % 11);
+      EXPECT_LE(cache.size(), static_cast<std::size_t>(capacity));
+    }
+  }
+}
+//----------------------------------------------------------------------------
+TEST(TinyLfuCacheTest, ScanDoesNotFlushHotEntries)
+{
+  LRUCache::TinyLfuCache<int, int> cache(100);
+  for (int round = 0; round < 5; ++round)
+    for (int i = 0; i < 50; ++i)
+      if (cache.get(i) == nullptr)
+        cache.put(i, i);
+  // Hot keys keep being requested while a scan of one-hit wonders ten times
+  // larger than the cache goes by. Every hot key is reused after 150 distinct
+  // keys, so plain LRU of the same capacity would keep none of them.
+  for (int i = 0; i < 1000; ++i)
+  {
+    if (cache.get(i % 50) == nullptr)
+      cache.put(i % 50, i % 50);
+    for (int scanKey : {1000 + 2 * i, 1001 + 2 * i})
+      if (cache.get(scanKey) == nullptr)
+        cache.put(scanKey, scanKey);
+  }
+  int hot = 0;
+  for (int i = 0; i < 50; ++i)
+    hot += cache.contains(i);
+  EXPECT_EQ(50, hot);
+  EXPECT_EQ(100, cache.size());
+}
+//----------------------------------------------------------------------------
+TEST(FrequencySketchTest, EstimatesAndAges)
+{
+  LRUCache::Internal::FrequencySketch sketch(512);
+  EXPECT_EQ(0u, sketch.frequency(42));
+  for (int i = 0; i < 5; ++i)
+    sketch.increment(42);
+  EXPECT_EQ(5u, sketch.frequency(42));
+  for (int i = 0; i < 100; ++i)
+    sketch.increment(7);
+  // Counters saturate at 15
+  EXPECT_EQ(15u, sketch.frequency(7));
+  EXPECT_EQ(0u, sketch.frequency(1234567));
+  // 10 * capacity increments halve all counters
+  for (std::uint64_t i = 0; i < 10 * 512; ++i)
+    sketch.increment(1000000 + i);
+  EXPECT_LE(sketch.frequency(7), 8u);
+  EXPECT_LT(sketch.frequency(42), 5u);
+  EXPECT_EQ(64u * 64, sketch.memory());
+  sketch.clear();
+  EXPECT_EQ(0u, sketch.frequency(7));
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
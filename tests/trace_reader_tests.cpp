@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------------
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+//----------------------------------------------------------------------------
+#include <gtest/gtest.h>
+//----------------------------------------------------------------------------
+#include "trace_reader.hpp"
+//----------------------------------------------------------------------------
+namespace
+{
+//----------------------------------------------------------------------------
+std::string tracePath(const char * name, const std::string & contents)
+{
+  const std::string path = ::testing::TempDir() + name;
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+  return path;
+}
+//----------------------------------------------------------------------------
+std::vector<std::uint64_t> readAll(LRUCache::TraceReader & reader)
+{
+  std::vector<std::uint64_t> keys;
+  std::uint64_t key;
+  while (reader.next(key))
+    keys.push_back(key);
+  return keys;
+}
+//----------------------------------------------------------------------------
+} // namespace
+//----------------------------------------------------------------------------
+TEST(TraceReaderTest, Binary)
+{
+  const std::vector<std::uint64_t> keys = {1, 2, 1ull << 40, 2};
+  // A trailing partial key is ignored
+  const std::string path = tracePath("trace.bin", std::string(reinterpret_cast<const char *>(keys.data()), keys.size() * 8) + "abc");
+  LRUCache::TraceReader reader(path, LRUCache::TraceFormat::BINARY);
+  ASSERT_TRUE(reader.is_open());
+  EXPECT_EQ(35, reader.bytes());
+  EXPECT_EQ(keys, readAll(reader));
+  reader.rewind();
+  EXPECT_EQ(keys, readAll(reader));
+  std::remove(path.c_str());
+
+  LRUCache::TraceReader missing(path, LRUCache::TraceFormat::BINARY);
+  EXPECT_FALSE(missing.is_open());
+  std::uint64_t key;
+  EXPECT_FALSE(missing.next(key));
+}
+//----------------------------------------------------------------------------
+TEST(TraceReaderTest, Csv)
+{
+  const std::string path = tracePath("trace.csv", "# time,key\n10,42\r\n\n11,user:7\n12,42\n13\n");
+  LRUCache::TraceReader reader(path, LRUCache::TraceFormat::CSV, 1);
+  const std::vector<std::uint64_t> expected = {42, LRUCache::TraceReader::hash("user:7", 6), 42};
+  EXPECT_EQ(expected, readAll(reader));
+  LRUCache::TraceReader first(path, LRUCache::TraceFormat::CSV);
+  EXPECT_EQ(std::vector<std::uint64_t>({10, 11, 12, 13}), readAll(first));
+  std::remove(path.c_str());
+}
+//----------------------------------------------------------------------------
+TEST(TraceReaderTest, Twitter)
+{
+  const std::string path = tracePath("trace.twitter", "0,key_a,10,100,1,get,0\n1,key_b,10,100,1,set,0\n2,key_a,10,100,2,get,0");
+  LRUCache::TraceReader reader(path, LRUCache::TraceFormat::TWITTER);
+  const std::uint64_t a = LRUCache::TraceReader::hash("key_a", 5);
+  const std::uint64_t b = LRUCache::TraceReader::hash("key_b", 5);
+  EXPECT_EQ(std::vector<std::uint64_t>({a, b, a}), readAll(reader));
+  std::remove(path.c_str());
+}
+//----------------------------------------------------------------------------
+TEST(TraceReaderTest, Spc)
+{
+  const std::string path = tracePath("trace.spc", "0,303567,3584,w,0.000000\n1,303567,512,r,0.01\nbad,1,1,r,0\n");
+  LRUCache::TraceReader reader(path, LRUCache::TraceFormat::SPC);
+  EXPECT_EQ(std::vector<std::uint64_t>({303567, (1ull << 48) + 303567}), readAll(reader));
+  std::remove(path.c_str());
+}
+//----------------------------------------------------------------------------
+TEST(TraceReaderTest, Arc)
+{
+  const std::string path = tracePath("trace.arc", "100 3 0 1\n  7\t1 0 2\n5 0 0 3\n");
+  LRUCache::TraceReader reader(path, LRUCache::TraceFormat::ARC);
+  EXPECT_EQ(std::vector<std::uint64_t>({100, 101, 102, 7}), readAll(reader));
+  reader.rewind();
+  std::uint64_t key;
+  ASSERT_TRUE(reader.next(key));
+  reader.rewind();
+  EXPECT_EQ(4, readAll(reader).size());
+  std::remove(path.c_str());
+}
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,303 @@
+//----------------------------------------------------------------------------
+#ifndef TRACE_READER_HPP
+#define TRACE_READER_HPP
+//----------------------------------------------------------------------------
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+//----------------------------------------------------------------------------
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+/**
+ * @brief Layout of an access trace file.
+ */
+enum class TraceFormat : std::uint8_t
+{
+  BINARY,  ///< Native-endian 64-bit keys, one after the other.
+  CSV,     ///< One request per line; the key is in a given column.
+  TWITTER, ///< Twitter cache traces: timestamp,key,key size,value size,client,operation,TTL.
+  SPC,     ///< SPC / UMass storage traces: ASU,LBA,size,opcode,timestamp. The key is the ASU and the LBA.
+  ARC      ///< ARC traces: "first block, block count, ...", one request for every block.
+};
+//----------------------------------------------------------------------------
+/**
+ * @brief Streams the keys of an access trace from a memory-mapped file.
+ *
+ * The file is mapped read-only and read sequentially, so the kernel reads
+ * ahead and drops the pages already read: traces much larger than the
+ * memory are replayed without loading them. Numeric keys are used as they
+ * are, and any other key is hashed with 64-bit FNV-1a. Empty lines and
+ * lines starting with '#' are skipped.
+ */
+class TraceReader
+{
+//----------------------------------------------------------------------------
+public:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Opens and maps a trace. Check `is_open` for failures.
+   *
+   * @param path The trace file.
+   * @param format The layout of the file.
+   * @param column The column of the key, for `TraceFormat::CSV`.
+   */
+  TraceReader(const std::string & path, TraceFormat format, std::size_t column = 0);
+  TraceReader(const TraceReader &) = delete;
+  TraceReader & operator =(const TraceReader &) = delete;
+  ~TraceReader();
+  /**
+   * @brief Tells whether the file is mapped.
+   */
+  bool is_open() const;
+  /**
+   * @brief Retrieves the size of the file in bytes.
+   */
+  std::size_t bytes() const;
+  /**
+   * @brief Reads the next key.
+   *
+   * @return False at the end of the trace.
+   */
+  bool next(std::uint64_t & key);
+  /**
+   * @brief Goes back to the first key.
+   */
+  void rewind();
+  /**
+   * @brief Hashes a key that is not a number, with 64-bit FNV-1a.
+   */
+  static std::uint64_t hash(const char * data, std::size_t size);
+//----------------------------------------------------------------------------
+private:
+//----------------------------------------------------------------------------
+  /**
+   * @brief Returns the field of `[line, end)` at `column`, split on commas
+   *        or, if `blank` is set, on spaces and tabs.
+   */
+  static bool field(const char * line, const char * end, std::size_t column, bool blank, const char *& first, const char *& last);
+  /**
+   * @brief Parses a decimal field, or hashes it if it is not one.
+   */
+  static std::uint64_t parse(const char * first, const char * last, bool & numeric);
+//----------------------------------------------------------------------------
+  int           fd_;
+  const char *  map_;      ///< Start of the mapping, nullptr if none.
+  std::size_t   size_;
+  const char *  cursor_;   ///< Next byte to read.
+  TraceFormat   format_;
+  std::size_t   column_;
+  std::uint64_t block_;    ///< Next block of the ARC request being expanded.
+  std::uint64_t blocks_;   ///< Blocks of the ARC request still to return.
+//----------------------------------------------------------------------------
+}; // class TraceReader
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+namespace LRUCache
+{
+//----------------------------------------------------------------------------
+inline TraceReader::TraceReader(const std::string & path, TraceFormat format, std::size_t column) :
+  fd_(-1),
+  map_(nullptr),
+  size_(0),
+  cursor_(nullptr),
+  format_(format),
+  column_(column),
+  block_(0),
+  blocks_(0)
+{
+  fd_ = ::open(path.c_str(), O_RDONLY);
+  struct stat status;
+  if (fd_ < 0 || ::fstat(fd_, &status) != 0)
+    return;
+  size_ = static_cast<std::size_t>(status.st_size);
+  if (size_ == 0)
+  {
+    // Nothing to map, but a valid empty trace
+    map_    = "";
+    cursor_ = map_;
+    return;
+  }
+  void * address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (address == MAP_FAILED)
+  {
+    size_ = 0;
+    return;
+  }
+  ::madvise(address, size_, MADV_SEQUENTIAL);
+  map_    = static_cast<const char *>(address);
+  cursor_ = map_;
+}
+//----------------------------------------------------------------------------
+inline TraceReader::~TraceReader()
+{
+  if (map_ != nullptr && size_ != 0)
+    ::munmap(const_cast<char *>(map_), size_);
+  if (fd_ >= 0)
+    ::close(fd_);
+}
+//----------------------------------------------------------------------------
+inline bool TraceReader::is_open() const
+{
+  return map_ != nullptr;
+}
+//----------------------------------------------------------------------------
+inline std::size_t TraceReader::bytes() const
+{
+  return size_;
+}
+//----------------------------------------------------------------------------
+inline bool TraceReader::next(std::uint64_t & key)
+{
+  if (map_ == nullptr)
+    return false;
+  if (blocks_ != 0)
+  {
+    key = block_++;
+    --blocks_;
+    return true;
+  }
+  const char * end = map_ + size_;
+  if (format_ == TraceFormat::BINARY)
+  {
+    if (end - cursor_ < static_cast<std::ptrdiff_t>(sizeof(key)))
+      return false;
+    std::memcpy(&key, cursor_, sizeof(key));
+    cursor_ += sizeof(key);
+    return true;
+  }
+  while (cursor_ < end)
+  {
+    const char * line    = cursor_;
+    const char * newline = static_cast<const char *>(std::memchr(line, '\n', end - line));
+    const char * last    = newline == nullptr ? end : newline;
+    cursor_ = newline == nullptr ? end : newline + 1;
+    if (last > line && last[-1] == '\r')
+      --last;
+    if (line == last || *line == '#')
+      continue;
+
+    const char * first;
+    const char * stop;
+    bool numeric;
+    switch (format_)
+    {
+      case TraceFormat::CSV:
+        if (!field(line, last, column_, false, first, stop))
+          continue;
+        key = parse(first, stop, numeric);
+        return true;
+      case TraceFormat::TWITTER:
+        if (!field(line, last, 1, false, first, stop))
+          continue;
+        key = parse(first, stop, numeric);
+        return true;
+      case TraceFormat::SPC:
+      {
+        if (!field(line, last, 0, false, first, stop))
+          continue;
+        const std::uint64_t asu = parse(first, stop, numeric);
+        if (!numeric || !field(line, last, 1, false, first, stop))
+          continue;
+        const std::uint64_t lba = parse(first, stop, numeric);
+        if (!numeric)
+          continue;
+        key = asu << 48 ^ lba;
+        return true;
+      }
+      case TraceFormat::ARC:
+      {
+        if (!field(line, last, 0, true, first, stop))
+          continue;
+        const std::uint64_t start = parse(first, stop, numeric);
+        if (!numeric || !field(line, last, 1, true, first, stop))
+          continue;
+        const std::uint64_t count = parse(first, stop, numeric);
+        if (!numeric || count == 0)
+          continue;
+        key     = start;
+        block_  = start + 1;
+        blocks_ = count - 1;
+        return true;
+      }
+      case TraceFormat::BINARY:
+        break;
+    }
+  }
+  return false;
+}
+//----------------------------------------------------------------------------
+inline void TraceReader::rewind()
+{
+  cursor_ = map_;
+  blocks_ = 0;
+}
+//----------------------------------------------------------------------------
+inline std::uint64_t TraceReader::hash(const char * data, std::size_t size)
+{
+  std::uint64_t hash = 14695981039346656037ull;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+//----------------------------------------------------------------------------
+inline bool TraceReader::field(const char * line, const char * end, std::size_t column, bool blank, const char *& first, const char *& last)
+{
+  auto separator = [blank](char c)
+  {
+    return blank ? c == ' ' || c == '\t' : c == ',';
+  };
+  const char * cursor = line;
+  if (blank)
+    while (cursor < end && separator(*cursor))
+      ++cursor;
+  for (std::size_t i = 0; i < column; ++i)
+  {
+    while (cursor < end && !separator(*cursor))
+      ++cursor;
+    if (cursor == end)
+      return false;
+    ++cursor;
+    if (blank)
+      while (cursor < end && separator(*cursor))
+        ++cursor;
+  }
+  first = cursor;
+  while (cursor < end && !separator(*cursor))
+    ++cursor;
+  last = cursor;
+  return blank ? first != last : true;
+}
+//----------------------------------------------------------------------------
+inline std::uint64_t TraceReader::parse(const char * first, const char * last, bool & numeric)
+{
+  std::uint64_t value = 0;
+  numeric = first != last && last - first <= 19;
+  for (const char * c = first; numeric && c != last; ++c)
+  {
+    if (*c < '0' || *c > '9')
+      numeric = false;
+    else
+      value = value * 10 + static_cast<std::uint64_t>(*c - '0');
+  }
+  return numeric ? value : hash(first, last - first);
+}
+//----------------------------------------------------------------------------
+} // namespace LRUCache
+//----------------------------------------------------------------------------
+#endif // TRACE_READER_HPP
+//----------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,283 @@
+//----------------------------------------------------------------------------
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <algorithm>
+//----------------------------------------------------------------------------
+#include "lru_cache.hpp"
+#include "arc_cache.hpp"
+#include "clock_cache.hpp"
+#include "trace_reader.hpp"
+#include "s3fifo_cache.hpp"
+#include "tinylfu_cache.hpp"
+#include "segmented_cache.hpp"
+//----------------------------------------------------------------------------
+namespace
+{
+//----------------------------------------------------------------------------
+constexpr const char * USAGE =
+  "Usage: trace_replay [options] <trace>\n"
+  "Replays an access trace against cache policies and capacities, and prints\n"
+  "one CSV row per run: policy,capacity,requests,hits,hit_ratio,seconds,mops\n"
+  "\n"
+  "  --format F         binary (default), csv, twitter, spc or arc\n"
+  "  --column N         key column of a csv trace (default 0)\n"
+  "  --policies P,...   lru, fifo, lfu, arc, tinylfu, segmented, s3fifo, clock\n"
+  "                     (default lru,arc,tinylfu,s3fifo)\n"
+  "  --capacities C,... cache sizes in entries (default 1000,10000,100000,1000000)\n"
+  "  --threads N        runs replayed in parallel (default: all cores)\n"
+  "  --limit N          only replay the first N requests\n";
+//----------------------------------------------------------------------------
+constexpr const char * POLICIES[] = {"lru", "fifo", "lfu", "arc", "tinylfu", "segmented", "s3fifo", "clock"};
+//----------------------------------------------------------------------------
+struct Options
+{
+  std::string                path_;
+  LRUCache::TraceFormat      format_     = LRUCache::TraceFormat::BINARY;
+  std::size_t                column_     = 0;
+  std::vector<std::string>   policies_   = {"lru", "arc", "tinylfu", "s3fifo"};
+  std::vector<std::size_t>   capacities_ = {1000, 10000, 100000, 1000000};
+  std::size_t                threads_    = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  std::uint64_t              limit_      = UINT64_MAX;
+};
+//----------------------------------------------------------------------------
+struct Run
+{
+  std::string   policy_;
+  std::size_t   capacity_ = 0;
+  std::uint64_t requests_ = 0;
+  std::uint64_t hits_     = 0;
+  double        seconds_  = 0.0;
+  bool          known_    = false; ///< The policy exists.
+  bool          done_     = false; ///< The trace was replayed; false if it could not be opened.
+};
+//----------------------------------------------------------------------------
+std::vector<std::string> split(const char * list)
+{
+  std::vector<std::string> items;
+  std::string item;
+  for (const char * c = list; ; ++c)
+  {
+    if (*c == ',' || *c == '\0')
+    {
+      if (!item.empty())
+        items.push_back(item);
+      item.clear();
+      if (*c == '\0')
+        return items;
+    }
+    else
+      item += *c;
+  }
+}
+//----------------------------------------------------------------------------
+bool parseNumber(const char * text, std::uint64_t & number)
+{
+  char * end = nullptr;
+  number = std::strtoull(text, &end, 10);
+  return end != text && *end == '\0';
+}
+//----------------------------------------------------------------------------
+bool knownPolicy(const std::string & policy)
+{
+  return std::find(std::begin(POLICIES), std::end(POLICIES), policy) != std::end(POLICIES);
+}
+//----------------------------------------------------------------------------
+bool parseOptions(int argc, char ** argv, Options & options)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const char * arg = argv[i];
+    if (std::strncmp(arg, "--", 2) != 0)
+    {
+      if (!options.path_.empty())
+        return false;
+      options.path_ = arg;
+      continue;
+    }
+    if (i + 1 == argc)
+      return false;
+    const char * value = argv[++i];
+    std::uint64_t number = 0;
+    if (std::strcmp(arg, "--format") == 0)
+    {
+      if (std::strcmp(value, "binary") == 0)
+        options.format_ = LRUCache::TraceFormat::BINARY;
+      else if (std::strcmp(value, "csv") == 0)
+        options.format_ = LRUCache::TraceFormat::CSV;
+      else if (std::strcmp(value, "twitter") == 0)
+        options.format_ = LRUCache::TraceFormat::TWITTER;
+      else if (std::strcmp(value, "spc") == 0)
+        options.format_ = LRUCache::TraceFormat::SPC;
+      else if (std::strcmp(value, "arc") == 0)
+        options.format_ = LRUCache::TraceFormat::ARC;
+      else
+        return false;
+    }
+    else if (std::strcmp(arg, "--column") == 0 && parseNumber(value, number))
+      options.column_ = number;
+    else if (std::strcmp(arg, "--policies") == 0)
+    {
+      options.policies_ = split(value);
+      if (!std::all_of(options.policies_.begin(), options.policies_.end(), knownPolicy))
+        return false;
+    }
+    else if (std::strcmp(arg, "--capacities") == 0)
+    {
+      options.capacities_.clear();
+      for (const std::string & item : split(value))
+      {
+        if (!parseNumber(item.c_str(), number) || number == 0)
+          return false;
+        options.capacities_.push_back(number);
+      }
+    }
+    else if (std::strcmp(arg, "--threads") == 0 && parseNumber(value, number) && number != 0)
+      options.threads_ = number;
+    else if (std::strcmp(arg, "--limit") == 0 && parseNumber(value, number))
+      options.limit_ = number;
+    else
+      return false;
+  }
+  return !options.path_.empty() && !options.policies_.empty() && !options.capacities_.empty();
+}
+//----------------------------------------------------------------------------
+/**
+ * @brief Looks a key up and inserts it on a miss, the way a read-through
+ *        cache in front of the traced system would.
+ */
+template<class _CacheT>
+bool lookup(_CacheT & cache, std::uint64_t key)
+{
+  bool hit;
+  if constexpr (requires { cache.get(key) != nullptr; })
+    hit = cache.get(key) != nullptr;
+  else
+  {
+    std::uint64_t value;
+    hit = cache.get(key, value);
+  }
+  if (!hit)
+    cache.put(key, key);
+  return hit;
+}
+//----------------------------------------------------------------------------
+template<class _CacheT>
+void replay(const Options & options, Run & run)
+{
+  LRUCache::TraceReader reader(options.path_, options.format_, options.column_);
+  if (!reader.is_open())
+    return;
+  _CacheT cache(run.capacity_);
+  std::uint64_t key;
+  const auto start = std::chrono::steady_clock::now();
+  while (run.requests_ < options.limit_ && reader.next(key))
+  {
+    run.hits_ += lookup(cache, key);
+    ++run.requests_;
+  }
+  run.seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  run.done_    = true;
+}
+//----------------------------------------------------------------------------
+bool replay(const Options & options, Run & run)
+{
+  using KeyT = std::uint64_t;
+  if (run.policy_ == "lru")
+    replay<LRUCache::Cache<KeyT, KeyT>>(options, run);
+  else if (run.policy_ == "fifo")
+    replay<LRUCache::FifoCache<KeyT, KeyT>>(options, run);
+  else if (run.policy_ == "lfu")
+    replay<LRUCache::LfuCache<KeyT, KeyT>>(options, run);
+  else if (run.policy_ == "arc")
+    replay<LRUCache::ArcCache<KeyT, KeyT>>(options, run);
+  else if (run.policy_ == "tinylfu")
+    replay<LRUCache::TinyLfuCache<KeyT, KeyT>>(options, run);
+  else if (run.policy_ == "segmented")
+    replay<LRUCache::SegmentedCache<KeyT, KeyT>>(options, run);
+  else if (run.policy_ == "s3fifo")
+    replay<LRUCache::S3FifoCache<KeyT, KeyT>>(options, run);
+  else if (run.policy_ == "clock")
+    replay<LRUCache::ClockCache<KeyT, KeyT>>(options, run);
+  else
+    return false;
+  return true;
+}
+//----------------------------------------------------------------------------
+} // namespace
+//----------------------------------------------------------------------------
+int main(int argc, char ** argv)
+{
+  Options options;
+  if (!parseOptions(argc, argv, options))
+  {
+    std::fputs(USAGE, stderr);
+    return 2;
+  }
+  {
+    LRUCache::TraceReader reader(options.path_, options.format_, options.column_);
+    if (!reader.is_open())
+    {
+      std::fprintf(stderr, "trace_replay: cannot open %s\n", options.path_.c_str());
+      return 1;
+    }
+  }
+
+  // One run per policy and capacity, largest first so that the longest
+  // runs do not start last. Every run streams its own copy of the trace
+  // through the page cache.
+  std::vector<Run> runs;
+  for (const std::string & policy : options.policies_)
+    for (std::size_t capacity : options.capacities_)
+      runs.push_back(Run{policy, capacity});
+  std::vector<std::size_t> order(runs.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&runs](std::size_t lhs, std::size_t rhs)
+  {
+    return runs[lhs].capacity_ > runs[rhs].capacity_;
+  });
+
+  std::atomic<std::size_t> next{0};
+  auto worker = [&]()
+  {
+    for (std::size_t i; (i = next.fetch_add(1)) < order.size();)
+      runs[order[i]].known_ = replay(options, runs[order[i]]);
+  };
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < std::min(options.threads_, runs.size()); ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread & thread : threads)
+    thread.join();
+
+  // NOTE: the trace was opened above, but a run can still fail to open it,
+  // e.g. if it was removed or the process ran out of file descriptors
+  int status = 0;
+  std::printf("policy,capacity,requests,hits,hit_ratio,seconds,mops\n");
+  for (const Run & run : runs)
+  {
+    if (!run.done_)
+    {
+      if (run.known_)
+        std::fprintf(stderr, "trace_replay: cannot open %s for %s,%zu\n", options.path_.c_str(), run.policy_.c_str(), run.capacity_);
+      else
+        std::fprintf(stderr, "trace_replay: unknown policy %s\n", run.policy_.c_str());
+      status = 1;
+      continue;
+    }
+    const double ratio = run.requests_ == 0 ? 0.0 : static_cast<double>(run.hits_) / static_cast<double>(run.requests_);
+    const double mops  = run.seconds_ == 0.0 ? 0.0 : static_cast<double>(run.requests_) / run.seconds_ / 1e6;
+    std::printf("%s,%zu,%llu,%llu,%.6f,%.3f,%.2f\n", run.policy_.c_str(), run.capacity_,
+                static_cast<unsigned long long>(run.requests_), static_cast<unsigned long long>(run.hits_), ratio, run.seconds_, mops);
+  }
+  return status;
+}
+//----------------------------------------------------------------------------
\ No newline at end of file